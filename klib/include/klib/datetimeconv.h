@@ -5,6 +5,12 @@
   datetimeconv.h 
   
   Functions for converting times and dates 
+
+  Functions that take a timezone name (tz) look up the zone each time,
+  which is cheap after the first, because zones are cached. The _r
+  variants take a zone handle from ktimezone_get() instead. In both
+  cases, a NULL zone means the system timezone, and all the functions 
+  are safe to call from more than one thread at a time.
   
   Copyright (c)2020 Kevin Boone, GPL v3.0
 
@@ -13,17 +19,28 @@
 #pragma once
 
 #include <time.h>
+#include <klib/ktimezone.h>
 
 BEGIN_DECLS
 
 extern char *datetimeconv_format_time (const char *fmt, const char *tz_city, 
          time_t t);
 
+/** Format a time into a buffer of len bytes, which is returned. fmt is
+ * a strftime() format, or one of "12hr", "24hr", "long_date" (e.g.,
+ * "Jan 21 2020") or "short_date" ("Jan 21"). The result is truncated 
+ * if it does not fit. To format many times in the same way, a
+ * KTimeFormat is quicker. */
+extern char *datetimeconv_format_time_r (const char *fmt, 
+         const KTimeZone *tz, time_t t, char *buff, size_t len);
+
 /** Get the current year, for a specified timezone. There's only a few
  * hours each year when the timezone could make any difference, but it's
  * still possible that it might. If tz is null, uses the system timezone. */
 int datetimeconv_get_current_year (const char *tz);
 
+extern int datetimeconv_get_current_year_r (const KTimeZone *tz);
+
 /** Get the day of the year in which falls the specified time. For the
     avoidance of doubt: t relates to a UTC time. */
 extern int    datetimeconv_get_day_of_year (time_t t);
@@ -38,6 +55,9 @@ time_t datetimeconv_jd_to_time (double jd);
  * if tz is NULL, behaves as localtime_r(). */
 void datetimeconv_localtime (time_t *t, struct tm *tm, const char *tz);
 
+extern void datetimeconv_localtime_r (time_t t, struct tm *tm, 
+                const KTimeZone *tz);
+
 /** Make a Unix time_t from a list of time values. Any value can be -1,
  * in which case the value for the current time is user. tz is a timezone
  * name, e.g., EST, or a city name, e.g., 'Europe/Paris'. It can't be
@@ -47,10 +67,16 @@ void datetimeconv_localtime (time_t *t, struct tm *tm, const char *tz);
 extern time_t datetimeconv_maketime (int year, int month, int day, 
                 int hour, int min, int sec, const char *tz);
 
+extern time_t datetimeconv_maketime_r (int year, int month, int day, 
+                int hour, int min, int sec, const KTimeZone *tz);
+
 /** Change the time of a time_t, whilst keeping the date the same. */
 extern time_t datetimeconv_make_time_on_day (time_t t, int h, 
                 int m, int s, const char *tz);
 
+extern time_t datetimeconv_make_time_on_day_r (time_t t, int h, 
+                int m, int s, const KTimeZone *tz);
+
 /** Parse a date in a variety of different formats. The h and m arguments
  * are the hours and minutes to fill in, to complete the time_t return
  * value. Supported formats are:
@@ -68,6 +94,9 @@ extern time_t datetimeconv_make_time_on_day (time_t t, int h,
  */
 time_t datetimeconv_parse_date (const char *s, int h, int m, const char *tz);
 
+extern time_t datetimeconv_parse_date_r (const char *s, int h, int m, 
+                const KTimeZone *tz);
+
 /* Convert a unix time to a julian date. */
 extern double datetimeconv_time_to_jd (time_t t);
 
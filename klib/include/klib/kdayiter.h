@@ -0,0 +1,70 @@
+/*============================================================================
+
+  klib
+
+  kdayiter.h
+
+  An iterator over the local calendar days in a range of dates, in a
+  particular timezone. For each day it gives the instant at which the
+  day starts and the instant at which the next day starts, so the day
+  is the half-open period [start, end). A day is usually 86400 seconds
+  long, but can be 23 or 25 hours (or some other length) when the clocks
+  change.
+
+  The boundaries are worked out from the zone's transitions, which are
+  read once for the whole range, so successive days cost a little
+  arithmetic each, and never a call to mktime(). If midnight does not
+  exist on some day, because the clocks went forward past it, the day
+  starts at the change. If it occurs twice, the day starts at the first.
+  A day that was skipped entirely, as Samoa skipped 30th December 2011,
+  has zero length.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <time.h>
+#include <klib/types.h>
+#include <klib/defs.h>
+#include <klib/ktimezone.h>
+
+struct _KDayIter;
+typedef struct _KDayIter KDayIter;
+
+/* One day, as returned by kdayiter_next(). month is 1-12. length is
+ * end - start, in seconds. */
+typedef struct _KDay
+  {
+  int year;
+  int month;
+  int day;
+  time_t start;
+  time_t end;
+  int length;
+  } KDay;
+
+BEGIN_DECLS
+
+/** Create an iterator over the days from first to last inclusive, each
+ * given as year, month (1-12) and day. tz may be NULL, meaning the
+ * system timezone. Out-of-range months and days are normalized, as
+ * mktime() would, so the 32nd of January is the 1st of February. */
+extern KDayIter *kdayiter_new (const KTimeZone *tz, int first_year,
+                   int first_month, int first_day, int last_year,
+                   int last_month, int last_day);
+
+/** Create an iterator over the n days starting with the local day in
+ * which time t falls. */
+extern KDayIter *kdayiter_new_from_time (const KTimeZone *tz, time_t t,
+                   int n);
+
+/** Get the next day. Returns FALSE, and leaves day unchanged, when there
+ * are no more days in the range. */
+extern BOOL kdayiter_next (KDayIter *self, KDay *day);
+
+extern void kdayiter_destroy (KDayIter *self);
+
+END_DECLS
+
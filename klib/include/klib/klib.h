@@ -24,6 +24,9 @@
 #include <klib/kterminal.h>
 #include <klib/klinux_terminal.h>
 #include <klib/numberformat.h>
+#include <klib/ktimezone.h>
 #include <klib/datetimeconv.h>
+#include <klib/ktimeformat.h>
+#include <klib/kdayiter.h>
 #include <klib/mathutil.h>
 
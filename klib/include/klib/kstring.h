@@ -63,6 +63,18 @@ extern size_t        kstring_find_last_utf8 (const KString *self,
 extern size_t        kstring_find_last_utf32 (const KString *self, 
                         const UTF32 *s);
 
+/** Fold a character to lower case, for case-insensitive comparison. 
+    This covers ASCII, Latin-1, Latin Extended-A, Greek and Cyrillic
+    capitals; other characters are returned unchanged. */
+extern UTF32         kstring_fold_char (UTF32 c);
+
+/** Fold a UTF8 string to lower case, as kstring_fold_char() does, into a
+    buffer of size bytes supplied by the caller. Bytes that are not valid
+    UTF8 are copied unchanged. The result is always terminated; the
+    function returns its length, or (size_t)-1 if it did not fit. */
+extern size_t        kstring_fold_utf8 (const UTF8 *s, UTF8 *buff, 
+                        size_t size);
+
 extern UTF32         kstring_get (const KString *self, size_t i);
 
 // Get a specific character in the string as a set of UTF8 bytes. The
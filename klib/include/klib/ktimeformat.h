@@ -0,0 +1,58 @@
+/*============================================================================
+
+  klib
+
+  ktimeformat.h
+
+  Precompiled time formats. A KTimeFormat parses its format once, and
+  is bound to a timezone once, and then formats times into buffers
+  supplied by the caller, so formatting many times costs no allocation
+  and no timezone lookup. The format is anything that
+  datetimeconv_format_time() accepts: a strftime() format, or one of
+  "12hr", "24hr", "long_date" or "short_date". The common numeric
+  conversions are done directly; others are passed to strftime() one
+  at a time.
+
+  Formatting does not change the KTimeFormat, so one object can be used
+  from more than one thread at a time.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <time.h>
+#include <stddef.h>
+#include <klib/types.h>
+#include <klib/defs.h>
+#include <klib/ktimezone.h>
+
+// A buffer of this size holds the result of any of the named formats
+#define KTIMEFORMAT_MAX 32
+
+struct _KTimeFormat;
+typedef struct _KTimeFormat KTimeFormat;
+
+BEGIN_DECLS
+
+/** Compile a format for the specified zone, which can be NULL to mean
+ * the system timezone. The zone must outlive the format, which is
+ * always the case for zones from ktimezone_get(). */
+extern KTimeFormat *ktimeformat_new (const char *fmt, const KTimeZone *tz);
+
+extern void ktimeformat_destroy (KTimeFormat *self);
+
+/** Format a time into a buffer of len bytes. The result is always
+ * terminated, and truncated if it does not fit. Returns the length of
+ * the result. */
+extern int ktimeformat_format (const KTimeFormat *self, time_t t,
+              char *buff, size_t len);
+
+/** Format n times. The result for times[i] is written at
+ * buff + i * stride, and is truncated to fit in stride bytes. */
+extern void ktimeformat_format_batch (const KTimeFormat *self,
+              const time_t *times, int n, char *buff, size_t stride);
+
+END_DECLS
+
@@ -0,0 +1,98 @@
+/*============================================================================
+  
+  klib
+  
+  ktimezone.h
+
+  Timezone handles. A KTimeZone reads the compiled timezone (TZif) file
+  in /usr/share/zoneinfo (or $TZDIR) directly, rather than going through
+  the C library. The C library only works with one timezone at a time
+  -- the one named by the TZ environment variable -- so switching
+  between timezones means changing the environment and calling tzset(),
+  which re-reads the zoneinfo file every time, and which makes every
+  caller unsafe to use from more than one thread.
+
+  Zones are loaded on first use, and cached for the life of the
+  process. A name that is not a zoneinfo file is interpreted as a POSIX
+  TZ string, e.g., "UTC+3" or "EST5EDT,M3.2.0,M11.1.0", as the C library
+  would. Leap seconds, which only the "right/" zones have, are ignored.
+
+  A zone is never modified once loaded, so a handle can be shared between
+  threads; all the functions here are thread-safe.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <time.h>
+#include <klib/types.h>
+#include <klib/defs.h>
+
+struct _KTimeZone;
+typedef struct _KTimeZone KTimeZone;
+
+/* A change of local time type, found by ktimezone_get_transitions(). 
+ * The offsets are in seconds east of UTC. */
+typedef struct _KTimeZoneTransition
+  {
+  time_t time;
+  int old_offset;
+  int new_offset;
+  BOOL old_isdst;
+  BOOL new_isdst;
+  } KTimeZoneTransition;
+
+BEGIN_DECLS
+
+/** Get the zone with the specified name, loading it if necessary. This
+ * function never fails: if the name is neither a zoneinfo file nor a
+ * valid POSIX TZ string, a warning is logged, and the zone behaves as
+ * UTC. The zone belongs to the cache, and must not be freed. */
+extern const KTimeZone *ktimezone_get (const char *name);
+
+/** Get the zone that the C library uses: the one named by the TZ
+ * environment variable or, if it is not set, /etc/localtime. */
+extern const KTimeZone *ktimezone_get_system (void);
+
+/** Find whether the name is that of a valid zoneinfo file, rather than
+ * a POSIX TZ string or an unknown zone, without adding it to the cache
+ * if it is not. This is for checking names from untrusted sources
+ * before they are passed to ktimezone_get(), which caches every name,
+ * valid or not; the name must already have been checked not to be a
+ * path outside the zoneinfo directory. */
+extern BOOL ktimezone_is_file (const char *name);
+
+/** Get the name by which the zone was loaded. */
+extern const char *ktimezone_get_name (const KTimeZone *self);
+
+/** Convert a time to local time in the specified zone, as localtime_r()
+ * would if TZ were set to the zone name. tm_zone points to storage owned
+ * by the zone, so remains valid. */
+extern void ktimezone_localtime (const KTimeZone *self, time_t t,
+                  struct tm *tm);
+
+/** Convert a local time in the specified zone to a time_t, as mktime()
+ * would if TZ were set to the zone name. Out-of-range fields are
+ * normalized, and tm is updated to the resulting local time. If the
+ * local time does not exist, because the clocks went forward past it,
+ * it is taken to be in the offset that applied before the change,
+ * giving a result after the change. If it occurs twice, because the
+ * clocks went back, the later is chosen unless tm_isdst selects the
+ * other. */
+extern time_t ktimezone_mktime (const KTimeZone *self, struct tm *tm);
+
+/** Find the times from start (inclusive) to end (exclusive) at which the
+ * offset from UTC or the daylight saving flag changes, whether from the 
+ * zone's table of transitions or, for later years, its TZ rule. Changes
+ * only of the zone abbreviation are not reported. The result is an 
+ * array in time order, which the caller must free(); the number of
+ * transitions is written to count. The result might be NULL if count 
+ * is zero. */
+extern KTimeZoneTransition *ktimezone_get_transitions 
+                  (const KTimeZone *self, time_t start, time_t end, 
+                  int *count);
+
+END_DECLS
+
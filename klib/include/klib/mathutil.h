@@ -16,12 +16,25 @@
 #include <klib/types.h>
 
 
+/** A function of one variable, as used by the root finder. */
+typedef double (*MathUtilFn) (double x, void *user_data);
+
 BEGIN_DECLS
 
 extern double mathutil_asin_deg (double angle); 
 extern double mathutil_acos_deg (double angle);
 extern double mathutil_cos_deg (double angle);
 
+/** Find a root of fn in the interval a..b, using Brent's method. fa and fb
+ * are the values of fn at a and b, which the caller will usually have
+ * computed already whilst bracketing the root; they must differ in sign.
+ * The search stops when the root is known to within tolerance. If evals
+ * is not NULL, the number of additional function evaluations is added
+ * to it. */
+extern double mathutil_find_root (MathUtilFn fn, void *user_data, 
+          double a, double b, double fa, double fb, double tolerance, 
+          int *evals);
+
 /** Use Muller's method to interpolate the downward crossing points
  * of the x axis in a set of x-y data points. npoints in the number
  * of points in each x and y array. mins is an array of doubles for
@@ -16,13 +16,48 @@
 #include <time.h>
 #include <klib/klog.h> 
 #include <klib/datetimeconv.h> 
+#include <klib/ktimezone.h>
+#include <klib/ktimeformat.h>
 
 #define KLOG_CLASS "klib.datetimeconv"
 
-static char *getenv_dup (const char *env); //FWD
-static void my_setenv (const char *name, const char *value, BOOL dummy); // FWD
 extern char *strptime (const char *s, const char *fmt, struct tm *tm);
 
+/*==========================================================================
+
+  datetimeconv_get_zone
+
+  Get the zone handle for a timezone name, or NULL (meaning the system
+  timezone) if the name is NULL
+
+==========================================================================*/
+static const KTimeZone *datetimeconv_get_zone (const char *tz)
+  {
+  KLOG_IN
+  const KTimeZone *ret = tz ? ktimezone_get (tz) : NULL;
+  KLOG_OUT
+  return ret;
+  }
+
+/*==========================================================================
+
+  datetimeconv_mktime
+
+  As mktime(), but in the specified timezone. If tz is NULL, uses the
+  system timezone. 
+
+==========================================================================*/
+static time_t datetimeconv_mktime (struct tm *tm, const KTimeZone *tz)
+  {
+  KLOG_IN
+  time_t ret;
+  if (tz)
+    ret = ktimezone_mktime (tz, tm);
+  else
+    ret = mktime (tm);
+  KLOG_OUT
+  return ret;
+  }
 
 /*==========================================================================
 
@@ -33,50 +68,27 @@ char *datetimeconv_format_time (const char *fmt, const char *tz,
          time_t t)
   {
   KLOG_IN
-  char *oldtz = NULL;
-  if (tz)
-    {
-    oldtz = getenv_dup ("TZ");
-    my_setenv ("TZ", tz, 1);
-    tzset ();
-    }
-
   char s[100]; 
-  struct tm tm;
-  localtime_r (&t, &tm);
-  if (strcmp (fmt, "12hr") == 0)
-    {
-    const char *ampm;
-    if (tm.tm_hour >= 12) ampm = "pm"; else ampm = "am"; 
-    sprintf (s, "%2d:%02d %s", tm.tm_hour % 12, tm.tm_min, ampm);
-    }
-  else if (strcmp (fmt, "24hr") == 0)
-    sprintf (s, "%02d:%02d", tm.tm_hour, tm.tm_min);
-  else if (strcmp (fmt, "long_date") == 0)
-    {
-    ctime_r (&t, s);
-    memmove (s, s+4, 20);
-    memmove (s + 7, s+16, 4);
-    s[11] = 0;
-    }
-  else if (strcmp (fmt, "short_date") == 0)
-    {
-    ctime_r (&t, s);
-    memmove (s, s+4, 20);
-    s[6] = 0;
-    }
-  else
-    strftime (s, sizeof (s), fmt, &tm);
+  datetimeconv_format_time_r (fmt, datetimeconv_get_zone (tz), t, 
+    s, sizeof (s));
+  KLOG_OUT
+  return strdup (s);
+  }
 
-  if (tz)
-    {
-    my_setenv ("TZ", oldtz, 1);
-    if (oldtz) free (oldtz);
-    tzset ();
-    }
+/*==========================================================================
+
+  datetimeconv_format_time_r
 
+==========================================================================*/
+char *datetimeconv_format_time_r (const char *fmt, const KTimeZone *tz, 
+         time_t t, char *buff, size_t len)
+  {
+  KLOG_IN
+  KTimeFormat *f = ktimeformat_new (fmt, tz);
+  ktimeformat_format (f, t, buff, len);
+  ktimeformat_destroy (f);
   KLOG_OUT
-  return strdup (s);
+  return buff;
   }
 
 /*==========================================================================
@@ -87,24 +99,21 @@ char *datetimeconv_format_time (const char *fmt, const char *tz,
 int datetimeconv_get_current_year (const char *tz)
   {
   KLOG_IN
-  char *oldtz = NULL;
-  if (tz)
-    {
-    oldtz = getenv_dup ("TZ");
-    my_setenv ("TZ", tz, 1);
-    tzset ();
-    }
+  int ret = datetimeconv_get_current_year_r (datetimeconv_get_zone (tz));
+  KLOG_OUT;
+  return ret;
+  }
 
-  struct tm tm;
-  time_t t = time (NULL);
-  localtime_r (&t, &tm);
+/*==========================================================================
 
-  if (tz)
-    {
-    my_setenv ("TZ", oldtz, 1);
-    if (oldtz) free (oldtz);
-    tzset ();
-    }
+  datetimeconv_get_current_year_r
+
+==========================================================================*/
+int datetimeconv_get_current_year_r (const KTimeZone *tz)
+  {
+  KLOG_IN
+  struct tm tm;
+  datetimeconv_localtime_r (time (NULL), &tm, tz);
   KLOG_OUT;
   return tm.tm_year + 1900;
   }
@@ -118,7 +127,7 @@ int datetimeconv_get_day_of_year (time_t t)
   {
   KLOG_IN
   struct tm tm;
-  memcpy (&tm, gmtime (&t), sizeof (struct tm));
+  gmtime_r (&t, &tm);
   int ret = tm.tm_yday + 1;
   KLOG_OUT
   return ret;
@@ -139,30 +148,29 @@ double datetimeconv_jd_to_mjd (double jd)
 
 /*==========================================================================
 
-  datetimeconv_maketime
+  datetimeconv_localtime
 
 ==========================================================================*/
 void datetimeconv_localtime (time_t *t, struct tm *tm, const char *tz)
   {
   KLOG_IN
+  datetimeconv_localtime_r (*t, tm, datetimeconv_get_zone (tz));
+  KLOG_OUT
+  }
 
-  char *oldtz = NULL;
-  if (tz)
-    {
-    oldtz = getenv_dup ("TZ");
-    my_setenv ("TZ", tz, 1);
-    tzset ();
-    }
+/*==========================================================================
 
-  localtime_r (t, tm);
+  datetimeconv_localtime_r
 
+==========================================================================*/
+void datetimeconv_localtime_r (time_t t, struct tm *tm, 
+         const KTimeZone *tz)
+  {
+  KLOG_IN
   if (tz)
-    {
-    my_setenv ("TZ", oldtz, 1);
-    if (oldtz) free (oldtz);
-    tzset ();
-    }
-
+    ktimezone_localtime (tz, t, tm);
+  else
+    localtime_r (&t, tm);
   KLOG_OUT
   }
 
@@ -175,17 +183,23 @@ time_t datetimeconv_maketime (int year, int month, int day,
          int hour, int min, int sec, const char *tz)
   {
   KLOG_IN
-  char *oldtz = NULL;
-  if (tz)
-    {
-    oldtz = getenv_dup ("TZ");
-    my_setenv ("TZ", tz, 1);
-    tzset ();
-    }
+  time_t ret = datetimeconv_maketime_r (year, month, day, hour, min, sec, 
+    datetimeconv_get_zone (tz));
+  KLOG_OUT
+  return ret;
+  }
+
+/*==========================================================================
 
-  time_t now = time (NULL);
+  datetimeconv_maketime_r
+
+==========================================================================*/
+time_t datetimeconv_maketime_r (int year, int month, int day, 
+         int hour, int min, int sec, const KTimeZone *tz)
+  {
+  KLOG_IN
   struct tm tm;
-  localtime_r (&now, &tm);  
+  datetimeconv_localtime_r (time (NULL), &tm, tz);
 
   if (sec >= 0) 
     tm.tm_sec = sec;
@@ -207,14 +221,7 @@ time_t datetimeconv_maketime (int year, int month, int day,
 
   tm.tm_isdst = -1; // Have the std library work it out
 
-  time_t ret = mktime (&tm); 
-
-  if (tz)
-    {
-    my_setenv ("TZ", oldtz, 1);
-    if (oldtz) free (oldtz);
-    tzset ();
-    }
+  time_t ret = datetimeconv_mktime (&tm, tz);
 
   KLOG_OUT
   return ret;
@@ -229,16 +236,23 @@ time_t datetimeconv_make_time_on_day (time_t t, int h,
                 int m, int s, const char *tz)
   {
   KLOG_IN
-  char *oldtz = NULL;
-  if (tz)
-    {
-    oldtz = getenv_dup ("TZ");
-    my_setenv ("TZ", tz, 1);
-    tzset ();
-    }
+  time_t ret = datetimeconv_make_time_on_day_r (t, h, m, s, 
+    datetimeconv_get_zone (tz));
+  KLOG_OUT
+  return ret;
+  }
 
+/*==========================================================================
+
+  datetimeconv_make_time_on_day_r
+
+==========================================================================*/
+time_t datetimeconv_make_time_on_day_r (time_t t, int h, 
+                int m, int s, const KTimeZone *tz)
+  {
+  KLOG_IN
   struct tm tm;
-  localtime_r (&t, &tm);  
+  datetimeconv_localtime_r (t, &tm, tz);
 
   if (s >= 0) 
     tm.tm_sec = s;
@@ -251,14 +265,7 @@ time_t datetimeconv_make_time_on_day (time_t t, int h,
 
   tm.tm_isdst = -1; // Have the std library work it out
 
-  time_t ret = mktime (&tm); 
-
-  if (tz)
-    {
-    my_setenv ("TZ", oldtz, 1);
-    if (oldtz) free (oldtz);
-    tzset ();
-    }
+  time_t ret = datetimeconv_mktime (&tm, tz);
 
   KLOG_OUT
   return ret;
@@ -292,20 +299,27 @@ time_t datetimeconv_parse_date (const char *s, int h, int m,
          const char *tz)
   {
   KLOG_IN
+  time_t ret = datetimeconv_parse_date_r (s, h, m, 
+    datetimeconv_get_zone (tz));
+  KLOG_OUT
+  return ret;
+  }
+
+/*=======================================================================
+
+  datetimeconv_parse_date_r
+
+=======================================================================*/
+time_t datetimeconv_parse_date_r (const char *s, int h, int m, 
+         const KTimeZone *tz)
+  {
+  KLOG_IN
   time_t ret = (time_t)0;
   BOOL found = FALSE;
   struct tm tm;
-  time_t now = time(NULL);
 
-  char *oldtz = NULL;
-  if (tz)
-    {
-    oldtz = getenv_dup ("TZ");
-    my_setenv ("TZ", tz, 1);
-    tzset ();
-    }
-
-  localtime_r (&now, &tm); // We only want the year from this conversion
+  // We only want the year from this conversion
+  datetimeconv_localtime_r (time (NULL), &tm, tz); 
   tm.tm_hour = h;
   tm.tm_min = m;
   tm.tm_sec = 0;
@@ -320,14 +334,7 @@ time_t datetimeconv_parse_date (const char *s, int h, int m,
     {
     // Good for the next 30 years. I won't be worried by then ;)
     if (tm.tm_year < 50) tm.tm_year += 2000;
-    ret = mktime (&tm); 
-    }
-
-  if (tz)
-    {
-    my_setenv ("TZ", oldtz, 1);
-    if (oldtz) free (oldtz);
-    tzset ();
+    ret = datetimeconv_mktime (&tm, tz);
     }
 
   KLOG_OUT
@@ -373,39 +380,3 @@ double datetimeconv_time_to_mjd (time_t t)
   return mjd;
   }
 
-
-/*=======================================================================
-
-  getenv_dup
-
-  Gets a copy of an environment string. Caller must free it, if it is
-  not NULL
-
-=======================================================================*/
-static char *getenv_dup (const char *env)
-  {
-  KLOG_IN
-  char *s = getenv (env);
-  KLOG_OUT
-  if (s) return strdup (s);
-  return NULL;
-  }
-
-/*=======================================================================
-
-  my_setenv
-
-  A variant of setenv() that allows a NULL value to call unsetenv; 
-  setenv() itself does not accept NULL as a value
-
-=======================================================================*/
-static void my_setenv (const char *name, const char *value, BOOL dummy)
-  {
-  KLOG_IN
-  if (value)
-    setenv (name, value, 1);
-  else
-    unsetenv (name);
-  KLOG_OUT
-  }
-
@@ -0,0 +1,190 @@
+/*============================================================================
+
+  klib
+
+  kdayiter.c
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <klib/klog.h>
+#include <klib/kdayiter.h>
+
+#define KLOG_CLASS "klib.kdayiter"
+
+#define SECS_PER_DAY 86400
+
+/*============================================================================
+
+  KDayIter
+
+  Days are counted from 1970-01-01, and 'day' is the next to be
+  returned. 'start' is the instant at which that day starts. 'offset'
+  is the zone's offset from UTC at that instant, and transitions[next]
+  the first transition after it.
+
+  ==========================================================================*/
+struct _KDayIter
+  {
+  const KTimeZone *tz;
+  time_t day;
+  time_t last_day;
+  time_t start;
+  int offset;
+  KTimeZoneTransition *transitions;
+  int ntransitions;
+  int next;
+  };
+
+/*============================================================================
+
+  kdayiter_get_day_number
+
+  Days since 1970-01-01 of the specified date, normalized
+
+  ==========================================================================*/
+static time_t kdayiter_get_day_number (int year, int month, int day)
+  {
+  struct tm tm;
+  memset (&tm, 0, sizeof (tm));
+  tm.tm_year = year - 1900;
+  tm.tm_mon = month - 1;
+  tm.tm_mday = day;
+  return timegm (&tm) / SECS_PER_DAY;
+  }
+
+/*============================================================================
+
+  kdayiter_find_start
+
+  Find the first instant at which the local time is midnight at the
+  start of the specified day, or later. Days must be presented in
+  order, because the current offset and transition are updated as
+  we go
+
+  ==========================================================================*/
+static time_t kdayiter_find_start (KDayIter *self, time_t day)
+  {
+  time_t midnight = day * SECS_PER_DAY;
+  time_t t = midnight - self->offset;
+  while (self->next < self->ntransitions
+          && self->transitions[self->next].time <= t)
+    {
+    const KTimeZoneTransition *tr = &self->transitions[self->next++];
+    self->offset = tr->new_offset;
+    if (tr->time + tr->new_offset >= midnight)
+      {
+      // The clocks went forward past midnight, so the day starts
+      //  at the change
+      t = tr->time;
+      break;
+      }
+    t = midnight - self->offset;
+    }
+  return t;
+  }
+
+/*============================================================================
+
+  kdayiter_new
+
+  ==========================================================================*/
+KDayIter *kdayiter_new (const KTimeZone *tz, int first_year,
+      int first_month, int first_day, int last_year, int last_month,
+      int last_day)
+  {
+  KLOG_IN
+  KDayIter *self = calloc (1, sizeof (KDayIter));
+  self->tz = tz ? tz : ktimezone_get_system ();
+  self->day = kdayiter_get_day_number (first_year, first_month, first_day);
+  self->last_day = kdayiter_get_day_number (last_year, last_month,
+    last_day);
+
+  if (self->last_day >= self->day)
+    {
+    // No zone is more than a day from UTC, so these limits take in
+    //  every transition that could affect the range
+    time_t from = (self->day - 2) * SECS_PER_DAY;
+    time_t to = (self->last_day + 3) * SECS_PER_DAY;
+    struct tm tm;
+    ktimezone_localtime (self->tz, from, &tm);
+    self->offset = tm.tm_gmtoff;
+    self->transitions = ktimezone_get_transitions (self->tz, from + 1, to,
+      &self->ntransitions);
+    self->start = kdayiter_find_start (self, self->day);
+    }
+
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+
+  kdayiter_new_from_time
+
+  ==========================================================================*/
+KDayIter *kdayiter_new_from_time (const KTimeZone *tz, time_t t, int n)
+  {
+  KLOG_IN
+  struct tm tm;
+  if (!tz) tz = ktimezone_get_system ();
+  ktimezone_localtime (tz, t, &tm);
+  int year = tm.tm_year + 1900;
+  int month = tm.tm_mon + 1;
+  KDayIter *self = kdayiter_new (tz, year, month, tm.tm_mday,
+    year, month, tm.tm_mday + n - 1);
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+
+  kdayiter_next
+
+  ==========================================================================*/
+BOOL kdayiter_next (KDayIter *self, KDay *day)
+  {
+  KLOG_IN
+  BOOL ret = FALSE;
+  if (self->day <= self->last_day)
+    {
+    struct tm tm;
+    time_t midnight = self->day * SECS_PER_DAY;
+    gmtime_r (&midnight, &tm);
+    day->year = tm.tm_year + 1900;
+    day->month = tm.tm_mon + 1;
+    day->day = tm.tm_mday;
+    day->start = self->start;
+    day->end = kdayiter_find_start (self, self->day + 1);
+    day->length = day->end - day->start;
+    self->start = day->end;
+    self->day++;
+    ret = TRUE;
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+
+  kdayiter_destroy
+
+  ==========================================================================*/
+void kdayiter_destroy (KDayIter *self)
+  {
+  KLOG_IN
+  if (self)
+    {
+    free (self->transitions);
+    free (self);
+    }
+  KLOG_OUT
+  }
+
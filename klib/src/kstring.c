@@ -463,6 +463,98 @@ size_t kstring_length_utf32 (const UTF32 *s)
   }
 
 
+/*============================================================================
+  
+  kstring_fold_char
+
+  ==========================================================================*/
+UTF32 kstring_fold_char (UTF32 c)
+  {
+  if (c < 0x80)
+    return (c >= 'A' && c <= 'Z') ? c + 32 : c;
+  if (c >= 0xC0 && c <= 0xDE && c != 0xD7)
+    return c + 32; // Latin-1 capitals, except the multiplication sign
+  if (c >= 0x100 && c <= 0x17F)
+    {
+    // Latin Extended-A is mostly capital/small pairs, capital first,
+    //  but the run from L-acute to N-caron, and the Zs, are out of step
+    if (c == 0x130 || c == 0x131 || c == 0x138 || c == 0x149 || c == 0x17F)
+      return c;
+    if (c == 0x178) return 0xFF; // Y-diaeresis
+    if ((c >= 0x139 && c <= 0x148) || c >= 0x179)
+      return (c & 1) ? c + 1 : c;
+    return c | 1;
+    }
+  if (c >= 0x391 && c <= 0x3A9 && c != 0x3A2)
+    return c + 32; // Greek
+  if (c == 0x3C2) 
+    return 0x3C3; // Final sigma
+  if (c >= 0x410 && c <= 0x42F)
+    return c + 32; // Cyrillic
+  if (c >= 0x400 && c <= 0x40F)
+    return c + 80; // Cyrillic with diacritics
+  return c;
+  }
+
+/*============================================================================
+  
+  kstring_fold_utf8
+
+  ==========================================================================*/
+size_t kstring_fold_utf8 (const UTF8 *s, UTF8 *buff, size_t size)
+  {
+  KLOG_IN
+  assert (s != NULL);
+  size_t pos = 0;
+  BOOL fits = TRUE;
+  while (*s && fits)
+    {
+    UTF32 c = *s;
+    int n = 0;
+    if (c >= 0xC0 && c < 0xE0) { c &= 0x1F; n = 1; }
+    else if (c >= 0xE0 && c < 0xF0) { c &= 0x0F; n = 2; }
+    else if (c >= 0xF0 && c < 0xF8) { c &= 0x07; n = 3; }
+    int i;
+    for (i = 1; i <= n && (s[i] & 0xC0) == 0x80; i++)
+      c = (c << 6) | (s[i] & 0x3F);
+
+    UTF8 u[UTF8_MAX_BYTES];
+    int len;
+    if (i <= n || n == 0)
+      {
+      // ASCII, or not valid UTF8
+      u[0] = *s < 0x80 ? (UTF8)kstring_fold_char (*s) : *s;
+      len = 1;
+      }
+    else
+      {
+      c = kstring_fold_char (c);
+      // Only characters of two bytes are folded, so the result is
+      //  always the same length as the original
+      if (n == 1)
+        {
+        u[0] = (UTF8)((c >> 6) | 0xC0);
+        u[1] = (UTF8)((c & 0x3F) | 0x80);
+        }
+      else
+        memcpy (u, s, n + 1);
+      len = n + 1;
+      }
+
+    if (pos + len < size)
+      {
+      memcpy (buff + pos, u, len);
+      pos += len;
+      s += len;
+      }
+    else
+      fits = FALSE;
+    }
+  if (size > 0) buff[pos] = 0;
+  KLOG_OUT
+  return fits && size > 0 ? pos : (size_t)-1;
+  }
+
 /*============================================================================
   
   kstring_get
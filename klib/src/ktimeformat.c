@@ -0,0 +1,340 @@
+/*============================================================================
+
+  klib
+
+  ktimeformat.c
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <klib/klog.h>
+#include <klib/datetimeconv.h>
+#include <klib/ktimeformat.h>
+
+#define KLOG_CLASS "klib.ktimeformat"
+
+/*============================================================================
+
+  KTimeFormatOpType
+
+  ==========================================================================*/
+typedef enum _KTimeFormatOpType
+  {
+  KTF_LITERAL = 0,  // text
+  KTF_YEAR,         // %Y
+  KTF_MONTH,        // %m
+  KTF_MDAY,         // %d
+  KTF_MDAY_SPACE,   // %e
+  KTF_HOUR,         // %H
+  KTF_HOUR12_SPACE, // Hour modulo 12, space-padded, as "12hr" has always
+                    //   done. Note that this is not %l, which gives 12
+                    //   rather than 0
+  KTF_MINUTE,       // %M
+  KTF_SECOND,       // %S
+  KTF_AMPM,         // "am" or "pm"
+  KTF_MONTH_ABBR,   // English month abbreviation, as asctime() gives
+  KTF_STRFTIME      // Any other conversion, in text, given to strftime()
+  } KTimeFormatOpType;
+
+/*============================================================================
+
+  KTimeFormatOp
+
+  ==========================================================================*/
+typedef struct _KTimeFormatOp
+  {
+  KTimeFormatOpType type;
+  char *text;
+  } KTimeFormatOp;
+
+/*============================================================================
+
+  KTimeFormat
+
+  ==========================================================================*/
+struct _KTimeFormat
+  {
+  const KTimeZone *tz;
+  int nops;
+  KTimeFormatOp *ops;
+  };
+
+static const char *month_abbrs[12] =
+  { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug",
+    "Sep", "Oct", "Nov", "Dec" };
+
+/*============================================================================
+
+  ktimeformat_add_op
+
+  ==========================================================================*/
+static void ktimeformat_add_op (KTimeFormat *self, KTimeFormatOpType type,
+      const char *text, int len)
+  {
+  // Consecutive literals are merged
+  if (type == KTF_LITERAL && self->nops > 0
+       && self->ops[self->nops - 1].type == KTF_LITERAL)
+    {
+    KTimeFormatOp *op = &self->ops[self->nops - 1];
+    int old_len = strlen (op->text);
+    op->text = realloc (op->text, old_len + len + 1);
+    memcpy (op->text + old_len, text, len);
+    op->text[old_len + len] = 0;
+    return;
+    }
+  self->ops = realloc (self->ops, (self->nops + 1) * sizeof (KTimeFormatOp));
+  KTimeFormatOp *op = &self->ops[self->nops++];
+  op->type = type;
+  op->text = text ? strndup (text, len) : NULL;
+  }
+
+/*============================================================================
+
+  ktimeformat_compile
+
+  Break a strftime() format into operations
+
+  ==========================================================================*/
+static void ktimeformat_compile (KTimeFormat *self, const char *fmt)
+  {
+  KLOG_IN
+  const char *p = fmt;
+  while (*p)
+    {
+    if (*p != '%' || p[1] == 0)
+      {
+      ktimeformat_add_op (self, KTF_LITERAL, p, 1);
+      p++;
+      continue;
+      }
+    KTimeFormatOpType type = KTF_STRFTIME;
+    switch (p[1])
+      {
+      case 'Y': type = KTF_YEAR; break;
+      case 'm': type = KTF_MONTH; break;
+      case 'd': type = KTF_MDAY; break;
+      case 'e': type = KTF_MDAY_SPACE; break;
+      case 'H': type = KTF_HOUR; break;
+      case 'M': type = KTF_MINUTE; break;
+      case 'S': type = KTF_SECOND; break;
+      case '%': type = KTF_LITERAL; break;
+      }
+    if (type == KTF_LITERAL)
+      {
+      ktimeformat_add_op (self, KTF_LITERAL, "%", 1);
+      p += 2;
+      }
+    else if (type != KTF_STRFTIME)
+      {
+      ktimeformat_add_op (self, type, NULL, 0);
+      p += 2;
+      }
+    else
+      {
+      // Flags, width and modifier, then the conversion itself
+      const char *start = p++;
+      while (*p && strchr ("_-0^#", *p)) p++;
+      while (*p >= '0' && *p <= '9') p++;
+      if (*p == 'E' || *p == 'O') p++;
+      if (*p) p++;
+      ktimeformat_add_op (self, KTF_STRFTIME, start, p - start);
+      }
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+
+  ktimeformat_new
+
+  ==========================================================================*/
+KTimeFormat *ktimeformat_new (const char *fmt, const KTimeZone *tz)
+  {
+  KLOG_IN
+  KTimeFormat *self = calloc (1, sizeof (KTimeFormat));
+  self->tz = tz;
+  if (strcmp (fmt, "12hr") == 0)
+    {
+    ktimeformat_add_op (self, KTF_HOUR12_SPACE, NULL, 0);
+    ktimeformat_add_op (self, KTF_LITERAL, ":", 1);
+    ktimeformat_add_op (self, KTF_MINUTE, NULL, 0);
+    ktimeformat_add_op (self, KTF_LITERAL, " ", 1);
+    ktimeformat_add_op (self, KTF_AMPM, NULL, 0);
+    }
+  else if (strcmp (fmt, "24hr") == 0)
+    ktimeformat_compile (self, "%H:%M");
+  else if (strcmp (fmt, "long_date") == 0 || strcmp (fmt, "short_date") == 0)
+    {
+    // These were once cut out of the result of ctime(), which is always
+    //  in English, and always has a space-padded day
+    ktimeformat_add_op (self, KTF_MONTH_ABBR, NULL, 0);
+    ktimeformat_add_op (self, KTF_LITERAL, " ", 1);
+    ktimeformat_add_op (self, KTF_MDAY_SPACE, NULL, 0);
+    if (fmt[0] == 'l')
+      {
+      ktimeformat_add_op (self, KTF_LITERAL, " ", 1);
+      ktimeformat_add_op (self, KTF_YEAR, NULL, 0);
+      }
+    }
+  else
+    ktimeformat_compile (self, fmt);
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+
+  ktimeformat_destroy
+
+  ==========================================================================*/
+void ktimeformat_destroy (KTimeFormat *self)
+  {
+  KLOG_IN
+  if (self)
+    {
+    for (int i = 0; i < self->nops; i++)
+      free (self->ops[i].text);
+    free (self->ops);
+    free (self);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+
+  ktimeformat_put
+
+  Append len characters to the output, as many as fit, leaving room for
+  the terminator. pos is advanced past the characters written
+
+  ==========================================================================*/
+static inline void ktimeformat_put (char *buff, size_t size, size_t *pos,
+      const char *s, size_t len)
+  {
+  if (*pos + len >= size) len = size - 1 - *pos;
+  memcpy (buff + *pos, s, len);
+  *pos += len;
+  }
+
+/*============================================================================
+
+  ktimeformat_put_2
+
+  Append a number from 0 to 99 as two characters, padded with pad
+
+  ==========================================================================*/
+static inline void ktimeformat_put_2 (char *buff, size_t size, size_t *pos,
+      int n, char pad)
+  {
+  char s[2];
+  s[0] = n >= 10 ? '0' + n / 10 : pad;
+  s[1] = '0' + n % 10;
+  ktimeformat_put (buff, size, pos, s, 2);
+  }
+
+/*============================================================================
+
+  ktimeformat_format_tm
+
+  ==========================================================================*/
+static int ktimeformat_format_tm (const KTimeFormat *self,
+      const struct tm *tm, char *buff, size_t size)
+  {
+  if (size == 0) return 0;
+  size_t pos = 0;
+  char s[64];
+  for (int i = 0; i < self->nops && pos < size - 1; i++)
+    {
+    const KTimeFormatOp *op = &self->ops[i];
+    switch (op->type)
+      {
+      case KTF_LITERAL:
+        ktimeformat_put (buff, size, &pos, op->text, strlen (op->text));
+        break;
+      case KTF_YEAR:
+        {
+        int len = snprintf (s, sizeof (s), "%d", tm->tm_year + 1900);
+        ktimeformat_put (buff, size, &pos, s, len);
+        }
+        break;
+      case KTF_MONTH:
+        ktimeformat_put_2 (buff, size, &pos, tm->tm_mon + 1, '0');
+        break;
+      case KTF_MDAY:
+        ktimeformat_put_2 (buff, size, &pos, tm->tm_mday, '0');
+        break;
+      case KTF_MDAY_SPACE:
+        ktimeformat_put_2 (buff, size, &pos, tm->tm_mday, ' ');
+        break;
+      case KTF_HOUR:
+        ktimeformat_put_2 (buff, size, &pos, tm->tm_hour, '0');
+        break;
+      case KTF_HOUR12_SPACE:
+        ktimeformat_put_2 (buff, size, &pos, tm->tm_hour % 12, ' ');
+        break;
+      case KTF_MINUTE:
+        ktimeformat_put_2 (buff, size, &pos, tm->tm_min, '0');
+        break;
+      case KTF_SECOND:
+        ktimeformat_put_2 (buff, size, &pos, tm->tm_sec, '0');
+        break;
+      case KTF_AMPM:
+        ktimeformat_put (buff, size, &pos, tm->tm_hour >= 12 ? "pm" : "am",
+          2);
+        break;
+      case KTF_MONTH_ABBR:
+        ktimeformat_put (buff, size, &pos, month_abbrs[tm->tm_mon], 3);
+        break;
+      case KTF_STRFTIME:
+        {
+        size_t len = strftime (s, sizeof (s), op->text, tm);
+        ktimeformat_put (buff, size, &pos, s, len);
+        }
+        break;
+      }
+    }
+  buff[pos] = 0;
+  return pos;
+  }
+
+/*============================================================================
+
+  ktimeformat_format
+
+  ==========================================================================*/
+int ktimeformat_format (const KTimeFormat *self, time_t t,
+      char *buff, size_t len)
+  {
+  KLOG_IN
+  struct tm tm;
+  datetimeconv_localtime_r (t, &tm, self->tz);
+  int ret = ktimeformat_format_tm (self, &tm, buff, len);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+
+  ktimeformat_format_batch
+
+  ==========================================================================*/
+void ktimeformat_format_batch (const KTimeFormat *self,
+      const time_t *times, int n, char *buff, size_t stride)
+  {
+  KLOG_IN
+  for (int i = 0; i < n; i++)
+    {
+    struct tm tm;
+    datetimeconv_localtime_r (times[i], &tm, self->tz);
+    ktimeformat_format_tm (self, &tm, buff + i * stride, stride);
+    }
+  KLOG_OUT
+  }
+
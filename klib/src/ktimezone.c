@@ -0,0 +1,885 @@
+/*============================================================================
+  
+  klib
+  
+  ktimezone.c
+
+  The TZif format is described in RFC 8536, and the POSIX TZ string
+  format in the POSIX description of the TZ environment variable.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <klib/klog.h>
+#include <klib/ktimezone.h>
+
+#define KLOG_CLASS "klib.ktimezone"
+
+#define KTIMEZONE_DEFAULT_DIR "/usr/share/zoneinfo"
+
+// The system timezone, if TZ is not set
+#define KTIMEZONE_SYSTEM_FILE "/etc/localtime"
+
+// Longest zone abbreviation we keep from a POSIX TZ string. Real ones
+//  are no more than six characters
+#define KTIMEZONE_NAME_MAX 16
+
+// Size of the TZif header
+#define KTIMEZONE_HEADER_SIZE 44
+
+// The largest TZif file that will be read. Real ones are a few 
+//  kilobytes
+#define KTIMEZONE_MAX_FILE (1024 * 1024)
+
+// No zone offset is more than a day from UTC, so a window this wide
+//  either side of a local time contains every transition that could
+//  affect its conversion to UTC
+#define KTIMEZONE_WINDOW (2 * 86400)
+
+/*============================================================================
+  
+  TzType
+
+  A local time type: the offset from UTC in seconds (east positive),
+  whether it counts as daylight saving, and the abbreviation
+
+  ==========================================================================*/
+typedef struct _TzType
+  {
+  int32_t utoff;
+  BOOL isdst;
+  const char *abbr;
+  } TzType;
+
+/*============================================================================
+  
+  TzRuleDate
+
+  A date in a POSIX TZ rule. kind is 'J' (day n, 1-365, never counting
+  29th February), 'D' (day n, 0-365, counting 29th February), or 'M'
+  (day d of week w of month m). time is seconds after local midnight,
+  and might be negative or more than a day.
+
+  ==========================================================================*/
+typedef struct _TzRuleDate
+  {
+  char kind;
+  int n, m, w, d;
+  int32_t time;
+  } TzRuleDate;
+
+/*============================================================================
+  
+  TzRule
+
+  A parsed POSIX TZ string
+
+  ==========================================================================*/
+typedef struct _TzRule
+  {
+  TzType std;
+  TzType dst;
+  BOOL has_dst;
+  TzRuleDate start;
+  TzRuleDate end;
+  char std_name[KTIMEZONE_NAME_MAX];
+  char dst_name[KTIMEZONE_NAME_MAX];
+  } TzRule;
+
+/*============================================================================
+  
+  KTimeZone
+
+  ==========================================================================*/
+struct _KTimeZone
+  {
+  char *name;
+  int ntimes;
+  int64_t *times;
+  unsigned char *type_idx;
+  int ntypes;
+  TzType *types;
+  char *abbrs;
+  BOOL has_rule;
+  TzRule rule;
+  BOOL from_file;
+  KTimeZone *next;
+  };
+
+// Zones loaded so far, which are never freed. The lock protects only
+//  the list: a zone is complete before it is added, and never changes
+//  after that. It is a read-write lock, because once the zones are 
+//  loaded, nearly every call is a lookup, and many threads can look 
+//  up a zone at the same time
+static KTimeZone *cache = NULL;
+static pthread_rwlock_t cache_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+static const int month_days[12] =
+  { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+/*============================================================================
+  
+  ktimezone_is_leap
+
+  ==========================================================================*/
+static BOOL ktimezone_is_leap (int64_t year)
+  {
+  return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+  }
+
+/*============================================================================
+  
+  ktimezone_days_from_civil
+
+  Days since 1970-01-01 of the specified date (month 1-12), in the
+  proleptic Gregorian calendar
+
+  ==========================================================================*/
+static int64_t ktimezone_days_from_civil (int64_t y, int m, int d)
+  {
+  y -= m <= 2;
+  int64_t era = (y >= 0 ? y : y - 399) / 400;
+  int64_t yoe = y - era * 400;
+  int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+  }
+
+/*============================================================================
+  
+  ktimezone_year_from_days
+
+  The year in which falls the day that is 'days' after 1970-01-01
+
+  ==========================================================================*/
+static int64_t ktimezone_year_from_days (int64_t days)
+  {
+  days += 719468;
+  int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  int64_t doe = days - era * 146097;
+  int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int64_t mp = (5 * doy + 2) / 153;
+  return yoe + era * 400 + (mp >= 10);
+  }
+
+/*============================================================================
+  
+  ktimezone_rule_date_days
+
+  Days since 1970-01-01 of a rule date in the specified year
+
+  ==========================================================================*/
+static int64_t ktimezone_rule_date_days (const TzRuleDate *date, int64_t year)
+  {
+  int64_t jan1 = ktimezone_days_from_civil (year, 1, 1);
+  switch (date->kind)
+    {
+    case 'J':
+      return jan1 + date->n - 1
+        + (ktimezone_is_leap (year) && date->n >= 60 ? 1 : 0);
+    case 'D':
+      return jan1 + date->n;
+    default:
+      {
+      int64_t first = ktimezone_days_from_civil (year, date->m, 1);
+      int wday = (int)(((first + 4) % 7 + 7) % 7); // 1970-01-01 was Thu
+      int mday = 1 + (date->d - wday + 7) % 7 + 7 * (date->w - 1);
+      int mdays = month_days[date->m - 1]
+        + (date->m == 2 && ktimezone_is_leap (year) ? 1 : 0);
+      while (mday > mdays) mday -= 7;
+      return first + mday - 1;
+      }
+    }
+  }
+
+/*============================================================================
+  
+  ktimezone_rule_type
+
+  ==========================================================================*/
+static const TzType *ktimezone_rule_type (const TzRule *rule, time_t t)
+  {
+  if (!rule->has_dst) return &rule->std;
+
+  int64_t local = (int64_t)t + rule->std.utoff;
+  int64_t days = local / 86400 - (local % 86400 < 0 ? 1 : 0);
+  int64_t year = ktimezone_year_from_days (days);
+
+  // The start is given in standard time, and the end in daylight time
+  int64_t start = ktimezone_rule_date_days (&rule->start, year) * 86400
+    + rule->start.time - rule->std.utoff;
+  int64_t end = ktimezone_rule_date_days (&rule->end, year) * 86400
+    + rule->end.time - rule->dst.utoff;
+
+  BOOL dst;
+  if (start < end)
+    dst = t >= start && t < end;
+  else // Southern hemisphere
+    dst = !(t >= end && t < start);
+  return dst ? &rule->dst : &rule->std;
+  }
+
+/*============================================================================
+  
+  ktimezone_parse_name
+
+  Parse a zone abbreviation in a TZ string: either three or more letters,
+  or anything between angle brackets. Returns a pointer to the rest of
+  the string, or NULL if there is no valid name.
+
+  ==========================================================================*/
+static const char *ktimezone_parse_name (const char *s, char *name)
+  {
+  const char *start, *end;
+  if (*s == '<')
+    {
+    start = ++s;
+    while (*s && *s != '>') s++;
+    if (*s != '>') return NULL;
+    end = s++;
+    }
+  else
+    {
+    start = s;
+    while (isalpha ((unsigned char)*s)) s++;
+    end = s;
+    }
+  if (end - start < 3) return NULL;
+  int len = end - start;
+  if (len >= KTIMEZONE_NAME_MAX) len = KTIMEZONE_NAME_MAX - 1;
+  memcpy (name, start, len);
+  name[len] = 0;
+  return s;
+  }
+
+/*============================================================================
+  
+  ktimezone_parse_number
+
+  ==========================================================================*/
+static const char *ktimezone_parse_number (const char *s, int min, int max,
+      int *n)
+  {
+  if (!isdigit ((unsigned char)*s)) return NULL;
+  int v = 0;
+  while (isdigit ((unsigned char)*s))
+    {
+    v = 10 * v + (*s++ - '0');
+    if (v > max) return NULL;
+    }
+  if (v < min) return NULL;
+  *n = v;
+  return s;
+  }
+
+/*============================================================================
+  
+  ktimezone_parse_hms
+
+  Parse [+|-]hh[:mm[:ss]] into seconds
+
+  ==========================================================================*/
+static const char *ktimezone_parse_hms (const char *s, int32_t *secs)
+  {
+  int sign = 1, h = 0, m = 0, sec = 0;
+  if (*s == '+' || *s == '-')
+    {
+    if (*s == '-') sign = -1;
+    s++;
+    }
+  if (!(s = ktimezone_parse_number (s, 0, 167, &h))) return NULL;
+  if (*s == ':')
+    {
+    if (!(s = ktimezone_parse_number (s + 1, 0, 59, &m))) return NULL;
+    if (*s == ':')
+      {
+      if (!(s = ktimezone_parse_number (s + 1, 0, 59, &sec))) return NULL;
+      }
+    }
+  *secs = sign * (h * 3600 + m * 60 + sec);
+  return s;
+  }
+
+/*============================================================================
+  
+  ktimezone_parse_date
+
+  ==========================================================================*/
+static const char *ktimezone_parse_date (const char *s, TzRuleDate *date)
+  {
+  memset (date, 0, sizeof (TzRuleDate));
+  if (*s == 'J')
+    {
+    date->kind = 'J';
+    s = ktimezone_parse_number (s + 1, 1, 365, &date->n);
+    }
+  else if (*s == 'M')
+    {
+    date->kind = 'M';
+    s = ktimezone_parse_number (s + 1, 1, 12, &date->m);
+    if (s && *s == '.') s = ktimezone_parse_number (s + 1, 1, 5, &date->w);
+    else s = NULL;
+    if (s && *s == '.') s = ktimezone_parse_number (s + 1, 0, 6, &date->d);
+    else s = NULL;
+    }
+  else
+    {
+    date->kind = 'D';
+    s = ktimezone_parse_number (s, 0, 365, &date->n);
+    }
+  if (!s) return NULL;
+  date->time = 7200;
+  if (*s == '/') s = ktimezone_parse_hms (s + 1, &date->time);
+  return s;
+  }
+
+/*============================================================================
+  
+  ktimezone_parse_rule
+
+  Parse a POSIX TZ string, e.g., "GMT0BST,M3.5.0/1,M10.5.0". Note that
+  offsets in TZ strings are positive west of Greenwich, the opposite of
+  the convention everywhere else.
+
+  ==========================================================================*/
+static BOOL ktimezone_parse_rule (const char *s, TzRule *rule)
+  {
+  int32_t offset;
+  memset (rule, 0, sizeof (TzRule));
+
+  if (!(s = ktimezone_parse_name (s, rule->std_name))) return FALSE;
+  if (!(s = ktimezone_parse_hms (s, &offset))) return FALSE;
+  rule->std.utoff = -offset;
+  rule->std.isdst = FALSE;
+  rule->std.abbr = rule->std_name;
+  if (*s == 0) return TRUE;
+
+  if (!(s = ktimezone_parse_name (s, rule->dst_name))) return FALSE;
+  rule->dst.utoff = rule->std.utoff + 3600;
+  if (*s && *s != ',')
+    {
+    if (!(s = ktimezone_parse_hms (s, &offset))) return FALSE;
+    rule->dst.utoff = -offset;
+    }
+  rule->dst.isdst = TRUE;
+  rule->dst.abbr = rule->dst_name;
+  rule->has_dst = TRUE;
+
+  if (*s == 0)
+    {
+    // No rule given: use the current US one, as the C library does
+    ktimezone_parse_date ("M3.2.0", &rule->start);
+    ktimezone_parse_date ("M11.1.0", &rule->end);
+    return TRUE;
+    }
+
+  if (*s != ',') return FALSE;
+  if (!(s = ktimezone_parse_date (s + 1, &rule->start))) return FALSE;
+  if (*s != ',') return FALSE;
+  if (!(s = ktimezone_parse_date (s + 1, &rule->end))) return FALSE;
+  return *s == 0;
+  }
+
+/*============================================================================
+  
+  ktimezone_get_be32
+
+  ==========================================================================*/
+static int32_t ktimezone_get_be32 (const unsigned char *p)
+  {
+  return (int32_t)((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16
+    | (uint32_t)p[2] << 8 | (uint32_t)p[3]);
+  }
+
+/*============================================================================
+  
+  ktimezone_get_be64
+
+  ==========================================================================*/
+static int64_t ktimezone_get_be64 (const unsigned char *p)
+  {
+  return (int64_t)((uint64_t)(uint32_t)ktimezone_get_be32 (p) << 32
+    | (uint64_t)(uint32_t)ktimezone_get_be32 (p + 4));
+  }
+
+/*============================================================================
+  
+  ktimezone_parse
+
+  Parse the contents of a TZif file into self. If the file is version 2
+  or later, the version 1 data is skipped, and the 64-bit data and the
+  TZ string footer used instead. Returns FALSE if the data is not valid.
+
+  ==========================================================================*/
+static BOOL ktimezone_parse (KTimeZone *self, const unsigned char *data,
+      size_t len)
+  {
+  KLOG_IN
+  BOOL ret = FALSE;
+  const unsigned char *p = data;
+  const unsigned char *limit = data + len;
+  int timesize = 4;
+
+  for (int pass = 0; pass < 2; pass++)
+    {
+    if (limit - p < KTIMEZONE_HEADER_SIZE || memcmp (p, "TZif", 4) != 0)
+      goto done;
+    int version = p[4];
+    int32_t isutcnt = ktimezone_get_be32 (p + 20);
+    int32_t isstdcnt = ktimezone_get_be32 (p + 24);
+    int32_t leapcnt = ktimezone_get_be32 (p + 28);
+    int32_t timecnt = ktimezone_get_be32 (p + 32);
+    int32_t typecnt = ktimezone_get_be32 (p + 36);
+    int32_t charcnt = ktimezone_get_be32 (p + 40);
+    if (isutcnt < 0 || isstdcnt < 0 || leapcnt < 0 || timecnt < 0
+         || typecnt < 1 || charcnt < 1)
+      goto done;
+    p += KTIMEZONE_HEADER_SIZE;
+
+    // The counts are at most INT32_MAX, so none of these can overflow,
+    //  and if the total fits in the file, so does each count
+    int64_t size = (int64_t)timecnt * (timesize + 1) + (int64_t)typecnt * 6
+      + charcnt + (int64_t)leapcnt * (timesize + 4) 
+      + (int64_t)isstdcnt + isutcnt;
+    if (limit - p < size) goto done;
+
+    if (pass == 0 && version >= '2')
+      {
+      // Skip to the 64-bit data
+      p += size;
+      timesize = 8;
+      continue;
+      }
+
+    self->ntimes = timecnt;
+    self->ntypes = typecnt;
+    self->times = malloc ((timecnt + 1) * sizeof (int64_t));
+    self->type_idx = malloc (timecnt + 1);
+    self->types = malloc (typecnt * sizeof (TzType));
+    self->abbrs = malloc (charcnt + 1);
+    if (!self->times || !self->type_idx || !self->types || !self->abbrs)
+      goto done;
+
+    for (int i = 0; i < timecnt; i++, p += timesize)
+      self->times[i] = timesize == 8
+        ? ktimezone_get_be64 (p) : ktimezone_get_be32 (p);
+    for (int i = 0; i < timecnt; i++, p++)
+      {
+      if (*p >= typecnt) goto done;
+      self->type_idx[i] = *p;
+      }
+    const unsigned char *types = p;
+    p += typecnt * 6;
+    memcpy (self->abbrs, p, charcnt);
+    self->abbrs[charcnt] = 0;
+    for (int i = 0; i < typecnt; i++)
+      {
+      const unsigned char *t = types + 6 * i;
+      if (t[5] >= charcnt) goto done;
+      self->types[i].utoff = ktimezone_get_be32 (t);
+      self->types[i].isdst = t[4] != 0;
+      self->types[i].abbr = self->abbrs + t[5];
+      }
+    p += charcnt + (int64_t)leapcnt * (timesize + 4) 
+      + (int64_t)isstdcnt + isutcnt;
+
+    // The footer holds a TZ string for times after the last transition
+    if (timesize == 8 && p < limit && *p == '\n')
+      {
+      const unsigned char *end = memchr (p + 1, '\n', limit - p - 1);
+      if (end && end > p + 1)
+        {
+        char *s = strndup ((const char *)p + 1, end - p - 1);
+        self->has_rule = ktimezone_parse_rule (s, &self->rule);
+        if (!self->has_rule)
+          klog_warn (KLOG_CLASS, "Can't parse TZ string '%s' in zone %s",
+            s, self->name);
+        free (s);
+        }
+      }
+    ret = TRUE;
+    break;
+    }
+
+done:
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  ktimezone_load
+
+  Try to load the zone from a zoneinfo file. Returns FALSE if there is no
+  such file, or it is not a valid TZif file. Only regular files no
+  larger than KTIMEZONE_MAX_FILE are read, so that a name like /dev/zero
+  or a FIFO can't exhaust memory, or block. An invalid file is logged
+  if warn is TRUE.
+
+  ==========================================================================*/
+static BOOL ktimezone_load (KTimeZone *self, const char *name, BOOL warn)
+  {
+  KLOG_IN
+  BOOL ret = FALSE;
+  if (*name == ':') name++;
+
+  char path[PATH_MAX];
+  if (*name == '/')
+    snprintf (path, sizeof (path), "%s", name);
+  else
+    {
+    const char *dir = getenv ("TZDIR");
+    snprintf (path, sizeof (path), "%s/%s", dir ? dir : KTIMEZONE_DEFAULT_DIR,
+      name);
+    }
+
+  // Opening a FIFO would block without O_NONBLOCK
+  int f = open (path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (f >= 0)
+    {
+    struct stat sb;
+    unsigned char *data = NULL;
+    size_t len = 0;
+    if (fstat (f, &sb) == 0 && S_ISREG (sb.st_mode)
+         && sb.st_size <= KTIMEZONE_MAX_FILE
+         && (data = malloc (sb.st_size + 1)))
+      {
+      ssize_t n;
+      while (len < (size_t)sb.st_size 
+           && (n = read (f, data + len, sb.st_size - len)) > 0)
+        len += n;
+      ret = ktimezone_parse (self, data, len);
+      }
+    close (f);
+    if (!ret && warn)
+      klog_warn (KLOG_CLASS, "%s is not a valid timezone file", path);
+    free (data);
+    }
+
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  ktimezone_get
+
+  ==========================================================================*/
+const KTimeZone *ktimezone_get (const char *name)
+  {
+  KLOG_IN
+  KTimeZone *self;
+  pthread_rwlock_rdlock (&cache_lock);
+  for (self = cache; self; self = self->next)
+    if (strcmp (self->name, name) == 0) break;
+  pthread_rwlock_unlock (&cache_lock);
+  if (self)
+    {
+    KLOG_OUT
+    return self;
+    }
+
+  // Another thread might have loaded the zone before we get the
+  //  write lock, so look again
+  pthread_rwlock_wrlock (&cache_lock);
+  for (self = cache; self; self = self->next)
+    if (strcmp (self->name, name) == 0) break;
+
+  if (!self)
+    {
+    self = calloc (1, sizeof (KTimeZone));
+    self->name = strdup (name);
+    self->from_file = *name && ktimezone_load (self, name, TRUE);
+    if (!self->from_file)
+      {
+      free (self->times);
+      free (self->type_idx);
+      free (self->types);
+      free (self->abbrs);
+      self->ntimes = self->ntypes = 0;
+      self->times = NULL;
+      self->type_idx = NULL;
+      self->types = NULL;
+      self->abbrs = NULL;
+      self->has_rule = ktimezone_parse_rule (*name == ':' ? name + 1 : name,
+        &self->rule);
+      if (!self->has_rule)
+        {
+        // This is what the C library does, but it is nearly always a
+        //  mistake, so it's worth a warning
+        if (*name)
+          klog_warn (KLOG_CLASS, "Unknown timezone '%s': using UTC", name);
+        ktimezone_parse_rule ("UTC0", &self->rule);
+        self->has_rule = TRUE;
+        }
+      }
+    self->next = cache;
+    cache = self;
+    klog_debug (KLOG_CLASS, "Loaded zone %s: %d transitions, %s rule",
+      name, self->ntimes, self->has_rule ? "with" : "no");
+    }
+  pthread_rwlock_unlock (&cache_lock);
+
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+  
+  ktimezone_is_file
+
+  ==========================================================================*/
+BOOL ktimezone_is_file (const char *name)
+  {
+  KLOG_IN
+  BOOL ret = FALSE;
+  KTimeZone *self;
+  pthread_rwlock_rdlock (&cache_lock);
+  for (self = cache; self; self = self->next)
+    if (strcmp (self->name, name) == 0) break;
+  if (self) ret = self->from_file;
+  pthread_rwlock_unlock (&cache_lock);
+
+  if (!self && *name)
+    {
+    KTimeZone zone;
+    memset (&zone, 0, sizeof (zone));
+    zone.name = (char *)name;
+    ret = ktimezone_load (&zone, name, FALSE);
+    free (zone.times);
+    free (zone.type_idx);
+    free (zone.types);
+    free (zone.abbrs);
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  ktimezone_get_name
+
+  ==========================================================================*/
+const char *ktimezone_get_name (const KTimeZone *self)
+  {
+  KLOG_IN
+  KLOG_OUT
+  return self->name;
+  }
+
+/*============================================================================
+  
+  ktimezone_find_type
+
+  Find the local time type in effect at time t
+
+  ==========================================================================*/
+static const TzType *ktimezone_find_type (const KTimeZone *self, time_t t)
+  {
+  int n = self->ntimes;
+  if (n == 0 || t >= self->times[n - 1])
+    {
+    if (self->has_rule) return ktimezone_rule_type (&self->rule, t);
+    if (n == 0) return &self->types[0];
+    return &self->types[self->type_idx[n - 1]];
+    }
+  if (t < self->times[0]) return &self->types[0];
+
+  // Find the last transition at or before t
+  int lo = 0, hi = n - 1;
+  while (hi - lo > 1)
+    {
+    int mid = (lo + hi) / 2;
+    if (self->times[mid] <= t)
+      lo = mid;
+    else
+      hi = mid;
+    }
+  return &self->types[self->type_idx[lo]];
+  }
+
+/*============================================================================
+  
+  ktimezone_localtime
+
+  ==========================================================================*/
+void ktimezone_localtime (const KTimeZone *self, time_t t, struct tm *tm)
+  {
+  KLOG_IN
+  const TzType *type = ktimezone_find_type (self, t);
+  time_t local = t + type->utoff;
+  gmtime_r (&local, tm);
+  tm->tm_isdst = type->isdst;
+  tm->tm_gmtoff = type->utoff;
+  tm->tm_zone = type->abbr;
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  ktimezone_mktime
+
+  ==========================================================================*/
+time_t ktimezone_mktime (const KTimeZone *self, struct tm *tm)
+  {
+  KLOG_IN
+  struct tm tmp = *tm;
+  time_t local = timegm (&tmp); // Normalizes the fields
+
+  // There is at most one transition in the window, so these are the
+  //  only two offsets that the local time could be in
+  const TzType *before = ktimezone_find_type (self, local - KTIMEZONE_WINDOW);
+  const TzType *after = ktimezone_find_type (self, local + KTIMEZONE_WINDOW);
+  time_t t1 = local - before->utoff;
+  time_t t2 = local - after->utoff;
+  const TzType *type1 = ktimezone_find_type (self, t1);
+  const TzType *type2 = ktimezone_find_type (self, t2);
+  BOOL valid1 = type1->utoff == before->utoff;
+  BOOL valid2 = type2->utoff == after->utoff;
+
+  time_t ret;
+  if (valid1 && valid2 && t1 != t2)
+    {
+    // The local time occurs twice
+    if (tm->tm_isdst >= 0 && type1->isdst != type2->isdst)
+      ret = (type1->isdst == (tm->tm_isdst > 0)) ? t1 : t2;
+    else
+      ret = t1 > t2 ? t1 : t2;
+    }
+  else if (valid1)
+    ret = t1;
+  else if (valid2)
+    ret = t2;
+  else if (before->utoff != after->utoff)
+    ret = t1; // In a gap
+  else
+    {
+    // The offset changed and changed back within the window, which
+    //  shouldn't happen, but use whatever is in effect at the
+    //  likeliest time
+    ret = local - ktimezone_find_type (self, t1)->utoff;
+    }
+
+  ktimezone_localtime (self, ret, tm);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  ktimezone_get_system
+
+  ==========================================================================*/
+const KTimeZone *ktimezone_get_system (void)
+  {
+  KLOG_IN
+  const char *tz = getenv ("TZ");
+  const KTimeZone *ret = ktimezone_get (tz ? tz : KTIMEZONE_SYSTEM_FILE);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  ktimezone_add_transition
+
+  If the local time type changes at time t, add the change to the list,
+  growing it if necessary
+
+  ==========================================================================*/
+static void ktimezone_add_transition (const KTimeZone *self, time_t t,
+      KTimeZoneTransition **list, int *count, int *size)
+  {
+  const TzType *before = ktimezone_find_type (self, t - 1);
+  const TzType *after = ktimezone_find_type (self, t);
+  if (before->utoff == after->utoff && before->isdst == after->isdst)
+    return;
+  if (*count > 0 && (*list)[*count - 1].time == t) 
+    return;
+  if (*count == *size)
+    {
+    *size = *size ? 2 * *size : 16;
+    *list = realloc (*list, *size * sizeof (KTimeZoneTransition));
+    }
+  KTimeZoneTransition *tr = &(*list)[(*count)++];
+  tr->time = t;
+  tr->old_offset = before->utoff;
+  tr->new_offset = after->utoff;
+  tr->old_isdst = before->isdst;
+  tr->new_isdst = after->isdst;
+  }
+
+/*============================================================================
+  
+  ktimezone_get_transitions
+
+  ==========================================================================*/
+KTimeZoneTransition *ktimezone_get_transitions (const KTimeZone *self,
+      time_t start, time_t end, int *count)
+  {
+  KLOG_IN
+  KTimeZoneTransition *list = NULL;
+  int size = 0;
+  *count = 0;
+
+  // Transitions in the table. Find the first at or after start
+  int n = self->ntimes;
+  int lo = 0, hi = n;
+  while (lo < hi)
+    {
+    int mid = (lo + hi) / 2;
+    if (self->times[mid] < start)
+      lo = mid + 1;
+    else
+      hi = mid;
+    }
+  for (int i = lo; i < n && self->times[i] < end; i++)
+    ktimezone_add_transition (self, self->times[i], &list, count, &size);
+
+  // Transitions from the rule, which applies after the end of the table.
+  //  The rule gives two candidates each year, which might not change 
+  //  anything (for example, in a zone that is on 'daylight saving' all 
+  //  year); ktimezone_add_transition() discards those
+  const TzRule *rule = &self->rule;
+  time_t from = n > 0 && self->times[n - 1] >= start 
+    ? self->times[n - 1] + 1 : start;
+  if (self->has_rule && rule->has_dst && from < end)
+    {
+    int64_t first = ktimezone_year_from_days (from / 86400) - 1;
+    int64_t last = ktimezone_year_from_days (end / 86400) + 1;
+    for (int64_t year = first; year <= last; year++)
+      {
+      time_t t[2];
+      t[0] = ktimezone_rule_date_days (&rule->start, year) * 86400
+        + rule->start.time - rule->std.utoff;
+      t[1] = ktimezone_rule_date_days (&rule->end, year) * 86400
+        + rule->end.time - rule->dst.utoff;
+      if (t[0] > t[1])
+        {
+        time_t temp = t[0]; t[0] = t[1]; t[1] = temp;
+        }
+      for (int i = 0; i < 2; i++)
+        if (t[i] >= from && t[i] < end)
+          ktimezone_add_transition (self, t[i], &list, count, &size);
+      }
+    }
+
+  KLOG_OUT
+  return list;
+  }
+
@@ -14,6 +14,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <math.h>
+#include <float.h>
 #include <time.h>
 #include <klib/klog.h> 
 #include <klib/mathutil.h> 
@@ -68,6 +69,95 @@ double mathutil_fix_angle (double angle)
   return result;
   }
 
+/*============================================================================
+  
+  mathutil_find_root
+
+  Brent's method: a combination of bisection, secant and inverse quadratic
+  interpolation that keeps the root bracketed at all times. fa and fb
+  are the (already-known) function values at a and b, which must have
+  opposite signs.
+
+  ==========================================================================*/
+double mathutil_find_root (MathUtilFn fn, void *user_data, double a, 
+        double b, double fa, double fb, double tolerance, int *evals)
+  {
+  KLOG_IN
+  double c = b, fc = fb;
+  double d = b - a, e = d;
+  int n = 0;
+
+  for (int iter = 0; iter < 100; iter++)
+    {
+    if ((fb > 0 && fc > 0) || (fb < 0 && fc < 0))
+      {
+      c = a; fc = fa;
+      e = d = b - a;
+      }
+    if (fabs (fc) < fabs (fb))
+      {
+      a = b; b = c; c = a;
+      fa = fb; fb = fc; fc = fa;
+      }
+    double tol1 = 2.0 * DBL_EPSILON * fabs (b) + 0.5 * tolerance;
+    double xm = 0.5 * (c - b);
+    if (fabs (xm) <= tol1 || fb == 0.0)
+      break;
+
+    if (fabs (e) >= tol1 && fabs (fa) > fabs (fb))
+      {
+      // Attempt inverse quadratic interpolation (or secant, if only
+      //   two distinct points are available)
+      double p, q, r;
+      double s = fb / fa;
+      if (a == c)
+        {
+        p = 2.0 * xm * s;
+        q = 1.0 - s;
+        }
+      else
+        {
+        q = fa / fc;
+        r = fb / fc;
+        p = s * (2.0 * xm * q * (q - r) - (b - a) * (r - 1.0));
+        q = (q - 1.0) * (r - 1.0) * (s - 1.0);
+        }
+      if (p > 0) q = -q;
+      p = fabs (p);
+      double min1 = 3.0 * xm * q - fabs (tol1 * q);
+      double min2 = fabs (e * q);
+      if (2.0 * p < (min1 < min2 ? min1 : min2))
+        {
+        e = d;
+        d = p / q;
+        }
+      else
+        {
+        d = xm;
+        e = d;
+        }
+      }
+    else
+      {
+      d = xm;
+      e = d;
+      }
+
+    a = b;
+    fa = fb;
+    if (fabs (d) > tol1)
+      b += d;
+    else
+      b += (xm > 0 ? tol1 : -tol1);
+    fb = fn (b, user_data);
+    n++;
+    }
+
+  if (evals) *evals += n;
+  KLOG_OUT
+  return b;
+  }
+
 /*============================================================================
   
   mathutil_get_negative_axis_crossings
@@ -18,6 +18,12 @@ BEGIN_DECLS
      Greenwich meridian -- 360/24 degrees per hour */
 extern double astroutil_get_hours_from_meridian (double longitude);
 
+/** Get the local hour angle, in degrees, of a body with the specified
+ * right ascension (in hours), as seen from the specified longitude. The
+ * body is on the observer's meridian when the hour angle is zero, and
+ * the hour angle increases with time. */
+double astroutil_get_hour_angle (time_t t, double longitude, double ra);
+
 /** Get  the local mean siderial time corresponding to the specified
  * time and (observer) longitude. See:
 https://en.wikipedia.org/wiki/Sidereal_time. As usual, a positive longitude
@@ -25,9 +31,31 @@ is to the east of the Greenwich meridian.
 */
 double astroutil_lmst (time_t t, double longitude);
 
+/** Get the Greenwich mean siderial time, in hours, corresponding to the
+ * specified time. The result is not reduced to the range 0-24. Unlike
+ * the local siderial time, it doesn't depend on the observer, so it
+ * can be worked out once and used for many places. */
+double astroutil_gmst (time_t t);
+
+/** Get the local mean siderial time from the Greenwich mean siderial 
+ * time returned by astroutil_gmst(). The result is exactly the same
+ * as astroutil_lmst() would give. */
+double astroutil_lmst_from_gmst (double gmst, double longitude);
+
+/** As astroutil_get_hour_angle(), but starting from the Greenwich mean 
+ * siderial time. */
+double astroutil_get_hour_angle_gmst (double gmst, double longitude, 
+        double ra);
+
 /* Get the sine altitude of a body with specified RA and declination,
  * as seen by an observer at the specified latitude and longitude. */
 double astroutil_ra_dec_to_sin_altitude (time_t t, double latitude, 
         double longitude, double ra, double dec);
 
+/* As astroutil_ra_dec_to_sin_altitude(), but starting from the Greenwich
+ * mean siderial time. All that is left to do is the rotation that
+ * depends on the observer's location. */
+double astroutil_gmst_ra_dec_to_sin_altitude (double gmst, double latitude,
+        double longitude, double ra, double dec);
+
 END_DECLS
@@ -18,6 +18,39 @@
 struct _Festival;
 typedef struct _Festival Festival;
 
+/* Sets of movable feasts, all of whose dates are fixed by a single
+ * anchor -- Easter, Orthodox Easter, or the first Sunday of Advent -- and
+ * an offset in days from it. */
+typedef enum _FestivalFeastSet
+  {
+  /** Shrove Tuesday to Whitsun, in the western churches */
+  FESTIVAL_FEASTS_EASTER = 0,
+  /** Ascension Day, Trinity Sunday, and Corpus Christi */
+  FESTIVAL_FEASTS_ASCENSION,
+  /** The four Sundays of Advent */
+  FESTIVAL_FEASTS_ADVENT,
+  /** Clean Monday to Pentecost, in the Orthodox churches */
+  FESTIVAL_FEASTS_ORTHODOX,
+  FESTIVAL_FEAST_SET_COUNT
+  } FestivalFeastSet;
+
+/* Selects sets in the 'sets' argument of festival_add_feasts() and
+ * festival_get_feast_dates() */
+#define FESTIVAL_FEAST_SET(set) (1 << (set))
+#define FESTIVAL_FEAST_SETS_ALL 0x0f
+
+/* The most feasts that festival_get_feast_dates() can find */
+#define FESTIVAL_MAX_FEASTS 32
+
+/* One feast found by festival_get_feast_dates(), on a day of the 
+ * Gregorian calendar. */
+typedef struct _FestivalFeastDate
+  {
+  const char *name;
+  int month; // 1-12
+  int day;   // 1-31
+  } FestivalFeastDate;
+
 BEGIN_DECLS
 
 extern Festival *festival_new (time_t date, BOOL has_time, const char *name);
@@ -40,6 +73,26 @@ extern Festival *festival_get_whitsun (int year, const char *tz);
 extern Festival *festival_get_vernal_equinox (int year);
 extern Festival *festival_get_winter_solstice (int year, BOOL southern);
 
+/** Append Festival objects for the movable feasts of the specified
+ * year, in the sets selected by the bitmask sets, to list, which must
+ * have been created with festival_destroy() as its free function. Each
+ * anchor is worked out once, so this is much quicker than calling the
+ * festival_get_XXX functions for each feast. */
+extern void      festival_add_feasts (int year, int sets, const char *tz, 
+                   KList *list);
+
+/** Get the dates of the movable feasts of the specified year, in the sets
+ * selected by the bitmask sets. dates must have room for 
+ * FESTIVAL_MAX_FEASTS. Returns the number of feasts, in no particular
+ * order. This function only does integer arithmetic, and does not depend
+ * on any timezone. */
+extern int       festival_get_feast_dates (int year, int sets,
+                   FestivalFeastDate *dates);
+
+/** Get the name of a set of feasts, e.g., "orthodox". This is the name
+ * used to select the set on the command line. */
+extern const char *festival_get_feast_set_name (FestivalFeastSet set);
+
 extern BOOL      festival_has_time (const Festival *self);
 
 /** The comparator used for sorting lists of Festivals using klist_sort().*/
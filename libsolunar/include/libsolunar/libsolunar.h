@@ -14,9 +14,17 @@
 #include <libsolunar/moontimes.h>
 #include <libsolunar/sunephemera.h>
 #include <libsolunar/moonephemera.h>
+#include <libsolunar/moonchebyshev.h>
+#include <libsolunar/moonevents.h>
 #include <libsolunar/astroutil.h>
+#include <libsolunar/solgazetteer.h>
+#include <libsolunar/soltzmap.h>
+#include <libsolunar/solephemeris.h>
 #include <libsolunar/solcity.h>
 #include <libsolunar/solunardaysummary.h>
 #include <libsolunar/solunaryearsummary.h>
+#include <libsolunar/solunarbatch.h>
+#include <libsolunar/solcache.h>
+#include <libsolunar/solgrid.h>
 #include <libsolunar/festival.h>
 
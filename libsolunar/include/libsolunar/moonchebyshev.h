@@ -0,0 +1,77 @@
+/*============================================================================
+  
+  libsolunar
+  
+  moonchebyshev.h
+
+  A tabulated lunar ephemeris, made of piecewise Chebyshev polynomial
+  approximations to the series in moonephemera.c. The coefficients are
+  stored in a binary file, which is memory-mapped when it is opened, so
+  an evaluation of the Moon's position costs a few dozen multiply-adds,
+  rather than the thirty-odd trigonometric functions of the series.
+
+  The file holds, for each segment of time, coefficients for the three
+  components of the Moon's direction (in equatorial coordinates) and for
+  the Moon's distance. The file is in the host's
+  native byte order, and is not portable between machines of different
+  endianness.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <klib/klib.h>
+
+/* Defaults for moonchebyshev_write_file(). With these values, the
+ * tabulated position agrees with the series to better than a hundredth
+ * of an arcsecond, and a century of coefficients takes about 5Mb. */
+#define MOONCHEBYSHEV_DEFAULT_SEGMENT_DAYS 4
+#define MOONCHEBYSHEV_DEFAULT_ORDER 14
+
+struct _MoonChebyshev;
+typedef struct _MoonChebyshev MoonChebyshev;
+
+BEGIN_DECLS
+
+/** Open and memory-map a coefficient file created by
+ * moonchebyshev_write_file(). Returns NULL, having logged the reason,
+ * if the file can't be opened or isn't valid. */
+extern MoonChebyshev *moonchebyshev_open (const char *path);
+
+extern void moonchebyshev_close (MoonChebyshev *self);
+
+/** Compare the tabulated ephemeris with the series at samples_per_segment
+ * evenly-spaced times in every segment. The largest angular difference
+ * in position (arcseconds) and in distance (km) are written to
+ * max_error_arcsec and max_error_km. */
+extern void moonchebyshev_check (const MoonChebyshev *self,
+              int samples_per_segment, double *max_error_arcsec,
+              double *max_error_km);
+
+/** Get the Moon's distance from the Earth, in km. Returns FALSE if the
+ * time is outside the range covered by the file. */
+extern BOOL moonchebyshev_get_distance (const MoonChebyshev *self,
+              time_t t, double *distance);
+
+/** Get the Moon's right ascension (hours) and declination (degrees),
+ * as moonephemera_get_ra_and_dec(). Returns FALSE if the time is outside
+ * the range covered by the file, in which case ra and dec are not
+ * written. */
+extern BOOL moonchebyshev_get_ra_and_dec (const MoonChebyshev *self,
+              time_t t, double *ra, double *dec);
+
+/** Get the range of times covered by the file. */
+extern void moonchebyshev_get_range (const MoonChebyshev *self,
+              time_t *start, time_t *end);
+
+/** Compute coefficients from the series for the years first_year to
+ * last_year inclusive, and write them to a file. Each segment covers
+ * segment_days days, with polynomials of the specified order. Returns
+ * FALSE, having logged the reason, if the file can't be written. */
+extern BOOL moonchebyshev_write_file (const char *path, int first_year,
+              int last_year, int segment_days, int order);
+
+END_DECLS
+
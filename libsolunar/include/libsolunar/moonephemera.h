@@ -11,20 +11,60 @@
 #pragma once
 
 #include <klib/klib.h>
+#include <libsolunar/moonchebyshev.h>
 
 #define MOONFLAG_PERIGEE    0x0001
 #define MOONFLAG_SUPERMOON  0x0002
 
+/* The Moon counts as being at perigee, for the purposes of 
+ * MOONFLAG_PERIGEE, when it is closer than this (km). A full moon at 
+ * perigee is a supermoon. */
+#define MOONEPHEMERA_SUPERMOON_DISTANCE 368000
+
 BEGIN_DECLS
 
 /** Get the moon's right ascension and declination at the specified
- * time. RA is in hours, dec in degrees. */
+ * time. RA is in hours, dec in degrees. If a tabulated ephemeris has been
+ * set using moonephemera_set_chebyshev(), and it covers the specified 
+ * time, it is used in preference to the series. */
 extern void  moonephemera_get_ra_and_dec (time_t t, double *ra, double *dec);
 
+/** Get the moon's right ascension and declination at each of n times,
+ * as moonephemera_get_ra_and_dec() would. When the series is in use, 
+ * the samples are evaluated together using the CPU's vector 
+ * instructions, which is several times faster than calling 
+ * moonephemera_get_ra_and_dec() for each one. */
+extern void  moonephemera_get_ra_and_dec_batch (const time_t *times, int n,
+               double *ra, double *dec);
+
+/** As get_ra_and_dec, but the time is a modified julian date, so it can
+ * have a fractional number of seconds. This function always uses the
+ * series, never a tabulated ephemeris. */
+extern void  moonephemera_get_ra_and_dec_mjd (double mjd, double *ra, 
+               double *dec);
+
+/** Get the components of the Moon's direction in equatorial coordinates
+ * at the specified modified julian date: x towards the vernal equinox,
+ * z towards the celestial pole. This is the part of the series that 
+ * varies smoothly with time; moonephemera_equatorial_to_ra_and_dec()
+ * converts the result to the same RA and declination that
+ * moonephemera_get_ra_and_dec_mjd() would give. */
+extern void moonephemera_get_equatorial_mjd (double mjd, double *x, 
+               double *y, double *z);
+
+/** See moonephemera_get_equatorial_mjd(). */
+extern void moonephemera_equatorial_to_ra_and_dec (double x, double y, 
+               double z, double *ra, double *dec);
+
 extern void moonephemera_get_moon_state (double latitude, double longitude, 
                time_t time, const char **phase_name, 
                double *phase, double *age, double *distance, int *moon_flags);
 
+/** Get the moon phase (0-1, with 0 at new moon) and distance from the
+ * Earth (km), at the specified julian date. */
+extern void moonephemera_get_phase_and_distance (double jd, double *phase, 
+               double *distance);
+
 /** Get the moon phase in English for the specified phase value, 
  * which lies between 0 (new) and 1 (new) with full at 0.5 */
 const char *moonephemera_get_phase_name (double phase);
@@ -35,6 +75,19 @@ const char *moonephemera_get_phase_name (double phase);
 extern double moonephemera_get_sin_altitude (double latitude, 
                   double longitude, time_t t);
 
+/** Get the sine of the moon's altitude for one observer at each of n
+ * times, as moonephemera_get_sin_altitude() would. See
+ * moonephemera_get_ra_and_dec_batch(). */
+extern void moonephemera_get_sin_altitude_batch (double latitude, 
+               double longitude, const time_t *times, int n, 
+               double *sin_altitude);
+
+/** Use the specified tabulated ephemeris for the Moon's position, at
+ * times that it covers. Pass NULL to go back to using the series at
+ * all times. The caller remains responsible for closing the ephemeris,
+ * and should not do so until it has been unset. */
+extern void moonephemera_set_chebyshev (const MoonChebyshev *mc);
+
 END_DECLS
 
 
@@ -0,0 +1,58 @@
+/*============================================================================
+  
+  libsolunar
+  
+  moonevents.h
+
+  Exact times of the Moon's principal phases, and of perigee and
+  apogee. Rather than scanning day by day, the finder predicts each event
+  from the previous one, using the mean length of the month, and then
+  solves for the exact time in a bracket around the prediction. So
+  a year's events cost a few evaluations of the ephemeris each.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <klib/klib.h>
+
+typedef enum _MoonEventType
+  {
+  MOONEVENT_NEW = 0,
+  MOONEVENT_FIRST_QUARTER,
+  MOONEVENT_FULL,
+  MOONEVENT_LAST_QUARTER,
+  MOONEVENT_PERIGEE,
+  MOONEVENT_APOGEE
+  } MoonEventType;
+
+/* Selects event types in the 'types' argument of moonevents_find() */
+#define MOONEVENTS_TYPE(type) (1 << (type))
+#define MOONEVENTS_ALL 0x3f
+
+/* One event found by moonevents_find(). The distance, in km, is the
+ * Moon's distance from the Earth at the time of the event. */
+typedef struct _MoonEvent
+  {
+  MoonEventType type;
+  time_t time;
+  double distance;
+  } MoonEvent;
+
+BEGIN_DECLS
+
+/** Find principal phases, perigees and apogees from start (inclusive)
+ * to end (exclusive). types is a bitmask of MOONEVENTS_TYPE() values, or
+ * MOONEVENTS_ALL. The result is an array of events in time order, which 
+ * the caller must free(); the number of events is written to count. The
+ * result might be NULL if count is zero. */
+extern MoonEvent *moonevents_find (time_t start, time_t end, int types,
+                    int *count);
+
+/** Get a name in English for the event type, e.g., "Full moon". */
+extern const char *moonevents_get_type_name (MoonEventType type);
+
+END_DECLS
+
@@ -11,6 +11,47 @@
 #pragma once
 
 #include <klib/klib.h>
+#include <libsolunar/solephemeris.h>
+
+/* Largest number of events of each kind that moontimes_get_events() will
+ * report. There are usually no more than two of each kind in a day. */
+#define MOONTIMES_MAX_EVENTS 3
+
+/* The interval, in seconds, at which the Moon's position is sampled to
+ * find events. A SolEphemeris with the same interval can supply the
+ * samples. */
+#define MOONTIMES_INTERVAL (60*60)
+
+/* All the events found by moontimes_get_events(). Each array holds the
+ * corresponding count of times, in order. The maximum altitude is in
+ * degrees, and is the highest the Moon gets during the period, which
+ * will usually be at an upper transit (culmination). */
+typedef struct _MoonTimesEvents
+  {
+  int nrises;
+  time_t rises[MOONTIMES_MAX_EVENTS];
+  int nsets;
+  time_t sets[MOONTIMES_MAX_EVENTS];
+  int nupper_transits;
+  time_t upper_transits[MOONTIMES_MAX_EVENTS];
+  int nlower_transits;
+  time_t lower_transits[MOONTIMES_MAX_EVENTS];
+  double max_altitude;
+  time_t max_altitude_time;
+  } MoonTimesEvents;
+
+/* The last sample of the Moon's position taken by 
+ * moontimes_get_events_carry(), which is also the first sample of the 
+ * next period, if that starts when this one ended, at the same place. 
+ * time is zero if there is no sample. */
+typedef struct _MoonTimesCarry
+  {
+  time_t time;
+  double latitude;
+  double longitude;
+  double sin_altitude;
+  double sin_hour_angle;
+  } MoonTimesCarry;
 
 
 BEGIN_DECLS
@@ -26,6 +67,34 @@ extern void moontimes_get_moonrises (time_t start, time_t end,
         double latitude, double longitude, time_t *rises, 
         int max, int *count);
 
+/* Determine moonrises, moonsets, upper and lower transits, and the 
+ * Moon's maximum altitude in the specified time period, all from a single
+ * scan of the Moon's position. This is cheaper than calling 
+ * get_moonrises() and get_moonsets() separately. */
+extern void moontimes_get_events (time_t start, time_t end, 
+        double latitude, double longitude, MoonTimesEvents *events);
+
+/* As moontimes_get_events(), but reusing the sample in carry, if it was
+ * taken at the start of this period, and replacing it with the sample at
+ * the end. Calling this for consecutive periods, with the same carry,
+ * which must first be zeroed, saves working out the Moon's position at 
+ * each boundary twice, and gives exactly the same results. */
+extern void moontimes_get_events_carry (time_t start, time_t end, 
+        double latitude, double longitude, MoonTimesCarry *carry,
+        MoonTimesEvents *events);
+
+/* As moontimes_get_events_carry(), but taking the samples of the Moon's
+ * position from eph, where it has them, rather than working them out. 
+ * Either eph or carry may be NULL. Since the samples are the same, the
+ * results are exactly the same as moontimes_get_events() gives. A 
+ * caller that finds the events for many places over the same period can
+ * create one SolEphemeris, with an interval of MOONTIMES_INTERVAL, that 
+ * covers all of them. Samples are shared only if start is a whole number
+ * of intervals from the epoch. */
+extern void moontimes_get_events_ephemeris (time_t start, time_t end, 
+        double latitude, double longitude, const SolEphemeris *eph,
+        MoonTimesCarry *carry, MoonTimesEvents *events);
+
 /* See get_moonrises */
 extern void moontimes_get_moonsets (time_t start, time_t end, 
         double latitude, double longitude, time_t *rises, 
@@ -0,0 +1,65 @@
+/*============================================================================
+  
+  libsolunar
+  
+  solcache.h
+
+  A persistent cache of day summaries, for programs that are asked for
+  the same places and dates over and over. The summaries are held in a
+  file which is memory-mapped, so a summary that is found costs only a
+  lookup in a hash table, in pages that are usually already in memory.
+
+  A summary is found by its date, its timezone, and its position rounded
+  to SOLCACHE_QUANTUM degrees, about ten metres, which changes the times
+  of events by a small fraction of a second. The city name is not part
+  of the key; the summary returned has the name that was asked for.
+
+  Records are appended to the file as they are added. When it is full,
+  it is rebuilt with twice the room, up to a limit, after which it is
+  rebuilt with only the half of the records that were used most
+  recently. The file records the version of the library, and a string
+  given by the caller to identify anything else that affects the
+  results, such as the ephemeris; if either differs when the file is
+  opened, the records are discarded.
+
+  The file is locked while it is read or changed, so it can be shared by
+  programs running at the same time. A SolCache itself must not be used
+  by more than one thread at a time. The file is in the host's native
+  byte order, and is not portable between machines.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <klib/klib.h>
+#include <libsolunar/solunardaysummary.h>
+
+#define SOLCACHE_QUANTUM 1e-4
+
+struct _SolCache;
+typedef struct _SolCache SolCache;
+
+BEGIN_DECLS
+
+/** Open the cache file at path, creating it if it does not exist. The
+ * directory must exist. source identifies anything, apart from the
+ * version of the library, that the summaries depend on, and may be NULL.
+ * Returns NULL, having logged the reason, if the file can't be opened
+ * or created. */
+extern SolCache *solcache_open (const char *path, const char *source);
+
+extern void solcache_close (SolCache *self);
+
+/** Get the summary as solunar_day_summary_create() would, from the cache
+ * if it is there, or otherwise by working it out and adding it to the
+ * cache. If tz is NULL, meaning the system timezone, which might change
+ * from one run to the next, the cache is not used. The caller must
+ * destroy the summary. */
+extern SolunarDaySummary *solcache_create_day_summary (SolCache *self,
+          time_t date, double latitude, double longitude, const char *city,
+          const char *tz);
+
+END_DECLS
+
@@ -14,19 +14,49 @@
 #pragma once
 
 #include <klib/klib.h>
+#include <libsolunar/solgazetteer.h>
 
 struct _SolCity;
 typedef struct _SolCity SolCity;
 
 BEGIN_DECLS
 
-/** Find cities that match the specified name, which can be partial.
+/** Find cities whose names contain the specified text, which is not
+ * case-sensitive. An empty string matches every city. If a gazetteer is
+ * in use, and it has places whose names are the text, those places are
+ * found instead; a gazetteer is not searched for parts of names.
  * In most cases, returning more than one city probably represents an
  * error, or insufficient user input. If the function does return a
  * list, the caller should destroy it. The list will contain instances
  * of SolCity */
 extern KList *solcity_find_matching (const UTF8 *s);
 
+/** Find cities whose name, or the place name after the region, starts
+ * with the specified text -- "lon" finds Europe/London, but not
+ * Asia/Colombo. Matching is not case-sensitive. If a gazetteer is in 
+ * use, and it has places whose names start with the text, those places
+ * are found instead. The result is as for solcity_find_matching(). */
+extern KList *solcity_find_prefix (const UTF8 *s);
+
+/** Find the k cities nearest to the specified point, nearest first,
+ * using an index built with the city table, so the cost grows roughly 
+ * as the logarithm of the number of cities. Latitude and longitude are 
+ * in degrees, +north and +east. The caller should destroy the list, 
+ * which is NULL if k is less than one. */
+extern KList *solcity_find_nearest (double latitude, double longitude, 
+                int k);
+
+/** Get the great-circle distance of the city from a point, in km. */
+extern double solcity_get_distance (const SolCity *self, double latitude,
+                double longitude);
+
+/** Use a gazetteer, as well as the built-in city table, to find cities,
+ * or stop using one, if g is NULL. Cities found in the gazetteer are
+ * valid until the gazetteer is changed, which must be done before the 
+ * gazetteer is closed. When a gazetteer is in use, 
+ * solcity_find_nearest() finds only its places. */
+extern void solcity_set_gazetteer (const SolGazetteer *g);
+
 /** Get the latitude of the city, in degrees, +north. */
 extern double solcity_get_latitude (const SolCity *self);
 
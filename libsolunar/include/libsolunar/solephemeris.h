@@ -0,0 +1,74 @@
+/*============================================================================
+  
+  libsolunar
+  
+  solephemeris.h
+
+  A table of the quantities that depend only on time, not on where the
+  observer is: the right ascension and declination of the Moon, and the
+  Greenwich mean siderial time. They are worked out once for each sample
+  time, after which the Moon's altitude, for any number of places, needs
+  only the rotation that depends on the place. The Sun's position is
+  cheap enough to work out as it is needed, and is not kept.
+
+  The samples fall on multiples of the interval since the epoch. With an
+  interval of an hour, the sampling used by moontimes_get_events() for
+  a local day coincides with the table for every zone whose offset from
+  UTC is a whole number of hours. In a zone with an offset of a fraction
+  of an hour, such as Asia/Kolkata or Australia/Adelaide, no sample of
+  the local day falls on the table, and nothing is shared: the results
+  are still right, but are worked out in full. The table can't be
+  aligned to the local day instead, because one table serves places in
+  all zones.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <klib/klib.h>
+
+struct _SolEphemeris;
+typedef struct _SolEphemeris SolEphemeris;
+
+/* One sample. The RA is in hours, the declination in degrees, and the
+ * siderial time is as returned by astroutil_gmst(). */
+typedef struct _SolEphemerisSample
+  {
+  time_t time;
+  double moon_ra;
+  double moon_dec;
+  double gmst;
+  } SolEphemerisSample;
+
+BEGIN_DECLS
+
+/** Create a table with samples every interval seconds, covering the
+ * period from start to end inclusive. The first sample is at or before
+ * start, and the last at or after end. */
+extern SolEphemeris *solephemeris_new (time_t start, time_t end,
+        int interval);
+
+extern void solephemeris_destroy (SolEphemeris *self);
+
+/** Get the sample at exactly the specified time, or NULL if the time
+ * is outside the table, or does not fall on a sample. */
+extern const SolEphemerisSample *solephemeris_find
+        (const SolEphemeris *self, time_t t);
+
+extern int solephemeris_get_count (const SolEphemeris *self);
+
+/** Get the i'th sample, in order of time. */
+extern const SolEphemerisSample *solephemeris_get_sample
+        (const SolEphemeris *self, int i);
+
+/** Get the sine of the Moon's altitude, as moonephemera_get_sin_altitude()
+ * would, at the time of each sample, for the observer at the specified
+ * place. The results are written to sin_altitude, which must have room
+ * for solephemeris_get_count() values. */
+extern void solephemeris_get_moon_sin_altitudes (const SolEphemeris *self,
+        double latitude, double longitude, double *sin_altitude);
+
+END_DECLS
+
@@ -0,0 +1,79 @@
+/*============================================================================
+  
+  libsolunar
+  
+  solgazetteer.h
+
+  A gazetteer: a compiled database of places, for use alongside the
+  built-in city table, which has only a few hundred zone capitals. The
+  database is made from a GeoNames-style text file, which can have
+  millions of places, by solgazetteer_write_file(). It holds the places
+  themselves, a sorted index of their names, a pool of strings, and a
+  k-d tree of their positions. It is memory-mapped when it is opened, so
+  opening it takes the same time however large it is, and nothing is
+  read from it until it is needed.
+
+  The database is in the host's native byte order, and is not portable
+  between machines of different endianness.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <stdint.h>
+#include <klib/klib.h>
+
+struct _SolGazetteer;
+typedef struct _SolGazetteer SolGazetteer;
+
+BEGIN_DECLS
+
+/** Open and memory-map a database created by solgazetteer_write_file().
+ * Returns NULL, having logged the reason, if the file can't be opened
+ * or isn't valid. */
+extern SolGazetteer *solgazetteer_open (const char *path);
+
+extern void solgazetteer_close (SolGazetteer *self);
+
+/** Find the places whose names are s or, if prefix is TRUE, start with
+ * s. Names are compared without regard to case, and a place can be
+ * found by its ASCII name, if the source file gives one, as well as by
+ * its proper name. The result is an array of place numbers, in
+ * ascending order, which the caller must free(); the number of places
+ * is written to count. The result might be NULL if count is zero. */
+extern uint32_t *solgazetteer_find_name (const SolGazetteer *self,
+                   const UTF8 *s, BOOL prefix, uint32_t *count);
+
+/** Find the k places nearest to the specified point, whose latitude and
+ * longitude are in degrees. Their numbers are written to places, which
+ * must have room for k, nearest first. Returns the number of places
+ * found, which is k unless the database has fewer places. */
+extern int solgazetteer_find_nearest (const SolGazetteer *self,
+                   double latitude, double longitude, int k,
+                   uint32_t *places);
+
+/** Get the number of places in the database. */
+extern uint32_t solgazetteer_get_count (const SolGazetteer *self);
+
+/** Get the details of a place, by number. The strings are in the mapped
+ * file, and remain valid until the database is closed. code is the
+ * country code, which might be empty. */
+extern void solgazetteer_get_place (const SolGazetteer *self,
+                   uint32_t place, const char **name, const char **code,
+                   double *latitude, double *longitude,
+                   const char **tz_name);
+
+/** Compile a GeoNames-style text file into a database. The source has a
+ * place on each line, with tab-separated fields: the second is the
+ * name, the third the name in ASCII, the fifth and sixth the latitude
+ * and longitude in degrees, the ninth the country code, and the
+ * eighteenth the timezone name. This is the layout of the GeoNames
+ * "cities" and country files. Lines without a valid position and
+ * timezone are skipped. Returns FALSE, having logged the reason, if the
+ * source can't be read or the database can't be written. */
+extern BOOL solgazetteer_write_file (const char *source, const char *path);
+
+END_DECLS
+
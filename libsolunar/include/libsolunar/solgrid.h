@@ -0,0 +1,115 @@
+/*============================================================================
+  
+  libsolunar
+  
+  solgrid.h
+
+  A table of the times of sunrise, sunset, twilight, moonrise and moonset
+  at the points of a grid of latitude and longitude, over one year, from
+  which the times at any place are found by bilinear interpolation
+  between the four points around it. The table is built by
+  solgrid_write_file(), which works out a day summary for every point on
+  every UTC day of the year, and is memory-mapped when it is opened, so
+  a lookup reads only a few hundred bytes, rather than working out the
+  positions of the Sun and Moon.
+
+  Times are stored to the minute. Along each row of the grid, the
+  times of each event are stored in blocks of sixteen points, as a 16-bit
+  base and an 8-bit difference from it for each point, which is a little
+  over half the size of storing them in full. Even so, a table of the
+  whole world at the usual step of a quarter of a degree is about 5Gb;
+  at one degree it is about 330Mb.
+
+  Interpolation does not work where an event happens at some of the four
+  points and not at others, such as near the edge of the polar day, and
+  then the lookup fails, and the caller should work the times out in
+  full. Otherwise, the error depends on the place and the time of year,
+  so, when the table is built, each cell of the grid is checked at its
+  corners, the middles of its edges and its centre on every day, and
+  the largest error, plus half a minute for storing times to the
+  minute, is stored with the cell. This is an estimate of the largest
+  error in the cell, not a bound: between the points that are checked,
+  the error can be larger.
+
+  The file is in the host's native byte order, and is not portable
+  between machines of different endianness.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <klib/klib.h>
+#include <libsolunar/moontimes.h>
+
+/* The error of a cell in which an event was found by
+ * interpolation, but did not in fact happen, or the other way round. */
+#define SOLGRID_ERROR_UNKNOWN 65535
+
+/* The times found by solgrid_get_times(). Times are zero if the event
+ * does not happen. error is the estimated largest error, in seconds,
+ * of the cell, from the points checked when the table was built, or
+ * SOLGRID_ERROR_UNKNOWN. */
+typedef struct _SolGridTimes
+  {
+  time_t sunrise;
+  time_t sunset;
+  time_t start_civil_twilight;
+  time_t end_civil_twilight;
+  time_t start_nautical_twilight;
+  time_t end_nautical_twilight;
+  time_t start_astronomical_twilight;
+  time_t end_astronomical_twilight;
+  int nmoon_rises;
+  time_t moon_rises[MOONTIMES_MAX_EVENTS];
+  int nmoon_sets;
+  time_t moon_sets[MOONTIMES_MAX_EVENTS];
+  int error;
+  } SolGridTimes;
+
+struct _SolGrid;
+typedef struct _SolGrid SolGrid;
+
+BEGIN_DECLS
+
+/** Open and memory-map a file created by solgrid_write_file(). Returns
+ * NULL, having logged the reason, if the file can't be opened or isn't
+ * valid. */
+extern SolGrid *solgrid_open (const char *path);
+
+extern void solgrid_close (SolGrid *self);
+
+/** Check the table against day summaries worked out in full, at samples
+ * places and dates chosen at random, but the same each time. Gives the
+ * number of samples the table could answer, the largest error of those,
+ * in seconds, and how many of them had a larger error than was estimated
+ * for their cell. */
+extern void solgrid_check (const SolGrid *self, int samples,
+                int *answered, int *max_error, int *over_bound);
+
+/** Get the year that the table covers, and its step in degrees. */
+extern void solgrid_get_range (const SolGrid *self, int *year,
+                double *step);
+
+/** Find the times of events at the specified place, as
+ * solunar_day_summary_create() would for the same date and timezone:
+ * the Sun's on the UTC day that includes date, and the Moon's during the
+ * local day that includes it. tz may be NULL, meaning the system
+ * timezone. Returns FALSE if the date is not in the table, or the times
+ * can't be interpolated. This function does not change the table, and
+ * can be used from more than one thread at a time. */
+extern BOOL solgrid_get_times (const SolGrid *self, time_t date,
+                double latitude, double longitude, const char *tz,
+                SolGridTimes *times);
+
+/** Build a table for the specified year, with points every step
+ * degrees, which must divide 180 and be from 0.05 to 2, using the
+ * specified number of threads, or one for each CPU if it is zero or
+ * negative. Returns FALSE, having logged the reason, if the step is
+ * invalid or the file can't be written. */
+extern BOOL solgrid_write_file (const char *path, int year, double step,
+                int threads);
+
+END_DECLS
+
@@ -0,0 +1,55 @@
+/*============================================================================
+  
+  libsolunar
+  
+  soltzmap.h
+
+  A map of timezones, for finding the timezone that applies at a
+  latitude and longitude. The map is compiled from the boundaries of the
+  zones, as polygons in a GeoJSON file, by soltzmap_write_file(), into a
+  binary file which holds the polygons and an R-tree of their bounding
+  boxes. The file is memory-mapped when it is opened, so a lookup reads
+  only the parts of the tree, and the polygons, that are near the point.
+
+  The file is in the host's native byte order, and is not portable
+  between machines of different endianness.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <klib/klib.h>
+
+struct _SolTzMap;
+typedef struct _SolTzMap SolTzMap;
+
+BEGIN_DECLS
+
+/** Open and memory-map a file created by soltzmap_write_file(). Returns
+ * NULL, having logged the reason, if the file can't be opened or isn't
+ * valid. */
+extern SolTzMap *soltzmap_open (const char *path);
+
+extern void soltzmap_close (SolTzMap *self);
+
+/** Find the timezone at the specified point, whose latitude and
+ * longitude are in degrees, +north and +east. Returns the name of the
+ * zone, which remains valid until the map is closed, or NULL if the
+ * point is not in any zone on the map. This function does not change
+ * the map, and can be used from more than one thread at a time. */
+extern const char *soltzmap_find_zone (const SolTzMap *self,
+                     double latitude, double longitude);
+
+/** Compile the zone boundaries in a GeoJSON file into a map. The file
+ * must hold a FeatureCollection, each feature of which has a Polygon or
+ * MultiPolygon geometry, and the zone name as its "tzid" property, as
+ * the files from the timezone-boundary-builder project do. Features
+ * without a zone name, or of other geometries, are skipped. Returns
+ * FALSE, having logged the reason, if the source can't be read or
+ * parsed, or the map can't be written. */
+extern BOOL soltzmap_write_file (const char *source, const char *path);
+
+END_DECLS
+
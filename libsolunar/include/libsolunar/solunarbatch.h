@@ -0,0 +1,51 @@
+/*============================================================================
+  
+  libsolunar
+  
+  solunarbatch.h
+
+  Day summaries for many places over a range of dates, worked out on a
+  pool of threads. The work is divided into tiles, each a few places
+  over a block of consecutive days, which the threads take in turn until
+  none are left. Within a tile, the Moon's position at the boundary
+  between days is shared, as it is by SolunarDayIter and, when there is
+  more than one place, the observer-independent part of the ephemeris
+  is worked out once for each block of days and shared by all the places.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <klib/klib.h>
+#include <libsolunar/solunardaysummary.h>
+
+/* One place for solunar_batch_create_day_summaries(). tz may be NULL,
+ * meaning the system timezone, and city may be NULL. The strings are
+ * copied into the summaries. */
+typedef struct _SolunarObserver
+  {
+  double latitude;
+  double longitude;
+  const char *tz;
+  const char *city;
+  } SolunarObserver;
+
+BEGIN_DECLS
+
+/** Work out the summaries of ndays local days, starting with the
+ * specified date (month 1-12), for each of nobservers places. Each place
+ * has its own local days, in its own timezone. The summary for place o
+ * on day d is written to results[o * ndays + d], which the caller must
+ * destroy; results must have room for nobservers * ndays summaries. The
+ * summaries are exactly as SolunarDayIter would give, and do not depend
+ * on the number of threads. If threads is zero or negative, one thread
+ * is used for each online CPU. */
+extern void solunar_batch_create_day_summaries
+          (const SolunarObserver *observers, int nobservers, int year,
+           int month, int day, int ndays, int threads,
+           SolunarDaySummary **results);
+
+END_DECLS
+
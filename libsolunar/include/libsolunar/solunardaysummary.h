@@ -10,11 +10,56 @@
   ==========================================================================*/
 #pragma once
 
+#include <stdint.h>
 #include <klib/klib.h>
+#include <libsolunar/solephemeris.h>
+#include <libsolunar/moontimes.h>
 
 struct _SolunarDaySummary;
 typedef struct _SolunarDaySummary SolunarDaySummary;
 
+/* An iterator over the summaries of consecutive local days. It holds 
+ * only the state carried from one day to the next, so its memory use
+ * does not depend on the number of days. */
+struct _SolunarDayIter;
+typedef struct _SolunarDayIter SolunarDayIter;
+
+/* The values in a summary, other than the city and timezone names, in
+ * a form with a fixed size and no pointers, so it can be stored in a
+ * file and read back by the same build of the library. Times are
+ * seconds since the epoch. */
+typedef struct _SolunarDayRecord
+  {
+  int64_t date;
+  int64_t sunrise;
+  int64_t sunset;
+  int64_t start_civil_twilight;
+  int64_t end_civil_twilight;
+  int64_t start_nautical_twilight;
+  int64_t end_nautical_twilight;
+  int64_t start_astronomical_twilight;
+  int64_t end_astronomical_twilight;
+  int64_t high_noon;
+  int64_t moon_rises[MOONTIMES_MAX_EVENTS];
+  int64_t moon_sets[MOONTIMES_MAX_EVENTS];
+  int64_t moon_transits[MOONTIMES_MAX_EVENTS];
+  int64_t moon_lower_transits[MOONTIMES_MAX_EVENTS];
+  int64_t moon_max_altitude_time;
+  int32_t n_moon_rises;
+  int32_t n_moon_sets;
+  int32_t n_moon_transits;
+  int32_t n_moon_lower_transits;
+  double moon_max_altitude;
+  double sun_max_altitude;
+  double moon_distance;
+  double moon_phase;
+  double moon_age;
+  double latitude;
+  double longitude;
+  int32_t moon_flags;
+  int32_t reserved;
+  } SolunarDayRecord;
+
 BEGIN_DECLS
 
 /** Get a summary of the day's solunar events. The day is that which contains
@@ -37,6 +82,22 @@ extern SolunarDaySummary *solunar_day_summary_create
         (time_t date, double latitude, double longitude, const char *city, 
 	 const char *tz);
 
+/** As solunar_day_summary_create(), but taking the samples of the Moon's
+ * position from eph where it has them. The results are exactly the same,
+ * but when summaries are needed for many places on the same date, 
+ * nearly all the work of finding the Moon's position is shared, in
+ * every zone whose offset from UTC is a whole number of hours (see
+ * solephemeris.h). eph may be NULL. */
+extern SolunarDaySummary *solunar_day_summary_create_with_ephemeris
+        (time_t date, double latitude, double longitude, const char *city, 
+	 const char *tz, const SolEphemeris *eph);
+
+/** Create an ephemeris for use with 
+ * solunar_day_summary_create_with_ephemeris(), that covers the local day
+ * containing date in any timezone. The caller should destroy it with
+ * solephemeris_destroy(). */
+extern SolEphemeris *solunar_day_summary_create_ephemeris (time_t date);
+
 extern void   solunar_day_summary_destroy (SolunarDaySummary *self);
 
 /** Get the city name that was supplied when this object was created. 
@@ -75,6 +136,16 @@ extern double solunar_day_summary_get_moon_distance
 /** Returns the various MOON_FLAG_XXX attributions. */
 int solunar_day_summary_get_moon_flags (const SolunarDaySummary *self);
 
+/** Get the n'th lower transit of the Moon (when it crosses the observer's
+ * meridian below the pole). */
+extern time_t solunar_day_summary_get_moon_lower_transit
+                (const SolunarDaySummary *self, int n);
+
+/** The highest altitude of the Moon during the day, in degrees. This is
+ * negative if the Moon does not rise at all. */
+extern double solunar_day_summary_get_moon_max_altitude 
+                 (const SolunarDaySummary *self);
+
 /** Moon phase, in range 0-1. 0 and 1 are both new; full is 0.5. */
 extern double solunar_day_summary_get_moon_phase 
                  (const SolunarDaySummary *self);
@@ -91,6 +162,19 @@ extern time_t solunar_day_summary_get_moon_rise
 extern time_t solunar_day_summary_get_moon_set
                 (const SolunarDaySummary *self, int n);
 
+/** Get the n'th upper transit (culmination) of the Moon. */
+extern time_t solunar_day_summary_get_moon_transit
+                (const SolunarDaySummary *self, int n);
+
+/** Get number of lower transits of the Moon during the day. */
+extern int solunar_day_summary_get_n_moon_lower_transits 
+                (const SolunarDaySummary *self);
+
+/** Get number of upper transits of the Moon during the day. There can be
+ * 0-2, although there is usually one. */
+extern int solunar_day_summary_get_n_moon_transits 
+                (const SolunarDaySummary *self);
+
 /** Get numbers of moonrises during the day. There can be 0-2. */
 extern int solunar_day_summary_get_n_rises (const SolunarDaySummary *self);
 
@@ -118,5 +202,41 @@ extern const char *solunar_day_summary_get_tz_city
 
 extern KString *solunar_day_summary_to_json (const SolunarDaySummary *self);
 
+/** Copy the values of a summary into a record. */
+extern void solunar_day_summary_get_record (const SolunarDaySummary *self,
+          SolunarDayRecord *record);
+
+/** Create a summary from a record made by 
+ * solunar_day_summary_get_record(), with the specified city and timezone
+ * names, either of which may be NULL. The summary is the same as the one
+ * the record was made from, apart from the names. */
+extern SolunarDaySummary *solunar_day_summary_new_from_record
+          (const SolunarDayRecord *record, const char *city, 
+           const char *tz);
+
+/** Create an iterator over the summaries of n days, starting with the
+ * local day, in timezone tz, in which first falls. Each summary is as 
+ * solunar_day_summary_create() would give for the start of the day, but 
+ * the Moon's position at the boundary between two days is worked out only
+ * once. */
+extern SolunarDayIter *solunar_day_iter_new (time_t first, int n,
+          double latitude, double longitude, const char *city, 
+          const char *tz);
+
+/** Create an iterator over the summaries of n local days in timezone 
+ * tz, starting with the specified date (month 1-12). Out-of-range days
+ * are normalized, so day 32 of January is the 1st of February. The 
+ * Moon's position is taken from eph, which may be NULL, where it has
+ * it; eph must not be destroyed until the iterator has been. */
+extern SolunarDayIter *solunar_day_iter_new_from_date (int year, int month,
+          int day, int n, double latitude, double longitude, 
+          const char *city, const char *tz, const SolEphemeris *eph);
+
+/** Get the summary for the next day, which the caller must destroy, or
+ * NULL if there are no more days. */
+extern SolunarDaySummary *solunar_day_iter_next (SolunarDayIter *self);
+
+extern void solunar_day_iter_destroy (SolunarDayIter *self);
+
 END_DECLS
 
@@ -20,6 +20,13 @@ BEGIN_DECLS
 extern SolunarYearSummary *solunar_year_summary_create 
             (int year, double latitude, const char *tz);
 
+/** Create a summary with the movable feasts in the sets selected by
+ * feasts, a bitmask of FESTIVAL_FEAST_SET() values. 
+ * solunar_year_summary_create() includes only the 
+ * FESTIVAL_FEASTS_EASTER set. */
+extern SolunarYearSummary *solunar_year_summary_create_with_feasts
+            (int year, double latitude, const char *tz, int feasts);
+
 extern void solunar_year_summary_destroy (SolunarYearSummary *self);
 
 /** Get the festivals as a KList of Festival objects. */
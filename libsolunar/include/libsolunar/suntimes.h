@@ -23,6 +23,25 @@
 #define SUNTIMES_NAUTICAL_TWILIGHT (90 + 50.0/60.0 + 12)
 #define SUNTIMES_ASTRONOMICAL_TWILIGHT (90 + 50.0/60.0 + 18)
 
+/* Zeniths often used by photographers. The "golden hour" is the time
+ * after sunrise and before sunset when the sun is less than 6 degrees 
+ * above the horizon, and the "blue hour" runs from civil twilight to 
+ * when the sun is 4 degrees below the horizon. Unlike sunrise and
+ * sunset, these are not corrected for refraction. */
+#define SUNTIMES_GOLDEN_HOUR (90.0 - 6.0)
+#define SUNTIMES_BLUE_HOUR (90.0 + 4.0)
+
+/* One zenith for suntimes_get_all_events(). The caller sets the zenith,
+ * and the function fills in the times at which the sun crosses it in 
+ * the morning (rise) and the evening (set). Either time is zero if the
+ * sun does not reach the zenith on that day. */
+typedef struct _SunTimesEvent
+  {
+  double zenith;
+  time_t rise;
+  time_t set;
+  } SunTimesEvent;
+
 BEGIN_DECLS
 
 /** Get a very approximate sunrise time, relative to midnight UTC at the
@@ -79,6 +98,15 @@ time_t suntimes_get_sunrise (time_t day, double latitude, double longitude,
 time_t suntimes_get_sunset (time_t day, double latitude, double longitude, 
        double zenith);
 
+/** Get the morning and evening crossings of any number of zeniths, on
+ * the day that includes the specified time, as get_sunrise() and 
+ * get_sunset() would. The parts of the calculation that do not depend 
+ * on the zenith are done only once for the morning and once for the
+ * evening, so this is much quicker than calling get_sunrise() and
+ * get_sunset() for each zenith. */
+void suntimes_get_all_events (time_t day, double latitude, 
+       double longitude, SunTimesEvent *events, int n);
+
 END_DECLS
 
 
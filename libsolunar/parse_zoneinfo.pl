@@ -1,15 +1,35 @@
 #!/usr/bin/perl -w
 
-# Construct cityinfo.h from zone.tag
+# Construct cityinfo.h from zone.tab
+# Usage: parse_zoneinfo.pl [path to zone.tab]
 # (c)2005-2012 Kevin Boone
 
 use strict;
 
-open IN,"</usr/share/zoneinfo/zone.tab" or die "Can't open zone.tab";
+my $zone_tab = $ARGV[0] || "/usr/share/zoneinfo/zone.tab";
+
+open IN,"<$zone_tab" or die "Can't open $zone_tab";
 open OUT,">src/cityinfo.h" or die "Can't write cityinfo.h";
 print OUT "//Do not edit this file by hand\n";
 print OUT "static SolCity cities[] = {\n";
 
+my @names;
+my @lats;
+my @longs;
+
+# Print a list of numbers as the body of a C array, a line at a time
+sub print_list
+  {
+  my @list = @_;
+  while (@list)
+    {
+    my @line = splice (@list, 0, 12);
+    print OUT join (",", @line);
+    print OUT (@list ? ",\n" : "\n");
+    }
+  print OUT "};\n";
+  }
+
 while (my $line=<IN>)
   {
   chomp ($line);
@@ -47,10 +67,148 @@ while (my $line=<IN>)
   print OUT "\"$name\"";
   print OUT "},";
   print OUT "\n";
+  push @names, $name;
+  push @lats, $lati;
+  push @longs, $longt;
   }
 
 print OUT "{NULL, NULL, 0, 0}";
 print OUT "};\n";
 
+# The index used by solcity_find_matching(). Zone names are ASCII, so
+#  lc() folds them the same way as kstring_fold_utf8() folds a query
+
+my @lnames = map { lc } @names;
+my $n = scalar @lnames;
+
+print OUT "\n#define CITY_COUNT $n\n";
+
+# The names in lower case, in the same order as cities[], each
+#  terminated by a zero
+print OUT "\nstatic const char city_name_pool[] =\n";
+my @offsets;
+my $offset = 0;
+foreach my $lname (@lnames)
+  {
+  push @offsets, $offset;
+  print OUT "\"$lname\\0\"\n";
+  $offset += length ($lname) + 1;
+  }
+print OUT ";\n";
+
+print OUT "\nstatic const unsigned short city_name_offsets[] = {\n";
+print_list (@offsets);
+
+# Every three-character sequence that occurs in a name, in order, with
+#  the cities in which it occurs. The cities for city_trigrams[i*3] are
+#  city_trigram_postings[city_trigram_starts[i]] up to, but not including,
+#  city_trigram_postings[city_trigram_starts[i+1]]
+
+my %trigrams;
+for (my $i = 0; $i < $n; $i++)
+  {
+  my $lname = $lnames[$i];
+  my %seen;
+  for (my $j = 0; $j + 3 <= length ($lname); $j++)
+    {
+    my $t = substr ($lname, $j, 3);
+    next if $seen{$t}++;
+    push @{$trigrams{$t}}, $i;
+    }
+  }
+
+my @keys = sort keys %trigrams;
+my $ntrigrams = scalar @keys;
+print OUT "\n#define CITY_TRIGRAM_COUNT $ntrigrams\n";
+
+print OUT "\nstatic const char city_trigrams[] =\n";
+for (my $i = 0; $i < $ntrigrams; $i += 20)
+  {
+  my $last = $i + 19 < $ntrigrams ? $i + 19 : $ntrigrams - 1;
+  print OUT "\"" . join ("", @keys[$i..$last]) . "\"\n";
+  }
+print OUT ";\n";
+
+my @starts;
+my @postings;
+foreach my $t (@keys)
+  {
+  push @starts, scalar @postings;
+  push @postings, @{$trigrams{$t}};
+  }
+push @starts, scalar @postings;
+
+print OUT "\nstatic const unsigned short city_trigram_starts[] = {\n";
+print_list (@starts);
+
+print OUT "\nstatic const unsigned short city_trigram_postings[] = {\n";
+print_list (@postings);
+
+# The cities in order of name, and in order of the place name -- the part
+#  after the last '/' -- for prefix searches
+
+sub place { my $s = shift; $s =~ s/.*\///; return $s; }
+
+my @name_order = sort { $lnames[$a] cmp $lnames[$b] || $a <=> $b } 0..$n-1;
+my @place_order = sort
+  { place ($lnames[$a]) cmp place ($lnames[$b]) || $a <=> $b } 0..$n-1;
+
+print OUT "\nstatic const unsigned short city_name_order[] = {\n";
+print_list (@name_order);
+
+print OUT "\nstatic const unsigned short city_place_order[] = {\n";
+print_list (@place_order);
+
+# A k-d tree for solcity_find_nearest(), over the positions of the cities
+#  as points on the unit sphere, built as spherekd_build() would
+
+my $pi = 4 * atan2 (1, 1);
+my @xyz;
+for (my $i = 0; $i < $n; $i++)
+  {
+  my $lat = $lats[$i] * $pi / 180;
+  my $long = $longs[$i] * $pi / 180;
+  push @xyz, [cos ($lat) * cos ($long), cos ($lat) * sin ($long), sin ($lat)];
+  }
+
+print OUT "\nstatic const double city_xyz[][3] = {\n";
+for (my $i = 0; $i < $n; $i++)
+  {
+  printf OUT "{%.17g,%.17g,%.17g}%s\n", @{$xyz[$i]}, 
+    $i < $n - 1 ? "," : "";
+  }
+print OUT "};\n";
+
+my @kd_order = 0..$n-1;
+my @kd_axis = (0) x $n;
+
+sub build_kd
+  {
+  my ($lo, $hi) = @_;
+  return if $lo >= $hi;
+  # Split on the axis along which the points are most spread out
+  my $axis = 0;
+  my $widest = -1;
+  for (my $i = 0; $i < 3; $i++)
+    {
+    my @v = sort { $a <=> $b } map { $xyz[$_][$i] } @kd_order[$lo..$hi-1];
+    my $spread = $v[-1] - $v[0];
+    if ($spread > $widest) { $widest = $spread; $axis = $i; }
+    }
+  @kd_order[$lo..$hi-1] = sort 
+    { $xyz[$a][$axis] <=> $xyz[$b][$axis] || $a <=> $b } 
+    @kd_order[$lo..$hi-1];
+  my $mid = int (($lo + $hi) / 2);
+  $kd_axis[$mid] = $axis;
+  build_kd ($lo, $mid);
+  build_kd ($mid + 1, $hi);
+  }
+
+build_kd (0, $n);
+
+print OUT "\nstatic const uint32_t city_kd_order[] = {\n";
+print_list (@kd_order);
 
+print OUT "\nstatic const uint8_t city_kd_axis[] = {\n";
+print_list (@kd_axis);
 
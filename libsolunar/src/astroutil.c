@@ -35,12 +35,54 @@ double astroutil_get_hours_from_meridian (double longitude)
   return ret;
   }
 
+/*============================================================================
+  
+  astroutil_get_hour_angle
+
+  ==========================================================================*/
+double astroutil_get_hour_angle (time_t t, double longitude, double ra)
+  {
+  KLOG_IN
+  double ret = astroutil_get_hour_angle_gmst (astroutil_gmst (t), 
+    longitude, ra);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  astroutil_get_hour_angle_gmst
+
+  ==========================================================================*/
+double astroutil_get_hour_angle_gmst (double gmst, double longitude, 
+         double ra)
+  {
+  KLOG_IN
+  double ret = DEG_PER_HOUR * (astroutil_lmst_from_gmst (gmst, longitude) 
+    - ra);
+  KLOG_OUT
+  return ret;
+  }
+
 /*============================================================================
   
   astroutil_lmst
 
   ==========================================================================*/
 double astroutil_lmst (time_t t, double longitude)
+  {
+  KLOG_IN
+  double LMST = astroutil_lmst_from_gmst (astroutil_gmst (t), longitude);
+  KLOG_OUT
+  return LMST;
+  } 
+
+/*============================================================================
+  
+  astroutil_gmst
+
+  ==========================================================================*/
+double astroutil_gmst (time_t t)
   {
   KLOG_IN
   double mjd = datetimeconv_time_to_mjd (t);
@@ -50,23 +92,50 @@ double astroutil_lmst (time_t t, double longitude)
   double GMST = 6.697374558
         + 1.0027379093 * UT
         + (8640184.812866 + (0.093104 - 6.2E-6 * T) * T) * T / 3600.0;
-  double LMST = 24.0 * mathutil_pascal_frac ((GMST + longitude / 15.0) / 24.0);
+  KLOG_OUT
+  return GMST;
+  } 
+
+/*============================================================================
+  
+  astroutil_lmst_from_gmst
+
+  ==========================================================================*/
+double astroutil_lmst_from_gmst (double gmst, double longitude)
+  {
+  KLOG_IN
+  double LMST = 24.0 * mathutil_pascal_frac ((gmst + longitude / 15.0) / 24.0);
   KLOG_OUT
   return LMST;
   } 
 
 /*============================================================================
   
-  astroutil_lmst
+  astroutil_ra_dec_to_sin_altitude
 
   ==========================================================================*/
 double astroutil_ra_dec_to_sin_altitude (time_t t, double latitude, 
          double longitude, double ra, double dec)
   { 
   KLOG_IN
+  double result = astroutil_gmst_ra_dec_to_sin_altitude (astroutil_gmst (t),
+    latitude, longitude, ra, dec);
+  KLOG_OUT
+  return result;
+  }
+
+/*============================================================================
+  
+  astroutil_gmst_ra_dec_to_sin_altitude
+
+  ==========================================================================*/
+double astroutil_gmst_ra_dec_to_sin_altitude (double gmst, double latitude,
+         double longitude, double ra, double dec)
+  { 
+  KLOG_IN
   double cos_latitude = mathutil_cos_deg (latitude);
   double sin_latitude = mathutil_sin_deg (latitude);
-  double tau = 15.0 * (astroutil_lmst (t, longitude) - ra);
+  double tau = astroutil_get_hour_angle_gmst (gmst, longitude, ra);
   double result = sin_latitude * mathutil_sin_deg (dec)
                 + cos_latitude * mathutil_cos_deg (dec) 
                      * mathutil_cos_deg (tau);
@@ -74,4 +143,3 @@ double astroutil_ra_dec_to_sin_altitude (time_t t, double latitude,
   return result;
   }
 
-
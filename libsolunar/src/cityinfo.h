@@ -419,3 +419,1740 @@ static SolCity cities[] = {
 {"Africa/Lusaka","ZM",-15.4166666666667,28.2833333333333,"Africa/Lusaka"},
 {"Africa/Harare","ZW",-17.8333333333333,31.05,"Africa/Harare"},
 {NULL, NULL, 0, 0}};
+
+#define CITY_COUNT 418
+
+static const char city_name_pool[] =
+"europe/andorra\0"
+"asia/dubai\0"
+"asia/kabul\0"
+"america/antigua\0"
+"america/anguilla\0"
+"europe/tirane\0"
+"asia/yerevan\0"
+"africa/luanda\0"
+"antarctica/mcmurdo\0"
+"antarctica/casey\0"
+"antarctica/davis\0"
+"antarctica/dumontdurville\0"
+"antarctica/mawson\0"
+"antarctica/palmer\0"
+"antarctica/rothera\0"
+"antarctica/syowa\0"
+"antarctica/troll\0"
+"antarctica/vostok\0"
+"america/argentina/buenos_aires\0"
+"america/argentina/cordoba\0"
+"america/argentina/salta\0"
+"america/argentina/jujuy\0"
+"america/argentina/tucuman\0"
+"america/argentina/catamarca\0"
+"america/argentina/la_rioja\0"
+"america/argentina/san_juan\0"
+"america/argentina/mendoza\0"
+"america/argentina/san_luis\0"
+"america/argentina/rio_gallegos\0"
+"america/argentina/ushuaia\0"
+"pacific/pago_pago\0"
+"europe/vienna\0"
+"australia/lord_howe\0"
+"antarctica/macquarie\0"
+"australia/hobart\0"
+"australia/melbourne\0"
+"australia/sydney\0"
+"australia/broken_hill\0"
+"australia/brisbane\0"
+"australia/lindeman\0"
+"australia/adelaide\0"
+"australia/darwin\0"
+"australia/perth\0"
+"australia/eucla\0"
+"america/aruba\0"
+"europe/mariehamn\0"
+"asia/baku\0"
+"europe/sarajevo\0"
+"america/barbados\0"
+"asia/dhaka\0"
+"europe/brussels\0"
+"africa/ouagadougou\0"
+"europe/sofia\0"
+"asia/bahrain\0"
+"africa/bujumbura\0"
+"africa/porto-novo\0"
+"america/st_barthelemy\0"
+"atlantic/bermuda\0"
+"asia/brunei\0"
+"america/la_paz\0"
+"america/kralendijk\0"
+"america/noronha\0"
+"america/belem\0"
+"america/fortaleza\0"
+"america/recife\0"
+"america/araguaina\0"
+"america/maceio\0"
+"america/bahia\0"
+"america/sao_paulo\0"
+"america/campo_grande\0"
+"america/cuiaba\0"
+"america/santarem\0"
+"america/porto_velho\0"
+"america/boa_vista\0"
+"america/manaus\0"
+"america/eirunepe\0"
+"america/rio_branco\0"
+"america/nassau\0"
+"asia/thimphu\0"
+"africa/gaborone\0"
+"europe/minsk\0"
+"america/belize\0"
+"america/st_johns\0"
+"america/halifax\0"
+"america/glace_bay\0"
+"america/moncton\0"
+"america/goose_bay\0"
+"america/blanc-sablon\0"
+"america/toronto\0"
+"america/iqaluit\0"
+"america/atikokan\0"
+"america/winnipeg\0"
+"america/resolute\0"
+"america/rankin_inlet\0"
+"america/regina\0"
+"america/swift_current\0"
+"america/edmonton\0"
+"america/cambridge_bay\0"
+"america/inuvik\0"
+"america/creston\0"
+"america/dawson_creek\0"
+"america/fort_nelson\0"
+"america/whitehorse\0"
+"america/dawson\0"
+"america/vancouver\0"
+"indian/cocos\0"
+"africa/kinshasa\0"
+"africa/lubumbashi\0"
+"africa/bangui\0"
+"africa/brazzaville\0"
+"europe/zurich\0"
+"africa/abidjan\0"
+"pacific/rarotonga\0"
+"america/santiago\0"
+"america/punta_arenas\0"
+"pacific/easter\0"
+"africa/douala\0"
+"asia/shanghai\0"
+"asia/urumqi\0"
+"america/bogota\0"
+"america/costa_rica\0"
+"america/havana\0"
+"atlantic/cape_verde\0"
+"america/curacao\0"
+"indian/christmas\0"
+"asia/nicosia\0"
+"asia/famagusta\0"
+"europe/prague\0"
+"europe/berlin\0"
+"europe/busingen\0"
+"africa/djibouti\0"
+"europe/copenhagen\0"
+"america/dominica\0"
+"america/santo_domingo\0"
+"africa/algiers\0"
+"america/guayaquil\0"
+"pacific/galapagos\0"
+"europe/tallinn\0"
+"africa/cairo\0"
+"africa/el_aaiun\0"
+"africa/asmara\0"
+"europe/madrid\0"
+"africa/ceuta\0"
+"atlantic/canary\0"
+"africa/addis_ababa\0"
+"europe/helsinki\0"
+"pacific/fiji\0"
+"atlantic/stanley\0"
+"pacific/chuuk\0"
+"pacific/pohnpei\0"
+"pacific/kosrae\0"
+"atlantic/faroe\0"
+"europe/paris\0"
+"africa/libreville\0"
+"europe/london\0"
+"america/grenada\0"
+"asia/tbilisi\0"
+"america/cayenne\0"
+"europe/guernsey\0"
+"africa/accra\0"
+"europe/gibraltar\0"
+"america/nuuk\0"
+"america/danmarkshavn\0"
+"america/scoresbysund\0"
+"america/thule\0"
+"africa/banjul\0"
+"africa/conakry\0"
+"america/guadeloupe\0"
+"africa/malabo\0"
+"europe/athens\0"
+"atlantic/south_georgia\0"
+"america/guatemala\0"
+"pacific/guam\0"
+"africa/bissau\0"
+"america/guyana\0"
+"asia/hong_kong\0"
+"america/tegucigalpa\0"
+"europe/zagreb\0"
+"america/port-au-prince\0"
+"europe/budapest\0"
+"asia/jakarta\0"
+"asia/pontianak\0"
+"asia/makassar\0"
+"asia/jayapura\0"
+"europe/dublin\0"
+"asia/jerusalem\0"
+"europe/isle_of_man\0"
+"asia/kolkata\0"
+"indian/chagos\0"
+"asia/baghdad\0"
+"asia/tehran\0"
+"atlantic/reykjavik\0"
+"europe/rome\0"
+"europe/jersey\0"
+"america/jamaica\0"
+"asia/amman\0"
+"asia/tokyo\0"
+"africa/nairobi\0"
+"asia/bishkek\0"
+"asia/phnom_penh\0"
+"pacific/tarawa\0"
+"pacific/kanton\0"
+"pacific/kiritimati\0"
+"indian/comoro\0"
+"america/st_kitts\0"
+"asia/pyongyang\0"
+"asia/seoul\0"
+"asia/kuwait\0"
+"america/cayman\0"
+"asia/almaty\0"
+"asia/qyzylorda\0"
+"asia/qostanay\0"
+"asia/aqtobe\0"
+"asia/aqtau\0"
+"asia/atyrau\0"
+"asia/oral\0"
+"asia/vientiane\0"
+"asia/beirut\0"
+"america/st_lucia\0"
+"europe/vaduz\0"
+"asia/colombo\0"
+"africa/monrovia\0"
+"africa/maseru\0"
+"europe/vilnius\0"
+"europe/luxembourg\0"
+"europe/riga\0"
+"africa/tripoli\0"
+"africa/casablanca\0"
+"europe/monaco\0"
+"europe/chisinau\0"
+"europe/podgorica\0"
+"america/marigot\0"
+"indian/antananarivo\0"
+"pacific/majuro\0"
+"pacific/kwajalein\0"
+"europe/skopje\0"
+"africa/bamako\0"
+"asia/yangon\0"
+"asia/ulaanbaatar\0"
+"asia/hovd\0"
+"asia/choibalsan\0"
+"asia/macau\0"
+"pacific/saipan\0"
+"america/martinique\0"
+"africa/nouakchott\0"
+"america/montserrat\0"
+"europe/malta\0"
+"indian/mauritius\0"
+"indian/maldives\0"
+"africa/blantyre\0"
+"america/mexico_city\0"
+"america/cancun\0"
+"america/merida\0"
+"america/monterrey\0"
+"america/matamoros\0"
+"america/chihuahua\0"
+"america/ciudad_juarez\0"
+"america/ojinaga\0"
+"america/mazatlan\0"
+"america/bahia_banderas\0"
+"america/hermosillo\0"
+"america/tijuana\0"
+"asia/kuala_lumpur\0"
+"asia/kuching\0"
+"africa/maputo\0"
+"africa/windhoek\0"
+"pacific/noumea\0"
+"africa/niamey\0"
+"pacific/norfolk\0"
+"africa/lagos\0"
+"america/managua\0"
+"europe/amsterdam\0"
+"europe/oslo\0"
+"asia/kathmandu\0"
+"pacific/nauru\0"
+"pacific/niue\0"
+"pacific/auckland\0"
+"pacific/chatham\0"
+"asia/muscat\0"
+"america/panama\0"
+"america/lima\0"
+"pacific/tahiti\0"
+"pacific/marquesas\0"
+"pacific/gambier\0"
+"pacific/port_moresby\0"
+"pacific/bougainville\0"
+"asia/manila\0"
+"asia/karachi\0"
+"europe/warsaw\0"
+"america/miquelon\0"
+"pacific/pitcairn\0"
+"america/puerto_rico\0"
+"asia/gaza\0"
+"asia/hebron\0"
+"europe/lisbon\0"
+"atlantic/madeira\0"
+"atlantic/azores\0"
+"pacific/palau\0"
+"america/asuncion\0"
+"asia/qatar\0"
+"indian/reunion\0"
+"europe/bucharest\0"
+"europe/belgrade\0"
+"europe/kaliningrad\0"
+"europe/moscow\0"
+"europe/simferopol\0"
+"europe/kirov\0"
+"europe/volgograd\0"
+"europe/astrakhan\0"
+"europe/saratov\0"
+"europe/ulyanovsk\0"
+"europe/samara\0"
+"asia/yekaterinburg\0"
+"asia/omsk\0"
+"asia/novosibirsk\0"
+"asia/barnaul\0"
+"asia/tomsk\0"
+"asia/novokuznetsk\0"
+"asia/krasnoyarsk\0"
+"asia/irkutsk\0"
+"asia/chita\0"
+"asia/yakutsk\0"
+"asia/khandyga\0"
+"asia/vladivostok\0"
+"asia/ust-nera\0"
+"asia/magadan\0"
+"asia/sakhalin\0"
+"asia/srednekolymsk\0"
+"asia/kamchatka\0"
+"asia/anadyr\0"
+"africa/kigali\0"
+"asia/riyadh\0"
+"pacific/guadalcanal\0"
+"indian/mahe\0"
+"africa/khartoum\0"
+"europe/stockholm\0"
+"asia/singapore\0"
+"atlantic/st_helena\0"
+"europe/ljubljana\0"
+"arctic/longyearbyen\0"
+"europe/bratislava\0"
+"africa/freetown\0"
+"europe/san_marino\0"
+"africa/dakar\0"
+"africa/mogadishu\0"
+"america/paramaribo\0"
+"africa/juba\0"
+"africa/sao_tome\0"
+"america/el_salvador\0"
+"america/lower_princes\0"
+"asia/damascus\0"
+"africa/mbabane\0"
+"america/grand_turk\0"
+"africa/ndjamena\0"
+"indian/kerguelen\0"
+"africa/lome\0"
+"asia/bangkok\0"
+"asia/dushanbe\0"
+"pacific/fakaofo\0"
+"asia/dili\0"
+"asia/ashgabat\0"
+"africa/tunis\0"
+"pacific/tongatapu\0"
+"europe/istanbul\0"
+"america/port_of_spain\0"
+"pacific/funafuti\0"
+"asia/taipei\0"
+"africa/dar_es_salaam\0"
+"europe/kyiv\0"
+"africa/kampala\0"
+"pacific/midway\0"
+"pacific/wake\0"
+"america/new_york\0"
+"america/detroit\0"
+"america/kentucky/louisville\0"
+"america/kentucky/monticello\0"
+"america/indiana/indianapolis\0"
+"america/indiana/vincennes\0"
+"america/indiana/winamac\0"
+"america/indiana/marengo\0"
+"america/indiana/petersburg\0"
+"america/indiana/vevay\0"
+"america/chicago\0"
+"america/indiana/tell_city\0"
+"america/indiana/knox\0"
+"america/menominee\0"
+"america/north_dakota/center\0"
+"america/north_dakota/new_salem\0"
+"america/north_dakota/beulah\0"
+"america/denver\0"
+"america/boise\0"
+"america/phoenix\0"
+"america/los_angeles\0"
+"america/anchorage\0"
+"america/juneau\0"
+"america/sitka\0"
+"america/metlakatla\0"
+"america/yakutat\0"
+"america/nome\0"
+"america/adak\0"
+"pacific/honolulu\0"
+"america/montevideo\0"
+"asia/samarkand\0"
+"asia/tashkent\0"
+"europe/vatican\0"
+"america/st_vincent\0"
+"america/caracas\0"
+"america/tortola\0"
+"america/st_thomas\0"
+"asia/ho_chi_minh\0"
+"pacific/efate\0"
+"pacific/wallis\0"
+"pacific/apia\0"
+"asia/aden\0"
+"indian/mayotte\0"
+"africa/johannesburg\0"
+"africa/lusaka\0"
+"africa/harare\0"
+;
+
+static const unsigned short city_name_offsets[] = {
+0,15,26,37,53,70,84,97,111,130,147,164,
+190,208,226,245,262,279,297,328,354,378,402,428,
+456,483,510,536,563,594,620,638,652,672,693,710,
+730,747,769,788,807,826,843,859,875,889,906,916,
+932,949,960,976,995,1008,1021,1038,1056,1078,1095,1107,
+1122,1141,1157,1171,1189,1204,1222,1237,1251,1269,1290,1305,
+1322,1342,1360,1375,1392,1411,1426,1439,1455,1468,1483,1500,
+1516,1534,1550,1568,1589,1605,1621,1638,1655,1672,1693,1708,
+1730,1747,1769,1784,1800,1821,1841,1860,1875,1893,1906,1922,
+1940,1954,1973,1987,2002,2020,2037,2058,2073,2087,2101,2113,
+2128,2147,2162,2182,2198,2215,2228,2243,2257,2271,2287,2303,
+2321,2338,2360,2375,2393,2411,2426,2439,2455,2469,2483,2496,
+2512,2531,2547,2560,2577,2591,2607,2622,2637,2650,2668,2682,
+2698,2711,2727,2743,2756,2773,2786,2807,2828,2842,2856,2871,
+2890,2904,2918,2941,2959,2972,2986,3001,3016,3036,3050,3073,
+3089,3102,3117,3131,3145,3159,3174,3193,3206,3220,3233,3245,
+3264,3276,3290,3306,3317,3328,3343,3356,3372,3387,3402,3421,
+3435,3452,3467,3478,3490,3505,3517,3532,3546,3558,3569,3581,
+3591,3606,3618,3635,3648,3661,3677,3691,3706,3724,3736,3751,
+3769,3783,3799,3816,3832,3852,3867,3885,3899,3913,3925,3942,
+3952,3968,3979,3994,4013,4031,4050,4063,4080,4096,4112,4132,
+4147,4162,4180,4198,4216,4238,4254,4271,4294,4313,4329,4347,
+4360,4374,4390,4405,4419,4435,4448,4464,4481,4493,4508,4522,
+4535,4552,4568,4580,4595,4608,4623,4641,4657,4678,4699,4711,
+4724,4738,4755,4772,4792,4802,4814,4828,4845,4861,4875,4892,
+4903,4918,4935,4951,4970,4984,5002,5015,5032,5049,5064,5081,
+5095,5114,5124,5141,5154,5165,5183,5200,5213,5224,5237,5251,
+5268,5282,5295,5309,5328,5343,5355,5369,5381,5401,5413,5429,
+5446,5461,5480,5497,5517,5535,5551,5569,5582,5599,5618,5630,
+5646,5666,5688,5702,5717,5736,5752,5769,5781,5794,5808,5824,
+5834,5848,5861,5879,5895,5917,5934,5946,5967,5979,5994,6009,
+6022,6039,6055,6083,6111,6140,6166,6190,6214,6241,6263,6279,
+6305,6326,6344,6372,6403,6431,6446,6460,6476,6496,6514,6529,
+6543,6562,6578,6591,6604,6621,6640,6655,6669,6684,6703,6719,
+6735,6753,6770,6784,6799,6812,6822,6837,6857,6871
+};
+
+#define CITY_TRIGRAM_COUNT 1679
+
+static const char city_trigrams[] =
+"-au-ne-no-pr-sa/ab/ac/ad/al/am/an/ap/aq/ar/as/at/au/az/ba/be"
+"/bi/bl/bo/br/bu/ca/ce/ch/ci/co/cr/cu/da/de/dh/di/dj/do/du/ea"
+"/ed/ef/ei/el/eu/fa/fi/fo/fr/fu/ga/gi/gl/go/gr/gu/ha/he/ho/in"
+"/iq/ir/is/ja/je/jo/ju/ka/ke/kh/ki/kn/ko/kr/ku/kw/ky/la/li/lj"
+"/lo/lu/ma/mb/mc/me/mi/mo/mu/na/nd/ne/ni/no/nu/oj/om/or/os/ou"
+"/pa/pe/ph/pi/po/pr/pu/py/qa/qo/qy/ra/re/ri/ro/sa/sc/se/sh/si"
+"/sk/so/sr/st/sw/sy/ta/tb/te/th/ti/to/tr/tu/ul/ur/us/va/ve/vi"
+"/vl/vo/wa/wh/wi/ya/ye/za/zu_aa_ab_ai_an_ar_ba_br_ch_ci_cr_cu"
+"_da_do_es_ga_ge_gr_he_hi_ho_in_jo_ju_ki_ko_lu_ma_mi_mo_ne_of"
+"_pa_pe_pr_ri_sa_sp_th_to_tu_ve_vi_yoa/aa/ba/ca/da/ea/fa/ga/h"
+"a/ia/ja/ka/la/ma/na/oa/pa/qa/ra/sa/ta/ua/va/wa/ya_aa_ba_la_p"
+"a_ra_vaaiaamaanaatabaabiablaboabuacaaccaceachaciacoacqad_ada"
+"addadeadhadiadoadraduadyafrafuagaageaghagoagraguaheahiahrahu"
+"aiaaicaidainaipairaitaiuajaajeajuakaakcakeakhakoakrakualaalc"
+"aldalealgaliallalmalpalsaltalualvamaambamcameammamnamoampams"
+"an/an_anaanbancandaneanganianjankanlanmannanoantao_aofapaape"
+"apiapoapuaqtaquar_araarbarcareargariarkarnaroarqarsartaruarw"
+"aryasaascaseashasiasmasnassastasuataateathatiatkatlatoatyau-"
+"aucaulaurausavaaviavnawaawsayaayeaymayoazaazoazzbaababbadbag"
+"bahbaibakbalbambanbarbasbatbaybeibelberbeubidbiebilbirbisbla"
+"blibljbloboabogboibonborboubrabrebribrobrubucbudbuebujbulbum"
+"burbusbyebysc-sc/ac/bc/cc/ec/fc/gc/hc/kc/lc/mc/nc/pc/rc/sc/t"
+"c/wca/cagcaicamcancaocapcarcascatcaucayccrce_ceicelcencesceu"
+"chachichochrchuciacifcigciocitciuckhcklckyclacmuco_coccolcom"
+"concopcorcoscoucowcqucracrectictocuicumcuncurcusd_hd_jd_tdad"
+"dakdaldamdandapdardavdawddideideldemdendeoderdetdgedgodhadho"
+"diadijdildisdivdjadjidmodnedobdomdondordosdoudozdridubdumdur"
+"dusduzdwadygdyre/ae/be/ce/de/ge/he/ie/je/ke/le/me/oe/pe/re/s"
+"e/te/ue/ve/we/ze_be_oe_veareaseauebreciedmedneekeetefaegiego"
+"eguehaehoehreineioeirekaekoel_elaelbeleelgelhelielleloelsema"
+"embemyen_enaendengenheniennenoensentenveoreouepeer_eraerdere"
+"ergerierlermerneroerrerserterues_esaesbesoesteteetletoetrets"
+"euceuleuneureutevaevievoew_exieykezaf_mf_sfakfamfarfatfaxfer"
+"fiaficfijfolforfrefrift_funfutg_kgabgadgaigalgamgapgatgazge_"
+"gelgengeoghaghdgiagibgiegingkoglago_goggongoogorgosgotgougra"
+"greguagucgueguigusguygyagyeh_dh_ghaghaihakhalhamhanharhashat"
+"havhdahebhelhenherhgahi_hiahichihhilhimhinhishithkehmahnohnp"
+"hnsho_hobhoehoiholhomhonhorhothovhowhrahrihuahulhuui_mia/ia_"
+"iabiagiamianibaibiiboibric/icaiceichicoidaideidgidjidwiehien"
+"ierifaifeifiiftigaigoiguihuijiijkijuikoilailiillilnimaimfimp"
+"in_inainbincindineinginhiniinkinlinninoinsinuinvio_iojionipa"
+"ipeipoiqaiquiraireiriirkirniroirsiruis_isbiseishisiislissist"
+"isvitaitciteitiitkittityiudiueiuniusiveivoiyaizejakjaljamjan"
+"javjayjerjevjibjinjohjuajubjujjuljumjunjurjuykabkalkamkankao"
+"karkaskatkchkekkenkerkhakhokigkinkirkitkjaklaknokokkolkonkop"
+"koskotkrakrykshkuakuckutkuwkuzkwaky/kyikyol_al_cl_sla_laalab"
+"lacladlaglahlailaklanlaplaulavlbolcaldile_legleilemlenleslet"
+"leylezlgilgolgrlholialibliflimlinlislizljaljulkall_llallelli"
+"llolmalmelnilomlonlorlosloulowlpalsalsilsoltalualublucluilul"
+"lumluslutluxlvalyalymm_pmacmadmagmahmaimajmakmalmanmapmarmas"
+"matmaumawmaymazmbambimbombrmbumchmcmmeamelmenmermetmexmeymfe"
+"midminmiqmmamogmonmormosmpamphmpompumqimskmstmudmurmusn/an/c"
+"n/kn/mn/rn_cn_hn_in_jn_ln_mna/nacnadnafnagnainaknalnamnannap"
+"narnasnaunaynbanbenbunc-ncancenchncinconctncund_ndandendhndi"
+"ndjndondundyneaneeneineknelnepnernesnetnewneyng_ngangenghngk"
+"ngongrngungynhanianicnilninnionipniqnisniunixnjunkinlenmanna"
+"nnenninolnomnornosnounovnoxnoynpenronsenshnskntantdntentinto"
+"ntsntuntynuunuvnvenvio-no_bo_co_do_go_po_ro_to_voa_obaobeobi"
+"ockocoodgoekoenof_ofiofoogaogoogrohaohnoiboisoitojaojiokaoke"
+"okuokyolaolgoliolkollolmolooluolyom_omaombomeomiomoomson_ona"
+"oncondoneongonhonoonrontoosopeopjopooraordoreorforgoriorkoro"
+"orrorsortos_oscoseosioslosrostotaothotoottouaougouiouloumoup"
+"ouroutouvovdoviovoovsowaoweownoyaozapacpagpaipalpanparpaupaz"
+"pe/pe_pegpeipenperpespetphnphophupiapitpjepo_podpohpolponpor"
+"prapripuepunpurputpyoqalqatqosqtaqtoquaquequiqyzr_er_pracrad"
+"raeragrairajrakralramranrarrasratraurawrazrbarbyrcarctrd_rda"
+"rderdorebrecredreeregremrenresreurevreyrezrforgergirguribric"
+"ridrierigrinrioriprisritrivriyrkarksrkurlirmormurnarnernsrob"
+"roeroirokrolromronroprosrotrovrqurrarrersarsbrserskrt-rt_rta"
+"rthrtirtorubrumrunrusrutrvirwis_as_ssabsaisaksalsamsansaosar"
+"sassausawsbasbosbusbyscascoscuse_selseoserseyshashgshishkshu"
+"siasibsilsimsinsitskoslasleslosmasnosofsolsonsouspasrasressa"
+"ssest-st_stastestmstostrsunsviswisydsyot-at-nt_bt_ct_ht_jt_k"
+"t_lt_mt_nt_ot_tt_vta/ta_tahtaitaltamtantaptartastattautbitca"
+"tdutegtehteltemtertevth_thathethithmthothutiatictigtijtiktim"
+"tintirtistiutkatlatmato-to_tobtoctoktoltomtontortoutovtowtra"
+"tritrotsetskttettstuctunturtyru-puaduaguahuaiuakualuamuanuar"
+"uatuayubaublubuuchuciuckuclucuudaueluenueruesugaugouiauiluis"
+"uitujuulauleulouluulyumaumbumeumoumpumqunauncunduneuniuntupe"
+"uraurdurguriurkurnurourruruurvusauscushusiussustutauteuthuti"
+"utoutsuukuveuviuwauxeuyauznvadvanvatvayvelvervesvevviavidvie"
+"vikvilvinvisvlavokvolvosvskw_sw_ywaiwajwakwalwarwaywerwhiwif"
+"winwsoxemxicy/ly/myadyakyanyapyaqyarydnyeayekyenyerygayivykj"
+"yloymaymsyonyoryotyowyrayreysuyzyzagzatzavznezorzurzylzza"
+;
+
+static const unsigned short city_trigram_starts[] = {
+0,1,2,3,4,5,6,7,11,13,15,21,
+22,24,38,42,45,46,47,58,65,67,69,73,
+79,84,96,98,107,108,115,116,118,126,128,129,
+130,131,133,137,138,139,140,141,143,144,147,148,
+150,151,152,156,157,158,159,161,168,171,174,179,
+188,189,190,192,195,197,198,201,208,211,213,217,
+218,220,222,225,226,227,230,234,235,242,246,273,
+274,275,281,284,293,294,297,298,300,303,313,314,
+315,316,317,318,319,325,327,329,330,338,339,341,
+342,343,344,345,347,352,356,358,373,374,375,376,
+379,380,382,383,392,393,395,400,401,404,406,408,
+413,415,417,419,420,422,425,426,430,431,433,436,
+437,440,443,445,446,447,448,449,450,451,452,457,
+458,459,461,462,463,466,467,468,469,470,471,472,
+473,474,475,476,478,479,480,483,485,486,487,488,
+490,493,494,495,498,501,502,503,504,505,507,509,
+510,544,572,596,614,619,623,633,642,653,661,679,
+692,725,740,744,759,762,770,795,812,816,822,826,
+831,832,833,834,835,837,838,839,840,841,842,846,
+847,849,851,852,855,856,858,859,897,898,899,900,
+904,905,910,911,913,916,917,918,919,971,972,975,
+977,978,984,985,989,990,993,994,995,996,997,998,
+1002,1004,1008,1009,1010,1011,1012,1013,1020,1021,1022,1024,
+1028,1029,1032,1040,1041,1042,1047,1048,1063,1066,1068,1069,
+1070,1073,1074,1075,1085,1087,1088,1233,1234,1235,1236,1238,
+1239,1250,1253,1274,1277,1283,1292,1296,1303,1304,1305,1306,
+1307,1308,1309,1310,1338,1340,1341,1342,1344,1345,1347,1350,
+1352,1353,1354,1364,1366,1379,1385,1397,1404,1406,1407,1409,
+1410,1412,1417,1418,1419,1420,1422,1423,1425,1428,1511,1512,
+1513,1515,1517,1518,1524,1527,1530,1534,1535,1547,1548,1550,
+1551,1552,1554,1556,1568,1570,1573,1574,1575,1578,1580,1581,
+1582,1583,1585,1586,1587,1588,1590,1591,1592,1595,1596,1597,
+1598,1599,1605,1609,1610,1611,1614,1615,1618,1620,1621,1622,
+1623,1624,1625,1627,1630,1631,1632,1633,1634,1635,1636,1637,
+1638,1642,1646,1647,1649,1651,1653,1654,1655,1656,1657,1659,
+1660,1664,1665,1666,1667,1668,1671,1673,1677,1679,1683,1687,
+1688,1692,1693,1697,1701,1706,1708,1712,1715,1717,1923,1924,
+1926,1928,1932,1933,1934,1935,1938,1940,1941,1943,1944,1945,
+1946,1947,1950,1951,1952,1956,1963,1966,1967,1968,1969,2008,
+2009,2010,2012,2013,2014,2015,2017,2018,2019,2020,2021,2022,
+2023,2024,2025,2027,2030,2031,2032,2033,2034,2036,2048,2049,
+2050,2051,2052,2054,2055,2056,2057,2058,2060,2065,2066,2068,
+2070,2071,2073,2074,2076,2077,2078,2080,2081,2083,2084,2085,
+2086,2087,2088,2089,2090,2109,2110,2111,2113,2115,2117,2118,
+2119,2121,2122,2124,2125,2127,2128,2130,2131,2132,2134,2135,
+2136,2137,2138,2139,2140,2141,2145,2152,2154,2155,2157,2158,
+2160,2161,2164,2168,2174,2175,2178,2180,2188,2190,2191,2196,
+2197,2199,2202,2203,2204,2205,2206,2207,2208,2209,2210,2211,
+2212,2213,2214,2215,2216,2217,2218,2219,2220,2221,2222,2225,
+2226,2227,2229,2230,2231,2236,2237,2238,2239,2241,2243,2246,
+2248,2249,2250,2251,2255,2257,2258,2260,2261,2264,2266,2267,
+2286,2287,2288,2289,2290,2291,2294,2296,2297,2298,2442,2443,
+2445,2446,2447,2449,2452,2454,2456,2457,2458,2461,2462,2465,
+2466,2467,2468,2469,2470,2471,2472,2473,2531,2532,2534,2536,
+2537,2539,2540,2541,2542,2543,2544,2545,2546,2547,2548,2549,
+2550,2551,2589,2590,2591,2593,2594,2646,2647,2648,2649,2650,
+2652,2655,2656,2660,2661,2662,2663,2664,2665,2666,2680,2681,
+2682,2683,2684,2685,2686,2687,2688,2689,2690,2691,2692,2693,
+2694,2698,2700,2701,2706,2708,2716,2717,2720,2722,2723,2724,
+2725,2726,2729,2730,2732,2733,2734,2736,2738,2743,2746,2747,
+2749,2751,2752,2753,2756,2757,2759,2760,2761,2763,2764,2765,
+2766,2767,2768,2769,2772,2774,2775,2776,2777,2778,2779,2780,
+2782,2783,2784,2785,2787,2789,2790,2791,2792,2794,2795,2797,
+2798,2799,2800,2894,2895,2896,2897,2898,2919,2920,2921,2923,
+2925,2974,3182,3183,3184,3187,3188,3190,3191,3192,3193,3194,
+3196,3198,3199,3200,3238,3239,3242,3243,3244,3245,3246,3247,
+3248,3249,3250,3252,3260,3261,3263,3264,3265,3266,3283,3284,
+3288,3309,3310,3315,3316,3319,3320,3321,3323,3324,3326,3327,
+3328,3330,3331,3333,3334,3336,3337,3338,3340,3342,3343,3344,
+3345,3346,3349,3350,3352,3353,3355,3356,3358,3360,3362,3363,
+3366,3367,3368,3369,3370,3373,3374,3375,3377,3378,3379,3380,
+3382,3383,3385,3386,3387,3388,3389,3391,3393,3394,3395,3397,
+3398,3399,3400,3402,3405,3407,3408,3409,3410,3411,3412,3413,
+3414,3415,3417,3420,3421,3424,3425,3429,3430,3431,3435,3436,
+3440,3441,3442,3444,3446,3447,3448,3449,3450,3452,3454,3455,
+3456,3457,3460,3462,3463,3464,3465,3466,3469,3470,3471,3472,
+3474,3475,3476,3477,3478,3479,3482,3484,3485,3486,3487,3488,
+3489,3490,3491,3506,3507,3508,3509,3510,3511,3512,3513,3514,
+3515,3519,3522,3523,3524,3525,3526,3527,3528,3529,3530,3541,
+3542,3543,3544,3550,3554,3555,3556,3557,3558,3559,3560,3566,
+3568,3570,3571,3572,3573,3575,3579,3581,3582,3584,3585,3586,
+3587,3588,3589,3592,3593,3594,3595,3597,3598,3599,3600,3601,
+3602,3603,3604,3605,3606,3610,3612,3614,3615,3616,3617,3619,
+3623,3632,3633,3645,3649,3652,3653,3654,3655,3656,3658,3659,
+3661,3662,3663,3664,3665,3666,3667,3670,3814,3815,3816,3817,
+3818,3819,3824,3825,3826,3827,3836,3839,3841,3842,3843,3844,
+3845,3846,3849,3850,3851,3852,3853,3854,3858,3859,3863,3864,
+3865,3866,3867,3868,3869,3870,3890,3891,3893,3894,3896,3897,
+3899,3900,3902,3903,3904,3906,3908,3912,3913,3914,3915,3917,
+3918,3919,3923,3924,3925,3927,3928,3929,3930,3931,3934,3935,
+3955,3956,3959,3960,3961,3962,3963,3964,3965,3966,3967,3968,
+3970,3971,3973,3974,3975,3978,3980,3981,3982,3985,3986,3988,
+3990,3992,3993,3995,3996,3997,3998,3999,4000,4001,4003,4004,
+4005,4007,4009,4010,4011,4014,4015,4016,4019,4024,4025,4027,
+4031,4032,4033,4034,4035,4036,4037,4038,4052,4053,4056,4083,
+4087,4088,4090,4091,4092,4093,4094,4095,4096,4097,4099,4100,
+4102,4104,4105,4106,4107,4108,4110,4111,4112,4113,4114,4115,
+4116,4117,4119,4120,4121,4122,4123,4124,4125,4127,4128,4129,
+4130,4131,4132,4133,4134,4135,4136,4137,4138,4140,4142,4143,
+4144,4145,4147,4148,4149,4150,4151,4155,4158,4159,4161,4162,
+4164,4165,4166,4167,4172,4173,4174,4175,4183,4184,4242,4243,
+4244,4246,4249,4253,4254,4255,4256,4257,4262,4263,4264,4275,
+4277,4278,4279,4282,4283,4284,4288,4292,4293,4294,4296,4299,
+4301,4302,4303,4305,4306,4308,4310,4311,4312,4313,4316,4317,
+4318,4320,4321,4322,4323,4361,4363,4364,4367,4369,4371,4372,
+4373,4431,4432,4433,4435,4437,4438,4439,4440,4441,4442,4443,
+4444,4445,4446,4447,4448,4449,4452,4453,4459,4460,4462,4463,
+4464,4466,4467,4468,4469,4470,4471,4472,4473,4474,4477,4478,
+4479,4480,4481,4484,4487,4488,4491,4492,4493,4494,4508,4509,
+4515,4517,4519,4522,4523,4524,4525,4526,4527,4528,4540,4541,
+4543,4544,4546,4547,4548,4549,4551,4552,4553,4557,4564,4565,
+4567,4569,4570,4571,4583,4584,4585,4586,4783,4786,4788,4790,
+4794,4797,4798,4801,4803,4804,4805,4806,4807,4808,4809,4810,
+4811,4812,4813,4814,4815,4816,4817,4818,4819,4820,4824,4882,
+4883,4885,4887,4888,4890,4892,4893,4894,4896,4898,4899,4902,
+4904,4909,4910,4915,4916,4917,4919,4921,4922,4923,4924,4927,
+4928,4930,4931,4933,4938,4940,4947,4949,4952,4953,4955,4956,
+4957,4958,4960,4962,4963,4965,4966,4967,4968,4969,4971,4974,
+4978,4979,4980,4982,4984,5067,5068,5069,5070,5074,5075,5076,
+5077,5078,5079,5080,5081,5082,5083,5087,5088,5089,5090,5091,
+5094,5095,5096,5103,5109,5111,5112,5116,5128,5130,5131,5132,
+5133,5134,5135,5136,5137,5138,5139,5140,5141,5142,5143,5144,
+5145,5146,5147,5150,5152,5153,5154,5156,5158,5162,5163,5179,
+5180,5181,5182,5183,5184,5185,5186,5188,5189,5190,5196,5197,
+5201,5202,5205,5206,5207,5208,5209,5212,5236,5237,5238,5239,
+5240,5253,5254,5255,5256,5258,5270,5271,5272,5275,5276,5277,
+5280,5281,5283,5289,5291,5292,5293,5294,5306,5307,5309,5310,
+5313,5314,5315,5318,5319,5320,5322,5323,5325,5326,5327,5329,
+5330,5332,5333,5336,5338,5339,5340,5343,5345,5346,5348,5350,
+5353,5354,5355,5358,5360,5361,5363,5364,5365,5366,5367,5369,
+5371,5372,5374,5376,5377,5378,5379,5380,5381,5383,5384,5385,
+5386,5387,5388,5389,5390,5393,5395,5396,5397,5400,5401,5405,
+5407,5408,5409,5468,5469,5471,5472,5474,5475,5477,5478,5479,
+5492,5494,5495,5496,5498,5499,5501,5503,5504,5505,5506,5507,
+5508,5509,5511,5514,5515,5516,5517,5520,5521,5522,5523,5524,
+5526,5528,5534,5536,5538,5539,5540,5541,5544,5545,5546,5547,
+5548,5549,5550,5551,5552,5553,5554,5555,5556,5560,5563,5564,
+5565,5566,5567,5568,5570,5574,5575,5576,5577,5578,5579,5580,
+5582,5583,5584,5585,5586,5587,5588,5589,5590,5591,5592,5593,
+5594,5595,5596,5597,5598,5599,5600,5601,5602,5603,5604,5605
+};
+
+static const unsigned short city_trigram_postings[] = {
+178,324,55,178,87,111,159,40,144,399,413,134,
+209,195,271,0,3,4,232,329,393,412,212,213,
+18,19,20,21,22,23,24,25,26,27,28,29,
+44,65,140,298,308,360,90,169,214,276,296,46,
+48,53,67,108,165,189,236,259,315,356,57,62,
+81,128,217,302,388,173,198,87,249,73,119,285,
+390,37,38,50,58,109,340,18,54,129,179,301,
+9,23,69,97,122,138,143,157,208,227,251,406,
+142,386,124,148,188,229,240,255,277,320,382,256,
+19,105,120,131,166,203,220,99,70,123,10,41,
+100,103,162,343,350,367,373,389,49,359,130,116,
+132,1,11,184,357,115,96,410,75,139,348,43,
+126,151,358,146,63,101,341,365,79,136,283,292,
+160,84,86,155,352,135,158,167,171,172,174,332,
+83,121,417,145,260,293,34,175,239,400,409,98,
+376,377,378,379,380,381,383,384,89,319,186,363,
+180,183,194,185,193,415,21,346,394,2,201,273,
+287,303,328,369,354,374,375,322,334,106,202,306,
+330,384,150,187,60,318,207,262,263,234,368,24,
+59,269,39,153,280,294,338,32,154,339,349,355,
+374,392,7,107,224,416,12,33,45,66,74,141,
+168,182,222,231,233,241,243,246,247,248,254,258,
+264,270,282,286,295,325,333,379,414,351,8,26,
+35,250,252,385,396,80,289,370,85,221,228,245,
+253,304,344,375,401,278,77,197,274,353,372,387,
+125,267,275,61,244,266,268,314,317,386,387,388,
+398,161,257,313,215,272,51,13,30,152,279,297,
+345,42,380,199,391,290,55,72,149,178,181,230,
+284,364,127,114,291,205,299,211,210,93,112,64,
+92,94,191,300,28,76,225,331,14,192,20,25,
+27,47,68,71,113,133,242,309,311,326,342,347,
+402,163,206,117,305,336,395,235,52,170,327,56,
+82,147,204,218,335,337,405,408,95,15,36,137,
+200,281,366,403,156,176,190,383,78,164,5,261,
+88,196,316,362,407,16,226,22,361,238,310,118,
+29,324,104,219,404,381,31,216,223,377,323,17,
+307,288,371,411,102,91,265,378,237,321,397,6,
+312,177,110,139,144,18,392,114,56,84,86,97,
+259,76,409,250,383,100,95,386,387,388,133,367,
+28,170,69,337,37,32,93,82,25,256,204,175,
+27,218,262,186,342,409,284,101,186,364,30,59,
+68,199,349,24,120,291,348,367,387,364,408,347,
+352,72,122,73,405,372,3,4,18,19,20,21,
+22,23,24,25,26,27,28,29,40,44,65,90,
+111,134,140,144,159,195,209,212,213,214,298,329,
+360,393,399,413,18,37,38,46,48,53,54,58,
+62,67,73,81,87,108,109,119,165,173,189,198,
+217,236,249,259,315,356,388,390,9,19,23,69,
+70,97,99,120,123,138,142,157,166,208,220,227,
+240,251,255,256,320,382,386,406,1,10,11,41,
+49,100,103,116,130,132,162,343,350,357,359,367,
+373,389,43,75,96,139,348,63,101,126,341,79,
+84,86,135,155,167,171,174,292,352,34,83,121,
+175,239,260,293,409,417,89,98,319,376,377,378,
+379,380,381,383,384,21,180,183,185,194,346,394,
+415,2,60,106,187,207,262,263,273,287,318,322,
+328,330,334,369,374,375,384,7,24,32,39,59,
+107,153,269,280,349,355,392,416,8,12,26,33,
+35,66,74,85,168,182,221,222,231,241,243,245,
+250,252,253,254,258,264,270,278,286,289,325,344,
+351,379,385,396,401,61,77,125,161,197,244,267,
+314,317,353,372,386,387,388,398,51,215,257,313,
+13,42,55,72,114,178,181,199,205,279,291,345,
+364,380,391,210,211,299,14,28,64,76,92,93,
+94,331,15,20,25,27,36,56,68,71,82,95,
+113,117,133,163,204,206,218,326,327,336,347,395,
+402,405,408,16,22,78,88,156,164,176,190,196,
+226,261,316,361,366,383,403,407,29,118,238,324,
+17,104,216,323,377,381,91,102,265,378,6,237,
+312,321,397,114,259,262,59,24,120,73,139,367,
+238,238,70,144,351,360,111,87,227,79,168,2,
+123,241,406,159,66,84,287,30,112,115,136,146,
+148,149,150,172,200,201,202,233,234,242,266,268,
+274,275,276,277,281,282,283,284,285,290,297,332,
+358,362,365,370,371,400,410,411,412,228,33,256,
+155,325,332,399,144,40,167,295,302,413,331,323,
+344,48,51,348,141,219,329,7,51,54,55,79,
+106,107,108,109,111,116,130,134,138,139,140,142,
+144,153,159,165,166,168,173,197,221,222,226,227,
+236,244,249,264,265,267,269,330,334,341,343,344,
+346,347,351,353,355,361,367,369,415,416,417,365,
+51,257,325,131,393,189,30,113,136,188,269,382,
+177,65,126,127,270,333,67,259,281,53,255,29,
+194,40,53,65,285,364,242,366,18,138,197,290,
+207,139,234,47,233,49,180,182,343,358,396,416,
+244,371,308,326,236,386,387,388,166,46,321,397,
+116,136,168,171,262,297,367,369,332,248,60,63,
+185,234,387,134,32,34,35,36,37,38,39,40,
+41,42,43,83,303,326,330,28,137,411,13,209,
+176,240,20,160,246,89,348,23,126,194,236,279,
+311,345,350,378,402,97,283,328,3,4,18,19,
+20,21,22,23,24,25,26,27,28,29,44,48,
+56,59,60,61,62,63,64,65,66,67,68,69,
+70,71,72,73,74,75,76,77,81,82,83,84,
+85,86,87,88,89,90,91,92,93,94,95,96,
+97,98,99,100,101,102,103,104,113,114,119,120,
+121,123,132,133,135,155,157,161,162,163,164,167,
+171,174,176,178,194,204,208,218,231,243,245,250,
+251,252,253,254,255,256,257,258,259,260,261,267,
+270,279,280,289,291,298,345,348,349,352,353,364,
+372,373,374,375,376,377,378,379,380,381,382,383,
+384,385,386,387,388,389,390,391,392,393,394,395,
+396,397,398,399,401,405,406,407,408,195,45,254,
+69,369,271,105,124,188,203,232,247,248,300,333,
+354,414,25,27,342,74,121,143,174,181,211,232,
+261,270,279,329,332,338,376,377,378,379,380,381,
+383,384,238,357,363,76,87,104,227,251,393,0,
+7,69,259,273,276,322,352,402,5,38,216,351,
+4,108,117,205,237,356,392,286,165,93,147,162,
+415,310,3,8,9,10,11,12,13,14,15,16,
+17,33,57,71,113,122,133,143,147,151,170,191,
+201,232,249,295,296,337,68,347,358,136,122,179,
+412,336,376,183,264,362,212,213,135,367,47,65,
+140,200,287,309,311,345,406,417,48,339,8,9,
+10,11,12,13,14,15,16,17,23,33,339,71,
+114,256,301,379,417,18,19,20,21,22,23,24,
+25,26,27,28,29,33,45,152,231,232,342,345,
+162,402,315,112,151,282,288,318,34,56,180,243,
+334,44,41,143,106,227,350,9,222,107,360,403,
+1,2,6,46,49,53,58,78,117,118,125,126,
+156,175,180,181,182,183,185,187,189,190,195,196,
+198,199,205,206,207,209,210,211,212,213,214,215,
+216,217,220,237,238,239,240,241,262,263,273,278,
+286,287,292,293,299,312,313,314,315,316,317,318,
+319,320,321,322,323,324,325,326,327,328,329,331,
+336,350,356,357,359,360,366,402,403,409,413,140,
+318,77,182,115,308,298,23,187,238,254,299,362,
+171,312,410,169,273,277,90,202,340,404,328,57,
+122,143,147,151,170,191,258,295,296,337,396,309,
+209,214,178,276,68,315,247,274,32,34,35,36,
+37,38,39,40,41,42,43,74,121,340,10,109,
+191,162,200,12,100,103,135,183,157,208,414,258,
+292,296,109,238,144,351,48,189,53,67,259,1,
+46,240,236,38,108,165,259,351,356,34,48,56,
+315,107,360,84,86,97,217,62,81,302,57,128,
+388,111,283,156,314,173,198,87,227,249,184,338,
+87,73,119,390,294,79,35,130,224,285,76,109,
+160,340,153,38,97,37,293,50,58,301,179,18,
+54,2,363,107,54,312,380,415,129,339,163,87,
+276,296,412,57,285,122,143,148,277,115,410,146,
+151,358,365,136,172,283,332,400,150,201,202,234,
+339,233,282,295,370,266,268,274,275,30,149,284,
+290,297,112,191,147,170,242,337,200,281,362,371,
+411,3,4,7,8,9,10,11,12,13,14,15,
+16,17,18,19,20,21,22,23,24,25,26,27,
+28,29,33,44,48,51,54,55,56,59,60,61,
+62,63,64,65,66,67,68,69,70,71,72,73,
+74,75,76,77,79,81,82,83,84,85,86,87,
+88,89,90,91,92,93,94,95,96,97,98,99,
+100,101,102,103,104,106,107,108,109,111,113,114,
+116,119,120,121,123,130,132,133,134,135,138,139,
+140,142,144,153,155,157,159,161,162,163,164,165,
+166,167,168,171,173,174,176,178,194,197,204,208,
+218,221,222,226,227,231,236,243,244,245,249,250,
+251,252,253,254,255,256,257,258,259,260,261,264,
+265,267,269,270,279,280,289,291,298,330,334,341,
+343,344,345,346,347,348,349,351,352,353,355,361,
+364,367,369,372,373,374,375,376,377,378,379,380,
+381,382,383,384,385,386,387,388,389,390,391,392,
+393,394,395,396,397,398,399,401,405,406,407,408,
+415,416,417,382,138,290,69,97,143,251,332,404,
+123,122,406,9,227,406,23,278,241,157,208,159,
+84,66,375,377,386,405,349,142,188,277,301,328,
+229,255,263,287,320,382,409,240,244,393,124,148,
+218,30,64,112,115,136,146,148,149,150,172,200,
+201,202,233,234,242,266,268,274,275,276,277,281,
+282,283,284,285,290,297,332,358,362,365,370,371,
+400,410,411,412,176,298,250,383,256,335,276,374,
+375,43,8,250,105,220,203,166,131,19,163,105,
+120,125,104,304,33,159,99,100,8,9,10,11,
+12,13,14,15,16,17,33,339,85,70,22,251,
+95,123,350,32,256,352,189,256,343,386,387,388,
+399,332,271,350,162,325,179,41,367,10,100,103,
+144,295,40,167,39,389,413,401,259,373,97,230,
+49,265,105,124,188,203,232,247,248,300,333,354,
+376,377,378,379,380,381,383,384,414,60,359,144,
+344,248,323,111,353,130,96,36,327,19,132,133,
+154,0,348,48,51,116,26,141,1,184,11,11,
+357,219,370,322,329,0,169,271,308,50,128,129,
+179,301,302,340,131,229,184,158,160,145,186,363,
+193,303,306,368,154,224,294,338,45,80,141,228,
+246,304,272,127,152,230,192,225,47,52,235,305,
+309,311,335,342,5,137,310,31,219,223,307,404,
+288,110,177,84,86,97,186,122,339,115,394,293,
+64,96,327,100,341,410,94,28,176,45,102,190,
+234,66,75,217,295,312,327,139,348,40,35,56,
+62,337,354,392,302,72,81,375,383,167,289,50,
+101,145,39,171,224,56,37,114,155,337,353,26,
+60,379,131,199,391,31,157,377,18,385,169,18,
+19,20,21,22,23,24,25,26,27,28,29,95,
+216,374,375,386,403,405,389,170,206,75,349,14,
+259,324,122,271,6,354,3,4,18,19,20,21,
+22,23,24,25,26,27,28,29,44,48,56,59,
+60,61,62,63,64,65,66,67,68,69,70,71,
+72,73,74,75,76,77,81,82,83,84,85,86,
+87,88,89,90,91,92,93,94,95,96,97,98,
+99,100,101,102,103,104,113,114,119,120,121,123,
+132,133,135,155,157,161,162,163,164,167,171,174,
+176,178,194,204,208,218,231,243,245,250,251,252,
+253,254,255,256,257,258,259,260,261,270,279,280,
+289,291,298,312,345,348,349,352,364,372,373,374,
+375,376,377,378,379,380,381,382,383,384,385,386,
+387,388,389,390,391,392,393,394,395,396,397,398,
+399,401,405,406,407,408,128,57,260,158,305,245,
+253,134,193,380,42,291,185,222,367,282,163,284,
+415,92,99,179,301,380,396,341,373,317,43,388,
+300,0,5,31,45,47,50,52,80,110,127,128,
+129,131,137,141,145,152,154,158,160,169,177,179,
+184,186,192,193,219,223,224,225,228,229,230,235,
+246,271,272,288,294,301,302,303,304,305,306,307,
+308,309,310,311,335,338,340,342,363,368,404,142,
+6,381,153,401,47,372,387,250,191,63,186,364,
+358,126,151,410,83,305,52,30,112,115,136,146,
+148,149,150,172,200,201,202,233,234,242,266,268,
+274,275,276,277,281,282,283,284,285,290,297,332,
+358,362,365,370,371,400,410,411,412,146,268,63,
+101,341,7,51,54,55,79,106,107,108,109,111,
+116,130,134,138,139,140,142,144,153,159,165,166,
+168,173,197,221,222,226,227,236,244,249,264,265,
+267,269,330,334,341,343,344,346,347,351,353,355,
+361,367,369,415,416,417,95,365,365,175,79,360,
+51,325,344,285,28,136,176,330,283,336,362,292,
+97,392,18,19,20,21,22,23,24,25,26,27,
+28,29,129,131,170,117,189,170,160,134,94,356,
+84,30,307,237,86,230,28,136,188,269,119,231,
+51,69,302,303,307,352,155,177,3,65,135,167,
+171,172,270,332,176,127,158,354,4,108,126,174,
+205,339,386,387,388,170,131,188,117,49,83,326,
+45,277,117,308,322,357,415,301,334,417,106,277,
+328,121,162,189,293,56,145,337,169,14,260,360,
+409,67,259,382,255,37,78,263,229,102,281,320,
+198,403,273,199,149,82,409,34,265,391,240,335,
+408,175,400,102,393,244,239,32,53,190,124,29,
+255,164,148,409,1,2,6,32,34,35,36,37,
+38,39,40,41,42,43,46,49,53,58,78,117,
+118,125,126,156,175,180,181,182,183,185,187,189,
+190,195,196,198,199,205,206,207,209,210,211,212,
+213,214,215,216,217,220,237,238,239,240,241,262,
+263,273,278,286,287,292,293,299,312,313,314,315,
+316,317,318,319,320,321,322,323,324,325,326,327,
+328,329,331,336,350,356,357,359,360,366,402,403,
+409,413,259,70,113,267,105,124,181,188,203,216,
+232,247,248,300,333,354,376,377,378,379,380,381,
+383,384,414,240,314,130,345,153,160,30,57,112,
+115,122,136,143,146,147,148,149,150,151,170,172,
+191,200,201,202,233,234,242,266,268,274,275,276,
+277,281,282,283,284,285,290,295,296,297,332,337,
+339,358,362,365,370,371,400,410,411,412,3,4,
+7,8,9,10,11,12,13,14,15,16,17,18,
+19,20,21,22,23,24,25,26,27,28,29,33,
+44,48,51,54,55,56,59,60,61,62,63,64,
+65,66,67,68,69,70,71,72,73,74,75,76,
+77,79,81,82,83,84,85,86,87,88,89,90,
+91,92,93,94,95,96,97,98,99,100,101,102,
+103,104,106,107,108,109,111,113,114,116,119,120,
+121,123,130,132,133,134,135,138,139,140,142,144,
+153,155,157,159,161,162,163,164,165,166,167,168,
+171,173,174,176,178,194,197,204,208,218,221,222,
+226,227,230,231,236,243,244,245,249,250,251,252,
+253,254,255,256,257,258,259,260,261,264,265,267,
+269,270,279,280,289,291,298,330,334,341,343,344,
+345,346,347,348,349,351,352,353,355,361,364,367,
+369,372,373,374,375,376,377,378,379,380,381,382,
+383,384,385,386,387,388,389,390,391,392,393,394,
+395,396,397,398,399,401,404,405,406,407,408,415,
+416,417,375,110,125,250,291,252,40,401,97,111,
+370,45,31,216,134,283,83,64,30,112,115,136,
+146,148,149,150,172,200,201,202,233,234,242,266,
+268,274,275,276,277,281,282,283,284,285,290,297,
+332,358,362,365,370,371,400,410,411,412,95,176,
+225,330,231,3,255,146,60,261,90,286,156,359,
+4,11,37,109,153,260,285,374,223,202,280,305,
+78,93,18,19,20,21,22,23,24,25,26,27,
+28,29,65,94,229,257,378,312,178,349,377,405,
+39,105,124,188,203,232,247,248,265,300,333,354,
+376,377,378,379,380,381,383,384,414,385,129,133,
+263,303,336,409,132,243,303,145,93,91,137,342,
+80,106,98,285,28,76,24,298,300,242,91,366,
+226,89,243,289,5,295,18,202,319,290,138,197,
+306,314,75,217,144,38,294,390,198,344,156,229,
+186,340,173,73,124,363,374,320,290,102,202,247,
+281,395,204,250,383,256,275,139,223,247,248,232,
+323,331,81,180,234,194,353,111,338,191,183,185,
+193,47,130,257,82,415,25,256,261,338,346,21,
+165,54,394,233,21,2,303,328,369,90,201,402,
+358,180,287,343,182,187,273,312,396,244,198,37,
+374,375,403,354,308,322,326,334,335,330,93,106,
+202,306,204,191,276,384,90,356,187,327,175,235,
+150,386,387,388,60,318,166,162,262,263,319,321,
+397,207,317,234,374,375,368,196,139,383,348,24,
+59,262,238,367,168,84,323,269,388,40,396,57,
+87,122,143,147,151,170,191,227,249,258,276,295,
+296,337,136,297,340,35,332,248,186,28,234,56,
+62,185,387,60,337,354,392,93,147,63,134,307,
+302,72,32,34,35,36,37,38,39,40,41,42,
+43,153,83,280,39,128,137,184,303,326,156,294,
+376,411,81,338,338,187,383,4,11,28,109,153,
+285,374,137,411,260,375,209,13,223,220,355,87,
+154,289,339,32,210,392,167,374,349,176,240,145,
+101,20,160,246,7,107,218,27,89,400,262,416,
+92,224,348,310,327,199,33,66,241,378,141,295,
+126,325,333,194,233,182,236,168,171,246,248,22,
+39,74,186,195,208,270,273,286,264,23,45,140,
+162,231,243,282,311,342,345,379,402,124,222,350,
+408,202,209,254,247,12,414,258,107,351,283,220,
+224,97,54,328,8,266,35,26,353,385,3,4,
+13,18,19,20,21,22,23,24,25,26,27,28,
+29,44,48,56,59,60,61,62,63,64,65,66,
+67,68,69,70,71,72,73,74,75,76,77,81,
+82,83,84,85,86,87,88,89,90,91,92,93,
+94,95,96,97,98,99,100,101,102,103,104,113,
+114,119,120,121,123,132,133,135,155,157,161,162,
+163,164,167,171,174,176,178,194,204,208,218,231,
+243,245,250,251,252,253,254,255,256,257,258,259,
+260,261,270,279,280,289,291,298,345,348,349,352,
+364,372,373,374,375,376,377,378,379,380,381,382,
+383,384,385,386,387,388,389,390,391,392,393,394,
+395,396,397,398,399,401,405,406,407,408,396,250,
+267,305,370,80,132,133,385,409,289,195,344,11,
+85,96,221,228,245,253,375,401,203,254,284,260,
+304,369,78,69,262,118,313,316,327,271,57,8,
+278,232,105,124,188,203,354,247,248,333,414,300,
+100,37,93,25,27,342,18,19,20,21,22,23,
+24,25,26,27,28,29,376,377,378,379,380,381,
+383,384,228,155,329,365,257,270,197,166,181,332,
+279,378,232,376,143,232,77,114,74,229,274,315,
+211,238,357,312,363,87,227,178,349,377,405,393,
+298,76,104,85,251,352,7,39,69,259,265,60,
+105,124,188,203,232,247,248,300,333,354,376,377,
+378,379,380,381,383,384,414,353,0,26,154,273,
+322,394,385,58,327,101,75,324,377,415,317,372,
+387,36,175,112,336,362,129,392,117,356,133,237,
+379,303,4,108,205,339,61,131,267,125,132,286,
+303,300,91,243,361,223,275,391,165,93,145,93,
+147,162,31,157,377,415,91,400,199,385,398,61,
+268,386,387,388,18,244,266,55,310,314,317,384,
+318,149,221,158,106,80,8,9,10,11,12,13,
+14,15,16,17,33,71,114,232,11,253,386,401,
+3,18,19,20,21,22,23,24,25,26,27,28,
+29,57,113,122,143,147,151,170,181,191,216,295,
+296,337,375,88,96,133,201,245,374,375,249,161,
+98,389,285,55,76,250,409,133,28,69,30,68,
+291,347,72,73,19,34,212,197,335,105,230,265,
+391,186,364,52,358,344,119,307,415,82,149,240,
+390,373,24,257,90,37,317,196,407,307,226,376,
+187,268,16,335,220,92,400,327,199,408,220,192,
+347,355,398,132,133,385,203,313,316,100,166,228,
+85,154,79,112,175,205,339,362,61,400,221,11,
+88,96,181,245,253,375,401,86,0,5,31,45,
+47,50,52,80,110,127,128,129,131,137,141,145,
+152,154,158,160,169,177,179,184,186,192,193,219,
+223,224,225,228,229,230,235,246,271,272,288,294,
+301,302,303,304,305,306,307,308,309,310,311,335,
+338,340,342,363,368,404,235,305,215,393,19,32,
+210,163,284,296,336,268,170,230,372,61,79,88,
+203,254,0,102,55,63,72,101,178,284,364,386,
+387,388,407,18,392,304,86,125,260,314,272,150,
+17,120,211,323,119,386,387,388,14,112,244,414,
+51,116,244,51,285,374,206,266,334,167,35,224,
+130,170,104,239,221,55,314,317,310,15,32,349,
+341,318,26,30,112,115,136,146,148,149,150,172,
+200,201,202,233,234,242,266,268,274,275,276,277,
+281,282,283,284,285,290,297,332,358,362,365,370,
+371,400,410,411,412,30,136,364,13,297,369,242,
+279,152,345,68,59,0,5,31,45,47,50,52,
+80,110,127,128,129,131,137,141,145,152,154,158,
+160,169,177,179,184,186,192,193,219,223,224,225,
+228,229,230,235,246,271,272,288,294,301,302,303,
+304,305,306,307,308,309,310,311,335,338,340,342,
+363,368,404,122,91,149,366,131,199,42,179,380,
+199,391,78,412,290,235,69,230,149,226,305,376,
+181,55,72,178,284,336,364,127,178,349,291,114,
+183,262,264,205,89,299,211,213,212,33,243,282,
+289,135,210,367,349,123,287,406,302,303,307,150,
+65,127,393,53,47,308,32,34,35,36,37,38,
+39,40,41,42,43,60,160,215,345,5,69,76,
+93,190,352,112,417,259,318,245,309,340,214,200,
+109,48,339,23,8,9,10,11,12,13,14,15,
+16,17,33,339,32,210,271,122,8,19,177,64,
+327,100,341,94,71,95,114,155,379,18,92,99,
+163,284,296,301,300,6,153,191,253,256,268,18,
+19,20,21,22,23,24,25,26,27,28,29,170,
+354,345,3,4,7,18,19,20,21,22,23,24,
+25,26,27,28,29,44,48,51,54,55,56,59,
+60,61,62,63,64,65,66,67,68,69,70,71,
+72,73,74,75,76,77,79,81,82,83,84,85,
+86,87,88,89,90,91,92,93,94,95,96,97,
+98,99,100,101,102,103,104,106,107,108,109,110,
+111,113,114,116,119,120,121,123,130,132,133,134,
+135,138,139,140,142,144,153,155,157,159,161,162,
+163,164,165,166,167,168,171,173,174,176,178,194,
+197,204,208,218,221,222,226,227,230,231,236,243,
+244,245,249,250,251,252,253,254,255,256,257,258,
+259,260,261,264,265,267,269,270,279,280,289,291,
+298,330,334,341,343,344,345,346,347,348,349,351,
+352,353,355,361,364,367,369,372,373,374,375,376,
+377,378,379,380,381,382,383,384,385,386,387,388,
+389,390,391,392,393,394,395,396,397,398,399,401,
+405,406,407,408,415,416,417,97,141,252,33,45,
+225,231,178,312,342,349,24,28,76,226,38,124,
+152,202,247,232,331,402,162,319,128,260,57,315,
+35,158,197,151,373,37,16,192,61,79,88,293,
+0,5,31,45,47,50,52,80,110,127,128,129,
+131,137,141,145,152,154,158,160,169,177,179,184,
+186,192,193,219,223,224,225,228,229,230,235,246,
+271,272,288,294,301,302,303,304,305,306,307,308,
+309,310,311,335,338,340,342,363,368,404,254,14,
+112,221,306,282,0,245,95,253,288,380,102,193,
+314,318,178,101,284,364,63,180,42,56,386,387,
+388,243,55,72,291,334,407,44,118,58,75,50,
+185,217,11,41,18,144,392,367,87,227,242,326,
+416,20,185,348,367,387,311,402,25,27,71,113,
+133,240,342,68,347,47,182,309,282,77,173,288,
+38,294,380,415,163,284,278,163,304,350,86,50,
+206,222,245,9,158,193,106,117,162,357,360,107,
+198,403,29,344,1,2,6,46,49,53,58,78,
+117,118,125,126,156,175,180,181,182,183,185,187,
+189,190,195,196,198,199,205,206,207,209,210,211,
+212,213,214,215,216,217,220,237,238,239,240,241,
+262,263,273,278,286,287,292,293,299,312,313,314,
+315,316,317,318,319,320,321,322,323,324,325,326,
+327,328,329,331,336,350,356,357,359,360,366,402,
+403,409,413,314,260,305,129,145,229,336,395,235,
+340,186,272,140,318,52,92,12,100,101,103,170,
+364,150,327,77,173,182,50,324,56,82,204,218,
+337,405,408,73,120,126,147,211,363,115,271,124,
+17,99,323,335,32,34,35,36,37,38,39,40,
+41,42,43,308,163,298,374,95,36,15,178,324,
+56,95,337,82,204,218,284,101,364,408,405,386,
+387,388,114,120,281,366,63,137,23,254,147,211,
+232,363,362,8,9,10,11,12,13,14,15,16,
+17,33,71,160,200,238,299,403,397,213,156,290,
+11,176,102,190,383,171,115,253,271,312,380,386,
+401,170,386,387,388,277,14,56,169,78,273,408,
+164,113,181,216,8,9,10,11,12,13,14,15,
+16,17,33,57,122,143,147,151,170,191,295,296,
+337,339,375,404,3,261,90,202,18,19,20,21,
+22,23,24,25,26,27,28,29,243,5,340,247,
+328,395,57,122,143,147,151,170,191,258,295,296,
+337,396,124,55,72,133,291,212,335,17,196,323,
+407,316,347,85,96,99,112,201,362,88,407,334,
+309,341,32,34,35,36,37,38,39,40,41,42,
+43,308,226,16,373,245,317,319,321,414,204,22,
+374,375,361,352,214,249,178,167,332,51,255,29,
+65,244,116,262,172,7,25,261,33,256,171,135,
+1,44,346,184,338,107,263,301,176,218,276,374,
+375,43,22,57,179,256,289,354,18,158,291,282,
+285,51,70,4,135,27,374,89,21,54,238,388,
+164,68,400,310,22,54,107,266,11,262,118,365,
+298,163,58,75,394,300,361,114,167,54,123,183,
+8,224,312,380,415,110,247,352,35,0,5,31,
+45,47,50,52,80,110,127,128,129,131,137,141,
+145,152,154,158,160,169,177,179,184,186,192,193,
+219,223,224,225,228,229,230,233,235,246,271,272,
+288,294,301,302,303,304,305,306,307,308,309,310,
+311,335,338,340,342,363,368,404,95,118,274,11,
+185,416,278,29,357,129,50,32,34,35,36,37,
+38,39,40,41,42,43,126,324,142,397,92,170,
+130,365,264,319,321,148,161,104,98,207,224,174,
+317,219,348,6,104,121,404,381,72,104,122,389,
+248,381,221,401,31,216,98,191,11,109,153,223,
+285,374,377,405,10,73,323,317,307,17,314,323,
+310,387,372,207,234,371,411,288,370,349,102,95,
+41,91,265,378,12,100,103,224,250,374,375,331,
+321,397,174,205,237,310,183,135,318,36,339,312,
+157,339,6,322,368,191,210,208,327,205,372,414,
+15,214,249,163,210,177,258,109,317,296,110,210,
+109
+};
+
+static const unsigned short city_name_order[] = {
+111,159,144,134,140,236,108,165,173,249,109,54,
+138,227,142,166,343,367,130,116,139,341,79,417,
+415,346,369,334,330,106,269,153,355,7,107,416,
+168,264,222,351,344,221,197,353,267,244,51,55,
+347,226,361,265,399,393,4,3,65,18,23,19,
+21,24,26,28,20,25,27,22,29,44,298,90,
+67,259,48,62,81,87,73,119,390,97,69,251,
+406,157,208,382,255,256,120,99,70,123,162,103,
+100,389,373,132,96,75,348,101,63,84,86,352,
+155,167,171,135,174,83,121,260,376,384,379,380,
+383,381,377,378,98,89,194,394,374,375,60,59,
+280,392,349,66,270,74,231,243,254,258,385,252,
+396,250,289,85,253,401,245,77,372,398,61,388,
+386,387,161,257,279,345,391,178,364,72,291,114,
+93,64,94,92,76,71,113,133,68,163,395,56,
+82,204,218,408,405,95,176,164,261,88,407,104,
+102,91,397,9,10,11,33,12,8,13,14,15,
+16,17,339,413,209,195,329,213,212,360,214,189,
+53,46,356,315,217,198,58,320,240,220,350,49,
+359,1,357,126,292,293,409,175,239,319,180,183,
+185,2,328,287,273,322,187,318,262,263,207,241,
+325,182,286,278,125,317,314,313,215,199,181,205,
+299,211,210,331,326,402,206,117,336,327,366,403,
+156,190,78,196,316,238,118,324,216,323,321,237,
+312,6,296,57,143,122,151,295,191,170,337,147,
+40,38,37,41,43,34,39,32,35,42,36,271,
+0,308,169,302,128,340,50,301,179,129,229,131,
+184,160,158,145,186,363,193,303,306,368,294,338,
+154,224,141,246,45,80,228,304,272,152,230,127,
+225,192,311,342,47,309,305,235,52,335,137,5,
+310,219,404,31,223,307,288,177,110,232,188,124,
+105,203,354,333,248,247,414,300,412,276,285,277,
+148,115,410,358,146,365,136,283,332,172,400,201,
+202,150,234,233,282,370,274,275,268,266,30,297,
+290,149,284,112,242,281,200,362,371,411
+};
+
+static const unsigned short city_place_order[] = {
+111,159,399,144,40,413,134,209,195,271,329,393,
+0,4,232,3,412,213,212,65,44,360,140,308,
+298,169,90,214,276,296,189,67,259,53,46,236,
+356,108,165,48,315,217,62,302,81,128,57,388,
+198,173,87,249,73,119,390,285,340,109,38,37,
+58,50,301,179,18,54,129,138,97,69,143,251,
+122,406,227,9,23,157,208,386,142,188,277,382,
+255,229,320,240,124,148,256,105,220,203,166,131,
+19,120,99,70,123,343,350,162,367,41,10,103,
+100,389,373,49,359,130,132,116,1,184,11,357,
+115,96,410,75,139,348,43,358,126,151,146,101,
+63,341,365,79,136,283,292,160,84,86,352,155,
+332,167,172,171,135,158,174,83,417,121,293,145,
+260,409,34,175,400,239,376,98,89,319,186,363,
+180,194,183,193,185,415,346,21,394,2,303,328,
+369,201,287,273,354,322,334,330,106,202,306,384,
+187,150,60,318,262,263,207,234,368,59,24,269,
+153,280,39,294,338,355,154,339,32,392,374,349,
+7,107,416,224,241,66,33,295,141,325,333,233,
+182,168,248,246,270,74,286,264,379,45,231,282,
+243,222,254,247,12,414,258,351,8,35,26,385,
+252,396,250,370,80,289,344,228,85,221,253,401,
+375,245,304,278,197,77,274,353,387,372,267,125,
+275,398,268,61,244,266,317,314,161,257,313,215,
+272,51,30,297,13,279,345,152,42,380,199,391,
+290,230,149,181,178,284,364,55,72,127,291,114,
+205,299,211,210,93,112,64,94,92,300,191,225,
+76,28,331,192,14,242,326,20,311,402,25,27,
+342,71,113,133,68,347,47,309,163,206,117,305,
+336,395,235,52,170,327,56,337,82,204,218,408,
+405,147,335,95,36,15,281,366,137,200,403,156,
+176,190,383,78,164,261,5,196,316,362,88,407,
+226,16,22,361,238,310,118,29,324,219,104,404,
+381,31,216,223,377,323,307,17,371,411,288,102,
+378,265,91,397,321,237,312,6,177,110
+};
+
+static const double city_xyz[][3] = {
+{0.73701904505212101,0.019514061706589685,0.67559020761566024},
+{0.51467568301303046,0.74328608080348468,0.42735786338719245},
+{0.2925944273606581,0.77026026640604106,0.56664594154867398},
+{0.45178180406459667,-0.84256950385554874,0.29320612662213047},
+{0.4302931271549002,-0.84693253769188359,0.31233491851223255},
+{0.7063404875438466,0.25476251605489064,0.66043862399900766},
+{0.5449117545086245,0.53548328979519411,0.64523548116052076},
+{0.96198685528158034,0.22622251029004428,-0.15298583628403808},
+{-0.20501847284103725,0.04884228970185963,-0.97753867265219152},
+{-0.14096793602429325,0.37670178576324759,-0.91554563273265144},
+{0.076126234547141389,0.35712402285511996,-0.93094963811875953},
+{-0.3034887497000443,0.25450689552767913,-0.91821610688027411},
+{0.17369334098969405,0.33918321749104496,-0.92454603361231313},
+{0.18598115600555717,-0.38301307384538702,-0.90482705246601947},
+{0.14212917933793145,-0.35415266164487369,-0.9243241794038376},
+{0.2761936874984886,0.22835199637246481,-0.93358042649720174},
+{0.30871498458243457,0.013658737379182075,-0.95105651629515353},
+{-0.05845379276130834,0.19239408640652333,-0.97957524959934406},
+{0.43069987746243871,-0.70146353915075943,-0.5678437450531012},
+{0.37171537437129926,-0.7683597100221693,-0.52100963184057625},
+{0.37770096117773988,-0.82560487045396658,-0.4191880029391355},
+{0.38119477498626375,-0.82877688149782802,-0.40965769151561982},
+{0.37410627227369414,-0.81025906723279484,-0.4511371642998635},
+{0.36059434106344274,-0.80173497678983929,-0.47664740446667442},
+{0.34239636676358115,-0.80079986684426419,-0.49141052215973963},
+{0.31215150941160708,-0.79311926273165301,-0.52299452220463516},
+{0.30345653520736093,-0.78303316561076675,-0.54293019145514954},
+{0.33521883791809087,-0.76546409349700362,-0.54926592127279761},
+{0.22024316478941994,-0.58030266713018741,-0.78405469380976944},
+{0.21313397969162398,-0.53558204023817213,-0.81714489833512849},
+{-0.9564203613769382,-0.15661984058048187,-0.24643522045387775},
+{0.63942432346074207,0.18738463795661478,0.74566985457683665},
+{-0.79602552223934142,0.30423793747571187,-0.5232424345789517},
+{-0.54195110049713702,0.20857834844816439,-0.81411551835631912},
+{-0.6167244759287086,0.39567678749523233,-0.68050775207040259},
+{-0.64684730241188859,0.45348841274829604,-0.61313687449499721},
+{-0.72774586307139311,0.39980604529758401,-0.55726213304510419},
+{-0.66358981241708348,0.52878932079252283,-0.52917900097419057},
+{-0.79080587594334018,0.40235637667149582,-0.46123249313689069},
+{-0.80410060015370821,0.48315238436879016,-0.34638995122722471},
+{-0.61492236866361438,0.54244497809439363,-0.57238442174582527},
+{-0.63844400702843918,0.73877513895514135,-0.21587159134838005},
+{-0.36996454739566526,0.76360711010196736,-0.52917900097419057},
+{-0.53379669941627528,0.66232959379342493,-0.52571911975666941},
+{0.33444657599120886,-0.91722373569706617,0.21643961393810288},
+{0.4685738552945406,0.17008400518359559,0.86689674893560276},
+{0.4911545158805169,0.58223274395318259,0.64789835113150485},
+{0.68403010452435153,0.22776754624745638,0.69298251130949728},
+{0.49262033828207424,-0.84021091825089911,0.22665130743685502},
+{-0.0066579770415863401,0.91552142353827248,0.40221411509812616},
+{0.62977288600664127,0.047721335740389774,0.77531205728146591},
+{0.97645483784525,-0.02585360593777155,0.21416708596005343},
+{0.67507619245121309,0.29096656331944343,0.67794586318941785},
+{0.56881899897035659,0.69208103126061338,0.44437460838757115},
+{0.86998026911661275,0.48954207551203782,-0.059015994875560619},
+{0.9925687432182051,0.045361608626109204,0.1129141906453055},
+{0.43427385197613172,-0.84682242509050643,0.30707979720855394},
+{0.36040612372103586,-0.76474683782382535,0.5341064500854088},
+{-0.41973891163439986,0.90356175103120318,0.085996558846244242},
+{0.35685156408862623,-0.889939461525453,-0.28401534470392265},
+{0.3619927848213858,-0.90810949893445148,0.21047175982130567},
+{0.84226694180507877,-0.53486259786952584,-0.067144621099399074},
+{0.66262563394117813,-0.74852317788839706,-0.025304572865529659},
+{0.7809621787930896,-0.62120536657118575,-0.064822587405231696},
+{0.81207029632940053,-0.56650808546593279,-0.14003721977104136},
+{0.66127666263793672,-0.73959769876247461,-0.12533323356430426},
+{0.80038564819304425,-0.57548854668307026,-0.16791589205077706},
+{0.76242465352593414,-0.60682214180397198,-0.22466761206791572},
+{0.62974722458448973,-0.66632717045557177,-0.39928252533864267},
+{0.54255120278132218,-0.76391421438821272,-0.34938984732842515},
+{0.53747536087582237,-0.79934534595160878,-0.26863963660805423},
+{0.57496222285935095,-0.81707762963365094,-0.042456912710282763},
+{0.43479945633278533,-0.88753611514165742,-0.1524108824591239},
+{0.48929787524955759,-0.87073119809833888,0.049140308652876608},
+{0.49900095869096678,-0.86487592015474657,-0.054659728886781389},
+{0.34187858159111839,-0.93254569364678164,-0.11609291412523023},
+{0.37213864443395755,-0.91189791142904397,-0.17307521038613227},
+{0.19834187808418133,-0.88370740609228082,0.42393598551631873},
+{0.0054200472074713429,0.88726276286283823,0.46123249313689069},
+{0.81746780150973153,0.39723493729786918,-0.41707409184077099},
+{0.5223066412513101,0.27266851674372405,0.8079898838980305},
+{0.0299569733686798,-0.95324634900485417,0.30070579950427312},
+{0.40872355212428935,-0.5368502402370956,0.73806292245057004},
+{0.31631926043224473,-0.63722101809122833,0.70277414549937478},
+{0.34659454211482921,-0.59911133899435753,0.72176022809836216},
+{0.2954186325220694,-0.62732282519850213,0.72055111168033037},
+{0.29481058012742373,-0.51931214648743462,0.80212319275504373},
+{0.3385996274733642,-0.52372932205371825,0.78170191857002091},
+{0.13330851869483351,-0.71118356575374442,0.69025124023443718},
+{0.16243447947145481,-0.41166145557287775,0.89674404702482247},
+{-0.01860173600622668,-0.65908336294244974,0.75183980747897727},
+{-0.080200086543176827,-0.63933547880601294,0.76473400058997842},
+{-0.02218037374428215,-0.26322075238914144,0.96448062009159019},
+{-0.016474679508550735,-0.45654203278868977,0.8895493000572039},
+{-0.16121329013166222,-0.61670059006949418,0.77051324277578914},
+{-0.19569065320967344,-0.6082889385744642,0.7692137124715881},
+{-0.23658820278588766,-0.54498243979635874,0.80437563527008438},
+{-0.092631258052671028,-0.34450174192614524,0.93420447432102949},
+{-0.25515566746621593,-0.26684970409079611,0.92934752422682243},
+{-0.29231435283302654,-0.58586504612841772,0.75585346916763951},
+{-0.28326396175214702,-0.48604557207918708,0.82675342747078706},
+{-0.27985907755982109,-0.43592531372637133,0.8553642601605066},
+{-0.34616795402550382,-0.34556430360037699,0.87221159111937008},
+{-0.33213113963526514,-0.2845032699624368,0.89930350575612727},
+{-0.35651202045385633,-0.54654075161650195,0.75775483244541453},
+{-0.11772069598965676,0.9704244917902265,-0.21075612320734946},
+{0.96184231811748033,0.26313028256339988,-0.074978726826327696},
+{0.86894867848649004,0.45170371660715797,-0.20221757233203794},
+{0.9451097159979257,0.31775853175289276,0.076138953398152742},
+{0.96196073429542928,0.26286193649107992,-0.074398575375863238},
+{0.66959447556501839,0.10046985475033693,0.73590016074142428},
+{0.99323174061158392,-0.070034217127140835,0.092660228108243467},
+{-0.87459439294707719,-0.322365902445303,-0.3621669128539477},
+{0.27622844388263929,-0.78731594997939447,-0.55120907258337037},
+{0.19607496209157727,-0.5667638439247803,-0.80020831941463455},
+{-0.29605016475267587,-0.83912150826204668,-0.4563215909004758},
+{0.98324196685334975,0.16806862728253241,0.070626985931166661},
+{-0.44634482815978765,0.72932063106634071,0.51852455243315554},
+{0.030433947482339411,0.72111829938314709,0.69214317387040669},
+{0.27335560926206187,-0.95856394853001892,0.080198924328858903},
+{0.10153659322721749,-0.9797618672767846,0.1725021845256425},
+{0.12215233977752639,-0.91144404961125813,0.39287218063271695},
+{0.88604416831852895,-0.38556947647508666,0.25741388967857531},
+{0.35029654462428472,-0.91255369780074813,0.21104046876006388},
+{-0.26641606704347826,0.94674808787532228,-0.18080524695236527},
+{0.68273321504877194,0.44960993660308562,0.57595682301448325},
+{0.67853706756751619,0.45681800346623996,0.57524321781833676},
+{0.62142049028154023,0.1599390820402585,0.76697852922645082},
+{0.59227041004491621,0.14073463977985812,0.79335334029123517},
+{0.66529833974678643,0.10160690168936526,0.73963109497860968},
+{0.71466453188667456,0.66994199487031536,0.20107792114596468},
+{0.55045921976007639,0.12287410184637039,0.82577030854625411},
+{0.46172578273195874,-0.84686499222870926,0.26387304996537286},
+{0.32596400226559041,-0.89073850015059353,0.31675289039954968},
+{0.79977108941056518,0.042614107778368,0.59879064986127772},
+{0.17638593661265278,-0.9835947708908207,-0.037806455024390895},
+{0.0069803990372037826,-0.9998522661934347,-0.015707317311820675},
+{0.46205508673173223,0.21301031259659073,0.86089006473116769},
+{0.74000209045901721,0.44904429179447275,0.50075555925329962},
+{0.86630504113614015,-0.20319001299318168,0.4563215909004758},
+{0.7507167361861844,0.60539157242040087,0.26443416203720221},
+{0.75996523421044893,-0.048922761955709479,0.64811990106313089},
+{0.80672646925454317,-0.075074444949410735,0.58613670036915155},
+{0.85045445747907211,-0.23425418567045828,0.47101188121941001},
+{0.77075085665055509,0.61748787393966686,0.15700905231834705},
+{0.45099107842654185,0.20998125247821472,0.86747617880109251},
+{-0.94997198380472769,0.026258571159832468,-0.31122936466014001},
+{0.32980774536184598,-0.52474079253690287,-0.78477637053308302},
+{-0.87379381722176974,0.46885143843632976,0.12908405657242489},
+{-0.92173789862486921,0.36835787678371312,0.12129188286940329},
+{-0.9521058068999908,0.29139082791715615,0.092660228108243467},
+{0.46594625968769976,-0.055285815753349773,0.88308411924319496},
+{0.65726813244383953,0.02678162411967791,0.75318081938091042},
+{0.98640718006577999,0.16418317193009552,0.0066903788867754988},
+{0.62251334610871589,-0.0012675742967053515,0.78260815685241381},
+{0.46289044277484442,-0.86148100768631575,0.20876520635268364},
+{0.52950225413771312,0.52612447954450459,0.66544751475011532},
+{0.60880288491733558,-0.78864671379708029,0.085996558846244242},
+{0.64947601074537242,-0.028735314798045034,0.75983892579265377},
+{0.99530506164012611,-0.0037638105249006223,0.09671436296578402},
+{0.80412862263888418,-0.075304587945921292,0.58966632707590327},
+{0.26971053695502201,-0.34192156388325562,0.90019212971846319},
+{0.21687542144481795,-0.073267679249412812,0.97344588896894402},
+{0.30982731048619266,-0.12496873440285594,0.9425443507329726},
+{0.084073379296623063,-0.21656724045115036,0.97264088812727778},
+{0.93173123008316827,-0.27864672313758593,0.23287962249280583},
+{0.95811023741640367,-0.23385738564279851,0.16533449772566564},
+{0.4576440504940702,-0.84404612948655222,0.27954973501355956},
+{0.98615687339718561,0.1523714269093536,0.065403129230143062},
+{0.72178760958633981,0.31709305828051038,0.61520292508890928},
+{0.46926113021938781,-0.34765763929183824,-0.81174389896521482},
+{-0.0087249086734709196,-0.9675230198659065,0.2526323059274016},
+{-0.7941884601420649,0.56127691134125957,0.23287962249280583},
+{0.94271270377141203,-0.26291453900036516,0.20535019681076389},
+{0.52373980998586733,-0.84360957304030204,0.11840396830650095},
+{-0.3785733297469081,0.84433372832272413,0.37918701088115764},
+{0.047096235161918305,-0.968727862026312,0.24361501178602252},
+{0.67026979261774333,0.19177483083653907,0.71691060765048265},
+{0.28774002878924415,-0.90342295678036066,0.31785631501449785},
+{0.63846251000289811,0.2208794964386013,0.73727733681012408},
+{-0.28735935121772915,0.95178009003538266,-0.10742096387560721},
+{-0.33106336185846835,0.94360834670492788,-0.00058177638451306754},
+{-0.48894758314033504,0.86774216780516922,-0.089184029702692624},
+{-0.77308391694833578,0.63276185416123365,-0.044200602645850511},
+{0.59360928300606886,-0.065010789669682628,0.80212319275504373},
+{0.69459328460841763,0.49028431745030221,0.52646125882079964},
+{0.58388646265299371,-0.045611081404322053,0.81055303835326065},
+{0.026327157603234005,0.92328145983702181,0.38322085889699736},
+{0.29962159471646865,0.94548109960537663,-0.12764164786059459},
+{0.59664895041874455,0.58462191307347777,0.54975198837159056},
+{0.50648458849286093,0.63521988122043471,0.58306866158413462},
+{0.40469378436136744,-0.16227576837502544,0.89993861784988982},
+{0.7267152215493754,0.16088711763672608,0.66783255547104659},
+{0.6532017880652613,-0.023951822241294916,0.75680495127850933},
+{0.21748498228518331,-0.92604020720810531,0.30846363985789799},
+{0.68703903143115186,0.4979427218246113,0.52917900097419057},
+{-0.62004419225671392,0.52521585556945749,0.58283231268278346},
+{0.80035628163864747,0.59910618288053608,-0.02239651928027479},
+{0.19453124809450881,0.70624124212524475,0.68072086895891781},
+{-0.25220134855155146,0.94673397976921048,0.20022300402084467},
+{-0.99224277043463316,0.12183209287689807,0.024722978490439008},
+{-0.98840035051351582,-0.14389839678353364,-0.048559226804880257},
+{-0.92227276727134633,-0.38516476443163516,0.032573716244481209},
+{0.71308519114929292,0.67119465952945034,-0.20250244241174342},
+{0.43765380233574103,-0.84854424373057247,0.29737487407778596},
+{-0.45394029508150641,0.6305628475657381,0.62954642701797814},
+{-0.47676361875627538,0.63345311460894171,0.60945352851768109},
+{0.5835260641073664,0.64769236252404083,0.48988971823808697},
+{0.14140304720128541,-0.93314812031724115,0.33051439271322308},
+{0.16446708775012381,0.70955961470085194,0.6851829903263591},
+{0.29462978230615344,0.64551058978703779,0.7046342099635946},
+{0.26619087700527722,0.5366299363413517,0.80073137094873348},
+{0.3464594181268702,0.53691352761582334,0.7692137124715881},
+{0.45579027323876192,0.54835260979979727,0.70111671078835791},
+{0.41958607507547324,0.53575957875774072,0.73274088146635274},
+{0.39121092656821094,0.48918530546887018,0.77952020361692365},
+{-0.20750573363389901,0.92832728786493957,0.30846363985789799},
+{0.67585793643511394,0.48208478094234175,0.55750364459924728},
+{0.47037456554837731,-0.84857817911432121,0.24220413294615428},
+{0.67072175964891823,0.11244090768174642,0.73313666080285733},
+{0.17493711057538475,0.97715149567277526,0.12071438128074871},
+{0.97640931080200111,-0.18596569239656804,0.10973431109104526},
+{0.77226891158442645,0.4020177495363122,-0.49191712437967056},
+{0.5225737187804389,0.24720546704740559,0.81596946358418143},
+{0.64438986255869735,0.069434222006627452,0.76153830753673668},
+{0.49783301940319941,0.22269147132740044,0.83819496144389416},
+{0.81749192335219767,0.19149013597235495,0.54317444995067066},
+{0.82515747079792512,-0.10985522085240464,0.55411819933822848},
+{0.71697272566717241,0.09290642988519332,0.69088241107685844},
+{0.5974484718965275,0.32890285276421904,0.73135370161917046},
+{0.69672628942760273,0.24353512091014845,0.67473188934844608},
+{0.43037461606053379,-0.84770347006937463,0.31012338944860163},
+{0.63889941101867154,0.69764367301887464,-0.32419260956525253},
+{-0.98054361852512728,0.15179617212922233,0.12446740254606924},
+{-0.96342725204859792,0.21652882008973537,0.15787083353372913},
+{0.69193259450496125,0.27162989917714858,0.66891440598528373},
+{0.96623032587399371,-0.13579481651309477,0.21899480626172582},
+{-0.10284521032958063,0.95186363921323491,0.28875331176629104},
+{-0.19464519251185483,0.6413234051090152,0.74217082877960172},
+{-0.019260689544385607,0.66863705279689645,0.74333943623714394},
+{-0.2771251727740372,0.60809569211713499,0.7439228910603185},
+{-0.36972781451312731,0.84896474976307201,0.37757144600071524},
+{-0.79767274206946681,0.54311603839603795,0.26218917864086472},
+{0.46792321346915178,-0.84705897370348859,0.25206935824311361},
+{0.91392265233763159,-0.26120019451763343,0.31067642963073178},
+{0.44643015267334724,-0.84732747590701729,0.28763912695788635},
+{0.78418087219545685,0.20304634677553038,0.58637235673578925},
+{0.50435978438004392,0.79168627921944223,-0.34475214748539423},
+{0.28326466848955439,0.95628549443980115,0.072657970722610613},
+{0.78826768249517287,0.55195097341021804,-0.27200033765641218},
+{-0.14999097280339585,-0.93122053808065675,0.33216113188370328},
+{0.052626689779808021,-0.93157289707796975,0.35972540771062889},
+{0.0062474005946814189,-0.93376785954324271,0.35782475385283324},
+{-0.16141760470077493,-0.8867573592390674,0.43313478586696297},
+{-0.11748211095959599,-0.89236522749298519,0.43575480991707932},
+{-0.24315496291413299,-0.84335079539076252,0.47920256669178496},
+{-0.24131932005943094,-0.81555145785176675,0.52596654395684872},
+{-0.21655107522556372,-0.8423933840223895,0.49343593137707281},
+{-0.25973408998916003,-0.88155389113137606,0.39420925855265349},
+{-0.24588833296894125,-0.9019079625765708,0.35510696240813705},
+{-0.31275852009690785,-0.81618274602821872,0.48582695807522691},
+{-0.38296822279940057,-0.75107726618297022,0.53779018264466705},
+{-0.20247765352343783,0.97772760676524961,0.055240626288448468},
+{-0.34735409133295075,0.93734383787240316,0.027049303815331781},
+{0.7575467933295108,0.48416095584992475,-0.43784817545201959},
+{0.88261141779056684,0.27152672631285341,-0.38375815572252048},
+{-0.89967173619306151,0.21682261203864861,-0.37891783014804126},
+{0.97163856361029599,0.035911389981069269,0.23372820491962085},
+{-0.85498712557416823,0.18225307257655496,-0.48557268522727515},
+{0.99192123512534758,0.058930979993683151,0.11233611576153554},
+{0.06337055741310739,-0.97554385384301134,0.21047175982130567},
+{0.60837441198982622,0.052156085431771027,0.79193454122703022},
+{0.49246215657101394,0.093496861763045336,0.86529726752480163},
+{0.072280102314162098,0.88230265251621276,0.46509957662022167},
+{-0.97400225397366791,0.22635877612849639,-0.0090174122576038174},
+{-0.93082095738067294,-0.165525124293602,-0.32584318088386488},
+{-0.79669889417669493,0.072972643523754918,-0.59995488606626624},
+{-0.71864096764134577,-0.0433245193947756,-0.69403036363456172},
+{0.47766130990251066,0.7820232254562367,0.40034903255689497},
+{0.17944338432352525,-0.97134328989870855,0.15585982481471272},
+{0.21916278952626003,-0.95309220975915532,-0.20876520635268364},
+{-0.82216201571078751,-0.48300276566980221,-0.30126059861471594},
+{-0.75104410634213792,-0.64145226515799003,-0.15643446504023087},
+{-0.64968281115560378,-0.65081771224655982,-0.39287218063271695},
+{-0.82872776695143491,0.53476123277902876,-0.16504760586067763},
+{-0.90508931683348748,0.41120180095397368,-0.10828853792576375},
+{-0.49844481180461925,0.82955147337049295,0.25178785239542856},
+{0.35377702763817037,0.83547279939581787,0.42050804532757369},
+{0.57155406940351794,0.21939905132214649,0.7906895737438433},
+{0.37771887931979709,-0.56707999968175005,0.73194857890861631},
+{-0.58325555125522943,-0.69304730296964234,-0.42367251241550147},
+{0.38428007471238523,-0.86717727749438545,0.31675289039954968},
+{0.70296393349721553,0.48253182078687379,0.5224985647159488},
+{0.69748102665156808,0.48989483280089824,0.52299452220463516},
+{0.77035621712412095,-0.12385079053205593,0.62546964788293213},
+{0.80576985337432672,-0.2448115994736505,0.53926081273931725},
+{0.7128320551274594,-0.34255228030300594,0.61198725186230274},
+{-0.69497026444426435,0.7076184998074182,0.12764164786059459},
+{0.48367603301906803,-0.76411523667526471,-0.42683181718756824},
+{0.56247019968161183,0.7079669882383135,0.42709485835689875},
+{0.52970462509254157,0.76976524373699085,-0.35619444084671109},
+{0.64125051987872894,0.31414538818162474,0.70007888544040242},
+{0.66425108377151754,0.24835330355334789,0.70504690221467048},
+{0.5410407727333082,0.20228685590160392,0.81630564751788193},
+{0.44580460768937802,0.34352239868860257,0.82658974912718863},
+{0.58603782359454004,0.39677743572376173,0.70648944494383703},
+{0.33733033641708504,0.39706332064720995,0.85355079727532746},
+{0.47110655049827993,0.46161015220164997,0.75164797974981701},
+{0.46142041599628264,0.51335949815601545,0.72356977918844934},
+{0.43154193943094948,0.44739535297501593,0.7833319555900522},
+{0.38711456820176615,0.43601763176215069,0.81242287995752915},
+{0.38384228725593067,0.45988517055097283,0.80073137094873348},
+{0.26844227435157064,0.47640828814471314,0.83724183383773898},
+{0.16386411568309311,0.5496712471364712,0.8191520442889918},
+{0.070670545994640274,0.56872579257886002,0.8194855988877211},
+{0.064959975251396102,0.59314529986482789,0.80247046977667746},
+{0.048424351770459936,0.54980861934947323,0.8338858220671681},
+{0.02974430761576841,0.59056106916416529,0.80644460426748255},
+{-0.027629455039312589,0.55826843128429005,0.8292002000998363},
+{-0.1515052295278673,0.59293723265425147,0.79086762707676073},
+{-0.24489199460540792,0.56411027741495168,0.78854771947740177},
+{-0.29967313064387618,0.36138561542308928,0.88294759285892688},
+{-0.32796586314617443,0.32172904814304876,0.88821664710348258},
+{-0.48741061553016846,0.54259262680605536,0.68412289334899989},
+{-0.3441677743581707,0.2573142813325765,0.90296063242848135},
+{-0.44216599343336804,0.24711822103734823,0.86221912474870277},
+{-0.54284997909295551,0.41354086381519639,0.7309568073106365},
+{-0.34360167641342471,0.16969417980483772,0.92365673997770814},
+{-0.56029839638913226,0.21901468613215502,0.798810537150206},
+{-0.426157310490897,0.018730632031070442,0.90445514545436789},
+{0.86494186495505154,0.50071719529678638,-0.034027350502167444},
+{0.62321215129007845,0.66172221781364438,0.4168096939086039},
+{-0.92788665401591375,0.33405975100762708,-0.16562137560071813},
+{0.56500630900115723,0.82106554966408041,-0.081358674667858288},
+{0.81202185901761492,0.51797937271461891,0.2689198206152657},
+{0.48494160163063832,0.15803507959560154,0.86014914789536534},
+{-0.23932079644395873,0.97068220974403241,0.02239651928027479},
+{0.95690670896442864,-0.095511987200935539,-0.27423896630456196},
+{0.67187328244701372,0.17396677263373395,0.71994573014448671},
+{0.19985754452088286,0.057308228700448681,0.97814760073380558},
+{0.63763153517020998,0.19636412557022406,0.744894056591622},
+{0.96268752768484289,-0.22668282251102026,0.14780941112961063},
+{0.70336480922210731,0.15550296672457456,0.69361139875855882},
+{0.92297815466808586,-0.28983362961167253,0.25319516810480175},
+{0.70211018444443651,0.71115455296520558,0.036062316845398207},
+{0.56823342453389614,-0.81656664524413236,0.10163507818280187},
+{0.84852537786645799,0.52235660009328067,0.084547415428108855},
+{0.99308579876606462,0.11724653637122308,0.0058177313549938334},
+{0.013564944021745103,-0.97145441728466475,0.23683814606561865},
+{0.43115510295891252,-0.84740794139629394,0.30984682998375945},
+{0.67205216816998448,0.49367139627758455,0.55193698531205815},
+{0.76763182212818371,0.4630651201697315,-0.44307119082417967},
+{0.30093519217358922,-0.8806312416995663,0.3659598697318121},
+{0.94418595297215435,0.25387718555635286,0.20990297964547788},
+{0.2204879632951128,0.61298829345947814,-0.75870311065897811},
+{0.99405179369586094,0.021111703341879829,0.10684253568708502},
+{-0.17729084562815911,0.95502532565663578,0.2376858923261731},
+{0.28268262023523061,0.72879930413866068,0.62365223522725255},
+{-0.97513999796286654,-0.15037879027194762,-0.16275197021641921},
+{-0.57541962860345153,0.80423178152634023,-0.148672433896923},
+{0.41338324217846967,0.6715071116369713,0.6149735718768643},
+{0.78811751227303461,0.14156805879152817,0.59902359851558573},
+{-0.92947267501923825,-0.07805000122178983,-0.36053951753151853},
+{0.66012963274137171,0.36541394252565823,0.65627853734873631},
+{0.46868818289957492,-0.86381537437294376,0.18480905336921546},
+{-0.98888039920857562,0.013520563868380948,-0.14809709792487188},
+{-0.47335163806513353,0.77243966918176443,0.42340900346523225},
+{0.76857955150382262,0.62870181588687646,-0.11840396830650095},
+{0.54874270043692797,0.32344919758369994,0.77088395060453074},
+{0.84415913092828165,0.53606418983504667,0.0055268478270364442},
+{-0.88023545256132074,-0.04048442782214403,0.47280710565523493},
+{-0.91826387785621588,0.21847906058213312,0.33023983816555724},
+{0.20897014378359671,-0.72876549776242672,0.65209840383039219},
+{0.089687498861288351,-0.73397595602583376,0.67322763499723459},
+{0.058198652072456621,-0.78315745468258291,0.61909394930983397},
+{0.072092713831069438,-0.79730439108000617,0.59925649648294355},
+{0.051611102062929473,-0.76692113299041598,0.63966262194734069},
+{0.03383084806018602,-0.78006075777049599,0.62478851454396012},
+{0.044725117211590663,-0.75280936292595535,0.65671738745173069},
+{0.050141656899754798,-0.78244972817969494,0.62069174081412481},
+{0.037329317617682288,-0.78189862701658353,0.62228695881866258},
+{0.067083036722472511,-0.77717671595301807,0.6256965865054509},
+{0.030543441288400267,-0.74426759551910138,0.66718276690459966},
+{0.044704968343918204,-0.78727947496323081,0.6149735718768643},
+{0.044347928663359425,-0.75014632842241391,0.65978310616265512},
+{0.02955883347102695,-0.70525240138281009,0.7083398377245288},
+{-0.13319044882593439,-0.6675636342534923,0.73254289878737866},
+{-0.13522191159183591,-0.67062595224883514,0.72936675739698531},
+{-0.13842548419843015,-0.66453655840781833,0.73432250943568556},
+{-0.1988229549902267,-0.74288168448117298,0.63921532790709057},
+{-0.31972611525173456,-0.64976926375740574,0.6896195437356698},
+{-0.31351959015631475,-0.77339611901313221,0.55096634169760439},
+{-0.39195633962825649,-0.72997542363638757,0.55991616221725149},
+{-0.41656932448759648,-0.24147679126992758,0.87644677943040405},
+{-0.36776244483303305,-0.37532817673476837,0.85081110942405114},
+{-0.38539344213741683,-0.38137859644195993,0.84025130820096561},
+{-0.37945535898448418,-0.42789200006261774,0.82031827166068227},
+{-0.38679644244680905,-0.32783384979723923,0.86192428846019498},
+{-0.41660953637563897,-0.10851865588900605,0.90258528434986052},
+{-0.61643841935814025,-0.036083375389616083,0.78657591188627796},
+{-0.86293237819882929,-0.35127802979403605,0.36325123047297836},
+{0.45624689259292966,-0.68153347129731134,-0.57214587344551615},
+{0.3032450753644485,0.7075237704767009,0.63832009092432818},
+{0.26541720235509886,0.7024062447218774,0.66043862399900766},
+{0.72680869889159461,0.16046430465533068,0.66783255547104659},
+{0.46862451026664709,-0.85360077528612022,0.22750117539977618},
+{0.38524116041912054,-0.90464327862839422,0.18223552549214747},
+{0.40663867053722152,-0.8570223572738731,0.31647696718158613},
+{0.40212923376348081,-0.85975572197844241,0.31482086633214607},
+{-0.28176995004597249,0.9411771773912192,0.1865240360087346},
+{-0.933432410051249,0.19132320791791863,-0.30347877352117064},
+{-0.97100162137800616,-0.065061276508898147,-0.23004973718810443},
+{-0.96090631692803086,-0.13961018984644266,-0.23909840020135434},
+{0.68725956545557498,0.69207436873846473,0.22069743502150108},
+{0.68676628080041124,0.6923828067558313,-0.22126482880134393},
+{0.79189162823707371,0.4210562475874175,-0.4422886902190013},
+{0.84892902839272044,0.45678269813172473,-0.26583655023283276},
+{0.81555342889624183,0.49100310039178707,-0.30624917962540799}
+};
+
+static const uint32_t city_kd_order[] = {
+283,281,112,275,277,362,30,282,202,358,201,412,
+411,290,114,28,113,29,14,13,26,115,136,135,
+25,280,119,400,260,258,259,255,256,257,250,171,
+252,253,254,348,120,270,176,81,251,121,208,279,
+194,178,77,352,261,392,391,389,390,104,99,95,
+388,94,387,386,91,96,396,100,101,395,394,102,
+97,397,103,98,393,398,92,377,380,383,379,375,
+374,381,382,384,378,376,373,372,90,385,88,86,
+85,83,93,89,161,164,162,163,370,276,268,32,
+266,146,410,34,36,35,37,38,39,41,332,365,
+200,274,150,233,234,149,285,148,284,183,297,40,
+33,11,8,9,43,42,17,16,15,12,10,354,
+105,359,182,58,263,180,181,124,336,262,220,188,
+248,409,371,399,328,326,196,323,325,329,327,324,
+322,321,242,172,286,175,241,199,216,366,206,117,
+205,240,320,238,339,312,211,313,318,316,314,319,
+239,317,315,210,403,356,237,187,49,78,118,273,
+209,198,357,2,402,133,27,24,23,19,22,298,
+20,59,21,70,76,75,72,74,44,123,60,406,
+364,155,73,71,157,345,174,48,69,147,401,18,
+170,68,337,67,65,63,66,64,61,62,341,166,
+173,221,111,236,51,159,355,55,347,269,405,291,
+408,407,4,231,349,56,218,243,132,245,204,167,
+3,57,84,289,87,82,122,165,343,244,296,295,
+143,267,139,227,142,160,134,294,141,0,228,110,
+219,129,191,151,186,184,158,193,154,272,271,50,
+152,224,131,265,79,222,415,351,264,416,7,153,
+109,106,107,54,247,300,232,414,417,249,203,330,
+369,197,333,367,344,168,116,108,353,334,138,292,
+226,293,185,195,350,346,287,278,1,299,53,207,
+189,130,144,413,140,331,217,335,45,145,137,225,
+223,303,128,127,340,288,179,31,361,192,404,246,
+5,235,230,338,342,177,47,302,80,306,310,311,
+309,304,307,215,214,308,212,213,360,46,368,229,
+301,363,169,52,305,125,126,156,6,190
+};
+
+static const uint8_t city_kd_axis[] = {
+0,1,0,1,0,2,2,0,1,0,1,0,
+1,0,0,2,0,1,0,0,2,0,2,0,
+0,2,2,0,0,0,0,0,2,0,0,0,
+2,0,0,0,0,2,0,2,0,0,0,0,
+2,2,0,0,2,0,0,0,1,0,0,0,
+0,1,0,0,0,1,0,0,0,1,0,1,
+1,0,0,1,0,1,0,0,0,0,0,0,
+2,2,0,0,0,0,0,1,0,0,0,0,
+0,0,1,0,0,1,0,0,1,0,1,0,
+2,0,1,1,0,1,0,2,0,1,2,0,
+1,0,2,0,1,1,0,2,1,0,2,0,
+0,0,0,1,0,0,0,0,1,1,0,1,
+2,0,2,0,0,0,2,0,0,0,0,0,
+2,2,0,2,0,1,0,0,0,0,1,1,
+0,1,1,0,0,0,0,0,2,2,0,1,
+2,0,2,0,0,1,0,1,0,0,1,0,
+0,0,0,0,1,0,0,0,2,0,2,0,
+0,0,0,0,2,0,0,2,0,0,0,0,
+2,0,0,0,2,0,0,2,0,0,0,0,
+0,2,0,0,2,2,0,2,1,0,2,0,
+0,0,1,2,0,0,1,0,2,2,0,2,
+0,1,0,2,1,0,1,1,0,2,2,0,
+0,0,0,0,0,0,0,2,2,0,2,1,
+0,2,0,2,0,0,1,0,2,2,0,1,
+1,0,2,0,2,0,1,2,0,1,1,0,
+1,2,0,0,0,0,0,1,1,0,0,0,
+0,1,1,0,1,0,1,0,1,2,0,2,
+1,0,1,1,0,0,0,0,0,1,2,0,
+2,1,0,0,2,0,1,0,2,0,2,2,
+0,1,1,0,2,1,0,0,0,0,0,2,
+0,0,0,2,0,2,2,0,1,0,1,0,
+0,0,0,0,1,0,0,0,0,2,0,1,
+0,1,2,0,0,1,0,1,1,0,1,0,
+0,0,1,1,0,0,1,0,1,0,0,0,
+0,0,0,2,1,0,1,1,0,1
+};
@@ -0,0 +1,124 @@
+/*============================================================================
+  
+  libsolunar
+  
+  fasttrig.h
+
+  Polynomial sine and cosine, written without calls or branches so that
+  a loop that uses them can be vectorized by the compiler. The argument
+  is reduced to the range -pi/4..pi/4 and the kernels are those of
+  fdlibm, so the results are within an ulp or two of libm's for the
+  arguments the ephemeris routines use (a few multiples of 2pi).
+
+  Functions that contain such loops should be marked FASTTRIG_CLONES,
+  which makes the compiler build AVX2 and baseline versions of them,
+  and pick one at load time according to the CPU.
+
+  This is a private header, shared by the libsolunar source files.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <math.h>
+
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define FASTTRIG_CLONES __attribute__((target_clones("avx2","default")))
+#endif
+#endif
+#ifndef FASTTRIG_CLONES
+#define FASTTRIG_CLONES
+#endif
+
+/*============================================================================
+  
+  fasttrig_floor
+
+  floor() for arguments smaller in magnitude than 2^51. libm's floor() is 
+  a function call on CPUs without a rounding instruction, and SSE2 can't
+  convert doubles to integers and back in vector registers, either of 
+  which would stop a loop being vectorized. Adding and subtracting 
+  1.5 * 2^52 rounds to the nearest integer in the default rounding mode
+
+  ==========================================================================*/
+static inline double fasttrig_floor (double x)
+  {
+  const double ROUNDER = 6755399441055744.0;
+  double r = (x + ROUNDER) - ROUNDER;
+  return r > x ? r - 1.0 : r;
+  }
+
+/*============================================================================
+  
+  fasttrig_frac
+
+  The fractional part of x, in the range 0 to 1, as mathutil_pascal_frac()
+
+  ==========================================================================*/
+static inline double fasttrig_frac (double x)
+  {
+  return x - fasttrig_floor (x);
+  }
+
+/*============================================================================
+  
+  fasttrig_odd
+
+  Returns 1.0 if the integer k (held in a double) is odd, 0.0 otherwise
+
+  ==========================================================================*/
+static inline double fasttrig_odd (double k)
+  {
+  return k - 2.0 * fasttrig_floor (k * 0.5);
+  }
+
+/*============================================================================
+  
+  fasttrig_sincos
+
+  Sine and cosine of x, in radians
+
+  ==========================================================================*/
+static inline void fasttrig_sincos (double x, double *s, double *c)
+  {
+  const double TWO_BY_PI = 6.36619772367581382433e-01;
+  const double PIO2_1 = 1.57079632673412561417e+00;
+  const double PIO2_2 = 6.07710050630396597660e-11;
+  const double PIO2_3 = 2.02226624879595063154e-21;
+
+  const double S1 = -1.66666666666666324348e-01;
+  const double S2 = 8.33333333332248946124e-03;
+  const double S3 = -1.98412698298579493134e-04;
+  const double S4 = 2.75573137070700676789e-06;
+  const double S5 = -2.50507602534068634195e-08;
+  const double S6 = 1.58969099521155010221e-10;
+
+  const double C1 = 4.16666666666666019037e-02;
+  const double C2 = -1.38888888888741095749e-03;
+  const double C3 = 2.48015872894767294178e-05;
+  const double C4 = -2.75573143513906633035e-07;
+  const double C5 = 2.08757232129817482790e-09;
+  const double C6 = -1.13596475577881948265e-11;
+
+  // x = k * pi/2 + r, and the quadrant is k mod 4
+  double k = fasttrig_floor (x * TWO_BY_PI + 0.5);
+  double r = ((x - k * PIO2_1) - k * PIO2_2) - k * PIO2_3;
+  double swap = fasttrig_odd (k);                     // Quadrants 1 and 3
+  double sin_neg = fasttrig_odd (fasttrig_floor (k * 0.5));         // 2, 3
+  double cos_neg = fasttrig_odd (fasttrig_floor ((k + 1.0) * 0.5)); // 1, 2
+
+  double z = r * r;
+  double sr = r + r * z * (S1 + z * (S2 + z * (S3 + z * (S4
+     + z * (S5 + z * S6)))));
+  double cr = 1.0 - 0.5 * z + z * z * (C1 + z * (C2 + z * (C3 + z * (C4
+     + z * (C5 + z * C6)))));
+
+  double ss = swap != 0.0 ? cr : sr;
+  double cc = swap != 0.0 ? sr : cr;
+  *s = sin_neg != 0.0 ? -ss : ss;
+  *c = cos_neg != 0.0 ? -cc : cc;
+  }
+
@@ -22,8 +22,94 @@
 static const int SECS_PER_DAY = 24 * 3600;
 
 double periodic24 (double t); //FWD
-static char *getenv_dup (const char *env); //FWD
-static void my_setenv (const char *name, const char *value, BOOL dummy);
+
+/*============================================================================
+  
+  FestivalAnchor
+
+  The days from which movable feasts are counted
+
+  ==========================================================================*/
+typedef enum _FestivalAnchor
+  {
+  FESTIVAL_ANCHOR_EASTER = 0,
+  FESTIVAL_ANCHOR_ORTHODOX_EASTER,
+  FESTIVAL_ANCHOR_ADVENT,
+  FESTIVAL_ANCHOR_COUNT
+  } FestivalAnchor;
+
+/*============================================================================
+  
+  FestivalFeast
+
+  The rule for a movable feast: its date is offset days after its anchor
+
+  ==========================================================================*/
+typedef struct _FestivalFeast
+  {
+  const char *name;
+  FestivalFeastSet set;
+  FestivalAnchor anchor;
+  int offset;
+  } FestivalFeast;
+
+/*============================================================================
+  
+  festival_feasts
+
+  The movable feasts. The order of the first set is the order in which
+  solunar_year_summary_create() used to add them, and the FESTIVAL_FEAST_XXX
+  numbers below index this table
+
+  ==========================================================================*/
+static const FestivalFeast festival_feasts[] = 
+  {
+  {"Shrove Tuesday", FESTIVAL_FEASTS_EASTER, FESTIVAL_ANCHOR_EASTER, -47},
+  {"Ash Wednesday", FESTIVAL_FEASTS_EASTER, FESTIVAL_ANCHOR_EASTER, -46},
+  {"Mothering Sunday", FESTIVAL_FEASTS_EASTER, FESTIVAL_ANCHOR_EASTER, -21},
+  {"Palm Sunday", FESTIVAL_FEASTS_EASTER, FESTIVAL_ANCHOR_EASTER, -7},
+  {"Maundy Thursday", FESTIVAL_FEASTS_EASTER, FESTIVAL_ANCHOR_EASTER, -3},
+  {"Good Friday", FESTIVAL_FEASTS_EASTER, FESTIVAL_ANCHOR_EASTER, -2},
+  {"Easter Sunday", FESTIVAL_FEASTS_EASTER, FESTIVAL_ANCHOR_EASTER, 0},
+  {"Easter Monday", FESTIVAL_FEASTS_EASTER, FESTIVAL_ANCHOR_EASTER, 1},
+  {"Whitsun/Pentecost", FESTIVAL_FEASTS_EASTER, FESTIVAL_ANCHOR_EASTER, 49},
+  {"Ascension Day", FESTIVAL_FEASTS_ASCENSION, FESTIVAL_ANCHOR_EASTER, 39},
+  {"Trinity Sunday", FESTIVAL_FEASTS_ASCENSION, FESTIVAL_ANCHOR_EASTER, 56},
+  {"Corpus Christi", FESTIVAL_FEASTS_ASCENSION, FESTIVAL_ANCHOR_EASTER, 60},
+  {"Advent Sunday", FESTIVAL_FEASTS_ADVENT, FESTIVAL_ANCHOR_ADVENT, 0},
+  {"Second Sunday of Advent", FESTIVAL_FEASTS_ADVENT, 
+     FESTIVAL_ANCHOR_ADVENT, 7},
+  {"Third Sunday of Advent", FESTIVAL_FEASTS_ADVENT, 
+     FESTIVAL_ANCHOR_ADVENT, 14},
+  {"Fourth Sunday of Advent", FESTIVAL_FEASTS_ADVENT, 
+     FESTIVAL_ANCHOR_ADVENT, 21},
+  {"Clean Monday", FESTIVAL_FEASTS_ORTHODOX, 
+     FESTIVAL_ANCHOR_ORTHODOX_EASTER, -48},
+  {"Orthodox Good Friday", FESTIVAL_FEASTS_ORTHODOX, 
+     FESTIVAL_ANCHOR_ORTHODOX_EASTER, -2},
+  {"Orthodox Easter", FESTIVAL_FEASTS_ORTHODOX, 
+     FESTIVAL_ANCHOR_ORTHODOX_EASTER, 0},
+  {"Orthodox Ascension", FESTIVAL_FEASTS_ORTHODOX, 
+     FESTIVAL_ANCHOR_ORTHODOX_EASTER, 39},
+  {"Orthodox Pentecost", FESTIVAL_FEASTS_ORTHODOX, 
+     FESTIVAL_ANCHOR_ORTHODOX_EASTER, 49},
+  };
+
+#define FESTIVAL_FEAST_COUNT \
+  (int)(sizeof (festival_feasts) / sizeof (festival_feasts[0]))
+
+#define FESTIVAL_FEAST_SHROVE_TUESDAY 0
+#define FESTIVAL_FEAST_ASH_WEDNESDAY 1
+#define FESTIVAL_FEAST_MOTHERING_SUNDAY 2
+#define FESTIVAL_FEAST_PALM_SUNDAY 3
+#define FESTIVAL_FEAST_MAUNDY_THURSDAY 4
+#define FESTIVAL_FEAST_GOOD_FRIDAY 5
+#define FESTIVAL_FEAST_EASTER_SUNDAY 6
+#define FESTIVAL_FEAST_EASTER_MONDAY 7
+#define FESTIVAL_FEAST_WHITSUN 8
+
+static const char *festival_feast_set_names[FESTIVAL_FEAST_SET_COUNT] = 
+  {"easter", "ascension", "advent", "orthodox"};
 
 /*============================================================================
   
@@ -70,6 +156,159 @@ void festival_destroy (Festival *self)
   KLOG_OUT
   }
 
+/*============================================================================
+  
+  festival_days_from_civil
+
+  The number of days from 1970-01-01 to a date in the Gregorian calendar
+
+  ==========================================================================*/
+static int festival_days_from_civil (int year, int month, int day)
+  {
+  // Count years from March, so the leap day is at the end of the year
+  if (month <= 2) year--;
+  int era = (year >= 0 ? year : year - 399) / 400;
+  int yoe = year - era * 400;
+  int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+  }
+
+/*============================================================================
+  
+  festival_civil_from_days
+
+  The inverse of festival_days_from_civil()
+
+  ==========================================================================*/
+static void festival_civil_from_days (int days, int *year, int *month, 
+      int *day)
+  {
+  days += 719468;
+  int era = (days >= 0 ? days : days - 146096) / 146097;
+  int doe = days - era * 146097;
+  int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int mp = (5 * doy + 2) / 153;
+  *day = doy - (153 * mp + 2) / 5 + 1;
+  *month = mp < 10 ? mp + 3 : mp - 9;
+  *year = yoe + era * 400 + (*month <= 2);
+  }
+
+/*============================================================================
+  
+  festival_get_anchor
+
+  Get the day, counted from 1970-01-01, of an anchor of the movable feasts
+
+  ==========================================================================*/
+static int festival_get_anchor (int year, FestivalAnchor anchor)
+  {
+  switch (anchor)
+    {
+    case FESTIVAL_ANCHOR_EASTER:
+      {
+      // The Gregorian computus, after Meeus
+      int nA = year % 19;
+      int nB = year / 100;
+      int nC = year % 100;
+      int nD = nB / 4;
+      int nE = nB % 4;
+      int nF = (nB + 8) / 25;
+      int nG = (nB - nF + 1) / 3;
+      int nH = (19 * nA + nB - nD - nG + 15) % 30;
+      int nI = nC / 4;
+      int nK = nC % 4;
+      int nL = (32 + 2 * nE + 2 * nI - nH - nK) % 7;
+      int nM = (nA + 11 * nH + 22 * nL) / 451;
+      int month = (nH + nL - 7 * nM + 114) / 31;
+      int day = (nH + nL - 7 * nM + 114) % 31 + 1;
+      return festival_days_from_civil (year, month, day);
+      }
+    case FESTIVAL_ANCHOR_ORTHODOX_EASTER:
+      {
+      // The Julian computus, which gives a date in the Julian calendar.
+      //  Between March and February, that is behind the Gregorian
+      //  calendar by the number of Julian leap days that the Gregorian
+      //  calendar skips, less the two it had skipped by its start
+      int nA = year % 4;
+      int nB = year % 7;
+      int nC = year % 19;
+      int nD = (19 * nC + 15) % 30;
+      int nE = (2 * nA + 4 * nB - nD + 34) % 7;
+      int month = (nD + nE + 114) / 31;
+      int day = (nD + nE + 114) % 31 + 1;
+      return festival_days_from_civil (year, month, day) 
+        + year / 100 - year / 400 - 2;
+      }
+    default:
+      {
+      // Advent Sunday is the fourth Sunday before Christmas Day. The
+      //  days are counted from a Thursday
+      int christmas = festival_days_from_civil (year, 12, 25);
+      int weekday = ((christmas + 4) % 7 + 7) % 7;
+      return christmas - (weekday == 0 ? 7 : weekday) - 21;
+      }
+    }
+  }
+
+/*============================================================================
+  
+  festival_get_anchor_time
+
+  Get the time of an anchor of the movable feasts. Like the feasts 
+  themselves, this is 2AM local time, which is on the right day whatever 
+  the daylight saving
+
+  ==========================================================================*/
+static time_t festival_get_anchor_time (int year, FestivalAnchor anchor,
+      const char *tz)
+  {
+  int y, m, d;
+  festival_civil_from_days (festival_get_anchor (year, anchor), &y, &m, &d);
+  return datetimeconv_maketime (y, m, d, 2, 0, 0, tz);
+  }
+
+/*============================================================================
+  
+  festival_new_feast
+
+  Create a Festival for one of the movable feasts, by its number in
+  festival_feasts[]
+
+  ==========================================================================*/
+static Festival *festival_new_feast (int year, const char *tz, int feast)
+  {
+  const FestivalFeast *f = &festival_feasts[feast];
+  time_t t = festival_get_anchor_time (year, f->anchor, tz);
+  return festival_new (t + f->offset * SECS_PER_DAY, FALSE, f->name);
+  }
+
+/*============================================================================
+  
+  festival_add_feasts
+
+  ==========================================================================*/
+void festival_add_feasts (int year, int sets, const char *tz, KList *list)
+  {
+  KLOG_IN
+  time_t anchors[FESTIVAL_ANCHOR_COUNT];
+  BOOL have_anchor[FESTIVAL_ANCHOR_COUNT] = { FALSE };
+  for (int i = 0; i < FESTIVAL_FEAST_COUNT; i++)
+    {
+    const FestivalFeast *f = &festival_feasts[i];
+    if (!(sets & FESTIVAL_FEAST_SET (f->set))) continue;
+    if (!have_anchor[f->anchor])
+      {
+      anchors[f->anchor] = festival_get_anchor_time (year, f->anchor, tz);
+      have_anchor[f->anchor] = TRUE;
+      }
+    klist_append (list, festival_new 
+      (anchors[f->anchor] + f->offset * SECS_PER_DAY, FALSE, f->name));
+    }
+  KLOG_OUT
+  }
+
 /*============================================================================
   
   festival_get_autumnal_equinox
@@ -117,12 +356,8 @@ time_t festival_get_date (const Festival *self)
 Festival *festival_get_ash_wednesday (int year, const char *tz)
   {
   KLOG_IN
-
-  Festival *temp = festival_get_easter_sunday (year, tz);
-  time_t t = festival_get_date(temp);
-  festival_destroy (temp);
-  t -= 46 * SECS_PER_DAY;
-  Festival *ret = festival_new (t, FALSE, "Ash Wednesday");
+  Festival *ret = festival_new_feast (year, tz, 
+    FESTIVAL_FEAST_ASH_WEDNESDAY);
   KLOG_OUT
   return ret;
   }
@@ -135,12 +370,8 @@ Festival *festival_get_ash_wednesday (int year, const char *tz)
 Festival *festival_get_easter_monday (int year, const char *tz)
   {
   KLOG_IN
-
-  Festival *temp = festival_get_easter_sunday (year, tz);
-  time_t t = festival_get_date(temp);
-  festival_destroy (temp);
-  t += SECS_PER_DAY;
-  Festival *ret = festival_new (t, FALSE, "Easter Monday");
+  Festival *ret = festival_new_feast (year, tz, 
+    FESTIVAL_FEAST_EASTER_MONDAY);
   KLOG_OUT
   return ret;
   }
@@ -153,29 +384,49 @@ Festival *festival_get_easter_monday (int year, const char *tz)
 Festival *festival_get_easter_sunday (int year, const char *tz)
   {
   KLOG_IN
-  int n_year = year;
-  int nA = n_year % 19;
-  int nB = n_year / 100;
-  int nC = n_year % 100;
-  int nD = nB / 4;
-  int nE = nB % 4;
-  int nF = (nB + 8) / 25;
-  int nG = (nB - nF + 1) / 3;
-  int nH = (19 * nA + nB - nD - nG + 15) % 30;
-  int nI = nC / 4;
-  int nK = nC % 4;
-  int nL = (32 + 2 * nE + 2 * nI - nH - nK) % 7;
-  int nM = (nA + 11 * nH + 22 * nL) / 451;
-  int n_easter_month = (nH + nL - 7 * nM + 114) / 31;
-  --n_easter_month;
-  int nP = (nH + nL - 7 * nM + 114) % 31;
-  int n_easter_day = nP + 1;
-  n_year -= 1900;
-
-  time_t t = datetimeconv_maketime (year, n_easter_month + 1, n_easter_day, 
-         2, 0, 0, tz);
-
-  Festival *ret = festival_new (t, FALSE, "Easter Sunday"); 
+  Festival *ret = festival_new_feast (year, tz, 
+    FESTIVAL_FEAST_EASTER_SUNDAY);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  festival_get_feast_dates
+
+  ==========================================================================*/
+int festival_get_feast_dates (int year, int sets, FestivalFeastDate *dates)
+  {
+  KLOG_IN
+  int anchors[FESTIVAL_ANCHOR_COUNT];
+  for (int i = 0; i < FESTIVAL_ANCHOR_COUNT; i++)
+    anchors[i] = festival_get_anchor (year, i);
+  int count = 0;
+  for (int i = 0; i < FESTIVAL_FEAST_COUNT; i++)
+    {
+    const FestivalFeast *f = &festival_feasts[i];
+    if (!(sets & FESTIVAL_FEAST_SET (f->set))) continue;
+    int y;
+    FestivalFeastDate *date = &dates[count++];
+    date->name = f->name;
+    festival_civil_from_days (anchors[f->anchor] + f->offset, &y, 
+      &date->month, &date->day);
+    }
+  KLOG_OUT
+  return count;
+  }
+
+/*============================================================================
+  
+  festival_get_feast_set_name
+
+  ==========================================================================*/
+const char *festival_get_feast_set_name (FestivalFeastSet set)
+  {
+  KLOG_IN
+  const char *ret = NULL;
+  if (set >= 0 && set < FESTIVAL_FEAST_SET_COUNT)
+    ret = festival_feast_set_names[set];
   KLOG_OUT
   return ret;
   }
@@ -188,12 +439,8 @@ Festival *festival_get_easter_sunday (int year, const char *tz)
 Festival *festival_get_good_friday (int year, const char *tz)
   {
   KLOG_IN
-
-  Festival *temp = festival_get_easter_sunday (year, tz);
-  time_t t = festival_get_date(temp);
-  festival_destroy (temp);
-  t -= 2 * SECS_PER_DAY;
-  Festival *ret = festival_new (t, FALSE, "Good Friday");
+  Festival *ret = festival_new_feast (year, tz, 
+    FESTIVAL_FEAST_GOOD_FRIDAY);
   KLOG_OUT
   return ret;
   }
@@ -206,12 +453,8 @@ Festival *festival_get_good_friday (int year, const char *tz)
 Festival *festival_get_maundy_thursday (int year, const char *tz)
   {
   KLOG_IN
-
-  Festival *temp = festival_get_easter_sunday (year, tz);
-  time_t t = festival_get_date(temp);
-  festival_destroy (temp);
-  t -= 3 * SECS_PER_DAY;
-  Festival *ret = festival_new (t, FALSE, "Maundy Thursday");
+  Festival *ret = festival_new_feast (year, tz, 
+    FESTIVAL_FEAST_MAUNDY_THURSDAY);
   KLOG_OUT
   return ret;
   }
@@ -224,12 +467,8 @@ Festival *festival_get_maundy_thursday (int year, const char *tz)
 Festival *festival_get_mothering_sunday (int year, const char *tz)
   {
   KLOG_IN
-
-  Festival *temp = festival_get_easter_sunday (year, tz);
-  time_t t = festival_get_date(temp);
-  festival_destroy (temp);
-  t -= 21 * SECS_PER_DAY;
-  Festival *ret = festival_new (t, FALSE, "Mothering Sunday");
+  Festival *ret = festival_new_feast (year, tz, 
+    FESTIVAL_FEAST_MOTHERING_SUNDAY);
   KLOG_OUT
   return ret;
   }
@@ -255,12 +494,8 @@ const char *festival_get_name (const Festival *self)
 Festival *festival_get_palm_sunday (int year, const char *tz)
   {
   KLOG_IN
-
-  Festival *temp = festival_get_easter_sunday (year, tz);
-  time_t t = festival_get_date(temp);
-  festival_destroy (temp);
-  t -= 7 * SECS_PER_DAY;
-  Festival *ret = festival_new (t, FALSE, "Palm Sunday");
+  Festival *ret = festival_new_feast (year, tz, 
+    FESTIVAL_FEAST_PALM_SUNDAY);
   KLOG_OUT
   return ret;
   }
@@ -273,12 +508,8 @@ Festival *festival_get_palm_sunday (int year, const char *tz)
 Festival *festival_get_shrove_tuesday (int year, const char *tz)
   {
   KLOG_IN
-
-  Festival *temp = festival_get_easter_sunday (year, tz);
-  time_t t = festival_get_date(temp);
-  festival_destroy (temp);
-  t -= 47 * SECS_PER_DAY;
-  Festival *ret = festival_new (t, FALSE, "Shrove Tuesday");
+  Festival *ret = festival_new_feast (year, tz, 
+    FESTIVAL_FEAST_SHROVE_TUESDAY);
   KLOG_OUT
   return ret;
   }
@@ -376,12 +607,8 @@ Festival *festival_get_winter_solstice (int year, BOOL southern)
 Festival *festival_get_whitsun (int year, const char *tz)
   {
   KLOG_IN
-
-  Festival *temp = festival_get_easter_sunday (year, tz);
-  time_t t = festival_get_date(temp);
-  festival_destroy (temp);
-  t += 49 * SECS_PER_DAY;
-  Festival *ret = festival_new (t, FALSE, "Whitsun/Pentecost");
+  Festival *ret = festival_new_feast (year, tz, 
+    FESTIVAL_FEAST_WHITSUN);
   KLOG_OUT
   return ret;
   }
@@ -429,18 +656,11 @@ KString *festival_to_string (const Festival *self, const char *tz)
       "Sep", "Oct", "Nov", "Dec"};
   static char *days[7] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
 
-  char *oldtz = NULL;
-  if (tz)
-    {
-    oldtz = getenv_dup ("TZ");
-    my_setenv ("TZ", tz, 1);
-    tzset ();
-    }
-
   KString *s = kstring_new_empty ();
   
   struct tm tm;
-  localtime_r (&self->date, &tm);  
+  time_t date = self->date;
+  datetimeconv_localtime (&date, &tm, tz);
 
   kstring_append_printf (s, "%s %s %d %s", 
         days[tm.tm_wday], months[tm.tm_mon], tm.tm_mday, self->name);
@@ -449,52 +669,10 @@ KString *festival_to_string (const Festival *self, const char *tz)
     kstring_append_printf (s, " (%02d:%02d)", tm.tm_hour, tm.tm_min);
     }
 
-  if (tz)
-    {
-    my_setenv ("TZ", oldtz, 1);
-    if (oldtz) free (oldtz);
-    tzset ();
-    }
-
   KLOG_OUT
   return s;
   }
 
-/*=======================================================================
-
-  getenv_dup
-
-  Gets a copy of an environment string. Caller must free it, if it is
-  not NULL
-
-=======================================================================*/
-static char *getenv_dup (const char *env)
-  {
-  KLOG_IN
-  char *s = getenv (env);
-  KLOG_OUT
-  if (s) return strdup (s);
-  return NULL;
-  }
-
-/*=======================================================================
-
-  my_setenv
-
-  A variant of setenv() that allows a NULL value to call unsetenv; 
-  setenv() itself does not accept NULL as a value
-
-=======================================================================*/
-static void my_setenv (const char *name, const char *value, BOOL dummy)
-  {
-  KLOG_IN
-  if (value)
-    setenv (name, value, 1);
-  else
-    unsetenv (name);
-  KLOG_OUT
-  }
-
 /*============================================================================
   
   periodic24
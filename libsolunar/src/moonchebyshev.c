@@ -0,0 +1,408 @@
+/*============================================================================
+  
+  libsolunar
+  
+  moonchebyshev.c
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <libsolunar/moonchebyshev.h>
+#include <libsolunar/moonephemera.h>
+#include <klib/klog.h>
+
+#define KLOG_CLASS "libsolunar.moonchebyshev"
+
+#define MOONCHEBYSHEV_MAGIC "SOLCHEB"
+#define MOONCHEBYSHEV_VERSION 1
+#define MOONCHEBYSHEV_BYTE_ORDER 0x01020304
+
+// Components stored for each segment: the x, y, z components of the
+//  Moon's direction, then the distance in km
+#define NCOMPONENTS 4
+
+// The highest order of polynomial that a file may have. Orders much
+//  above the default gain nothing, as the series is only so accurate
+#define MOONCHEBYSHEV_MAX_ORDER 64
+
+static const double ARCSEC_PER_RAD = 206264.8062;
+
+/*============================================================================
+  
+  MoonChebyshevHeader
+
+  The layout of the start of the file. The coefficients follow directly,
+  as nsegments * NCOMPONENTS * (order + 1) doubles.
+
+  ==========================================================================*/
+typedef struct _MoonChebyshevHeader
+  {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  int64_t start;
+  int64_t segment_secs;
+  uint32_t nsegments;
+  uint32_t order;
+  } MoonChebyshevHeader;
+
+/*============================================================================
+  
+  MoonChebyshev
+
+  ==========================================================================*/
+struct _MoonChebyshev
+  {
+  void *map;
+  size_t map_size;
+  time_t start;
+  time_t segment_secs;
+  int nsegments;
+  int ncoeffs;
+  const double *coeffs;
+  };
+
+/*============================================================================
+  
+  moonchebyshev_series
+
+  Evaluate the series in moonephemera at a time that may have a fractional
+  number of seconds, giving the components we store.
+
+  ==========================================================================*/
+static void moonchebyshev_series (double t, double *v)
+  {
+  double mjd = t / 86400.0 + 40587.0;
+  double phase;
+  moonephemera_get_equatorial_mjd (mjd, &v[0], &v[1], &v[2]);
+  moonephemera_get_phase_and_distance (mjd + 2400000.5, &phase, &v[3]);
+  }
+
+/*============================================================================
+  
+  moonchebyshev_eval
+
+  Clenshaw's recurrence. The first coefficient is stored already halved.
+
+  ==========================================================================*/
+static double moonchebyshev_eval (const double *c, int n, double x)
+  {
+  double b1 = 0, b2 = 0;
+  double x2 = 2.0 * x;
+  for (int j = n - 1; j >= 1; j--)
+    {
+    double temp = x2 * b1 - b2 + c[j];
+    b2 = b1;
+    b1 = temp;
+    }
+  return x * b1 - b2 + c[0];
+  }
+
+/*============================================================================
+  
+  moonchebyshev_evaluate
+
+  Work out the components at time t, returning FALSE if t is out of range
+
+  ==========================================================================*/
+static BOOL moonchebyshev_evaluate (const MoonChebyshev *self, time_t t,
+         double *v)
+  {
+  if (t < self->start) return FALSE;
+  time_t offset = t - self->start;
+  time_t seg = offset / self->segment_secs;
+  if (seg >= self->nsegments)
+    {
+    // Allow the very end of the last segment
+    if (offset != (time_t)self->nsegments * self->segment_secs)
+      return FALSE;
+    seg = self->nsegments - 1;
+    }
+  double x = 2.0 * (offset - seg * self->segment_secs)
+    / self->segment_secs - 1.0;
+  const double *c = self->coeffs + seg * NCOMPONENTS * self->ncoeffs;
+  for (int i = 0; i < NCOMPONENTS; i++)
+    v[i] = moonchebyshev_eval (c + i * self->ncoeffs, self->ncoeffs, x);
+  return TRUE;
+  }
+
+/*============================================================================
+  
+  moonchebyshev_separation
+
+  Angle in arcseconds between two positions given as RA (hours) and
+  declination (degrees), using the haversine formula, which is well-
+  behaved for small angles
+
+  ==========================================================================*/
+static double moonchebyshev_separation (double ra1, double dec1, 
+         double ra2, double dec2)
+  {
+  double a1 = ra1 * M_PI / 12.0, a2 = ra2 * M_PI / 12.0;
+  double d1 = dec1 * M_PI / 180.0, d2 = dec2 * M_PI / 180.0;
+  double sd = sin (0.5 * (d2 - d1));
+  double sa = sin (0.5 * (a2 - a1));
+  double h = sd * sd + cos (d1) * cos (d2) * sa * sa;
+  return 2.0 * asin (sqrt (h)) * ARCSEC_PER_RAD;
+  }
+
+/*============================================================================
+  
+  moonchebyshev_check
+
+  ==========================================================================*/
+void moonchebyshev_check (const MoonChebyshev *self,
+       int samples_per_segment, double *max_error_arcsec,
+       double *max_error_km)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  double max_angle = 0, max_dist = 0;
+  for (int seg = 0; seg < self->nsegments; seg++)
+    {
+    for (int i = 0; i < samples_per_segment; i++)
+      {
+      time_t t = self->start + seg * self->segment_secs
+        + (time_t)i * self->segment_secs / samples_per_segment;
+      double v[NCOMPONENTS], s[NCOMPONENTS];
+      moonchebyshev_evaluate (self, t, v);
+      moonchebyshev_series ((double)t, s);
+      double ra1, dec1, ra2, dec2;
+      moonephemera_equatorial_to_ra_and_dec (v[0], v[1], v[2], &ra1, &dec1);
+      moonephemera_equatorial_to_ra_and_dec (s[0], s[1], s[2], &ra2, &dec2);
+      double angle = moonchebyshev_separation (ra1, dec1, ra2, dec2);
+      if (angle > max_angle) max_angle = angle;
+      double dd = fabs (v[3] - s[3]);
+      if (dd > max_dist) max_dist = dd;
+      }
+    }
+  *max_error_arcsec = max_angle;
+  *max_error_km = max_dist;
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  moonchebyshev_close
+
+  ==========================================================================*/
+void moonchebyshev_close (MoonChebyshev *self)
+  {
+  KLOG_IN
+  if (self)
+    {
+    if (self->map) munmap (self->map, self->map_size);
+    free (self);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  moonchebyshev_get_distance
+
+  ==========================================================================*/
+BOOL moonchebyshev_get_distance (const MoonChebyshev *self, time_t t,
+       double *distance)
+  {
+  KLOG_IN
+  double v[NCOMPONENTS];
+  BOOL ret = moonchebyshev_evaluate (self, t, v);
+  if (ret) *distance = v[3];
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  moonchebyshev_get_ra_and_dec
+
+  ==========================================================================*/
+BOOL moonchebyshev_get_ra_and_dec (const MoonChebyshev *self, time_t t,
+       double *ra, double *dec)
+  {
+  KLOG_IN
+  double v[NCOMPONENTS];
+  BOOL ret = moonchebyshev_evaluate (self, t, v);
+  if (ret)
+    moonephemera_equatorial_to_ra_and_dec (v[0], v[1], v[2], ra, dec);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  moonchebyshev_get_range
+
+  ==========================================================================*/
+void moonchebyshev_get_range (const MoonChebyshev *self, time_t *start,
+       time_t *end)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  *start = self->start;
+  *end = self->start + (time_t)self->nsegments * self->segment_secs;
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  moonchebyshev_open
+
+  ==========================================================================*/
+MoonChebyshev *moonchebyshev_open (const char *path)
+  {
+  KLOG_IN
+  MoonChebyshev *self = NULL;
+  int f = open (path, O_RDONLY);
+  if (f >= 0)
+    {
+    struct stat sb;
+    size_t size = fstat (f, &sb) == 0 ? sb.st_size : 0;
+    if (size >= sizeof (MoonChebyshevHeader))
+      {
+      void *map = mmap (NULL, size, PROT_READ, MAP_SHARED, f, 0);
+      if (map != MAP_FAILED)
+        {
+        const MoonChebyshevHeader *h = map;
+        size_t ncoeffs = (size_t)h->order + 1;
+        size_t expected = sizeof (MoonChebyshevHeader)
+          + (size_t)h->nsegments * NCOMPONENTS * ncoeffs * sizeof (double);
+        if (memcmp (h->magic, MOONCHEBYSHEV_MAGIC, 8) != 0)
+          klog_error (KLOG_CLASS, "%s is not an ephemeris file", path);
+        else if (h->byte_order != MOONCHEBYSHEV_BYTE_ORDER)
+          klog_error (KLOG_CLASS,
+            "%s was created on a machine of different byte order", path);
+        else if (h->version != MOONCHEBYSHEV_VERSION)
+          klog_error (KLOG_CLASS,
+            "%s has unsupported version %d", path, h->version);
+        else if (size != expected || h->segment_secs <= 0
+             || h->nsegments == 0 || h->order == 0
+             || h->order > MOONCHEBYSHEV_MAX_ORDER)
+          klog_error (KLOG_CLASS, "%s is corrupt", path);
+        else
+          {
+          self = malloc (sizeof (MoonChebyshev));
+          self->map = map;
+          self->map_size = size;
+          self->start = h->start;
+          self->segment_secs = h->segment_secs;
+          self->nsegments = h->nsegments;
+          self->ncoeffs = ncoeffs;
+          self->coeffs = (const double *)(h + 1);
+          klog_debug (KLOG_CLASS, "Mapped %s: %d segments of order %d",
+            path, self->nsegments, h->order);
+          }
+        if (!self) munmap (map, size);
+        }
+      else
+        klog_error (KLOG_CLASS, "Can't map %s: %s", path, strerror (errno));
+      }
+    else
+      klog_error (KLOG_CLASS, "%s is not an ephemeris file", path);
+    close (f);
+    }
+  else
+    klog_error (KLOG_CLASS, "Can't open %s: %s", path, strerror (errno));
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+  
+  moonchebyshev_write_file
+
+  ==========================================================================*/
+BOOL moonchebyshev_write_file (const char *path, int first_year,
+       int last_year, int segment_days, int order)
+  {
+  KLOG_IN
+  BOOL ret = FALSE;
+  assert (last_year >= first_year);
+  assert (segment_days > 0 && order > 0 
+    && order <= MOONCHEBYSHEV_MAX_ORDER);
+
+  struct tm tm;
+  memset (&tm, 0, sizeof (tm));
+  tm.tm_mday = 1;
+  tm.tm_year = first_year - 1900;
+  time_t start = timegm (&tm);
+  tm.tm_year = last_year + 1 - 1900;
+  time_t end = timegm (&tm);
+
+  MoonChebyshevHeader h;
+  memset (&h, 0, sizeof (h));
+  memcpy (h.magic, MOONCHEBYSHEV_MAGIC, 8);
+  h.version = MOONCHEBYSHEV_VERSION;
+  h.byte_order = MOONCHEBYSHEV_BYTE_ORDER;
+  h.start = start;
+  h.segment_secs = (int64_t)segment_days * 86400;
+  h.nsegments = (end - start + h.segment_secs - 1) / h.segment_secs;
+  h.order = order;
+
+  FILE *f = fopen (path, "wb");
+  if (f)
+    {
+    int n = order + 1;
+    double *values = malloc (n * NCOMPONENTS * sizeof (double));
+    double *coeffs = malloc (n * NCOMPONENTS * sizeof (double));
+    BOOL ok = fwrite (&h, sizeof (h), 1, f) == 1;
+    for (uint32_t seg = 0; seg < h.nsegments && ok; seg++)
+      {
+      double seg_start = (double)start + (double)seg * h.segment_secs;
+      // Sample at the Chebyshev nodes...
+      for (int k = 0; k < n; k++)
+        {
+        double x = cos (M_PI * (k + 0.5) / n);
+        double t = seg_start + 0.5 * (x + 1.0) * h.segment_secs;
+        double v[NCOMPONENTS];
+        moonchebyshev_series (t, v);
+        for (int i = 0; i < NCOMPONENTS; i++)
+          values[i * n + k] = v[i];
+        }
+      // ... and fit by the discrete orthogonality of the polynomials
+      for (int i = 0; i < NCOMPONENTS; i++)
+        {
+        for (int j = 0; j < n; j++)
+          {
+          double sum = 0;
+          for (int k = 0; k < n; k++)
+            sum += values[i * n + k] * cos (M_PI * j * (k + 0.5) / n);
+          coeffs[i * n + j] = 2.0 * sum / n;
+          }
+        coeffs[i * n] *= 0.5;
+        }
+      ok = fwrite (coeffs, sizeof (double), n * NCOMPONENTS, f)
+         == (size_t)(n * NCOMPONENTS);
+      }
+    free (values);
+    free (coeffs);
+    if (fclose (f) != 0) ok = FALSE;
+    if (ok)
+      {
+      klog_debug (KLOG_CLASS, "Wrote %d segments to %s", h.nsegments, path);
+      ret = TRUE;
+      }
+    else
+      klog_error (KLOG_CLASS, "Can't write %s: %s", path, strerror (errno));
+    }
+  else
+    klog_error (KLOG_CLASS, "Can't open %s for writing: %s", path,
+      strerror (errno));
+
+  KLOG_OUT
+  return ret;
+  }
+
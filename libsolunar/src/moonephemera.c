@@ -16,8 +16,10 @@
 #include <assert.h>
 #include <math.h>
 #include <libsolunar/moonephemera.h>
+#include <libsolunar/moonchebyshev.h>
 #include <libsolunar/astroutil.h>
 #include <klib/klog.h>
+#include "fasttrig.h"
 
 static const double TWO_PI = 2.0 * M_PI; 
 
@@ -87,6 +89,9 @@ const double LUNATBASE = 2423436.0;
 /** Radius of Earth in kilometres. */
 const double EARTHRAD = 6378.16;
 
+/** Tabulated ephemeris to use in preference to the series, if set. */
+static const MoonChebyshev *chebyshev = NULL;
+
 
 /*============================================================================
   
@@ -157,6 +162,29 @@ void moonephemera_get_moon_state (double latitude, double longitude,
          double *age, double *distance, int *moon_flags)
   {
   double jd = datetimeconv_time_to_jd (time);
+  moonephemera_get_phase_and_distance (jd, phase, distance);
+  *age = *phase * SYNMONTH;
+  *phase_name = moonephemera_get_phase_name (*phase);
+
+  *moon_flags = 0;
+  if (*distance < MOONEPHEMERA_SUPERMOON_DISTANCE)
+    {
+    *moon_flags |= MOONFLAG_PERIGEE;
+    if (*phase > 0.48 && *phase < 0.52)
+      {
+      *moon_flags |= MOONFLAG_SUPERMOON;
+      }
+    }
+  }
+
+/*============================================================================
+  
+  moonephemera_get_phase_and_distance
+
+  ==========================================================================*/
+void moonephemera_get_phase_and_distance (double jd, double *phase, 
+         double *distance)
+  {
   double day = jd - EPOCH; 
  
   double N = mathutil_fix_angle ((360.0 / 365.2422) * day);                  
@@ -187,21 +215,8 @@ void moonephemera_get_moon_state (double latitude, double longitude,
   double MoonDist = (MSMAX * (1.0 - MECC * MECC)) /
        (1.0 + MECC * mathutil_cos_deg (MmP + mEc));
 
-  double MoonFraction = mathutil_fix_angle (MoonAgeDegrees) / 360.0;
-  *phase = MoonFraction;
-  *age = MoonFraction * SYNMONTH;
+  *phase = mathutil_fix_angle (MoonAgeDegrees) / 360.0;
   *distance = MoonDist;
-  *phase_name = moonephemera_get_phase_name (*phase);
-
-  *moon_flags = 0;
-  if (*distance < 368000)
-    {
-    *moon_flags |= MOONFLAG_PERIGEE;
-    if (*phase > 0.48 && *phase < 0.52)
-      {
-      *moon_flags |= MOONFLAG_SUPERMOON;
-      }
-    }
   }
 
 
@@ -213,7 +228,95 @@ void moonephemera_get_moon_state (double latitude, double longitude,
 void moonephemera_get_ra_and_dec (time_t tu, double *ra, double *dec)
   {
   KLOG_IN
-  double mjd = datetimeconv_time_to_mjd (tu);
+  if (!(chebyshev && moonchebyshev_get_ra_and_dec (chebyshev, tu, ra, dec)))
+    moonephemera_get_ra_and_dec_mjd (datetimeconv_time_to_mjd (tu), ra, dec);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  moonephemera_get_ra_and_dec_mjd
+
+  ==========================================================================*/
+void moonephemera_get_ra_and_dec_mjd (double mjd, double *ra, double *dec)
+  {
+  KLOG_IN
+  double X, Y, Z;
+  moonephemera_get_equatorial_mjd (mjd, &X, &Y, &Z);
+  moonephemera_equatorial_to_ra_and_dec (X, Y, Z, ra, dec);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  moonephemera_get_perturbations
+
+  Sum the periodic terms in the Moon's longitude (DL) and latitude (N), 
+  in arcseconds. Every term is the sine of an integer combination of
+  the fundamental arguments L, LS, D and F, so all of them can be built
+  from the sines and cosines of those four, using the angle-addition 
+  formulae, rather than calling sin() for each term. The results agree
+  with the direct evaluation to within rounding error (about 1e-11
+  arcsec).
+
+  This function is inlined into both the scalar and the vectorized
+  evaluations, so it must not call anything.
+
+  ==========================================================================*/
+static inline void moonephemera_get_perturbations (double sin_L, 
+         double cos_L, double sin_LS, double cos_LS, double sin_D, 
+         double cos_D, double sin_F, double cos_F, double *DL, double *N)
+  {
+  // Double angles
+  double sin_2L = 2 * sin_L * cos_L;
+  double cos_2L = cos_L * cos_L - sin_L * sin_L;
+  double sin_2D = 2 * sin_D * cos_D;
+  double cos_2D = cos_D * cos_D - sin_D * sin_D;
+  double sin_2F = 2 * sin_F * cos_F;
+  double cos_2F = cos_F * cos_F - sin_F * sin_F;
+
+  // L - 2D, and H = F - 2D, which appear in several other terms
+  double sin_L_2D = sin_L * cos_2D - cos_L * sin_2D;
+  double cos_L_2D = cos_L * cos_2D + sin_L * sin_2D;
+  double sin_H = sin_F * cos_2D - cos_F * sin_2D;
+  double cos_H = cos_F * cos_2D + sin_F * sin_2D;
+
+  double _DL = 22640 * sin_L
+       - 4586 * sin_L_2D
+       + 2370 * sin_2D
+       + 769 * sin_2L
+       - 668 * sin_LS
+       - 412 * sin_2F
+       - 212 * (sin_2L * cos_2D - cos_2L * sin_2D)       // 2L - 2D
+       - 206 * (sin_L_2D * cos_LS + cos_L_2D * sin_LS)   // L + LS - 2D
+       + 192 * (sin_L * cos_2D + cos_L * sin_2D)         // L + 2D
+       - 165 * (sin_LS * cos_2D - cos_LS * sin_2D)       // LS - 2D
+       - 125 * sin_D
+       - 110 * (sin_L * cos_LS + cos_L * sin_LS)         // L + LS
+       + 148 * (sin_L * cos_LS - cos_L * sin_LS)         // L - LS
+       - 55 * (sin_2F * cos_2D - cos_2F * sin_2D);       // 2F - 2D
+
+  double _N = -526 * sin_H
+       + 44 * (sin_H * cos_L + cos_H * sin_L)            // L + H
+       - 31 * (sin_H * cos_L - cos_H * sin_L)            // -L + H
+       - 23 * (sin_H * cos_LS + cos_H * sin_LS)          // LS + H
+       + 11 * (sin_H * cos_LS - cos_H * sin_LS)          // -LS + H
+       - 25 * (sin_F * cos_2L - cos_F * sin_2L)          // -2L + F
+       + 21 * (sin_F * cos_L - cos_F * sin_L);           // -L + F
+
+  *DL = _DL;
+  *N = _N;
+  }
+
+/*============================================================================
+  
+  moonephemera_get_equatorial_mjd
+
+  ==========================================================================*/
+void moonephemera_get_equatorial_mjd (double mjd, double *x, double *y, 
+         double *z)
+  {
+  KLOG_IN
   const double CosEPS = 0.91748;
   const double SinEPS = 0.39778;
   const double ARC = 206264.8062;
@@ -228,18 +331,15 @@ void moonephemera_get_ra_and_dec (time_t tu, double *ra, double *dec)
   double D = P2 * mathutil_pascal_frac (0.827361 + 1236.853086 * t);
   double F = P2 * mathutil_pascal_frac (0.259086 + 1342.227825 * t);
 
-  double DL =  22640*sin(L) - 4586*sin(L - 2*D)+ 2370 * sin(2*D);
-  DL +=  +769 * sin(2*L)  - 668*sin(LS) - 412*sin(2*F);
-  DL +=  -212 * sin(2*L - 2*D) - 206*sin(L + LS - 2*D);
-  DL +=  +192 * sin(L + 2*D) - 165 * sin(LS - 2*D);
-  DL +=  -125 * sin(D) - 110 * sin(L + LS) +148 * sin(L - LS);
-  DL +=   -55 * sin(2*F - 2*D);
+  double sin_LS = sin(LS);
+  double sin_F = sin(F);
+  double cos_F = cos(F);
+  double DL, N;
+  moonephemera_get_perturbations (sin(L), cos(L), sin_LS, cos(LS), 
+    sin(D), cos(D), sin_F, cos_F, &DL, &N);
 
-  double S = F + (DL + 412 * sin(2*F) + 541* sin(LS)) / ARC;
-  double H = F - 2*D;
-  double N =   -526 * sin(H)+44 * sin(L + H) -31 * sin(-L + H);
-  N +=   -23*sin(LS + H) + 11*sin(-LS + H) - 25*sin(-2*L + F);
-  N +=   21*sin(-L + F);
+  double sin_2F = 2 * sin_F * cos_F;
+  double S = F + (DL + 412 * sin_2F + 541* sin_LS) / ARC;
 
   double L_moon = P2 * mathutil_pascal_frac(L0 + DL / 1296000);
   double B_moon = (18520.0 * sin(S) + N) /ARC;
@@ -249,6 +349,77 @@ void moonephemera_get_ra_and_dec (time_t tu, double *ra, double *dec)
   double W = sin(B_moon);
   double Y = CosEPS * V - SinEPS * W;
   double Z = SinEPS * V + CosEPS * W;
+
+  *x = X;
+  *y = Y;
+  *z = Z;
+
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  moonephemera_get_equatorial_batch
+
+  The same series as moonephemera_get_equatorial_mjd(), evaluated for n
+  times at once. The times are in julian centuries from J2000. The loop 
+  body makes no function calls, so the compiler can vectorize it, taking 
+  several samples per instruction.
+
+  ==========================================================================*/
+FASTTRIG_CLONES
+static void moonephemera_get_equatorial_batch (const double *restrict times,
+         int n, double *restrict x, double *restrict y, double *restrict z)
+  {
+  const double CosEPS = 0.91748;
+  const double SinEPS = 0.39778;
+  const double ARC = 206264.8062;
+  const double P2 = TWO_PI;
+
+  for (int i = 0; i < n; i++)
+    {
+    double t = times[i];
+    double L0 = fasttrig_frac (0.606433 + 1336.855225 * t);
+    double L = P2 * fasttrig_frac (0.374897 + 1325.552410 * t);
+    double LS = P2 * fasttrig_frac (0.993133 + 99.997361 * t);
+    double D = P2 * fasttrig_frac (0.827361 + 1236.853086 * t);
+    double F = P2 * fasttrig_frac (0.259086 + 1342.227825 * t);
+
+    double sin_L, cos_L, sin_LS, cos_LS, sin_D, cos_D, sin_F, cos_F, c;
+    fasttrig_sincos (L, &sin_L, &cos_L);
+    fasttrig_sincos (LS, &sin_LS, &cos_LS);
+    fasttrig_sincos (D, &sin_D, &cos_D);
+    fasttrig_sincos (F, &sin_F, &cos_F);
+    double DL, N;
+    moonephemera_get_perturbations (sin_L, cos_L, sin_LS, cos_LS, 
+      sin_D, cos_D, sin_F, cos_F, &DL, &N);
+
+    double sin_2F = 2 * sin_F * cos_F;
+    double S = F + (DL + 412 * sin_2F + 541 * sin_LS) / ARC;
+
+    double L_moon = P2 * fasttrig_frac (L0 + DL / 1296000);
+    double SS, SB, CB, SL, CL;
+    fasttrig_sincos (S, &SS, &c);
+    double B_moon = (18520.0 * SS + N) / ARC;
+    fasttrig_sincos (B_moon, &SB, &CB);
+    fasttrig_sincos (L_moon, &SL, &CL);
+    double V = CB * SL;
+    x[i] = CB * CL;
+    y[i] = CosEPS * V - SinEPS * SB;
+    z[i] = SinEPS * V + CosEPS * SB;
+    }
+  }
+
+/*============================================================================
+  
+  moonephemera_equatorial_to_ra_and_dec
+
+  ==========================================================================*/
+void moonephemera_equatorial_to_ra_and_dec (double X, double Y, double Z,
+         double *ra, double *dec)
+  {
+  KLOG_IN
+  const double P2 = TWO_PI;
   double RHO = sqrt(1.0 - Z*Z);
   double _dec = (360.0 / P2) * atan(Z / RHO);
   double _ra = (48.0 / P2) * atan(Y / (X + RHO));
@@ -261,5 +432,72 @@ void moonephemera_get_ra_and_dec (time_t tu, double *ra, double *dec)
   KLOG_OUT
   }
 
+/*============================================================================
+  
+  moonephemera_get_ra_and_dec_batch
+
+  ==========================================================================*/
+void moonephemera_get_ra_and_dec_batch (const time_t *times, int n, 
+         double *ra, double *dec)
+  {
+  KLOG_IN
+  if (chebyshev)
+    {
+    // The tabulated ephemeris is already cheaper than the vectorized
+    //  series, so there's nothing to gain by batching
+    for (int i = 0; i < n; i++)
+      moonephemera_get_ra_and_dec (times[i], &ra[i], &dec[i]);
+    }
+  else
+    {
+    double *x = (double *) malloc (4 * n * sizeof (double));
+    double *y = x + n;
+    double *z = y + n;
+    double *t = z + n;
+    // Converting a time_t to a double can't be vectorized without
+    //  AVX-512, so it's done here rather than in the batch
+    for (int i = 0; i < n; i++)
+      {
+      double JD = datetimeconv_time_to_mjd (times[i]) + 2400000.5;
+      t[i] = (JD - 2451545.0) / 36525.0;
+      }
+    moonephemera_get_equatorial_batch (t, n, x, y, z);
+    for (int i = 0; i < n; i++)
+      moonephemera_equatorial_to_ra_and_dec (x[i], y[i], z[i], 
+        &ra[i], &dec[i]);
+    free (x);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  moonephemera_get_sin_altitude_batch
+
+  ==========================================================================*/
+void moonephemera_get_sin_altitude_batch (double latitude, double longitude,
+         const time_t *times, int n, double *sin_altitude)
+  {
+  KLOG_IN
+  double *ra = (double *) malloc (2 * n * sizeof (double));
+  double *dec = ra + n;
+  moonephemera_get_ra_and_dec_batch (times, n, ra, dec);
+  for (int i = 0; i < n; i++)
+    sin_altitude[i] = astroutil_ra_dec_to_sin_altitude (times[i], latitude, 
+      longitude, ra[i], dec[i]);
+  free (ra);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  moonephemera_set_chebyshev
 
+  ==========================================================================*/
+void moonephemera_set_chebyshev (const MoonChebyshev *mc)
+  {
+  KLOG_IN
+  chebyshev = mc;
+  KLOG_OUT
+  }
 
@@ -0,0 +1,280 @@
+/*============================================================================
+  
+  libsolunar
+  
+  moonevents.c
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <memory.h>
+#include <assert.h>
+#include <math.h>
+#include <libsolunar/moonephemera.h>
+#include <libsolunar/moonevents.h>
+#include <klib/klog.h>
+
+#define KLOG_CLASS "libsolunar.moonevents"
+
+// Mean lengths of the month, from one new moon to the next, and from
+//  one perigee to the next, in days
+#define SYNODIC_MONTH 29.53058868
+#define ANOMALISTIC_MONTH 27.55454988
+
+// How far either side of its predicted time to look for an event, in
+//  days. The true phases differ from the mean by less than a day,
+//  and the apsides in the ephemeris by less than that. Both
+//  must be well under half the spacing between successive events of the
+//  same kind, or the bracket might contain two of them
+#define PHASE_BRACKET 2.0
+#define APSIS_BRACKET 4.0
+
+// Events are reported as time_t, so there's no point refining beyond
+//  a second
+#define TOLERANCE (1.0 / 86400.0)
+
+// Interval used to take the rate of change of the Moon's distance
+#define RATE_STEP (1.0 / 24.0)
+
+/*============================================================================
+  
+  MoonEventsList
+
+  A growable array of events
+
+  ==========================================================================*/
+typedef struct _MoonEventsList
+  {
+  MoonEvent *events;
+  int count;
+  int size;
+  } MoonEventsList;
+
+/*============================================================================
+  
+  moonevents_jd_to_time
+
+  datetimeconv_jd_to_time() truncates, but we want the nearest second
+
+  ==========================================================================*/
+static time_t moonevents_jd_to_time (double jd)
+  {
+  return (time_t) floor (86400.0 * (jd - 2440587.5) + 0.5);
+  }
+
+/*============================================================================
+  
+  moonevents_phase_fn
+
+  The difference between the Moon's phase and the target phase (passed
+  as user_data), wrapped into the range -0.5..0.5. It crosses zero
+  upwards at the instant of the target phase
+
+  ==========================================================================*/
+static double moonevents_phase_fn (double jd, void *user_data)
+  {
+  double target = *(const double *)user_data;
+  double phase, distance;
+  moonephemera_get_phase_and_distance (jd, &phase, &distance);
+  double diff = phase - target;
+  return diff - floor (diff + 0.5);
+  }
+
+/*============================================================================
+  
+  moonevents_distance_rate_fn
+
+  The rate at which the Moon's distance is increasing, which crosses
+  zero upwards at perigee, and downwards at apogee. The scale doesn't
+  matter, because only the sign is used
+
+  ==========================================================================*/
+static double moonevents_distance_rate_fn (double jd, void *user_data)
+  {
+  (void)user_data;
+  double phase, before, after;
+  moonephemera_get_phase_and_distance (jd - RATE_STEP, &phase, &before);
+  moonephemera_get_phase_and_distance (jd + RATE_STEP, &phase, &after);
+  return after - before;
+  }
+
+/*============================================================================
+  
+  moonevents_add
+
+  ==========================================================================*/
+static void moonevents_add (MoonEventsList *list, MoonEventType type,
+      double jd)
+  {
+  if (list->count == list->size)
+    {
+    list->size = list->size ? 2 * list->size : 16;
+    list->events = realloc (list->events, list->size * sizeof (MoonEvent));
+    }
+  MoonEvent *e = &list->events[list->count++];
+  double phase;
+  e->type = type;
+  e->time = moonevents_jd_to_time (jd);
+  moonephemera_get_phase_and_distance (jd, &phase, &e->distance);
+  }
+
+/*============================================================================
+  
+  moonevents_find_series
+
+  Find successive events of one type, each of which is a zero of fn
+  crossed in the direction given by 'rising'. The first is expected
+  near 'guess', and each subsequent one about 'period' days after
+  the last. The root finder is given a bracket of 'half_width' days
+  either side of the prediction. Events between jd_start (inclusive)
+  and jd_end (exclusive) are added to the list.
+
+  ==========================================================================*/
+static void moonevents_find_series (MathUtilFn fn, void *user_data,
+      BOOL rising, MoonEventType type, double guess, double period,
+      double half_width, time_t start, time_t end, double jd_end,
+      MoonEventsList *list, int *evals)
+  {
+  KLOG_IN
+  while (guess - half_width < jd_end)
+    {
+    double a = guess - half_width;
+    double b = guess + half_width;
+    double fa = fn (a, user_data);
+    double fb = fn (b, user_data);
+    *evals += 2;
+    if ((fa < 0) == rising && (fb < 0) != rising)
+      {
+      double jd = mathutil_find_root (fn, user_data, a, b, fa, fb,
+        TOLERANCE, evals);
+      time_t t = moonevents_jd_to_time (jd);
+      if (t >= start && t < end)
+        moonevents_add (list, type, jd);
+      guess = jd + period;
+      }
+    else
+      {
+      // Shouldn't happen, given the widths of the brackets. But if
+      //  it does, skip to the next prediction rather than giving up
+      klog_warn (KLOG_CLASS, "No %s within %g days of JD %f",
+        moonevents_get_type_name (type), half_width, guess);
+      guess += period;
+      }
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  moonevents_sort_fn
+
+  ==========================================================================*/
+static int moonevents_sort_fn (const void *a, const void *b)
+  {
+  const MoonEvent *e1 = a;
+  const MoonEvent *e2 = b;
+  if (e1->time < e2->time) return -1;
+  if (e1->time > e2->time) return 1;
+  return 0;
+  }
+
+/*============================================================================
+  
+  moonevents_find
+
+  ==========================================================================*/
+MoonEvent *moonevents_find (time_t start, time_t end, int types, 
+      int *count)
+  {
+  KLOG_IN
+  MoonEventsList list = { NULL, 0, 0 };
+  int evals = 0;
+
+  if (end > start)
+    {
+    double jd_start = datetimeconv_time_to_jd (start);
+    double jd_end = datetimeconv_time_to_jd (end);
+
+    // Principal phases. The first of each is predicted from the phase
+    //  at the start, assuming the mean rate of change
+    double phase, distance;
+    moonephemera_get_phase_and_distance (jd_start, &phase, &distance);
+    evals++;
+    double targets[4] = { 0.0, 0.25, 0.5, 0.75 };
+    for (int i = 0; i < 4; i++)
+      {
+      if (!(types & MOONEVENTS_TYPE (MOONEVENT_NEW + i))) continue;
+      double ahead = targets[i] - phase;
+      ahead -= floor (ahead);
+      moonevents_find_series (moonevents_phase_fn, &targets[i], TRUE,
+        MOONEVENT_NEW + i, jd_start + ahead * SYNODIC_MONTH, SYNODIC_MONTH,
+        PHASE_BRACKET, start, end, jd_end, &list, &evals);
+      }
+
+    // Apsides. There's no simple way to predict the first of these, so
+    //  step a day at a time until the rate of change of distance
+    //  has changed sign in both directions
+    BOOL want_perigee = (types & MOONEVENTS_TYPE (MOONEVENT_PERIGEE)) != 0;
+    BOOL want_apogee = (types & MOONEVENTS_TYPE (MOONEVENT_APOGEE)) != 0;
+    if (want_perigee || want_apogee)
+      {
+      double perigee = 0, apogee = 0;
+      double x0 = jd_start;
+      double f0 = moonevents_distance_rate_fn (x0, NULL);
+      evals++;
+      for (int i = 1; i <= (int)ANOMALISTIC_MONTH + 1 
+            && ((want_perigee && perigee == 0) 
+              || (want_apogee && apogee == 0)); i++)
+        {
+        double x1 = jd_start + i;
+        double f1 = moonevents_distance_rate_fn (x1, NULL);
+        evals++;
+        if (f0 < 0 && f1 >= 0 && perigee == 0) perigee = 0.5 * (x0 + x1);
+        if (f0 >= 0 && f1 < 0 && apogee == 0) apogee = 0.5 * (x0 + x1);
+        x0 = x1;
+        f0 = f1;
+        }
+      if (want_perigee && perigee != 0)
+        moonevents_find_series (moonevents_distance_rate_fn, NULL, TRUE,
+          MOONEVENT_PERIGEE, perigee, ANOMALISTIC_MONTH, APSIS_BRACKET,
+          start, end, jd_end, &list, &evals);
+      if (want_apogee && apogee != 0)
+        moonevents_find_series (moonevents_distance_rate_fn, NULL, FALSE,
+          MOONEVENT_APOGEE, apogee, ANOMALISTIC_MONTH, APSIS_BRACKET,
+          start, end, jd_end, &list, &evals);
+      }
+
+    qsort (list.events, list.count, sizeof (MoonEvent), moonevents_sort_fn);
+    }
+
+  klog_debug (KLOG_CLASS, "%d evaluations for %d events", evals,
+    list.count);
+
+  *count = list.count;
+  KLOG_OUT
+  return list.events;
+  }
+
+/*============================================================================
+  
+  moonevents_get_type_name
+
+  ==========================================================================*/
+const char *moonevents_get_type_name (MoonEventType type)
+  {
+  switch (type)
+    {
+    case MOONEVENT_NEW: return "New moon";
+    case MOONEVENT_FIRST_QUARTER: return "First quarter";
+    case MOONEVENT_FULL: return "Full moon";
+    case MOONEVENT_LAST_QUARTER: return "Last quarter";
+    case MOONEVENT_PERIGEE: return "Perigee";
+    case MOONEVENT_APOGEE: return "Apogee";
+    }
+  return "?";
+  }
+
@@ -17,6 +17,7 @@
 #include <libsolunar/moonephemera.h>
 #include <libsolunar/moontimes.h>
 #include <libsolunar/astroutil.h>
+#include <libsolunar/solephemeris.h>
 #include <klib/klog.h>
 
 //static const double DEG_PER_HOUR = 360.0 / 24.0;
@@ -24,92 +25,394 @@
 
 #define KLOG_CLASS "libsolunar.moontimes"
 
-#define INTERVAL (15*60)
+// Step used to bracket horizon crossings. The Moon's altitude curve is
+//  smooth enough that an hour's sampling, backed up by the check for
+//  a grazing extremum between samples, won't miss an event.
+#define INTERVAL MOONTIMES_INTERVAL
+
+// The results are time_t, so there's no point refining beyond a second
+#define TOLERANCE 1.0
 
 /*============================================================================
   
-  moontimes_get_moonrises
+  MoonTimesObserver
+
+  Passed to the root finder, which works in seconds after 'start'
 
   ==========================================================================*/
-void moontimes_get_moonrises (time_t start, time_t end, double latitude, 
-      double longitude, time_t *rises, int max, int *count) 
+typedef struct _MoonTimesObserver
+  {
+  time_t start;
+  double latitude;
+  double longitude;
+  } MoonTimesObserver;
+
+/*============================================================================
+  
+  moontimes_sin_altitude_fn
+
+  ==========================================================================*/
+static double moontimes_sin_altitude_fn (double x, void *user_data)
+  {
+  const MoonTimesObserver *obs = user_data;
+  return moonephemera_get_sin_altitude (obs->latitude, obs->longitude, 
+      obs->start + (time_t)floor (x + 0.5));
+  }
+
+/*============================================================================
+  
+  moontimes_sin_hour_angle_fn
+
+  The sine of the hour angle crosses zero upwards at upper transit, and
+  downwards at lower transit
+
+  ==========================================================================*/
+static double moontimes_sin_hour_angle_fn (double x, void *user_data)
+  {
+  const MoonTimesObserver *obs = user_data;
+  time_t t = obs->start + (time_t)floor (x + 0.5);
+  double ra, dec;
+  moonephemera_get_ra_and_dec (t, &ra, &dec);
+  return mathutil_sin_deg (astroutil_get_hour_angle (t, obs->longitude, ra));
+  }
+
+/*============================================================================
+  
+  moontimes_get_npoints
+
+  ==========================================================================*/
+static int moontimes_get_npoints (time_t start, time_t end)
   {
-  KLOG_IN
-  assert (end > start);
   int diff = end - start;
-  int npoints = diff / INTERVAL + 1;
-  *count = 0;
+  return (diff + INTERVAL - 1) / INTERVAL + 1;
+  }
+
+/*============================================================================
+  
+  moontimes_sample
 
-  double *x = (double *) malloc (npoints * sizeof (double));
-  double *y = (double *) malloc (npoints * sizeof (double));
-  double *d_events = malloc (max * sizeof (double));
+  Fill x with the sample offsets from obs->start, always including a
+  sample exactly at the end of the period, even if it does not fall on
+  a multiple of INTERVAL. The sine altitude is written to alt and, if
+  sin_ha is not NULL, the sine of the hour angle to sin_ha. Both come
+  from the same evaluation of the Moon's position. If carry is not NULL,
+  and holds the sample at the start of the period, that sample is used
+  rather than worked out again; the sample at the end is then stored in
+  carry, in which case sin_ha must not be NULL. Samples that are in eph,
+  if it is not NULL, are not worked out again either. Returns the number
+  of samples whose Moon position was worked out.
 
-  time_t tx = start;
+  ==========================================================================*/
+static int moontimes_sample (const MoonTimesObserver *obs, time_t end, 
+      double *x, double *alt, double *sin_ha, const SolEphemeris *eph,
+      MoonTimesCarry *carry)
+  {
+  KLOG_IN
+  int diff = end - obs->start;
+  int npoints = moontimes_get_npoints (obs->start, end);
+  time_t *times = (time_t *) malloc (2 * npoints * sizeof (time_t));
+  time_t *missing_times = times + npoints;
+  int *missing = (int *) malloc (npoints * sizeof (int));
+  double *ra = (double *) malloc (5 * npoints * sizeof (double));
+  double *dec = ra + npoints;
+  double *gmst = dec + npoints;
+  double *missing_ra = gmst + npoints;
+  double *missing_dec = missing_ra + npoints;
   for (int i = 0; i < npoints; i++)
     {
-    double alt = moonephemera_get_sin_altitude
-      (latitude, longitude, tx);
-    x[i] = i * INTERVAL;
-    y[i] = alt;
-    tx += INTERVAL;
+    x[i] = (i == npoints - 1) ? diff : (double)i * INTERVAL;
+    times[i] = obs->start + (time_t)x[i];
+    }
+  int first = 0;
+  if (carry && carry->time == obs->start 
+       && carry->latitude == obs->latitude 
+       && carry->longitude == obs->longitude)
+    {
+    alt[0] = carry->sin_altitude;
+    sin_ha[0] = carry->sin_hour_angle;
+    first = 1;
+    }
+  // Take what we can from the shared ephemeris, and note the rest
+  int nmissing = 0;
+  for (int i = first; i < npoints; i++)
+    {
+    const SolEphemerisSample *s = eph ? solephemeris_find (eph, times[i]) 
+      : NULL;
+    if (s)
+      {
+      ra[i] = s->moon_ra;
+      dec[i] = s->moon_dec;
+      gmst[i] = s->gmst;
+      }
+    else
+      {
+      missing_times[nmissing] = times[i];
+      missing[nmissing++] = i;
+      }
+    }
+  // The Moon's position is by far the most expensive part, so get it
+  //  for all the missing samples in one go
+  moonephemera_get_ra_and_dec_batch (missing_times, nmissing, missing_ra, 
+    missing_dec);
+  for (int j = 0; j < nmissing; j++)
+    {
+    int i = missing[j];
+    ra[i] = missing_ra[j];
+    dec[i] = missing_dec[j];
+    gmst[i] = astroutil_gmst (times[i]);
+    }
+  for (int i = first; i < npoints; i++)
+    {
+    alt[i] = astroutil_gmst_ra_dec_to_sin_altitude (gmst[i], obs->latitude, 
+      obs->longitude, ra[i], dec[i]);
+    if (sin_ha)
+      sin_ha[i] = mathutil_sin_deg 
+        (astroutil_get_hour_angle_gmst (gmst[i], obs->longitude, ra[i]));
+    }
+  if (carry)
+    {
+    carry->time = end;
+    carry->latitude = obs->latitude;
+    carry->longitude = obs->longitude;
+    carry->sin_altitude = alt[npoints - 1];
+    carry->sin_hour_angle = sin_ha[npoints - 1];
     }
+  free (ra);
+  free (missing);
+  free (times);
+  KLOG_OUT
+  return nmissing;
+  }
 
-  mathutil_get_positive_axis_crossings (x, y, npoints, d_events,
-    max, count);
-  // Axis crossing times are in seconds after the first x value, that
-  //  is, seconds after the 'start' value
+/*============================================================================
+  
+  moontimes_refine
 
-  for (int i = 0; i < *count; i++)
-    rises[i] = start + d_events[i];
+  Refine a bracketed crossing, and store it as an upward or downward
+  crossing according to the signs at the ends of the bracket
 
-  free (d_events);
-  free (x);
-  free (y);
+  ==========================================================================*/
+static void moontimes_refine (MathUtilFn fn, MoonTimesObserver *obs, 
+      double a, double b, double fa, double fb, time_t *ups, int *nups, 
+      time_t *downs, int *ndowns, int max, int *evals)
+  {
+  time_t *events = NULL;
+  int *count = NULL;
+  if (fa < 0 && fb >= 0)
+    {
+    events = ups; count = nups;
+    }
+  else if (fa >= 0 && fb < 0)
+    {
+    events = downs; count = ndowns;
+    }
+  if (events && *count < max)
+    {
+    double r = mathutil_find_root (fn, obs, a, b, fa, fb, TOLERANCE, evals);
+    events[(*count)++] = obs->start + (time_t)floor (r + 0.5);
+    }
+  }
+
+/*============================================================================
+  
+  moontimes_find_crossings
+
+  Find the upward and downward zero crossings of fn, given samples y at 
+  offsets x. Each crossing bracketed by the samples is refined using the
+  root finder. If grazing is TRUE, then where three consecutive samples
+  have the same sign, but a parabola through them has a vertex of the
+  opposite sign, the function may have crossed zero and come back
+  between samples; the vertex is then evaluated, to split the interval
+  into two brackets. Either ups or downs may be NULL, if only one
+  direction is of interest.
+
+  ==========================================================================*/
+static void moontimes_find_crossings (MathUtilFn fn, MoonTimesObserver *obs,
+      const double *x, const double *y, int npoints, BOOL grazing, 
+      time_t *ups, int *nups, time_t *downs, int *ndowns, int max, 
+      int *evals)
+  {
+  KLOG_IN
+  int dummy;
+  if (!ups) nups = &dummy;
+  if (!downs) ndowns = &dummy;
+  *nups = 0;
+  *ndowns = 0;
+
+  for (int i = 1; i < npoints; i++)
+    {
+    double x0 = x[i - 1], y0 = y[i - 1];
+    double x1 = x[i], y1 = y[i];
+
+    if (grazing && i < npoints - 1 && (y0 < 0) == (y1 < 0) 
+         && (y1 < 0) == (y[i + 1] < 0))
+      {
+      double x2 = x[i + 1], y2 = y[i + 1];
+      double A = 0.5 * (y0 + y2) - y1;
+      double B = 0.5 * (y2 - y0);
+      if (A != 0.0)
+        {
+        double xe = -B / (2.0 * A);
+        double ye = y1 - B * B / (4.0 * A);
+        if (xe > -1 && xe < 1 && (ye < 0) != (y1 < 0))
+          {
+          double xa = xe < 0 ? x0 : x1;
+          double ya = xe < 0 ? y0 : y1;
+          double xb = xe < 0 ? x1 : x2;
+          double yb = xe < 0 ? y1 : y2;
+          double xv = xa + (xe < 0 ? 1 + xe : xe) * (xb - xa);
+          double yv = fn (xv, obs);
+          (*evals)++;
+          if ((yv < 0) != (y1 < 0))
+            {
+            moontimes_refine (fn, obs, xa, xv, ya, yv, ups, nups, 
+              downs, ndowns, max, evals);
+            moontimes_refine (fn, obs, xv, xb, yv, yb, ups, nups, 
+              downs, ndowns, max, evals);
+            // If the vertex was after sample i, the next interval has
+            //   been dealt with as well
+            if (xe >= 0) i++;
+            continue;
+            }
+          }
+        }
+      }
+
+    moontimes_refine (fn, obs, x0, x1, y0, y1, ups, nups, downs, ndowns, 
+      max, evals);
+    }
 
   KLOG_OUT
   }
 
 /*============================================================================
   
-  moontimes_get_moonsets
+  moontimes_get_events
 
   ==========================================================================*/
-void moontimes_get_moonsets (time_t start, time_t end, double latitude, 
-      double longitude, time_t *rises, int max, int *count) 
+void moontimes_get_events (time_t start, time_t end, double latitude, 
+      double longitude, MoonTimesEvents *events)
+  {
+  KLOG_IN
+  moontimes_get_events_ephemeris (start, end, latitude, longitude, NULL,
+    NULL, events);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  moontimes_get_events_carry
+
+  ==========================================================================*/
+void moontimes_get_events_carry (time_t start, time_t end, double latitude, 
+      double longitude, MoonTimesCarry *carry, MoonTimesEvents *events)
+  {
+  KLOG_IN
+  moontimes_get_events_ephemeris (start, end, latitude, longitude, NULL,
+    carry, events);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  moontimes_get_events_ephemeris
+
+  ==========================================================================*/
+void moontimes_get_events_ephemeris (time_t start, time_t end, 
+      double latitude, double longitude, const SolEphemeris *eph, 
+      MoonTimesCarry *carry, MoonTimesEvents *events)
   {
   KLOG_IN
   assert (end > start);
-  int diff = end - start;
-  int npoints = diff / INTERVAL + 1;
-  *count = 0;
+  memset (events, 0, sizeof (MoonTimesEvents));
+  MoonTimesObserver obs = { start, latitude, longitude };
+  int npoints = moontimes_get_npoints (start, end);
 
-  double *x = (double *) malloc (npoints * sizeof (double));
-  double *y = (double *) malloc (npoints * sizeof (double));
-  double *d_events = malloc (max * sizeof (double));
+  double *x = (double *) malloc (3 * npoints * sizeof (double));
+  double *alt = x + npoints;
+  double *sin_ha = alt + npoints;
 
-  time_t tx = start;
-  for (int i = 0; i < npoints; i++)
+  int evals = moontimes_sample (&obs, end, x, alt, sin_ha, eph, carry);
+
+  moontimes_find_crossings (moontimes_sin_altitude_fn, &obs, x, alt, 
+    npoints, TRUE, events->rises, &events->nrises, events->sets, 
+    &events->nsets, MOONTIMES_MAX_EVENTS, &evals);
+
+  moontimes_find_crossings (moontimes_sin_hour_angle_fn, &obs, x, sin_ha, 
+    npoints, FALSE, events->upper_transits, &events->nupper_transits, 
+    events->lower_transits, &events->nlower_transits, 
+    MOONTIMES_MAX_EVENTS, &evals);
+
+  // The highest point in the period is either at an upper transit
+  //  or, failing that, at one end of the period
+  double max_alt = alt[0];
+  events->max_altitude_time = start;
+  if (alt[npoints - 1] > max_alt)
     {
-    double alt = moonephemera_get_sin_altitude
-      (latitude, longitude, tx);
-    x[i] = i * INTERVAL;
-    y[i] = alt;
-    tx += INTERVAL;
+    max_alt = alt[npoints - 1];
+    events->max_altitude_time = end;
     }
+  for (int i = 0; i < events->nupper_transits; i++)
+    {
+    time_t t = events->upper_transits[i];
+    double a = moontimes_sin_altitude_fn (t - start, &obs);
+    evals++;
+    if (a > max_alt)
+      {
+      max_alt = a;
+      events->max_altitude_time = t;
+      }
+    }
+  if (max_alt > 1) max_alt = 1;
+  events->max_altitude = mathutil_asin_deg (max_alt);
 
-  mathutil_get_negative_axis_crossings (x, y, npoints, d_events,
-    max, count);
-  // Axis crossing times are in seconds after the first x value, that
-  //  is, seconds after the 'start' value
-
-  for (int i = 0; i < *count; i++)
-    rises[i] = start + d_events[i];
+  klog_debug (KLOG_CLASS, "%d evaluations for %d rises, %d sets, %d transits",
+    evals, events->nrises, events->nsets, 
+    events->nupper_transits + events->nlower_transits);
 
-  free (d_events);
   free (x);
-  free (y);
+  KLOG_OUT
+  }
 
+/*============================================================================
+  
+  moontimes_get_moonrises
+
+  ==========================================================================*/
+void moontimes_get_moonrises (time_t start, time_t end, double latitude, 
+      double longitude, time_t *rises, int max, int *count) 
+  {
+  KLOG_IN
+  assert (end > start);
+  MoonTimesObserver obs = { start, latitude, longitude };
+  int npoints = moontimes_get_npoints (start, end);
+  double *x = (double *) malloc (2 * npoints * sizeof (double));
+  double *y = x + npoints;
+  int evals = moontimes_sample (&obs, end, x, y, NULL, NULL, NULL);
+  moontimes_find_crossings (moontimes_sin_altitude_fn, &obs, x, y, npoints, 
+    TRUE, rises, count, NULL, NULL, max, &evals);
+  free (x);
   KLOG_OUT
   }
 
+/*============================================================================
+  
+  moontimes_get_moonsets
+
+  ==========================================================================*/
+void moontimes_get_moonsets (time_t start, time_t end, double latitude, 
+      double longitude, time_t *sets, int max, int *count) 
+  {
+  KLOG_IN
+  assert (end > start);
+  MoonTimesObserver obs = { start, latitude, longitude };
+  int npoints = moontimes_get_npoints (start, end);
+  double *x = (double *) malloc (2 * npoints * sizeof (double));
+  double *y = x + npoints;
+  int evals = moontimes_sample (&obs, end, x, y, NULL, NULL, NULL);
+  moontimes_find_crossings (moontimes_sin_altitude_fn, &obs, x, y, npoints, 
+    TRUE, NULL, NULL, sets, count, max, &evals);
+  free (x);
+  KLOG_OUT
+  }
 
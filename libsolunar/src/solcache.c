@@ -0,0 +1,641 @@
+/*============================================================================
+  
+  libsolunar
+  
+  solcache.c
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <libsolunar/solcache.h>
+#include <klib/klog.h>
+
+#define KLOG_CLASS "libsolunar.solcache"
+
+#define SOLCACHE_MAGIC "SOLCACH"
+#define SOLCACHE_FORMAT 1
+#define SOLCACHE_BYTE_ORDER 0x01020304
+
+// The number of records there is room for in a new file, and the most
+//  there can be room for, which is a file of about 14Mb. Both must be
+//  powers of two
+#define SOLCACHE_MIN_RECORDS 1024
+#define SOLCACHE_MAX_RECORDS 32768
+
+// The longest timezone name that can be cached, including the
+//  terminating zero, and the longest tag
+#define SOLCACHE_MAX_TZ 48
+#define SOLCACHE_MAX_TAG 256
+
+/*============================================================================
+  
+  SolCacheHeader
+
+  The layout of the start of the file. It is followed by these sections:
+
+    uint32_t buckets[2 * capacity]   the hash table: the index of a
+                                      record plus one, or zero if empty
+    SolCacheEntry entries[capacity]  in the order they were added
+
+  ==========================================================================*/
+typedef struct _SolCacheHeader
+  {
+  char magic[8];
+  uint32_t format;
+  uint32_t byte_order;
+  char tag[SOLCACHE_MAX_TAG];  // The library version, then the source
+  uint32_t capacity;
+  uint32_t nrecords;
+  uint64_t clock;              // Advanced each time a record is used
+  } SolCacheHeader;
+
+/*============================================================================
+  
+  SolCacheEntry
+
+  ==========================================================================*/
+typedef struct _SolCacheEntry
+  {
+  uint64_t hash;
+  uint64_t last_used;          // The clock when the record was last used
+  int64_t date;
+  int32_t latitude;            // In units of SOLCACHE_QUANTUM
+  int32_t longitude;
+  char tz[SOLCACHE_MAX_TZ];
+  SolunarDayRecord record;
+  } SolCacheEntry;
+
+/*============================================================================
+  
+  SolCacheKey
+
+  ==========================================================================*/
+typedef struct _SolCacheKey
+  {
+  uint64_t hash;
+  int64_t date;
+  int32_t latitude;
+  int32_t longitude;
+  const char *tz;
+  } SolCacheKey;
+
+/*============================================================================
+  
+  SolCache
+
+  The file is mapped only while it is locked, so that another program
+  can change its size in between
+
+  ==========================================================================*/
+struct _SolCache
+  {
+  char *path;
+  char tag[SOLCACHE_MAX_TAG];
+  int fd;                      // -1 if the file could not be reopened
+  void *map;
+  size_t map_size;
+  SolCacheHeader *header;
+  uint32_t *buckets;
+  SolCacheEntry *entries;
+  };
+
+/*============================================================================
+  
+  solcache_file_size
+
+  ==========================================================================*/
+static size_t solcache_file_size (uint32_t capacity)
+  {
+  return sizeof (SolCacheHeader) + 2 * (size_t)capacity * sizeof (uint32_t)
+    + (size_t)capacity * sizeof (SolCacheEntry);
+  }
+
+/*============================================================================
+  
+  solcache_set_map
+
+  ==========================================================================*/
+static void solcache_set_map (SolCache *self, void *map, size_t size)
+  {
+  self->map = map;
+  self->map_size = size;
+  self->header = map;
+  self->buckets = (uint32_t *)(self->header + 1);
+  self->entries = (SolCacheEntry *)(self->buckets
+    + 2 * self->header->capacity);
+  }
+
+/*============================================================================
+  
+  solcache_unmap
+
+  ==========================================================================*/
+static void solcache_unmap (SolCache *self)
+  {
+  if (self->map) munmap (self->map, self->map_size);
+  self->map = NULL;
+  self->header = NULL;
+  }
+
+/*============================================================================
+  
+  solcache_create_file
+
+  Make the file open on fd an empty cache with room for capacity records,
+  and map it. Returns NULL, having logged the reason, if it can't be
+
+  ==========================================================================*/
+static void *solcache_create_file (const SolCache *self, int fd,
+      uint32_t capacity, size_t *size)
+  {
+  KLOG_IN
+  void *map = NULL;
+  *size = solcache_file_size (capacity);
+  // Truncating first clears the hash table
+  if (ftruncate (fd, 0) == 0 && ftruncate (fd, *size) == 0)
+    {
+    map = mmap (NULL, *size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+      map = NULL;
+    else
+      {
+      SolCacheHeader *h = map;
+      memcpy (h->magic, SOLCACHE_MAGIC, 8);
+      h->format = SOLCACHE_FORMAT;
+      h->byte_order = SOLCACHE_BYTE_ORDER;
+      memcpy (h->tag, self->tag, SOLCACHE_MAX_TAG);
+      h->capacity = capacity;
+      }
+    }
+  if (!map)
+    klog_error (KLOG_CLASS, "Can't create cache %s: %s", self->path,
+      strerror (errno));
+  KLOG_OUT
+  return map;
+  }
+
+/*============================================================================
+  
+  solcache_map
+
+  Map the file, if it is a valid cache made by this version of the
+  library from the same source. If it is not, it is made an empty one
+
+  ==========================================================================*/
+static BOOL solcache_map (SolCache *self)
+  {
+  KLOG_IN
+  struct stat sb;
+  size_t size = fstat (self->fd, &sb) == 0 ? sb.st_size : 0;
+  if (size >= sizeof (SolCacheHeader))
+    {
+    void *map = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      self->fd, 0);
+    if (map != MAP_FAILED)
+      {
+      const SolCacheHeader *h = map;
+      if (memcmp (h->magic, SOLCACHE_MAGIC, 8) == 0
+           && h->format == SOLCACHE_FORMAT
+           && h->byte_order == SOLCACHE_BYTE_ORDER
+           && memcmp (h->tag, self->tag, SOLCACHE_MAX_TAG) == 0
+           && h->capacity >= SOLCACHE_MIN_RECORDS
+           && h->capacity <= SOLCACHE_MAX_RECORDS
+           && (h->capacity & (h->capacity - 1)) == 0
+           && h->nrecords <= h->capacity
+           && size == solcache_file_size (h->capacity))
+        solcache_set_map (self, map, size);
+      else
+        {
+        klog_debug (KLOG_CLASS, "Discarding %s", self->path);
+        munmap (map, size);
+        }
+      }
+    }
+
+  if (!self->map)
+    {
+    void *map = solcache_create_file (self, self->fd, SOLCACHE_MIN_RECORDS,
+      &size);
+    if (map) solcache_set_map (self, map, size);
+    }
+  KLOG_OUT
+  return self->map != NULL;
+  }
+
+/*============================================================================
+  
+  solcache_discard
+
+  Make the file, which is locked and mapped, an empty cache, because its
+  hash table was found to be corrupt
+
+  ==========================================================================*/
+static void solcache_discard (SolCache *self)
+  {
+  KLOG_IN
+  klog_warn (KLOG_CLASS, "Cache %s is corrupt: discarding it", self->path);
+  solcache_unmap (self);
+  size_t size;
+  void *map = solcache_create_file (self, self->fd, SOLCACHE_MIN_RECORDS,
+    &size);
+  if (map) solcache_set_map (self, map, size);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solcache_lock
+
+  Lock the file, and map it. If another program has replaced the file
+  since it was opened, the new one is opened instead
+
+  ==========================================================================*/
+static BOOL solcache_lock (SolCache *self)
+  {
+  KLOG_IN
+  BOOL ret = FALSE;
+  for (;;)
+    {
+    if (self->fd < 0)
+      self->fd = open (self->path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (self->fd < 0)
+      {
+      klog_warn (KLOG_CLASS, "Can't open cache %s: %s", self->path,
+        strerror (errno));
+      break;
+      }
+    if (flock (self->fd, LOCK_EX) != 0)
+      {
+      klog_warn (KLOG_CLASS, "Can't lock cache %s: %s", self->path,
+        strerror (errno));
+      break;
+      }
+    struct stat sb, fsb;
+    if (stat (self->path, &sb) == 0 && fstat (self->fd, &fsb) == 0
+         && sb.st_ino == fsb.st_ino && sb.st_dev == fsb.st_dev)
+      {
+      ret = solcache_map (self);
+      if (!ret) flock (self->fd, LOCK_UN);
+      break;
+      }
+    close (self->fd);
+    self->fd = -1;
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  solcache_unlock
+
+  ==========================================================================*/
+static void solcache_unlock (SolCache *self)
+  {
+  KLOG_IN
+  solcache_unmap (self);
+  flock (self->fd, LOCK_UN);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solcache_find
+
+  The hash table has twice as many buckets as there are records, so a
+  search that goes all the way round it without finding an empty one
+  means that the file is corrupt, and then corrupt is set
+
+  ==========================================================================*/
+static SolCacheEntry *solcache_find (const SolCache *self,
+      const SolCacheKey *key, BOOL *corrupt)
+  {
+  KLOG_IN
+  SolCacheEntry *ret = NULL;
+  uint32_t mask = 2 * self->header->capacity - 1;
+  uint32_t nrecords = self->header->nrecords;
+  uint32_t b = key->hash & mask;
+  uint32_t steps = 0;
+  *corrupt = FALSE;
+  for (; self->buckets[b] && !ret; b = (b + 1) & mask)
+    {
+    if (++steps > mask + 1)
+      {
+      *corrupt = TRUE;
+      break;
+      }
+    uint32_t i = self->buckets[b] - 1;
+    if (i >= nrecords) break; // A record that was never finished
+    SolCacheEntry *e = &self->entries[i];
+    if (e->hash == key->hash && e->date == key->date
+         && e->latitude == key->latitude && e->longitude == key->longitude
+         && strcmp (e->tz, key->tz) == 0)
+      ret = e;
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  solcache_insert
+
+  Add an entry, which has already been written to the next free record,
+  to the hash table. Returns FALSE if the table has no empty bucket, 
+  which means that the file is corrupt
+
+  ==========================================================================*/
+static BOOL solcache_insert (SolCache *self)
+  {
+  uint32_t i = self->header->nrecords;
+  uint32_t mask = 2 * self->header->capacity - 1;
+  uint32_t b = self->entries[i].hash & mask;
+  for (uint32_t steps = 0; self->buckets[b]; b = (b + 1) & mask)
+    {
+    if (++steps > mask) return FALSE;
+    }
+  // The record is counted before it is put in the table, so that a
+  //  program that stops in between leaves only an unused record
+  self->header->nrecords = i + 1;
+  self->buckets[b] = i + 1;
+  return TRUE;
+  }
+
+/*============================================================================
+  
+  solcache_compare_use
+
+  Order records most recently used first
+
+  ==========================================================================*/
+static int solcache_compare_use (const void *a, const void *b)
+  {
+  const SolCacheEntry *ea = *(const SolCacheEntry **)a;
+  const SolCacheEntry *eb = *(const SolCacheEntry **)b;
+  if (ea->last_used > eb->last_used) return -1;
+  if (ea->last_used < eb->last_used) return 1;
+  return 0;
+  }
+
+/*============================================================================
+  
+  solcache_rebuild
+
+  Write a new file, with twice the room or, if it is already as large as
+  it can be, only the more recently used half of the records, and put
+  it in place of the old one. The new file is locked before it is
+  renamed, so no other program can use it until this one has finished
+
+  ==========================================================================*/
+static BOOL solcache_rebuild (SolCache *self)
+  {
+  KLOG_IN
+  BOOL ret = FALSE;
+  uint32_t capacity = self->header->capacity;
+  uint32_t keep = self->header->nrecords;
+  if (capacity < SOLCACHE_MAX_RECORDS)
+    capacity *= 2;
+  else
+    keep /= 2;
+  klog_debug (KLOG_CLASS, "Rebuilding %s with %u of %u records, room for %u",
+    self->path, keep, self->header->nrecords, capacity);
+
+  SolCacheEntry **order = malloc (self->header->nrecords
+    * sizeof (SolCacheEntry *));
+  for (uint32_t i = 0; i < self->header->nrecords; i++)
+    order[i] = &self->entries[i];
+  if (keep < self->header->nrecords)
+    qsort (order, self->header->nrecords, sizeof (SolCacheEntry *),
+      solcache_compare_use);
+
+  char *temp = malloc (strlen (self->path) + 8);
+  sprintf (temp, "%s.XXXXXX", self->path);
+  int fd = mkostemp (temp, O_CLOEXEC);
+  size_t size = 0;
+  void *map = NULL;
+  if (fd >= 0 && flock (fd, LOCK_EX) == 0)
+    map = solcache_create_file (self, fd, capacity, &size);
+  else
+    klog_warn (KLOG_CLASS, "Can't rebuild cache %s: %s", self->path,
+      strerror (errno));
+
+  if (map)
+    {
+    SolCacheHeader *h = map;
+    h->clock = self->header->clock;
+    SolCache new;
+    memset (&new, 0, sizeof (new));
+    solcache_set_map (&new, map, size);
+    for (uint32_t i = 0; i < keep; i++)
+      {
+      new.entries[i] = *order[i];
+      solcache_insert (&new);
+      }
+    if (rename (temp, self->path) == 0)
+      {
+      // Closing the old file releases the lock on it, and any program
+      //  waiting for that lock then finds that the file was replaced
+      solcache_unmap (self);
+      close (self->fd);
+      self->fd = fd;
+      solcache_set_map (self, map, size);
+      ret = TRUE;
+      }
+    else
+      {
+      klog_warn (KLOG_CLASS, "Can't rebuild cache %s: %s", self->path,
+        strerror (errno));
+      munmap (map, size);
+      }
+    }
+
+  if (!ret)
+    {
+    if (fd >= 0) close (fd);
+    unlink (temp);
+    }
+  free (temp);
+  free (order);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  solcache_add
+
+  ==========================================================================*/
+static void solcache_add (SolCache *self, const SolCacheKey *key,
+      const SolunarDaySummary *sds)
+  {
+  KLOG_IN
+  if (self->header->nrecords < self->header->capacity
+       || solcache_rebuild (self))
+    {
+    SolCacheEntry *e = &self->entries[self->header->nrecords];
+    memset (e, 0, sizeof (SolCacheEntry));
+    e->hash = key->hash;
+    e->last_used = ++self->header->clock;
+    e->date = key->date;
+    e->latitude = key->latitude;
+    e->longitude = key->longitude;
+    strcpy (e->tz, key->tz);
+    solunar_day_summary_get_record (sds, &e->record);
+    if (!solcache_insert (self)) solcache_discard (self);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solcache_make_key
+
+  The hash is FNV-1a, of the fields that make up the key
+
+  ==========================================================================*/
+static void solcache_make_key (SolCacheKey *key, time_t date,
+      double latitude, double longitude, const char *tz)
+  {
+  key->date = date;
+  key->latitude = (int32_t)lround (latitude / SOLCACHE_QUANTUM);
+  key->longitude = (int32_t)lround (longitude / SOLCACHE_QUANTUM);
+  key->tz = tz;
+  uint64_t h = 14695981039346656037ULL;
+  const unsigned char *p = (const unsigned char *)&key->date;
+  for (size_t i = 0; i < sizeof (key->date); i++)
+    h = (h ^ p[i]) * 1099511628211ULL;
+  p = (const unsigned char *)&key->latitude;
+  for (size_t i = 0; i < sizeof (key->latitude); i++)
+    h = (h ^ p[i]) * 1099511628211ULL;
+  p = (const unsigned char *)&key->longitude;
+  for (size_t i = 0; i < sizeof (key->longitude); i++)
+    h = (h ^ p[i]) * 1099511628211ULL;
+  for (p = (const unsigned char *)tz; *p; p++)
+    h = (h ^ *p) * 1099511628211ULL;
+  key->hash = h;
+  }
+
+/*============================================================================
+  
+  solcache_open
+
+  ==========================================================================*/
+SolCache *solcache_open (const char *path, const char *source)
+  {
+  KLOG_IN
+  SolCache *self = NULL;
+  int fd = open (path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd >= 0)
+    {
+    self = malloc (sizeof (SolCache));
+    memset (self, 0, sizeof (SolCache));
+    self->path = strdup (path);
+    self->fd = fd;
+    snprintf (self->tag, sizeof (self->tag), "%s %s", VERSION,
+      source ? source : "");
+    klog_debug (KLOG_CLASS, "Opened cache %s", path);
+    }
+  else
+    klog_error (KLOG_CLASS, "Can't open cache %s: %s", path,
+      strerror (errno));
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+  
+  solcache_close
+
+  ==========================================================================*/
+void solcache_close (SolCache *self)
+  {
+  KLOG_IN
+  if (self)
+    {
+    if (self->fd >= 0) close (self->fd);
+    free (self->path);
+    free (self);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solcache_create_day_summary
+
+  The summary is worked out without the file locked, so that other
+  programs can use the cache in the meantime; one of them might add the
+  same summary, so it is looked for again before it is added
+
+  ==========================================================================*/
+SolunarDaySummary *solcache_create_day_summary (SolCache *self,
+        time_t date, double latitude, double longitude, const char *city,
+        const char *tz)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  if (!tz || strlen (tz) >= SOLCACHE_MAX_TZ)
+    {
+    SolunarDaySummary *ret = solunar_day_summary_create (date, latitude,
+      longitude, city, tz);
+    KLOG_OUT
+    return ret;
+    }
+
+  SolCacheKey key;
+  solcache_make_key (&key, date, latitude, longitude, tz);
+  SolunarDaySummary *ret = NULL;
+  BOOL corrupt;
+  if (solcache_lock (self))
+    {
+    SolCacheEntry *e = solcache_find (self, &key, &corrupt);
+    if (e)
+      {
+      e->last_used = ++self->header->clock;
+      // The record has the position of whoever added it, which might
+      //  differ from this one by up to half of SOLCACHE_QUANTUM
+      SolunarDayRecord record = e->record;
+      record.latitude = latitude;
+      record.longitude = longitude;
+      ret = solunar_day_summary_new_from_record (&record, city, tz);
+      }
+    else if (corrupt)
+      solcache_discard (self);
+    solcache_unlock (self);
+    }
+  klog_debug (KLOG_CLASS, "Cache %s", ret ? "hit" : "miss");
+
+  if (!ret)
+    {
+    ret = solunar_day_summary_create (date, latitude, longitude, city, tz);
+    if (solcache_lock (self))
+      {
+      if (!solcache_find (self, &key, &corrupt))
+        {
+        if (corrupt)
+          solcache_discard (self);
+        if (self->map)
+          solcache_add (self, &key, ret);
+        }
+      solcache_unlock (self);
+      }
+    }
+  KLOG_OUT
+  return ret;
+  }
+
@@ -14,8 +14,12 @@
 #include <assert.h>
 #include <errno.h>
 #include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <pthread.h>
 #include <klib/klib.h>
 #include <libsolunar/solcity.h>
+#include "spherekd.h"
 
 #define KLOG_CLASS "solunar.solcity"
 
@@ -35,57 +39,333 @@ struct _SolCity
 
 #include "cityinfo.h"
 
+// The gazetteer in use, if any, and the SolCity objects made for its 
+//  places, which are made when they are first found, and last until the 
+//  gazetteer is changed
+static const SolGazetteer *gazetteer = NULL;
+static SolCity **gazetteer_cities = NULL;
+static pthread_mutex_t gazetteer_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Mean radius of the Earth, for distances between places
+#define EARTH_RADIUS_KM 6371.0
+
+// Longest query, after case folding, that can match anything. No city
+//  name is anywhere near this long
+#define MAX_QUERY 256
+
+/*============================================================================
+  
+  solcity_get_lname
+
+  Get the name of city i in lower case, from the pool
+
+  ==========================================================================*/
+static inline const char *solcity_get_lname (int i)
+  {
+  return city_name_pool + city_name_offsets[i];
+  }
+
+/*============================================================================
+  
+  solcity_get_lplace
+
+  Get the part of the name of city i after the last '/', in lower case
+
+  ==========================================================================*/
+static const char *solcity_get_lplace (int i)
+  {
+  const char *name = solcity_get_lname (i);
+  const char *p = strrchr (name, '/');
+  return p ? p + 1 : name;
+  }
+
+/*============================================================================
+  
+  solcity_find_trigram
+
+  Find a three-character sequence in the trigram index, by binary 
+  search. Returns its number, or -1 if it does not occur in any name
+
+  ==========================================================================*/
+static int solcity_find_trigram (const char *t)
+  {
+  int lo = 0, hi = CITY_TRIGRAM_COUNT - 1;
+  while (lo <= hi)
+    {
+    int mid = (lo + hi) / 2;
+    int cmp = memcmp (city_trigrams + mid * 3, t, 3);
+    if (cmp == 0) return mid;
+    if (cmp < 0) lo = mid + 1; else hi = mid - 1;
+    }
+  return -1;
+  }
+
+/*============================================================================
+  
+  solcity_find_prefix_in
+
+  Mark, in found, the cities whose keys start with s, where order is
+  the cities in order of key, and get_key gets a city's key
+
+  ==========================================================================*/
+static void solcity_find_prefix_in (const char *s, 
+     const unsigned short *order, const char *(*get_key)(int i), 
+     BOOL *found)
+  {
+  size_t len = strlen (s);
+  // Find the first key that is not less than s
+  int lo = 0, hi = CITY_COUNT;
+  while (lo < hi)
+    {
+    int mid = (lo + hi) / 2;
+    if (strcmp (get_key (order[mid]), s) < 0) 
+      lo = mid + 1; 
+    else 
+      hi = mid;
+    }
+  for (int i = lo; i < CITY_COUNT 
+        && strncmp (get_key (order[i]), s, len) == 0; i++)
+    found[order[i]] = TRUE;
+  }
+
 /*============================================================================
   
-  strcmp_case 
+  solcity_make_list
+
+  Make a list of the cities marked in found, in the order of the 
+  table. Returns NULL if there are none
 
   ==========================================================================*/
-static void lower (char *s)
+static KList *solcity_make_list (const BOOL *found)
   {
-  while (*s)
+  KList *list = NULL;
+  for (int i = 0; i < CITY_COUNT; i++)
+    {
+    if (found[i])
+      {
+      if (!list) list = klist_new_empty ((KListFreeFn)NULL);
+      klist_append (list, &cities[i]);
+      klog_debug (KLOG_CLASS, "Found '%s'", cities[i].name);
+      }
+    }
+  return list;
+  }
+
+/*============================================================================
+  
+  solcity_get_gazetteer_city
+
+  Get the SolCity for a place in the gazetteer. Its strings are those in
+  the gazetteer, not copies. Call with gazetteer_mutex locked
+
+  ==========================================================================*/
+static SolCity *solcity_get_gazetteer_city (uint32_t place)
+  {
+  SolCity *c = gazetteer_cities[place];
+  if (!c)
+    {
+    c = malloc (sizeof (SolCity));
+    solgazetteer_get_place (gazetteer, place, &c->name, &c->code, 
+      &c->latitude, &c->longitude, &c->tz_name);
+    gazetteer_cities[place] = c;
+    }
+  return c;
+  }
+
+/*============================================================================
+  
+  solcity_find_in_gazetteer
+
+  Find places in the gazetteer, if there is one, by name or by the start
+  of the name. Returns NULL if there are none
+
+  ==========================================================================*/
+static KList *solcity_find_in_gazetteer (const UTF8 *s, BOOL prefix)
+  {
+  KList *list = NULL;
+  pthread_mutex_lock (&gazetteer_mutex);
+  if (gazetteer)
     {
-    *s |= 32;
-    s++;
+    uint32_t count;
+    uint32_t *places = solgazetteer_find_name (gazetteer, s, prefix, &count);
+    if (count > 0)
+      {
+      list = klist_new_empty ((KListFreeFn)NULL);
+      for (uint32_t i = 0; i < count; i++)
+        klist_append (list, solcity_get_gazetteer_city (places[i]));
+      klog_debug (KLOG_CLASS, "Found %u places in gazetteer", count);
+      }
+    free (places);
     }
+  pthread_mutex_unlock (&gazetteer_mutex);
+  return list;
   }
 
 /*============================================================================
   
   solcity_find_matching 
 
+  The names are held in lower case in a pool, and the query is folded
+  to match. For a query of three or more characters, only the cities
+  that contain its least common three-character sequence are checked.
+  Shorter queries have to check every city
+
   ==========================================================================*/
 KList *solcity_find_matching (const UTF8 *s)
   {
   KLOG_IN
   assert (s != NULL);
-  KList *list = NULL;
   klog_debug (KLOG_CLASS, "Find city matching '%s'", s);
+  KList *list = solcity_find_in_gazetteer (s, FALSE);
+  if (list)
+    {
+    KLOG_OUT
+    return list;
+    }
 
-  char *slwr = strdup ((char *)s);
-  lower (slwr);
-  int i = 0;
-  SolCity *c = &cities[i];
-  while (c->name)
+  BOOL found[CITY_COUNT];
+  memset (found, 0, sizeof (found));
+  char q[MAX_QUERY];
+  size_t len = kstring_fold_utf8 (s, (UTF8 *)q, sizeof (q));
+
+  if (len == (size_t)-1)
+    ; // Too long to match
+  else if (len < 3)
     {
-    char *name = strdup (c->name);
-    lower (name);
-    if (strstr (name, (char *)slwr)) 
+    for (int i = 0; i < CITY_COUNT; i++)
+      found[i] = strstr (solcity_get_lname (i), q) != NULL;
+    }
+  else
+    {
+    int best = -1;
+    int best_count = CITY_COUNT + 1;
+    for (size_t i = 0; i + 3 <= len; i++)
       {
-      if (!list) list = klist_new_empty ((KListFreeFn)NULL);
-      // Add to list
-      klist_append (list, c);
-      klog_debug (KLOG_CLASS, "Found '%s'", c->name);
+      int t = solcity_find_trigram (q + i);
+      if (t < 0) 
+        {
+        // Nothing contains this sequence, so nothing can match
+        best = -1;
+        break;
+        }
+      int count = city_trigram_starts[t + 1] - city_trigram_starts[t];
+      if (count < best_count) 
+        {
+        best = t;
+        best_count = count;
+        }
+      }
+    if (best >= 0)
+      {
+      for (int i = city_trigram_starts[best]; 
+            i < city_trigram_starts[best + 1]; i++)
+        {
+        int c = city_trigram_postings[i];
+        found[c] = strstr (solcity_get_lname (c), q) != NULL;
+        }
       }
-    i++;
-    c = &cities[i];
-    free (name);
     }
 
-  free (slwr);
+  list = solcity_make_list (found);
+  KLOG_OUT
+  return list;
+  }
+
+/*============================================================================
+  
+  solcity_find_prefix
+
+  ==========================================================================*/
+KList *solcity_find_prefix (const UTF8 *s)
+  {
+  KLOG_IN
+  assert (s != NULL);
+  klog_debug (KLOG_CLASS, "Find city starting with '%s'", s);
+  KList *list = solcity_find_in_gazetteer (s, TRUE);
+  if (!list)
+    {
+    BOOL found[CITY_COUNT];
+    memset (found, 0, sizeof (found));
+    char q[MAX_QUERY];
+    if (kstring_fold_utf8 (s, (UTF8 *)q, sizeof (q)) != (size_t)-1)
+      {
+      solcity_find_prefix_in (q, city_name_order, solcity_get_lname, 
+        found);
+      solcity_find_prefix_in (q, city_place_order, solcity_get_lplace, 
+        found);
+      }
+    list = solcity_make_list (found);
+    }
+  KLOG_OUT
+  return list;
+  }
+
+/*============================================================================
+  
+  solcity_find_nearest
+
+  ==========================================================================*/
+KList *solcity_find_nearest (double latitude, double longitude, int k)
+  {
+  KLOG_IN
+  klog_debug (KLOG_CLASS, "Find %d cities nearest %g,%g", k, 
+    latitude, longitude);
+  KList *list = NULL;
+  if (k > 0)
+    {
+    list = klist_new_empty ((KListFreeFn)NULL);
+    pthread_mutex_lock (&gazetteer_mutex);
+    if (gazetteer)
+      {
+      uint32_t count = solgazetteer_get_count (gazetteer);
+      if ((uint32_t)k > count) k = count;
+      uint32_t *places = malloc (k * sizeof (uint32_t));
+      int n = solgazetteer_find_nearest (gazetteer, latitude, longitude, 
+        k, places);
+      for (int i = 0; i < n; i++)
+        klist_append (list, solcity_get_gazetteer_city (places[i]));
+      free (places);
+      }
+    else
+      {
+      if (k > CITY_COUNT) k = CITY_COUNT;
+      double p[3];
+      spherekd_get_point (latitude, longitude, p);
+      SphereKDNeighbour *best = malloc (k * sizeof (SphereKDNeighbour));
+      int n = spherekd_search (city_xyz, CITY_COUNT, city_kd_order, 
+        city_kd_axis, p, k, best);
+      for (int i = 0; i < n; i++)
+        klist_append (list, &cities[best[i].point]);
+      free (best);
+      }
+    pthread_mutex_unlock (&gazetteer_mutex);
+    }
   KLOG_OUT
   return list;
   }
 
+/*============================================================================
+  
+  solcity_get_distance
+
+  Great-circle distance, by the haversine formula
+
+  ==========================================================================*/
+double solcity_get_distance (const SolCity *self, double latitude, 
+     double longitude)
+  {
+  KLOG_IN
+  double lat1 = self->latitude * M_PI / 180.0;
+  double lat2 = latitude * M_PI / 180.0;
+  double dlat = lat2 - lat1;
+  double dlong = (longitude - self->longitude) * M_PI / 180.0;
+  double a = sin (dlat / 2) * sin (dlat / 2) 
+    + cos (lat1) * cos (lat2) * sin (dlong / 2) * sin (dlong / 2);
+  double ret = 2 * EARTH_RADIUS_KM * asin (sqrt (fmin (a, 1.0)));
+  KLOG_OUT
+  return ret;
+  }
+
 /*============================================================================
   
   solcity_get_latitude 
@@ -138,4 +418,29 @@ const char *solcity_get_tz_name (const SolCity *self)
   return ret;
   }
 
+/*============================================================================
+  
+  solcity_set_gazetteer
+
+  ==========================================================================*/
+void solcity_set_gazetteer (const SolGazetteer *g)
+  {
+  KLOG_IN
+  pthread_mutex_lock (&gazetteer_mutex);
+  if (gazetteer_cities)
+    {
+    uint32_t n = solgazetteer_get_count (gazetteer);
+    for (uint32_t i = 0; i < n; i++)
+      free (gazetteer_cities[i]);
+    free (gazetteer_cities);
+    gazetteer_cities = NULL;
+    }
+  gazetteer = g;
+  // calloc() of a large block gets untouched pages, so this costs little
+  //  more than the pages actually used
+  if (g) 
+    gazetteer_cities = calloc (solgazetteer_get_count (g), sizeof (SolCity *));
+  pthread_mutex_unlock (&gazetteer_mutex);
+  KLOG_OUT
+  }
 
@@ -0,0 +1,165 @@
+/*============================================================================
+  
+  libsolunar
+  
+  solephemeris.c
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <memory.h>
+#include <assert.h>
+#include <math.h>
+#include <libsolunar/solephemeris.h>
+#include <libsolunar/moonephemera.h>
+#include <libsolunar/astroutil.h>
+#include <klib/klog.h>
+
+#define KLOG_CLASS "libsolunar.solephemeris"
+
+/*============================================================================
+  
+  SolEphemeris
+
+  ==========================================================================*/
+struct _SolEphemeris
+  {
+  time_t first;
+  int interval;
+  int count;
+  SolEphemerisSample *samples;
+  };
+
+/*============================================================================
+  
+  solephemeris_new
+
+  ==========================================================================*/
+SolEphemeris *solephemeris_new (time_t start, time_t end, int interval)
+  {
+  KLOG_IN
+  assert (interval > 0);
+  assert (end >= start);
+  SolEphemeris *self = malloc (sizeof (SolEphemeris));
+  memset (self, 0, sizeof (SolEphemeris));
+  // Round down, even if start is before the epoch
+  self->first = start - ((start % interval) + interval) % interval;
+  self->interval = interval;
+  self->count = (end - self->first + interval - 1) / interval + 1;
+  self->samples = malloc (self->count * sizeof (SolEphemerisSample));
+
+  time_t *times = (time_t *) malloc (self->count * sizeof (time_t));
+  double *ra = (double *) malloc (2 * self->count * sizeof (double));
+  double *dec = ra + self->count;
+  for (int i = 0; i < self->count; i++)
+    times[i] = self->first + (time_t)i * interval;
+
+  // The Moon's position is by far the most expensive part, so get it
+  //  for all the samples in one go
+  moonephemera_get_ra_and_dec_batch (times, self->count, ra, dec);
+
+  for (int i = 0; i < self->count; i++)
+    {
+    SolEphemerisSample *s = &self->samples[i];
+    s->time = times[i];
+    s->moon_ra = ra[i];
+    s->moon_dec = dec[i];
+    s->gmst = astroutil_gmst (times[i]);
+    }
+
+  free (ra);
+  free (times);
+  klog_debug (KLOG_CLASS, "%d samples from %ld", self->count,
+    (long)self->first);
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+  
+  solephemeris_destroy
+
+  ==========================================================================*/
+void solephemeris_destroy (SolEphemeris *self)
+  {
+  KLOG_IN
+  if (self)
+    {
+    if (self->samples) free (self->samples);
+    free (self);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solephemeris_find
+
+  ==========================================================================*/
+const SolEphemerisSample *solephemeris_find (const SolEphemeris *self,
+         time_t t)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  const SolEphemerisSample *ret = NULL;
+  if (t >= self->first && (t - self->first) % self->interval == 0)
+    {
+    time_t i = (t - self->first) / self->interval;
+    if (i < self->count) ret = &self->samples[i];
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  solephemeris_get_count
+
+  ==========================================================================*/
+int solephemeris_get_count (const SolEphemeris *self)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  int ret = self->count;
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  solephemeris_get_sample
+
+  ==========================================================================*/
+const SolEphemerisSample *solephemeris_get_sample (const SolEphemeris *self,
+         int i)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  assert (i >= 0 && i < self->count);
+  const SolEphemerisSample *ret = &self->samples[i];
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  solephemeris_get_moon_sin_altitudes
+
+  ==========================================================================*/
+void solephemeris_get_moon_sin_altitudes (const SolEphemeris *self,
+        double latitude, double longitude, double *sin_altitude)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  for (int i = 0; i < self->count; i++)
+    {
+    const SolEphemerisSample *s = &self->samples[i];
+    sin_altitude[i] = astroutil_gmst_ra_dec_to_sin_altitude (s->gmst,
+      latitude, longitude, s->moon_ra, s->moon_dec);
+    }
+  KLOG_OUT
+  }
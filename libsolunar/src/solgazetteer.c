@@ -0,0 +1,705 @@
+/*============================================================================
+  
+  libsolunar
+  
+  solgazetteer.c
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <libsolunar/solgazetteer.h>
+#include <klib/klog.h>
+#include "spherekd.h"
+
+#define KLOG_CLASS "libsolunar.solgazetteer"
+
+#define SOLGAZETTEER_MAGIC "SOLGAZE"
+#define SOLGAZETTEER_VERSION 1
+#define SOLGAZETTEER_BYTE_ORDER 0x01020304
+
+// Fields of the source file, counting from zero
+#define FIELD_NAME 1
+#define FIELD_ASCII_NAME 2
+#define FIELD_LATITUDE 4
+#define FIELD_LONGITUDE 5
+#define FIELD_CODE 8
+#define FIELD_TZ 17
+#define NFIELDS 18
+
+// Longest name, after case folding, that will be indexed or looked up
+#define MAX_NAME 256
+
+// An offset into the pool, for a string that could not be added
+#define NO_STRING ((uint32_t)-1)
+
+/*============================================================================
+  
+  SolGazetteerHeader
+
+  The layout of the start of the file. It is followed by these sections,
+  each nplaces long, except the names, which is nnames long, and the
+  string pool, which is pool_size bytes:
+
+    SolGazetteerPlace places[]
+    double xyz[][3]           position on the unit sphere, for the tree
+    SolGazetteerName names[]  sorted by name
+    uint32_t kd_order[]       the k-d tree, as spherekd_build() makes it
+    uint8_t kd_axis[]
+    char pool[]
+
+  ==========================================================================*/
+typedef struct _SolGazetteerHeader
+  {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t nplaces;
+  uint32_t nnames;
+  uint64_t pool_size;
+  } SolGazetteerHeader;
+
+/*============================================================================
+  
+  SolGazetteerPlace
+
+  Strings are offsets into the pool
+
+  ==========================================================================*/
+typedef struct _SolGazetteerPlace
+  {
+  double latitude;
+  double longitude;
+  uint32_t name;
+  uint32_t tz_name;
+  char code[8];
+  } SolGazetteerPlace;
+
+/*============================================================================
+  
+  SolGazetteerName
+
+  An entry in the name index: a name in lower case, as an offset into the
+  pool, and the place that has it
+
+  ==========================================================================*/
+typedef struct _SolGazetteerName
+  {
+  uint32_t lname;
+  uint32_t place;
+  } SolGazetteerName;
+
+/*============================================================================
+  
+  SolGazetteer
+
+  ==========================================================================*/
+struct _SolGazetteer
+  {
+  void *map;
+  size_t map_size;
+  uint32_t nplaces;
+  uint32_t nnames;
+  const SolGazetteerPlace *places;
+  const double (*xyz)[3];
+  const SolGazetteerName *names;
+  const uint32_t *kd_order;
+  const uint8_t *kd_axis;
+  const char *pool;
+  };
+
+/*============================================================================
+  
+  SolGazetteerWriter
+
+  The database as it is built by solgazetteer_write_file(). tz_names is
+  an open-addressed hash table of the timezone names in the pool, which
+  are few, and shared by many places
+
+  ==========================================================================*/
+typedef struct _SolGazetteerWriter
+  {
+  SolGazetteerPlace *places;
+  uint32_t nplaces;
+  uint32_t places_size;
+  double (*xyz)[3];
+  SolGazetteerName *names;
+  uint32_t nnames;
+  uint32_t names_size;
+  char *pool;
+  uint64_t pool_len;
+  uint64_t pool_size;
+  uint32_t *tz_names;
+  uint32_t ntz_names;
+  uint32_t tz_names_size;
+  BOOL full;
+  } SolGazetteerWriter;
+
+/*============================================================================
+  
+  solgazetteer_get_sections_size
+
+  The size of the sections that follow the header, up to the pool
+
+  ==========================================================================*/
+static size_t solgazetteer_get_sections_size (uint32_t nplaces,
+      uint32_t nnames)
+  {
+  return (size_t)nplaces * (sizeof (SolGazetteerPlace) + 3 * sizeof (double)
+    + sizeof (uint32_t) + sizeof (uint8_t))
+    + (size_t)nnames * sizeof (SolGazetteerName);
+  }
+
+/*============================================================================
+  
+  solgazetteer_check_sections
+
+  Check that the string offsets and place numbers in each section are in
+  range, so that a corrupt file can't lead a lookup outside the mapping
+
+  ==========================================================================*/
+static BOOL solgazetteer_check_sections (const SolGazetteer *self,
+      uint64_t pool_size)
+  {
+  for (uint32_t i = 0; i < self->nplaces; i++)
+    {
+    const SolGazetteerPlace *p = &self->places[i];
+    if (p->name >= pool_size || p->tz_name >= pool_size
+         || p->code[sizeof (p->code) - 1] != 0
+         || self->kd_order[i] >= self->nplaces || self->kd_axis[i] > 2)
+      return FALSE;
+    }
+  for (uint32_t i = 0; i < self->nnames; i++)
+    {
+    const SolGazetteerName *n = &self->names[i];
+    if (n->lname >= pool_size || n->place >= self->nplaces)
+      return FALSE;
+    }
+  return TRUE;
+  }
+
+/*============================================================================
+  
+  solgazetteer_close
+
+  ==========================================================================*/
+void solgazetteer_close (SolGazetteer *self)
+  {
+  KLOG_IN
+  if (self)
+    {
+    if (self->map) munmap (self->map, self->map_size);
+    free (self);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solgazetteer_compare_places
+
+  ==========================================================================*/
+static int solgazetteer_compare_places (const void *p1, const void *p2)
+  {
+  uint32_t i1 = *(const uint32_t *)p1, i2 = *(const uint32_t *)p2;
+  return i1 < i2 ? -1 : i1 > i2;
+  }
+
+/*============================================================================
+  
+  solgazetteer_find_name
+
+  ==========================================================================*/
+uint32_t *solgazetteer_find_name (const SolGazetteer *self, const UTF8 *s,
+      BOOL prefix, uint32_t *count)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  assert (s != NULL);
+  uint32_t *ret = NULL;
+  *count = 0;
+  char q[MAX_NAME];
+  size_t len = kstring_fold_utf8 (s, (UTF8 *)q, sizeof (q));
+  if (len != (size_t)-1)
+    {
+    // Find the first name that is not less than q...
+    uint32_t lo = 0, hi = self->nnames;
+    while (lo < hi)
+      {
+      uint32_t mid = lo + (hi - lo) / 2;
+      if (strcmp (self->pool + self->names[mid].lname, q) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+      }
+    // ... and the names after it that match
+    uint32_t end = lo;
+    while (end < self->nnames)
+      {
+      const char *lname = self->pool + self->names[end].lname;
+      if (prefix ? strncmp (lname, q, len) != 0 : strcmp (lname, q) != 0)
+        break;
+      end++;
+      }
+
+    if (end > lo)
+      {
+      ret = malloc ((end - lo) * sizeof (uint32_t));
+      for (uint32_t i = lo; i < end; i++)
+        ret[i - lo] = self->names[i].place;
+      // A place can be found by both of its names
+      qsort (ret, end - lo, sizeof (uint32_t), solgazetteer_compare_places);
+      uint32_t n = 0;
+      for (uint32_t i = 0; i < end - lo; i++)
+        if (n == 0 || ret[n - 1] != ret[i]) ret[n++] = ret[i];
+      *count = n;
+      }
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  solgazetteer_find_nearest
+
+  ==========================================================================*/
+int solgazetteer_find_nearest (const SolGazetteer *self, double latitude,
+      double longitude, int k, uint32_t *places)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  int ret = 0;
+  if (k > 0 && (uint32_t)k > self->nplaces) k = self->nplaces;
+  if (k > 0)
+    {
+    double p[3];
+    spherekd_get_point (latitude, longitude, p);
+    SphereKDNeighbour *best = malloc (k * sizeof (SphereKDNeighbour));
+    ret = spherekd_search (self->xyz, self->nplaces, self->kd_order,
+      self->kd_axis, p, k, best);
+    for (int i = 0; i < ret; i++)
+      places[i] = best[i].point;
+    free (best);
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  solgazetteer_get_count
+
+  ==========================================================================*/
+uint32_t solgazetteer_get_count (const SolGazetteer *self)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  uint32_t ret = self->nplaces;
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  solgazetteer_get_place
+
+  ==========================================================================*/
+void solgazetteer_get_place (const SolGazetteer *self, uint32_t place,
+      const char **name, const char **code, double *latitude,
+      double *longitude, const char **tz_name)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  assert (place < self->nplaces);
+  const SolGazetteerPlace *p = &self->places[place];
+  *name = self->pool + p->name;
+  *code = p->code;
+  *latitude = p->latitude;
+  *longitude = p->longitude;
+  *tz_name = self->pool + p->tz_name;
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solgazetteer_open
+
+  ==========================================================================*/
+SolGazetteer *solgazetteer_open (const char *path)
+  {
+  KLOG_IN
+  SolGazetteer *self = NULL;
+  int f = open (path, O_RDONLY);
+  if (f >= 0)
+    {
+    struct stat sb;
+    size_t size = fstat (f, &sb) == 0 ? sb.st_size : 0;
+    if (size >= sizeof (SolGazetteerHeader))
+      {
+      void *map = mmap (NULL, size, PROT_READ, MAP_SHARED, f, 0);
+      if (map != MAP_FAILED)
+        {
+        const SolGazetteerHeader *h = map;
+        // Huge counts in a corrupt header must not wrap round to the size
+        //  of the file, so the counts are first limited by the size, 
+        //  which keeps the size of the sections from wrapping, and the 
+        //  size of the pool is found by subtraction
+        size_t room = size - sizeof (SolGazetteerHeader);
+        BOOL sized = h->nplaces <= room / sizeof (SolGazetteerPlace)
+          && h->nnames <= room / sizeof (SolGazetteerName)
+          && solgazetteer_get_sections_size (h->nplaces, h->nnames) <= room
+          && h->pool_size == room
+               - solgazetteer_get_sections_size (h->nplaces, h->nnames);
+        if (memcmp (h->magic, SOLGAZETTEER_MAGIC, 8) != 0)
+          klog_error (KLOG_CLASS, "%s is not a gazetteer", path);
+        else if (h->byte_order != SOLGAZETTEER_BYTE_ORDER)
+          klog_error (KLOG_CLASS,
+            "%s was created on a machine of different byte order", path);
+        else if (h->version != SOLGAZETTEER_VERSION)
+          klog_error (KLOG_CLASS,
+            "%s has unsupported version %d", path, h->version);
+        else if (!sized || h->pool_size == 0
+             || ((const char *)map)[size - 1] != 0)
+          klog_error (KLOG_CLASS, "%s is corrupt", path);
+        else
+          {
+          self = malloc (sizeof (SolGazetteer));
+          self->map = map;
+          self->map_size = size;
+          self->nplaces = h->nplaces;
+          self->nnames = h->nnames;
+          const char *p = (const char *)(h + 1);
+          self->places = (const SolGazetteerPlace *)p;
+          p += h->nplaces * sizeof (SolGazetteerPlace);
+          self->xyz = (const double (*)[3])p;
+          p += h->nplaces * 3 * sizeof (double);
+          self->names = (const SolGazetteerName *)p;
+          p += h->nnames * sizeof (SolGazetteerName);
+          self->kd_order = (const uint32_t *)p;
+          p += h->nplaces * sizeof (uint32_t);
+          self->kd_axis = (const uint8_t *)p;
+          p += h->nplaces * sizeof (uint8_t);
+          self->pool = p;
+          if (solgazetteer_check_sections (self, h->pool_size))
+            klog_debug (KLOG_CLASS, "Mapped %s: %u places", path,
+              self->nplaces);
+          else
+            {
+            klog_error (KLOG_CLASS, "%s is corrupt", path);
+            free (self);
+            self = NULL;
+            }
+          }
+        if (!self) munmap (map, size);
+        }
+      else
+        klog_error (KLOG_CLASS, "Can't map %s: %s", path, strerror (errno));
+      }
+    else
+      klog_error (KLOG_CLASS, "%s is not a gazetteer", path);
+    close (f);
+    }
+  else
+    klog_error (KLOG_CLASS, "Can't open %s: %s", path, strerror (errno));
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+  
+  solgazetteer_add_string
+
+  Add a string to the pool, returning its offset, or NO_STRING if the
+  pool is full
+
+  ==========================================================================*/
+static uint32_t solgazetteer_add_string (SolGazetteerWriter *w,
+      const char *s)
+  {
+  size_t len = strlen (s) + 1;
+  if (w->pool_len + len >= NO_STRING)
+    {
+    w->full = TRUE;
+    return NO_STRING;
+    }
+  if (w->pool_len + len > w->pool_size)
+    {
+    w->pool_size = (w->pool_size + len) * 2;
+    w->pool = realloc (w->pool, w->pool_size);
+    }
+  uint32_t ret = w->pool_len;
+  memcpy (w->pool + w->pool_len, s, len);
+  w->pool_len += len;
+  return ret;
+  }
+
+/*============================================================================
+  
+  solgazetteer_hash
+
+  ==========================================================================*/
+static uint32_t solgazetteer_hash (const char *s)
+  {
+  uint32_t h = 2166136261u;
+  while (*s) h = (h ^ (unsigned char)*s++) * 16777619u;
+  return h;
+  }
+
+/*============================================================================
+  
+  solgazetteer_add_tz_name
+
+  Add a timezone name to the pool, if it is not already there
+
+  ==========================================================================*/
+static uint32_t solgazetteer_add_tz_name (SolGazetteerWriter *w,
+      const char *s)
+  {
+  if (w->ntz_names * 2 >= w->tz_names_size)
+    {
+    // Rehash into a table twice the size
+    uint32_t old_size = w->tz_names_size;
+    uint32_t *old = w->tz_names;
+    w->tz_names_size = old_size ? old_size * 2 : 256;
+    w->tz_names = malloc (w->tz_names_size * sizeof (uint32_t));
+    memset (w->tz_names, 0xFF, w->tz_names_size * sizeof (uint32_t));
+    for (uint32_t i = 0; i < old_size; i++)
+      {
+      if (old[i] == NO_STRING) continue;
+      uint32_t j = solgazetteer_hash (w->pool + old[i]);
+      while (w->tz_names[j & (w->tz_names_size - 1)] != NO_STRING) j++;
+      w->tz_names[j & (w->tz_names_size - 1)] = old[i];
+      }
+    free (old);
+    }
+
+  uint32_t j = solgazetteer_hash (s);
+  uint32_t mask = w->tz_names_size - 1;
+  while (w->tz_names[j & mask] != NO_STRING)
+    {
+    if (strcmp (w->pool + w->tz_names[j & mask], s) == 0)
+      return w->tz_names[j & mask];
+    j++;
+    }
+  uint32_t ret = solgazetteer_add_string (w, s);
+  if (ret != NO_STRING)
+    {
+    w->tz_names[j & mask] = ret;
+    w->ntz_names++;
+    }
+  return ret;
+  }
+
+/*============================================================================
+  
+  solgazetteer_add_name
+
+  Add an entry to the name index, in lower case, unless it is the same
+  as other, which is the offset of the place's other name in the index,
+  or NO_STRING. Returns the offset of the entry, or NO_STRING if none
+  was added
+
+  ==========================================================================*/
+static uint32_t solgazetteer_add_name (SolGazetteerWriter *w,
+      uint32_t place, const char *name, uint32_t other)
+  {
+  char q[MAX_NAME];
+  if (kstring_fold_utf8 ((const UTF8 *)name, (UTF8 *)q, sizeof (q))
+       == (size_t)-1)
+    return NO_STRING; // Too long to look up anyway
+  if (other != NO_STRING && strcmp (q, w->pool + other) == 0)
+    return NO_STRING;
+
+  uint32_t offset = solgazetteer_add_string (w, q);
+  if (offset == NO_STRING) return NO_STRING;
+  if (w->nnames == w->names_size)
+    {
+    w->names_size = w->names_size ? w->names_size * 2 : 1024;
+    w->names = realloc (w->names,
+      w->names_size * sizeof (SolGazetteerName));
+    }
+  w->names[w->nnames].lname = offset;
+  w->names[w->nnames].place = place;
+  w->nnames++;
+  return offset;
+  }
+
+/*============================================================================
+  
+  solgazetteer_add_place
+
+  Parse a line of the source file, and add the place to the database.
+  Returns FALSE if the line does not describe a place. If the pool fills
+  up, w->full is set
+
+  ==========================================================================*/
+static BOOL solgazetteer_add_place (SolGazetteerWriter *w, char *line)
+  {
+  char *fields[NFIELDS];
+  int nfields = 0;
+  char *p = line;
+  while (nfields < NFIELDS)
+    {
+    fields[nfields++] = p;
+    p = strchr (p, '\t');
+    if (!p) break;
+    *p++ = 0;
+    }
+  if (nfields < NFIELDS) return FALSE;
+  char *end = strpbrk (fields[FIELD_TZ], "\t\r\n");
+  if (end) *end = 0;
+
+  char *e1, *e2;
+  double latitude = strtod (fields[FIELD_LATITUDE], &e1);
+  double longitude = strtod (fields[FIELD_LONGITUDE], &e2);
+  if (e1 == fields[FIELD_LATITUDE] || *e1 || latitude < -90
+       || latitude > 90 || e2 == fields[FIELD_LONGITUDE] || *e2
+       || longitude < -180 || longitude > 180
+       || fields[FIELD_NAME][0] == 0 || fields[FIELD_TZ][0] == 0)
+    return FALSE;
+
+  if (w->nplaces == w->places_size)
+    {
+    w->places_size = w->places_size ? w->places_size * 2 : 1024;
+    w->places = realloc (w->places,
+      w->places_size * sizeof (SolGazetteerPlace));
+    w->xyz = realloc (w->xyz, w->places_size * 3 * sizeof (double));
+    }
+  SolGazetteerPlace *place = &w->places[w->nplaces];
+  memset (place, 0, sizeof (SolGazetteerPlace));
+  place->latitude = latitude;
+  place->longitude = longitude;
+  strncpy (place->code, fields[FIELD_CODE], sizeof (place->code) - 1);
+  place->name = solgazetteer_add_string (w, fields[FIELD_NAME]);
+  place->tz_name = solgazetteer_add_tz_name (w, fields[FIELD_TZ]);
+  spherekd_get_point (latitude, longitude, w->xyz[w->nplaces]);
+  uint32_t lname = solgazetteer_add_name (w, w->nplaces,
+    fields[FIELD_NAME], NO_STRING);
+  solgazetteer_add_name (w, w->nplaces, fields[FIELD_ASCII_NAME], lname);
+  w->nplaces++;
+  return TRUE;
+  }
+
+/*============================================================================
+  
+  solgazetteer_compare_names
+
+  ==========================================================================*/
+static int solgazetteer_compare_names (const void *p1, const void *p2,
+      void *arg)
+  {
+  const char *pool = arg;
+  const SolGazetteerName *n1 = p1, *n2 = p2;
+  int ret = strcmp (pool + n1->lname, pool + n2->lname);
+  if (ret == 0)
+    ret = n1->place < n2->place ? -1 : n1->place > n2->place;
+  return ret;
+  }
+
+/*============================================================================
+  
+  solgazetteer_write_file
+
+  ==========================================================================*/
+BOOL solgazetteer_write_file (const char *source, const char *path)
+  {
+  KLOG_IN
+  BOOL ret = FALSE;
+  FILE *in = fopen (source, "r");
+  if (in)
+    {
+    SolGazetteerWriter w;
+    memset (&w, 0, sizeof (w));
+    char *line = NULL;
+    size_t line_size = 0;
+    int skipped = 0;
+    while (!w.full && getline (&line, &line_size, in) > 0)
+      {
+      if (line[0] != '#' && !solgazetteer_add_place (&w, line))
+        skipped++;
+      }
+    free (line);
+    fclose (in);
+
+    if (w.full)
+      klog_error (KLOG_CLASS, "%s has too many places", source);
+    else if (w.nplaces == 0)
+      klog_error (KLOG_CLASS, "%s has no places", source);
+    else
+      {
+      klog_debug (KLOG_CLASS, "Read %u places from %s, skipped %d lines",
+        w.nplaces, source, skipped);
+      qsort_r (w.names, w.nnames, sizeof (SolGazetteerName),
+        solgazetteer_compare_names, w.pool);
+      uint32_t *kd_order = malloc (w.nplaces * sizeof (uint32_t));
+      uint8_t *kd_axis = malloc (w.nplaces * sizeof (uint8_t));
+      spherekd_build ((const double (*)[3])w.xyz, w.nplaces, kd_order,
+        kd_axis);
+
+      SolGazetteerHeader h;
+      memset (&h, 0, sizeof (h));
+      memcpy (h.magic, SOLGAZETTEER_MAGIC, 8);
+      h.version = SOLGAZETTEER_VERSION;
+      h.byte_order = SOLGAZETTEER_BYTE_ORDER;
+      h.nplaces = w.nplaces;
+      h.nnames = w.nnames;
+      h.pool_size = w.pool_len;
+
+      FILE *f = fopen (path, "wb");
+      if (f)
+        {
+        BOOL ok = fwrite (&h, sizeof (h), 1, f) == 1
+          && fwrite (w.places, sizeof (SolGazetteerPlace), w.nplaces, f)
+             == w.nplaces
+          && fwrite (w.xyz, 3 * sizeof (double), w.nplaces, f)
+             == w.nplaces
+          && fwrite (w.names, sizeof (SolGazetteerName), w.nnames, f)
+             == w.nnames
+          && fwrite (kd_order, sizeof (uint32_t), w.nplaces, f)
+             == w.nplaces
+          && fwrite (kd_axis, sizeof (uint8_t), w.nplaces, f)
+             == w.nplaces
+          && fwrite (w.pool, 1, w.pool_len, f) == w.pool_len;
+        if (fclose (f) != 0) ok = FALSE;
+        if (ok)
+          {
+          klog_debug (KLOG_CLASS, "Wrote %u places to %s", w.nplaces,
+            path);
+          ret = TRUE;
+          }
+        else
+          klog_error (KLOG_CLASS, "Can't write %s: %s", path,
+            strerror (errno));
+        }
+      else
+        klog_error (KLOG_CLASS, "Can't open %s for writing: %s", path,
+          strerror (errno));
+      free (kd_order);
+      free (kd_axis);
+      }
+
+    free (w.places);
+    free (w.xyz);
+    free (w.names);
+    free (w.pool);
+    free (w.tz_names);
+    }
+  else
+    klog_error (KLOG_CLASS, "Can't open %s: %s", source, strerror (errno));
+
+  KLOG_OUT
+  return ret;
+  }
+
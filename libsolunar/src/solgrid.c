@@ -0,0 +1,1000 @@
+/*============================================================================
+  
+  libsolunar
+  
+  solgrid.c
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <libsolunar/solgrid.h>
+#include <libsolunar/solunardaysummary.h>
+#include <libsolunar/solunarbatch.h>
+#include <klib/klog.h>
+
+#define KLOG_CLASS "libsolunar.solgrid"
+
+#define SOLGRID_MAGIC "SOLGRID"
+#define SOLGRID_VERSION 1
+#define SOLGRID_BYTE_ORDER 0x01020304
+
+#define SOLGRID_MIN_STEP 0.05
+#define SOLGRID_MAX_STEP 2.0
+
+// The number of points in a block of a row
+#define SOLGRID_BLOCK 16
+
+// The events stored for each point on each day, each of which is
+//  called a channel: the eight events of the Sun, in the order of
+//  SolGridTimes, then two moonrises and two moonsets
+#define SOLGRID_SUN_CHANNELS 8
+#define SOLGRID_MOON_SLOTS 2
+#define SOLGRID_MOON_RISES 8
+#define SOLGRID_MOON_SETS 10
+#define SOLGRID_CHANNELS 12
+
+// The differences in a block that mean that the event does not happen,
+//  and that it could not be stored. Other differences are in the range
+//  SOLGRID_MIN_OFFSET to INT8_MAX
+#define SOLGRID_NONE INT8_MIN
+#define SOLGRID_UNKNOWN (INT8_MIN + 1)
+#define SOLGRID_MIN_OFFSET (INT8_MIN + 2)
+
+// The same, as decoded minutes of the day
+#define SOLGRID_VALUE_NONE -1
+#define SOLGRID_VALUE_UNKNOWN -2
+
+#define MINUTES_PER_DAY 1440
+#define SECONDS_PER_DAY 86400
+
+// The furthest apart, in seconds, that the times of a moonrise or
+//  moonset at the four points around a place can be, for them to be
+//  taken as the same event. Except near the poles, consecutive moonrises
+//  are about 24 hours and 50 minutes apart, but at a high latitude the
+//  time can change by tens of minutes from one point to the next
+#define SOLGRID_MATCH (4 * 60 * 60)
+
+// The most error, in seconds, of storing a time to the minute and
+//  taking it to be in the middle of the minute
+#define SOLGRID_ROUNDING 30
+
+// The most moonrises or moonsets that are gathered at a point, over
+//  the UTC days that a local day touches, and one either side
+#define SOLGRID_MAX_GATHER 16
+
+// The number of days worked out at once when the table is built
+#define SOLGRID_DAYS_PER_BATCH 32
+
+/*============================================================================
+  
+  SolGridHeader
+
+  The layout of the start of the file. It is followed by these sections:
+
+    uint16_t errors[nrows - 1][ncols - 1]   the estimated largest error
+                                             of each cell, in seconds
+    SolGridBlock blocks[ndays][nrows][SOLGRID_CHANNELS][nblocks]
+
+  Rows are from 90S northwards, and columns from 180W eastwards to 180E,
+  which appears twice, because the times at a point depend on which side
+  of the date line it is taken to be
+
+  ==========================================================================*/
+typedef struct _SolGridHeader
+  {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  int64_t first_day;           // Midnight UTC at the start of the year
+  double step;
+  int32_t year;
+  uint32_t ndays;
+  uint32_t nrows;
+  uint32_t ncols;
+  uint32_t nblocks;            // Blocks in a row of one channel
+  uint32_t reserved;
+  } SolGridHeader;
+
+/*============================================================================
+  
+  SolGridBlock
+
+  The times of one event at SOLGRID_BLOCK consecutive points of a row,
+  in minutes after midnight UTC, as base + offsets[i], modulo the length
+  of the day; the base is chosen so that the offsets are small, even
+  when the event moves across midnight UTC within the block
+
+  ==========================================================================*/
+typedef struct _SolGridBlock
+  {
+  int16_t base;
+  int8_t offsets[SOLGRID_BLOCK];
+  } SolGridBlock;
+
+/*============================================================================
+  
+  SolGrid
+
+  ==========================================================================*/
+struct _SolGrid
+  {
+  void *map;
+  size_t map_size;
+  const SolGridHeader *header;
+  const uint16_t *errors;
+  const SolGridBlock *blocks;
+  };
+
+/*============================================================================
+  
+  solgrid_file_size
+
+  The size of a file with the specified header, or zero if it is too
+  large to work out, which can only be if the header is corrupt. The
+  header must have at least one row and column
+
+  ==========================================================================*/
+static size_t solgrid_file_size (const SolGridHeader *h)
+  {
+  size_t errors = (size_t)(h->nrows - 1) * (h->ncols - 1);
+  size_t blocks = (size_t)h->ndays * h->nrows;
+  if (h->ndays && blocks / h->ndays != h->nrows) return 0;
+  size_t per_row = (size_t)SOLGRID_CHANNELS * h->nblocks 
+    * sizeof (SolGridBlock);
+  if (blocks && SIZE_MAX / blocks < per_row) return 0;
+  blocks *= per_row;
+  if (SIZE_MAX / sizeof (uint16_t) < errors) return 0;
+  errors *= sizeof (uint16_t);
+  if (SIZE_MAX - sizeof (SolGridHeader) - errors < blocks) return 0;
+  return sizeof (SolGridHeader) + errors + blocks;
+  }
+
+/*============================================================================
+  
+  solgrid_get_day
+
+  The day of the table that includes t, which may be outside the table
+
+  ==========================================================================*/
+static int64_t solgrid_get_day (const SolGrid *self, time_t t)
+  {
+  int64_t s = (int64_t)t - self->header->first_day;
+  return s >= 0 ? s / SECONDS_PER_DAY
+    : -((-s + SECONDS_PER_DAY - 1) / SECONDS_PER_DAY);
+  }
+
+/*============================================================================
+  
+  solgrid_get_value
+
+  Get the minute of the day at which an event happens at a point, or
+  SOLGRID_VALUE_NONE or SOLGRID_VALUE_UNKNOWN
+
+  ==========================================================================*/
+static int solgrid_get_value (const SolGrid *self, int day, int row,
+      int channel, int col)
+  {
+  const SolGridHeader *h = self->header;
+  const SolGridBlock *b = self->blocks
+    + (((size_t)day * h->nrows + row) * SOLGRID_CHANNELS + channel)
+      * h->nblocks + col / SOLGRID_BLOCK;
+  int offset = b->offsets[col % SOLGRID_BLOCK];
+  if (offset == SOLGRID_NONE) return SOLGRID_VALUE_NONE;
+  if (offset == SOLGRID_UNKNOWN) return SOLGRID_VALUE_UNKNOWN;
+  int ret = (b->base + offset) % MINUTES_PER_DAY;
+  if (ret < 0) ret += MINUTES_PER_DAY;
+  return ret;
+  }
+
+/*============================================================================
+  
+  solgrid_get_sun_time
+
+  Interpolate the time of one of the Sun's events, which is within the
+  UTC day, like the times worked out in full
+
+  ==========================================================================*/
+static BOOL solgrid_get_sun_time (const SolGrid *self, int day,
+      const int *rows, const int *cols, const double *w, int channel,
+      time_t *t)
+  {
+  int v[4];
+  int nnone = 0;
+  for (int i = 0; i < 4; i++)
+    {
+    v[i] = solgrid_get_value (self, day, rows[i], channel, cols[i]);
+    if (v[i] == SOLGRID_VALUE_UNKNOWN) return FALSE;
+    if (v[i] == SOLGRID_VALUE_NONE) nnone++;
+    }
+  if (nnone == 4)
+    {
+    *t = 0;
+    return TRUE;
+    }
+  if (nnone > 0) return FALSE;
+
+  double m = 0;
+  for (int i = 0; i < 4; i++)
+    {
+    // The event might be either side of midnight at different points
+    if (v[i] - v[0] > MINUTES_PER_DAY / 2) v[i] -= MINUTES_PER_DAY;
+    if (v[0] - v[i] > MINUTES_PER_DAY / 2) v[i] += MINUTES_PER_DAY;
+    m += w[i] * v[i];
+    }
+  // Times are stored to the minute, so the middle of the minute is the
+  //  best estimate, as it is for the Moon
+  int64_t second = llround (m * 60 + 30) % SECONDS_PER_DAY;
+  if (second < 0) second += SECONDS_PER_DAY;
+  *t = self->header->first_day + (int64_t)day * SECONDS_PER_DAY + second;
+  return TRUE;
+  }
+
+/*============================================================================
+  
+  solgrid_find_match
+
+  Find the event in times that is nearest to t, if it is near enough to
+  be the same one
+
+  ==========================================================================*/
+static BOOL solgrid_find_match (const time_t *times, int n, time_t t,
+      time_t *match)
+  {
+  BOOL ret = FALSE;
+  for (int i = 0; i < n; i++)
+    {
+    time_t d = times[i] > t ? times[i] - t : t - times[i];
+    if (d <= SOLGRID_MATCH && (!ret || d < labs (*match - t)))
+      {
+      *match = times[i];
+      ret = TRUE;
+      }
+    }
+  return ret;
+  }
+
+/*============================================================================
+  
+  solgrid_get_moon_times
+
+  Interpolate the moonrises or moonsets, according to channel, between
+  start and end. They are stored by UTC day, so they are gathered at
+  each point from the UTC days that the period touches, and one either
+  side, and then matched between the points. If an event near the
+  period can't be matched at all four, they can't be interpolated
+
+  ==========================================================================*/
+static BOOL solgrid_get_moon_times (const SolGrid *self, const int *rows,
+      const int *cols, const double *w, int channel, time_t start,
+      time_t end, time_t *times, int *n)
+  {
+  const SolGridHeader *h = self->header;
+  int64_t first = solgrid_get_day (self, start) - 1;
+  int64_t last = solgrid_get_day (self, end - 1) + 1;
+  if (first < 0) first = 0;
+  if (last > h->ndays - 1) last = h->ndays - 1;
+
+  time_t events[4][SOLGRID_MAX_GATHER];
+  int nevents[4] = { 0, 0, 0, 0 };
+  for (int i = 0; i < 4; i++)
+    {
+    for (int64_t day = first; day <= last; day++)
+      {
+      for (int s = 0; s < SOLGRID_MOON_SLOTS; s++)
+        {
+        int v = solgrid_get_value (self, day, rows[i], channel + s,
+          cols[i]);
+        if (v == SOLGRID_VALUE_UNKNOWN) return FALSE;
+        // Times are stored to the minute, so the middle of the minute
+        //  is the best estimate
+        if (v != SOLGRID_VALUE_NONE && nevents[i] < SOLGRID_MAX_GATHER)
+          events[i][nevents[i]++] = h->first_day + day * SECONDS_PER_DAY
+            + v * 60 + 30;
+        }
+      }
+    }
+
+  for (int i = 0; i < 4; i++)
+    {
+    for (int k = 0; k < nevents[i]; k++)
+      {
+      time_t t = events[i][k];
+      if (t < start - SOLGRID_MATCH || t >= end + SOLGRID_MATCH) continue;
+      for (int j = 0; j < 4; j++)
+        {
+        time_t match;
+        if (j != i && !solgrid_find_match (events[j], nevents[j], t, &match))
+          return FALSE;
+        }
+      }
+    }
+
+  *n = 0;
+  for (int k = 0; k < nevents[0]; k++)
+    {
+    double t = w[0] * events[0][k];
+    for (int j = 1; j < 4; j++)
+      {
+      time_t match = 0;
+      solgrid_find_match (events[j], nevents[j], events[0][k], &match);
+      t += w[j] * match;
+      }
+    time_t tt = (time_t)llround (t);
+    if (tt >= start && tt < end && *n < MOONTIMES_MAX_EVENTS)
+      times[(*n)++] = tt;
+    }
+  return TRUE;
+  }
+
+/*============================================================================
+  
+  solgrid_get_times
+
+  ==========================================================================*/
+BOOL solgrid_get_times (const SolGrid *self, time_t date, double latitude,
+      double longitude, const char *tz, SolGridTimes *times)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  const SolGridHeader *h = self->header;
+  memset (times, 0, sizeof (SolGridTimes));
+  BOOL ret = latitude >= -90 && latitude <= 90
+    && longitude >= -180 && longitude <= 180;
+
+  int64_t day = solgrid_get_day (self, date);
+  if (day < 0 || day >= h->ndays) ret = FALSE;
+
+  int rows[4], cols[4];
+  double w[4];
+  int r = 0, c = 0;
+  if (ret)
+    {
+    double fy = (latitude + 90) / h->step;
+    double fx = (longitude + 180) / h->step;
+    r = (int)floor (fy);
+    c = (int)floor (fx);
+    if (r > (int)h->nrows - 2) r = h->nrows - 2;
+    if (c > (int)h->ncols - 2) c = h->ncols - 2;
+    double v = fy - r;
+    double u = fx - c;
+    rows[0] = rows[1] = r;
+    rows[2] = rows[3] = r + 1;
+    cols[0] = cols[2] = c;
+    cols[1] = cols[3] = c + 1;
+    w[0] = (1 - u) * (1 - v);
+    w[1] = u * (1 - v);
+    w[2] = (1 - u) * v;
+    w[3] = u * v;
+    }
+
+  time_t *sun[SOLGRID_SUN_CHANNELS] =
+    {
+    &times->sunrise, &times->sunset,
+    &times->start_civil_twilight, &times->end_civil_twilight,
+    &times->start_nautical_twilight, &times->end_nautical_twilight,
+    &times->start_astronomical_twilight, &times->end_astronomical_twilight
+    };
+  for (int i = 0; i < SOLGRID_SUN_CHANNELS && ret; i++)
+    ret = solgrid_get_sun_time (self, day, rows, cols, w, i, sun[i]);
+
+  if (ret)
+    {
+    // The Moon's events are in the local day, as they are when they
+    //  are worked out in full
+    KDayIter *iter = kdayiter_new_from_time (tz ? ktimezone_get (tz) : NULL,
+      date, 1);
+    KDay local;
+    kdayiter_next (iter, &local);
+    kdayiter_destroy (iter);
+    if (local.end > local.start)
+      {
+      if (solgrid_get_day (self, local.start) < 0
+           || solgrid_get_day (self, local.end - 1) >= h->ndays)
+        ret = FALSE;
+      else
+        ret = solgrid_get_moon_times (self, rows, cols, w,
+            SOLGRID_MOON_RISES, local.start, local.end, times->moon_rises,
+            &times->nmoon_rises)
+          && solgrid_get_moon_times (self, rows, cols, w,
+            SOLGRID_MOON_SETS, local.start, local.end, times->moon_sets,
+            &times->nmoon_sets);
+      }
+    }
+
+  if (ret) times->error = self->errors[(size_t)r * (h->ncols - 1) + c];
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  solgrid_times_from_summary
+
+  ==========================================================================*/
+static void solgrid_times_from_summary (const SolunarDaySummary *sds,
+      SolGridTimes *times)
+  {
+  memset (times, 0, sizeof (SolGridTimes));
+  times->sunrise = solunar_day_summary_get_sunrise (sds);
+  times->sunset = solunar_day_summary_get_sunset (sds);
+  times->start_civil_twilight =
+    solunar_day_summary_get_start_civil_twilight (sds);
+  times->end_civil_twilight =
+    solunar_day_summary_get_end_civil_twilight (sds);
+  times->start_nautical_twilight =
+    solunar_day_summary_get_start_nautical_twilight (sds);
+  times->end_nautical_twilight =
+    solunar_day_summary_get_end_nautical_twilight (sds);
+  times->start_astronomical_twilight =
+    solunar_day_summary_get_start_astronomical_twilight (sds);
+  times->end_astronomical_twilight =
+    solunar_day_summary_get_end_astronomical_twilight (sds);
+  times->nmoon_rises = solunar_day_summary_get_n_rises (sds);
+  for (int i = 0; i < times->nmoon_rises; i++)
+    times->moon_rises[i] = solunar_day_summary_get_moon_rise (sds, i);
+  times->nmoon_sets = solunar_day_summary_get_n_sets (sds);
+  for (int i = 0; i < times->nmoon_sets; i++)
+    times->moon_sets[i] = solunar_day_summary_get_moon_set (sds, i);
+  }
+
+/*============================================================================
+  
+  solgrid_compare_moon_times
+
+  The largest distance from an event in a to the nearest in b, or, if
+  there is none near, to the nearer end of the period. An event just
+  inside the period in one is as likely to be just outside it in the
+  other, and that is an error of only the distance to the end
+
+  ==========================================================================*/
+static time_t solgrid_compare_moon_times (const time_t *a, int na,
+      const time_t *b, int nb, time_t start, time_t end)
+  {
+  time_t ret = 0;
+  for (int i = 0; i < na; i++)
+    {
+    time_t d = a[i] - start < end - a[i] ? a[i] - start : end - a[i];
+    time_t match = 0;
+    if (solgrid_find_match (b, nb, a[i], &match)
+         && labs (match - a[i]) < d)
+      d = labs (match - a[i]);
+    if (d > ret) ret = d;
+    }
+  return ret;
+  }
+
+/*============================================================================
+  
+  solgrid_compare_times
+
+  The largest difference in seconds between the times of the same
+  events, or SOLGRID_ERROR_UNKNOWN if one of the Sun's events happens in
+  one and not the other. The Sun's events are kept within the UTC day
+  by adding or taking away a day, so one just after midnight in one
+  might be just before the next midnight in the other. The Moon's events
+  are in the period from start to end
+
+  ==========================================================================*/
+static int solgrid_compare_times (const SolGridTimes *a,
+      const SolGridTimes *b, time_t start, time_t end)
+  {
+  const time_t *ta = &a->sunrise;
+  const time_t *tb = &b->sunrise;
+  time_t ret = 0;
+  for (int i = 0; i < SOLGRID_SUN_CHANNELS; i++)
+    {
+    if ((ta[i] == 0) != (tb[i] == 0)) return SOLGRID_ERROR_UNKNOWN;
+    time_t d = labs (ta[i] - tb[i]);
+    if (d > SECONDS_PER_DAY / 2) d = SECONDS_PER_DAY - d;
+    if (d > ret) ret = d;
+    }
+  time_t d[4];
+  d[0] = solgrid_compare_moon_times (a->moon_rises, a->nmoon_rises,
+    b->moon_rises, b->nmoon_rises, start, end);
+  d[1] = solgrid_compare_moon_times (b->moon_rises, b->nmoon_rises,
+    a->moon_rises, a->nmoon_rises, start, end);
+  d[2] = solgrid_compare_moon_times (a->moon_sets, a->nmoon_sets,
+    b->moon_sets, b->nmoon_sets, start, end);
+  d[3] = solgrid_compare_moon_times (b->moon_sets, b->nmoon_sets,
+    a->moon_sets, a->nmoon_sets, start, end);
+  for (int i = 0; i < 4; i++)
+    if (d[i] > ret) ret = d[i];
+  return ret < SOLGRID_ERROR_UNKNOWN ? (int)ret : SOLGRID_ERROR_UNKNOWN - 1;
+  }
+
+/*============================================================================
+  
+  solgrid_check
+
+  ==========================================================================*/
+void solgrid_check (const SolGrid *self, int samples, int *answered,
+      int *max_error, int *over_bound)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  const SolGridHeader *h = self->header;
+  *answered = 0;
+  *max_error = 0;
+  *over_bound = 0;
+  // The places and dates must be the same each time, so that the results
+  //  can be compared
+  unsigned int seed = 1;
+  for (int i = 0; i < samples; i++)
+    {
+    double latitude = rand_r (&seed) * 180.0 / RAND_MAX - 90;
+    double longitude = rand_r (&seed) * 360.0 / RAND_MAX - 180;
+    time_t date = h->first_day
+      + (time_t)(rand_r (&seed) % h->ndays) * SECONDS_PER_DAY
+      + rand_r (&seed) % SECONDS_PER_DAY;
+    SolGridTimes grid, full;
+    if (solgrid_get_times (self, date, latitude, longitude, "UTC", &grid))
+      {
+      SolunarDaySummary *sds = solunar_day_summary_create (date, latitude,
+        longitude, NULL, "UTC");
+      solgrid_times_from_summary (sds, &full);
+      solunar_day_summary_destroy (sds);
+      time_t start = h->first_day + solgrid_get_day (self, date)
+        * SECONDS_PER_DAY;
+      int error = solgrid_compare_times (&grid, &full, start,
+        start + SECONDS_PER_DAY);
+      (*answered)++;
+      if (error > *max_error) *max_error = error;
+      if (error > grid.error) (*over_bound)++;
+      }
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solgrid_close
+
+  ==========================================================================*/
+void solgrid_close (SolGrid *self)
+  {
+  KLOG_IN
+  if (self)
+    {
+    if (self->map) munmap (self->map, self->map_size);
+    free (self);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solgrid_get_range
+
+  ==========================================================================*/
+void solgrid_get_range (const SolGrid *self, int *year, double *step)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  *year = self->header->year;
+  *step = self->header->step;
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solgrid_open
+
+  ==========================================================================*/
+SolGrid *solgrid_open (const char *path)
+  {
+  KLOG_IN
+  SolGrid *self = NULL;
+  int f = open (path, O_RDONLY);
+  if (f >= 0)
+    {
+    struct stat sb;
+    size_t size = fstat (f, &sb) == 0 ? sb.st_size : 0;
+    if (size >= sizeof (SolGridHeader))
+      {
+      void *map = mmap (NULL, size, PROT_READ, MAP_SHARED, f, 0);
+      if (map != MAP_FAILED)
+        {
+        const SolGridHeader *h = map;
+        if (memcmp (h->magic, SOLGRID_MAGIC, 8) != 0)
+          klog_error (KLOG_CLASS, "%s is not a grid table", path);
+        else if (h->byte_order != SOLGRID_BYTE_ORDER)
+          klog_error (KLOG_CLASS,
+            "%s was created on a machine of different byte order", path);
+        else if (h->version != SOLGRID_VERSION)
+          klog_error (KLOG_CLASS,
+            "%s has unsupported version %d", path, h->version);
+        else if (h->nrows < 2 || h->ncols < 2 || h->ndays == 0
+             || h->ndays > 366
+             || !(h->step >= SOLGRID_MIN_STEP && h->step <= SOLGRID_MAX_STEP)
+             || h->nrows - 1 != lround (180 / h->step)
+             || h->ncols != 2 * (h->nrows - 1) + 1
+             || h->nblocks != (h->ncols + SOLGRID_BLOCK - 1) / SOLGRID_BLOCK
+             || size != solgrid_file_size (h))
+          klog_error (KLOG_CLASS, "%s is corrupt", path);
+        else
+          {
+          self = malloc (sizeof (SolGrid));
+          self->map = map;
+          self->map_size = size;
+          self->header = h;
+          self->errors = (const uint16_t *)(h + 1);
+          self->blocks = (const SolGridBlock *)(self->errors
+            + (size_t)(h->nrows - 1) * (h->ncols - 1));
+          klog_debug (KLOG_CLASS, "Mapped %s: %d, step %g", path, h->year,
+            h->step);
+          }
+        if (!self) munmap (map, size);
+        }
+      else
+        klog_error (KLOG_CLASS, "Can't map %s: %s", path, strerror (errno));
+      }
+    else
+      klog_error (KLOG_CLASS, "%s is not a grid table", path);
+    close (f);
+    }
+  else
+    klog_error (KLOG_CLASS, "Can't open %s: %s", path, strerror (errno));
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+  
+  solgrid_get_minutes
+
+  Get the events of a summary, as minutes after midnight UTC, into a
+  value for each channel, stride apart
+
+  ==========================================================================*/
+static void solgrid_get_minutes (const SolunarDaySummary *sds,
+      time_t midnight, int16_t *values, size_t stride)
+  {
+  SolGridTimes times;
+  solgrid_times_from_summary (sds, &times);
+  const time_t *sun = &times.sunrise;
+  for (int i = 0; i < SOLGRID_SUN_CHANNELS; i++)
+    {
+    int m = (sun[i] - midnight) / 60;
+    if (sun[i] == 0)
+      m = SOLGRID_VALUE_NONE;
+    else if (m < 0 || m >= MINUTES_PER_DAY)
+      m = SOLGRID_VALUE_UNKNOWN;
+    values[i * stride] = m;
+    }
+
+  for (int kind = 0; kind < 2; kind++)
+    {
+    int channel = kind ? SOLGRID_MOON_SETS : SOLGRID_MOON_RISES;
+    int n = kind ? times.nmoon_sets : times.nmoon_rises;
+    const time_t *t = kind ? times.moon_sets : times.moon_rises;
+    for (int s = 0; s < SOLGRID_MOON_SLOTS; s++)
+      {
+      int m = SOLGRID_VALUE_NONE;
+      if (n > SOLGRID_MOON_SLOTS)
+        m = SOLGRID_VALUE_UNKNOWN;
+      else if (s < n)
+        {
+        m = (t[s] - midnight) / 60;
+        if (m < 0 || m >= MINUTES_PER_DAY) m = SOLGRID_VALUE_UNKNOWN;
+        }
+      values[(channel + s) * stride] = m;
+      }
+    }
+  }
+
+/*============================================================================
+  
+  solgrid_encode_row
+
+  Encode the times of one event along a row into blocks. Returns the
+  number of times that could not be stored
+
+  ==========================================================================*/
+static int solgrid_encode_row (const int16_t *values, int ncols,
+      SolGridBlock *blocks)
+  {
+  int ret = 0;
+  for (int first = 0; first < ncols; first += SOLGRID_BLOCK)
+    {
+    SolGridBlock *b = &blocks[first / SOLGRID_BLOCK];
+    int code[SOLGRID_BLOCK], v[SOLGRID_BLOCK];
+    int ref = 0, lo = 0, hi = 0;
+    BOOL any = FALSE;
+    for (int i = 0; i < SOLGRID_BLOCK; i++)
+      {
+      code[i] = first + i < ncols ? values[first + i] : SOLGRID_VALUE_NONE;
+      v[i] = code[i];
+      if (code[i] < 0) continue;
+      if (!any) ref = lo = hi = v[i];
+      any = TRUE;
+      // Move the time across midnight, if that brings it nearer to the
+      //  others
+      if (v[i] - ref > MINUTES_PER_DAY / 2) v[i] -= MINUTES_PER_DAY;
+      if (ref - v[i] > MINUTES_PER_DAY / 2) v[i] += MINUTES_PER_DAY;
+      if (v[i] < lo) lo = v[i];
+      if (v[i] > hi) hi = v[i];
+      }
+    b->base = (lo + hi) / 2;
+    for (int i = 0; i < SOLGRID_BLOCK; i++)
+      {
+      int o = v[i] - b->base;
+      if (code[i] == SOLGRID_VALUE_NONE)
+        b->offsets[i] = SOLGRID_NONE;
+      else if (code[i] == SOLGRID_VALUE_UNKNOWN || o < SOLGRID_MIN_OFFSET
+           || o > INT8_MAX)
+        {
+        b->offsets[i] = SOLGRID_UNKNOWN;
+        ret++;
+        }
+      else
+        b->offsets[i] = o;
+      }
+    }
+  return ret;
+  }
+
+
+/*============================================================================
+  
+  solgrid_add_error
+
+  Raise the errors of the cells that include the point at half-step
+  row i and column j, to at least e. A point on the edge of a cell is
+  interpolated from the two corners at the ends of the edge, whichever
+  cell it is taken to be in, so its error belongs to every cell that
+  includes it
+
+  ==========================================================================*/
+static void solgrid_add_error (uint16_t *errors, int nrows, int ncols,
+      int i, int j, int e)
+  {
+  for (int r = (i - 1) / 2; r <= i / 2; r++)
+    {
+    if (r < 0 || r >= nrows - 1) continue;
+    for (int c = (j - 1) / 2; c <= j / 2; c++)
+      {
+      if (c < 0 || c >= ncols - 1) continue;
+      uint16_t *error = &errors[(size_t)r * (ncols - 1) + c];
+      if (e > *error) *error = e;
+      }
+    }
+  }
+
+/*============================================================================
+  
+  solgrid_write_errors
+
+  Estimate the largest error of each cell, by looking up the times in
+  the table that has just been written on every day, at nine points of
+  the cell -- the corners, the middles of the edges and the centre --
+  and comparing them with the times worked out in full. The points are
+  those of a grid of half the step, which are shared between cells. To
+  the largest error found is added the error of storing times to the
+  minute, which is up to half a minute either way. This is an estimate,
+  not a bound: the error between the points can be larger, especially
+  near the poles, and near the edges of the polar day and night
+
+  ==========================================================================*/
+static BOOL solgrid_write_errors (const char *path, int threads)
+  {
+  KLOG_IN
+  BOOL ret = FALSE;
+  SolGrid *grid = solgrid_open (path);
+  if (grid)
+    {
+    const SolGridHeader *h = grid->header;
+    size_t nerrors = (size_t)(h->nrows - 1) * (h->ncols - 1);
+    uint16_t *errors = calloc (nerrors, sizeof (uint16_t));
+    int nlines = 2 * (h->nrows - 1) + 1;
+    int npoints = 2 * (h->ncols - 1) + 1;
+    SolunarObserver *observers = calloc (npoints, sizeof (SolunarObserver));
+    SolunarDaySummary **results = malloc ((size_t)npoints
+      * SOLGRID_DAYS_PER_BATCH * sizeof (SolunarDaySummary *));
+    for (int i = 0; i < nlines; i++)
+      {
+      klog_info (KLOG_CLASS, "Checking line %d of %d", i + 1, nlines);
+      for (int j = 0; j < npoints; j++)
+        {
+        observers[j].latitude = -90 + i * h->step / 2;
+        observers[j].longitude = -180 + j * h->step / 2;
+        observers[j].tz = "UTC";
+        }
+      for (uint32_t first = 0; first < h->ndays;
+            first += SOLGRID_DAYS_PER_BATCH)
+        {
+        int ndays = h->ndays - first;
+        if (ndays > SOLGRID_DAYS_PER_BATCH) ndays = SOLGRID_DAYS_PER_BATCH;
+        solunar_batch_create_day_summaries (observers, npoints, h->year, 1,
+          1 + first, ndays, threads, results);
+        for (int j = 0; j < npoints; j++)
+          {
+          int error = 0;
+          for (int d = 0; d < ndays; d++)
+            {
+            SolunarDaySummary *sds = results[j * ndays + d];
+            SolGridTimes interpolated, full;
+            time_t start = solunar_day_summary_get_date (sds);
+            if (solgrid_get_times (grid, start + SECONDS_PER_DAY / 2,
+                 observers[j].latitude, observers[j].longitude, "UTC",
+                 &interpolated))
+              {
+              solgrid_times_from_summary (sds, &full);
+              int e = solgrid_compare_times (&interpolated, &full, start,
+                start + SECONDS_PER_DAY);
+              if (e > error) error = e;
+              }
+            solunar_day_summary_destroy (sds);
+            }
+          solgrid_add_error (errors, h->nrows, h->ncols, i, j, error);
+          }
+        }
+      }
+    for (size_t i = 0; i < nerrors; i++)
+      {
+      if (errors[i] < SOLGRID_ERROR_UNKNOWN - SOLGRID_ROUNDING)
+        errors[i] += SOLGRID_ROUNDING;
+      else if (errors[i] < SOLGRID_ERROR_UNKNOWN)
+        errors[i] = SOLGRID_ERROR_UNKNOWN - 1;
+      }
+    free (results);
+    free (observers);
+    solgrid_close (grid);
+
+    int f = open (path, O_WRONLY);
+    ret = f >= 0 && pwrite (f, errors, nerrors * sizeof (uint16_t),
+      sizeof (SolGridHeader)) == (ssize_t)(nerrors * sizeof (uint16_t));
+    if (f >= 0 && close (f) != 0) ret = FALSE;
+    if (!ret)
+      klog_error (KLOG_CLASS, "Can't write %s: %s", path, strerror (errno));
+    free (errors);
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  solgrid_write_file
+
+  The table is written a row at a time, each row being worked out for
+  the whole year, and then written into each day's section
+
+  ==========================================================================*/
+BOOL solgrid_write_file (const char *path, int year, double step,
+      int threads)
+  {
+  KLOG_IN
+  BOOL ret = FALSE;
+  double nsteps = 180 / step;
+  if (!(step >= SOLGRID_MIN_STEP && step <= SOLGRID_MAX_STEP)
+       || fabs (nsteps - lround (nsteps)) > 1e-6)
+    {
+    klog_error (KLOG_CLASS,
+      "Grid step must divide 180, and be from %g to %g degrees",
+      SOLGRID_MIN_STEP, SOLGRID_MAX_STEP);
+    KLOG_OUT
+    return FALSE;
+    }
+
+  struct tm tm;
+  memset (&tm, 0, sizeof (tm));
+  tm.tm_mday = 1;
+  tm.tm_year = year - 1900;
+  time_t start = timegm (&tm);
+  tm.tm_year++;
+  time_t end = timegm (&tm);
+
+  SolGridHeader h;
+  memset (&h, 0, sizeof (h));
+  memcpy (h.magic, SOLGRID_MAGIC, 8);
+  h.version = SOLGRID_VERSION;
+  h.byte_order = SOLGRID_BYTE_ORDER;
+  h.first_day = start;
+  h.step = step;
+  h.year = year;
+  h.ndays = (end - start) / SECONDS_PER_DAY;
+  h.nrows = lround (nsteps) + 1;
+  h.ncols = 2 * lround (nsteps) + 1;
+  h.nblocks = (h.ncols + SOLGRID_BLOCK - 1) / SOLGRID_BLOCK;
+
+  FILE *f = fopen (path, "wb");
+  if (f)
+    {
+    // The errors are filled in when the rest of the table is complete
+    size_t nerrors = (size_t)(h.nrows - 1) * (h.ncols - 1);
+    uint16_t *errors = calloc (nerrors, sizeof (uint16_t));
+    BOOL ok = fwrite (&h, sizeof (h), 1, f) == 1
+      && fwrite (errors, sizeof (uint16_t), nerrors, f) == nerrors;
+    free (errors);
+    off_t data = sizeof (h) + nerrors * sizeof (uint16_t);
+
+    size_t row_blocks = SOLGRID_CHANNELS * h.nblocks;
+    int16_t *values = malloc ((size_t)h.ndays * SOLGRID_CHANNELS * h.ncols
+      * sizeof (int16_t));
+    SolGridBlock *blocks = malloc (row_blocks * sizeof (SolGridBlock));
+    SolunarObserver *observers = calloc (h.ncols, sizeof (SolunarObserver));
+    SolunarDaySummary **results = malloc ((size_t)h.ncols
+      * SOLGRID_DAYS_PER_BATCH * sizeof (SolunarDaySummary *));
+    int unstored = 0;
+    for (uint32_t r = 0; r < h.nrows && ok; r++)
+      {
+      klog_info (KLOG_CLASS, "Working out row %u of %u", r + 1, h.nrows);
+      for (uint32_t c = 0; c < h.ncols; c++)
+        {
+        observers[c].latitude = -90 + r * step;
+        observers[c].longitude = -180 + c * step;
+        observers[c].tz = "UTC";
+        }
+      for (uint32_t first = 0; first < h.ndays;
+            first += SOLGRID_DAYS_PER_BATCH)
+        {
+        int ndays = h.ndays - first;
+        if (ndays > SOLGRID_DAYS_PER_BATCH) ndays = SOLGRID_DAYS_PER_BATCH;
+        solunar_batch_create_day_summaries (observers, h.ncols, year, 1,
+          1 + first, ndays, threads, results);
+        for (uint32_t c = 0; c < h.ncols; c++)
+          {
+          for (int d = 0; d < ndays; d++)
+            {
+            SolunarDaySummary *sds = results[c * ndays + d];
+            solgrid_get_minutes (sds,
+              start + (time_t)(first + d) * SECONDS_PER_DAY,
+              values + (size_t)(first + d) * SOLGRID_CHANNELS * h.ncols + c,
+              h.ncols);
+            solunar_day_summary_destroy (sds);
+            }
+          }
+        }
+
+      for (uint32_t d = 0; d < h.ndays && ok; d++)
+        {
+        for (int ch = 0; ch < SOLGRID_CHANNELS; ch++)
+          unstored += solgrid_encode_row (values
+            + ((size_t)d * SOLGRID_CHANNELS + ch) * h.ncols, h.ncols,
+            blocks + ch * h.nblocks);
+        off_t pos = data + ((off_t)d * h.nrows + r) * row_blocks
+          * sizeof (SolGridBlock);
+        ok = fseeko (f, pos, SEEK_SET) == 0
+          && fwrite (blocks, sizeof (SolGridBlock), row_blocks, f)
+            == row_blocks;
+        }
+      }
+    free (results);
+    free (observers);
+    free (blocks);
+    free (values);
+
+    if (fclose (f) != 0) ok = FALSE;
+    if (ok)
+      {
+      if (unstored)
+        klog_warn (KLOG_CLASS, "%d times could not be stored", unstored);
+      klog_debug (KLOG_CLASS, "Wrote %u rows of %u points to %s", h.nrows,
+        h.ncols, path);
+      ret = solgrid_write_errors (path, threads);
+      }
+    else
+      klog_error (KLOG_CLASS, "Can't write %s: %s", path, strerror (errno));
+    }
+  else
+    klog_error (KLOG_CLASS, "Can't open %s for writing: %s", path,
+      strerror (errno));
+  KLOG_OUT
+  return ret;
+  }
+
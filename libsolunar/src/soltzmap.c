@@ -0,0 +1,1142 @@
+/*============================================================================
+  
+  libsolunar
+  
+  soltzmap.c
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <libsolunar/soltzmap.h>
+#include <klib/klog.h>
+
+#define KLOG_CLASS "libsolunar.soltzmap"
+
+#define SOLTZMAP_MAGIC "SOLTZMP"
+#define SOLTZMAP_VERSION 1
+#define SOLTZMAP_BYTE_ORDER 0x01020304
+
+// Coordinates are stored as whole numbers of this many degrees, which
+//  is about a centimetre
+#define SOLTZMAP_SCALE 1e7
+
+// The most children of a node in the R-tree
+#define SOLTZMAP_FANOUT 16
+
+// The deepest the search of the R-tree can go. A tree of this depth
+//  would have more nodes than a map can hold
+#define SOLTZMAP_MAX_DEPTH 16
+
+// Longest zone name
+#define MAX_ZONE_NAME 256
+
+// Indices into a bounding box
+#define MIN_X 0
+#define MIN_Y 1
+#define MAX_X 2
+#define MAX_Y 3
+
+/*============================================================================
+  
+  SolTzMapHeader
+
+  The layout of the start of the file. It is followed by these sections:
+
+    SolTzMapPolygon polygons[npolygons]  in the order of the R-tree leaves
+    SolTzMapRing rings[nrings]
+    int32_t points[npoints][2]           longitude, latitude
+    SolTzMapNode nodes[nnodes]           leaves, then each level up to
+                                          the root, which is the last
+    uint32_t zones[nzones]               zone names, in the pool
+    char pool[pool_size]
+
+  ==========================================================================*/
+typedef struct _SolTzMapHeader
+  {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t npolygons;
+  uint32_t nrings;
+  uint32_t npoints;
+  uint32_t nnodes;
+  uint32_t nleaves;
+  uint32_t nzones;
+  uint32_t pool_size;
+  uint32_t reserved;
+  } SolTzMapHeader;
+
+/*============================================================================
+  
+  SolTzMapPolygon
+
+  A polygon is an outer ring with, perhaps, some holes. The point is in
+  the polygon if it is inside an odd number of its rings
+
+  ==========================================================================*/
+typedef struct _SolTzMapPolygon
+  {
+  int32_t box[4];
+  uint32_t zone;
+  uint32_t first_ring;
+  uint32_t nrings;
+  uint32_t reserved;
+  } SolTzMapPolygon;
+
+/*============================================================================
+  
+  SolTzMapRing
+
+  ==========================================================================*/
+typedef struct _SolTzMapRing
+  {
+  uint32_t first_point;
+  uint32_t npoints;
+  } SolTzMapRing;
+
+/*============================================================================
+  
+  SolTzMapNode
+
+  A node of the R-tree. The children of a leaf are polygons, and of
+  other nodes, nodes
+
+  ==========================================================================*/
+typedef struct _SolTzMapNode
+  {
+  int32_t box[4];
+  uint32_t first;
+  uint32_t count;
+  } SolTzMapNode;
+
+/*============================================================================
+  
+  SolTzMap
+
+  ==========================================================================*/
+struct _SolTzMap
+  {
+  void *map;
+  size_t map_size;
+  uint32_t nleaves;
+  uint32_t nnodes;
+  const SolTzMapPolygon *polygons;
+  const SolTzMapRing *rings;
+  const int32_t (*points)[2];
+  const SolTzMapNode *nodes;
+  const uint32_t *zones;
+  const char *pool;
+  };
+
+/*============================================================================
+  
+  SolTzMapWriter
+
+  The map as it is built by soltzmap_write_file()
+
+  ==========================================================================*/
+typedef struct _SolTzMapWriter
+  {
+  SolTzMapPolygon *polygons;
+  uint32_t npolygons;
+  uint32_t polygons_size;
+  SolTzMapRing *rings;
+  uint32_t nrings;
+  uint32_t rings_size;
+  int32_t (*points)[2];
+  uint32_t npoints;
+  uint32_t points_size;
+  SolTzMapNode *nodes;
+  uint32_t nnodes;
+  uint32_t nleaves;
+  uint32_t *zones;
+  uint32_t nzones;
+  char *pool;
+  uint32_t pool_len;
+  } SolTzMapWriter;
+
+/*============================================================================
+  
+  SolTzMapParser
+
+  The state of the GeoJSON parser: the text still to be parsed, and
+  whether it has gone wrong
+
+  ==========================================================================*/
+typedef struct _SolTzMapParser
+  {
+  const char *p;
+  const char *end;
+  BOOL error;
+  } SolTzMapParser;
+
+/*============================================================================
+  
+  soltzmap_box_contains
+
+  ==========================================================================*/
+static inline BOOL soltzmap_box_contains (const int32_t *box, int32_t x,
+      int32_t y)
+  {
+  return x >= box[MIN_X] && x <= box[MAX_X]
+    && y >= box[MIN_Y] && y <= box[MAX_Y];
+  }
+
+/*============================================================================
+  
+  soltzmap_polygon_contains
+
+  Count crossings of the rings by a line from the point towards +x
+
+  ==========================================================================*/
+static BOOL soltzmap_polygon_contains (const SolTzMap *self,
+      const SolTzMapPolygon *polygon, int32_t x, int32_t y)
+  {
+  BOOL inside = FALSE;
+  for (uint32_t r = 0; r < polygon->nrings; r++)
+    {
+    const SolTzMapRing *ring = &self->rings[polygon->first_ring + r];
+    const int32_t (*p)[2] = self->points + ring->first_point;
+    uint32_t n = ring->npoints;
+    for (uint32_t i = 0, j = n - 1; i < n; j = i++)
+      {
+      if ((p[i][1] > y) != (p[j][1] > y))
+        {
+        // Edges can span most of the world, so the differences are
+        //  worked out in double, where they can't overflow
+        double cross = p[i][0] + ((double)y - p[i][1])
+          * ((double)p[j][0] - p[i][0]) / ((double)p[j][1] - p[i][1]);
+        if (x < cross) inside = !inside;
+        }
+      }
+    }
+  return inside;
+  }
+
+/*============================================================================
+  
+  soltzmap_find_zone
+
+  ==========================================================================*/
+const char *soltzmap_find_zone (const SolTzMap *self, double latitude,
+      double longitude)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  const char *ret = NULL;
+  int32_t x = lround (longitude * SOLTZMAP_SCALE);
+  int32_t y = lround (latitude * SOLTZMAP_SCALE);
+
+  uint32_t stack[SOLTZMAP_MAX_DEPTH * SOLTZMAP_FANOUT];
+  int sp = 0;
+  stack[sp++] = self->nnodes - 1;
+  while (sp > 0 && !ret)
+    {
+    const SolTzMapNode *node = &self->nodes[stack[--sp]];
+    if (!soltzmap_box_contains (node->box, x, y)) continue;
+    if ((uint32_t)(node - self->nodes) < self->nleaves)
+      {
+      for (uint32_t i = node->first; i < node->first + node->count
+            && !ret; i++)
+        {
+        const SolTzMapPolygon *polygon = &self->polygons[i];
+        if (soltzmap_box_contains (polygon->box, x, y)
+             && soltzmap_polygon_contains (self, polygon, x, y))
+          ret = self->pool + self->zones[polygon->zone];
+        }
+      }
+    else
+      {
+      for (uint32_t i = 0; i < node->count
+            && sp < SOLTZMAP_MAX_DEPTH * SOLTZMAP_FANOUT; i++)
+        stack[sp++] = node->first + i;
+      }
+    }
+
+  klog_debug (KLOG_CLASS, "Zone at %g,%g is %s", latitude, longitude,
+    ret ? ret : "unknown");
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  soltzmap_check_sections
+
+  Check that the indices in each section of a map are in range, so that
+  a corrupt map can't lead soltzmap_find_zone() outside the mapping. The
+  children of a node must come before it, so the search must end
+
+  ==========================================================================*/
+static BOOL soltzmap_check_sections (const SolTzMap *self,
+      const SolTzMapHeader *h)
+  {
+  for (uint32_t i = 0; i < h->npolygons; i++)
+    {
+    const SolTzMapPolygon *polygon = &self->polygons[i];
+    if ((uint64_t)polygon->first_ring + polygon->nrings > h->nrings
+         || polygon->zone >= h->nzones)
+      return FALSE;
+    }
+  for (uint32_t i = 0; i < h->nrings; i++)
+    {
+    const SolTzMapRing *ring = &self->rings[i];
+    if ((uint64_t)ring->first_point + ring->npoints > h->npoints)
+      return FALSE;
+    }
+  for (uint32_t i = 0; i < h->nnodes; i++)
+    {
+    const SolTzMapNode *node = &self->nodes[i];
+    uint32_t limit = i < h->nleaves ? h->npolygons : i;
+    if ((uint64_t)node->first + node->count > limit)
+      return FALSE;
+    }
+  for (uint32_t i = 0; i < h->nzones; i++)
+    {
+    if (self->zones[i] >= h->pool_size)
+      return FALSE;
+    }
+  return TRUE;
+  }
+
+/*============================================================================
+  
+  soltzmap_close
+
+  ==========================================================================*/
+void soltzmap_close (SolTzMap *self)
+  {
+  KLOG_IN
+  if (self)
+    {
+    if (self->map) munmap (self->map, self->map_size);
+    free (self);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  soltzmap_open
+
+  ==========================================================================*/
+SolTzMap *soltzmap_open (const char *path)
+  {
+  KLOG_IN
+  SolTzMap *self = NULL;
+  int f = open (path, O_RDONLY);
+  if (f >= 0)
+    {
+    struct stat sb;
+    size_t size = fstat (f, &sb) == 0 ? sb.st_size : 0;
+    if (size >= sizeof (SolTzMapHeader))
+      {
+      void *map = mmap (NULL, size, PROT_READ, MAP_SHARED, f, 0);
+      if (map != MAP_FAILED)
+        {
+        const SolTzMapHeader *h = map;
+        size_t expected = sizeof (SolTzMapHeader)
+          + (size_t)h->npolygons * sizeof (SolTzMapPolygon)
+          + (size_t)h->nrings * sizeof (SolTzMapRing)
+          + (size_t)h->npoints * 2 * sizeof (int32_t)
+          + (size_t)h->nnodes * sizeof (SolTzMapNode)
+          + (size_t)h->nzones * sizeof (uint32_t)
+          + h->pool_size;
+        if (memcmp (h->magic, SOLTZMAP_MAGIC, 8) != 0)
+          klog_error (KLOG_CLASS, "%s is not a timezone map", path);
+        else if (h->byte_order != SOLTZMAP_BYTE_ORDER)
+          klog_error (KLOG_CLASS,
+            "%s was created on a machine of different byte order", path);
+        else if (h->version != SOLTZMAP_VERSION)
+          klog_error (KLOG_CLASS,
+            "%s has unsupported version %d", path, h->version);
+        else if (size != expected || h->nnodes == 0 || h->pool_size == 0
+             || h->nleaves > h->nnodes || ((const char *)map)[size - 1] != 0)
+          klog_error (KLOG_CLASS, "%s is corrupt", path);
+        else
+          {
+          self = malloc (sizeof (SolTzMap));
+          self->map = map;
+          self->map_size = size;
+          self->nleaves = h->nleaves;
+          self->nnodes = h->nnodes;
+          const char *p = (const char *)(h + 1);
+          self->polygons = (const SolTzMapPolygon *)p;
+          p += h->npolygons * sizeof (SolTzMapPolygon);
+          self->rings = (const SolTzMapRing *)p;
+          p += h->nrings * sizeof (SolTzMapRing);
+          self->points = (const int32_t (*)[2])p;
+          p += h->npoints * 2 * sizeof (int32_t);
+          self->nodes = (const SolTzMapNode *)p;
+          p += h->nnodes * sizeof (SolTzMapNode);
+          self->zones = (const uint32_t *)p;
+          p += h->nzones * sizeof (uint32_t);
+          self->pool = p;
+          if (soltzmap_check_sections (self, h))
+            klog_debug (KLOG_CLASS, "Mapped %s: %u zones, %u polygons",
+              path, h->nzones, h->npolygons);
+          else
+            {
+            klog_error (KLOG_CLASS, "%s is corrupt", path);
+            free (self);
+            self = NULL;
+            }
+          }
+        if (!self) munmap (map, size);
+        }
+      else
+        klog_error (KLOG_CLASS, "Can't map %s: %s", path, strerror (errno));
+      }
+    else
+      klog_error (KLOG_CLASS, "%s is not a timezone map", path);
+    close (f);
+    }
+  else
+    klog_error (KLOG_CLASS, "Can't open %s: %s", path, strerror (errno));
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+  
+  soltzmap_skip_space
+
+  ==========================================================================*/
+static void soltzmap_skip_space (SolTzMapParser *parser)
+  {
+  while (parser->p < parser->end && strchr (" \t\r\n", *parser->p)
+          && *parser->p)
+    parser->p++;
+  }
+
+/*============================================================================
+  
+  soltzmap_peek
+
+  Get the next character that is not space, without consuming it, or 0 at
+  the end
+
+  ==========================================================================*/
+static char soltzmap_peek (SolTzMapParser *parser)
+  {
+  soltzmap_skip_space (parser);
+  return parser->p < parser->end ? *parser->p : 0;
+  }
+
+/*============================================================================
+  
+  soltzmap_expect
+
+  Consume the character c, which must be next, apart from space
+
+  ==========================================================================*/
+static BOOL soltzmap_expect (SolTzMapParser *parser, char c)
+  {
+  if (soltzmap_peek (parser) == c)
+    {
+    parser->p++;
+    return TRUE;
+    }
+  parser->error = TRUE;
+  return FALSE;
+  }
+
+/*============================================================================
+  
+  soltzmap_parse_string
+
+  Parse a JSON string into a buffer of size bytes, truncating it if it
+  does not fit
+
+  ==========================================================================*/
+static BOOL soltzmap_parse_string (SolTzMapParser *parser, char *buff,
+      size_t size)
+  {
+  if (!soltzmap_expect (parser, '"')) return FALSE;
+  size_t len = 0;
+  while (parser->p < parser->end && *parser->p != '"')
+    {
+    char c = *parser->p++;
+    if (c == '\\' && parser->p < parser->end)
+      {
+      c = *parser->p++;
+      switch (c)
+        {
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'u':
+          // Zone names are ASCII, so other characters need not be
+          //  decoded properly
+          c = '?';
+          if (parser->end - parser->p >= 4)
+            {
+            char hex[5];
+            memcpy (hex, parser->p, 4);
+            hex[4] = 0;
+            long u = strtol (hex, NULL, 16);
+            if (u > 0 && u < 0x80) c = u;
+            parser->p += 4;
+            }
+          break;
+        }
+      }
+    if (len + 1 < size) buff[len++] = c;
+    }
+  if (size > 0) buff[len] = 0;
+  return soltzmap_expect (parser, '"');
+  }
+
+/*============================================================================
+  
+  soltzmap_skip_value
+
+  Skip any JSON value
+
+  ==========================================================================*/
+static BOOL soltzmap_skip_value (SolTzMapParser *parser)
+  {
+  char c = soltzmap_peek (parser);
+  if (c == '"')
+    {
+    char s[1];
+    return soltzmap_parse_string (parser, s, sizeof (s));
+    }
+  if (c == '{' || c == '[')
+    {
+    char close = c == '{' ? '}' : ']';
+    parser->p++;
+    if (soltzmap_peek (parser) == close)
+      {
+      parser->p++;
+      return TRUE;
+      }
+    do
+      {
+      if (c == '{')
+        {
+        char s[1];
+        if (!soltzmap_parse_string (parser, s, sizeof (s))
+             || !soltzmap_expect (parser, ':'))
+          return FALSE;
+        }
+      if (!soltzmap_skip_value (parser)) return FALSE;
+      } while (soltzmap_peek (parser) == ',' && parser->p++);
+    return soltzmap_expect (parser, close);
+    }
+  // A number, true, false or null
+  const char *start = parser->p;
+  while (parser->p < parser->end && !strchr (",]} \t\r\n", *parser->p))
+    parser->p++;
+  if (parser->p == start) parser->error = TRUE;
+  return !parser->error;
+  }
+
+/*============================================================================
+  
+  soltzmap_parse_position
+
+  Parse a GeoJSON position, [longitude, latitude], and add it to the
+  points. Any further values, such as an altitude, are ignored
+
+  ==========================================================================*/
+static BOOL soltzmap_parse_position (SolTzMapParser *parser,
+      SolTzMapWriter *w)
+  {
+  if (!soltzmap_expect (parser, '[')) return FALSE;
+  double v[2];
+  for (int i = 0; i < 2; i++)
+    {
+    if (i > 0 && !soltzmap_expect (parser, ',')) return FALSE;
+    soltzmap_skip_space (parser);
+    // The text is not terminated, so the number is copied out for
+    //  strtod()
+    char num[64];
+    size_t len = 0;
+    while (parser->p + len < parser->end && len < sizeof (num) - 1
+         && parser->p[len] && strchr ("0123456789+-.eE", parser->p[len]))
+      len++;
+    memcpy (num, parser->p, len);
+    num[len] = 0;
+    char *end;
+    v[i] = strtod (num, &end);
+    if (end == num)
+      {
+      parser->error = TRUE;
+      return FALSE;
+      }
+    parser->p += end - num;
+    }
+  while (soltzmap_peek (parser) == ',')
+    {
+    parser->p++;
+    if (!soltzmap_skip_value (parser)) return FALSE;
+    }
+  if (fabs (v[0]) > 180 || fabs (v[1]) > 90 || w->npoints == UINT32_MAX)
+    {
+    parser->error = TRUE;
+    return FALSE;
+    }
+
+  if (w->npoints == w->points_size)
+    {
+    w->points_size = w->points_size ? w->points_size * 2 : 4096;
+    w->points = realloc (w->points, w->points_size * 2 * sizeof (int32_t));
+    }
+  w->points[w->npoints][0] = lround (v[0] * SOLTZMAP_SCALE);
+  w->points[w->npoints][1] = lround (v[1] * SOLTZMAP_SCALE);
+  w->npoints++;
+  return soltzmap_expect (parser, ']');
+  }
+
+/*============================================================================
+  
+  soltzmap_parse_ring
+
+  Parse a ring -- an array of positions -- and add it to the rings. The
+  last position repeats the first, and is dropped
+
+  ==========================================================================*/
+static BOOL soltzmap_parse_ring (SolTzMapParser *parser, SolTzMapWriter *w)
+  {
+  if (!soltzmap_expect (parser, '[')) return FALSE;
+  uint32_t first = w->npoints;
+  if (soltzmap_peek (parser) != ']')
+    {
+    do
+      {
+      if (!soltzmap_parse_position (parser, w)) return FALSE;
+      } while (soltzmap_peek (parser) == ',' && parser->p++);
+    }
+  if (!soltzmap_expect (parser, ']')) return FALSE;
+
+  uint32_t n = w->npoints - first;
+  if (n > 1 && w->points[first][0] == w->points[w->npoints - 1][0]
+       && w->points[first][1] == w->points[w->npoints - 1][1])
+    {
+    w->npoints--;
+    n--;
+    }
+  if (n < 3)
+    {
+    // Not a ring at all
+    w->npoints = first;
+    return TRUE;
+    }
+
+  if (w->nrings == w->rings_size)
+    {
+    w->rings_size = w->rings_size ? w->rings_size * 2 : 1024;
+    w->rings = realloc (w->rings, w->rings_size * sizeof (SolTzMapRing));
+    }
+  w->rings[w->nrings].first_point = first;
+  w->rings[w->nrings].npoints = n;
+  w->nrings++;
+  return TRUE;
+  }
+
+/*============================================================================
+  
+  soltzmap_parse_polygon
+
+  Parse a polygon -- an array of rings, the first of which is the
+  outside -- and add it to the polygons, without a zone
+
+  ==========================================================================*/
+static BOOL soltzmap_parse_polygon (SolTzMapParser *parser,
+      SolTzMapWriter *w)
+  {
+  if (!soltzmap_expect (parser, '[')) return FALSE;
+  uint32_t first = w->nrings;
+  if (soltzmap_peek (parser) != ']')
+    {
+    do
+      {
+      if (!soltzmap_parse_ring (parser, w)) return FALSE;
+      } while (soltzmap_peek (parser) == ',' && parser->p++);
+    }
+  if (!soltzmap_expect (parser, ']')) return FALSE;
+  if (w->nrings == first) return TRUE;
+
+  if (w->npolygons == w->polygons_size)
+    {
+    w->polygons_size = w->polygons_size ? w->polygons_size * 2 : 1024;
+    w->polygons = realloc (w->polygons,
+      w->polygons_size * sizeof (SolTzMapPolygon));
+    }
+  SolTzMapPolygon *polygon = &w->polygons[w->npolygons++];
+  memset (polygon, 0, sizeof (SolTzMapPolygon));
+  polygon->first_ring = first;
+  polygon->nrings = w->nrings - first;
+  // Holes are inside the outer ring, so it alone gives the box
+  const SolTzMapRing *outer = &w->rings[first];
+  polygon->box[MIN_X] = polygon->box[MIN_Y] = INT32_MAX;
+  polygon->box[MAX_X] = polygon->box[MAX_Y] = INT32_MIN;
+  for (uint32_t i = 0; i < outer->npoints; i++)
+    {
+    const int32_t *p = w->points[outer->first_point + i];
+    if (p[0] < polygon->box[MIN_X]) polygon->box[MIN_X] = p[0];
+    if (p[0] > polygon->box[MAX_X]) polygon->box[MAX_X] = p[0];
+    if (p[1] < polygon->box[MIN_Y]) polygon->box[MIN_Y] = p[1];
+    if (p[1] > polygon->box[MAX_Y]) polygon->box[MAX_Y] = p[1];
+    }
+  return TRUE;
+  }
+
+/*============================================================================
+  
+  soltzmap_parse_coordinates
+
+  Parse the coordinates of a Polygon or a MultiPolygon, which are told
+  apart by the depth of the arrays, so the geometry's type need not come
+  first. Coordinates of other depths are skipped
+
+  ==========================================================================*/
+static BOOL soltzmap_parse_coordinates (SolTzMapParser *parser,
+      SolTzMapWriter *w)
+  {
+  soltzmap_skip_space (parser);
+  int depth = 0;
+  for (const char *p = parser->p; p < parser->end
+        && (*p == '[' || strchr (" \t\r\n", *p)) && *p; p++)
+    if (*p == '[') depth++;
+
+  if (depth == 3)
+    return soltzmap_parse_polygon (parser, w);
+  if (depth == 4)
+    {
+    if (!soltzmap_expect (parser, '[')) return FALSE;
+    if (soltzmap_peek (parser) != ']')
+      {
+      do
+        {
+        if (!soltzmap_parse_polygon (parser, w)) return FALSE;
+        } while (soltzmap_peek (parser) == ',' && parser->p++);
+      }
+    return soltzmap_expect (parser, ']');
+    }
+  return soltzmap_skip_value (parser);
+  }
+
+/*============================================================================
+  
+  soltzmap_parse_object
+
+  Parse an object, calling handler for each member, which must consume
+  the member's value
+
+  ==========================================================================*/
+static BOOL soltzmap_parse_object (SolTzMapParser *parser,
+      BOOL (*handler)(SolTzMapParser *parser, const char *key, void *data),
+      void *data)
+  {
+  if (!soltzmap_expect (parser, '{')) return FALSE;
+  if (soltzmap_peek (parser) == '}')
+    {
+    parser->p++;
+    return TRUE;
+    }
+  do
+    {
+    char key[32];
+    if (!soltzmap_parse_string (parser, key, sizeof (key))
+         || !soltzmap_expect (parser, ':')
+         || !handler (parser, key, data))
+      return FALSE;
+    } while (soltzmap_peek (parser) == ',' && parser->p++);
+  return soltzmap_expect (parser, '}');
+  }
+
+/*============================================================================
+  
+  SolTzMapFeature
+
+  A feature as it is parsed: the zone name, and the writer to which its
+  polygons are added
+
+  ==========================================================================*/
+typedef struct _SolTzMapFeature
+  {
+  SolTzMapWriter *w;
+  char zone[MAX_ZONE_NAME];
+  } SolTzMapFeature;
+
+/*============================================================================
+  
+  soltzmap_properties_member
+
+  ==========================================================================*/
+static BOOL soltzmap_properties_member (SolTzMapParser *parser,
+      const char *key, void *data)
+  {
+  SolTzMapFeature *feature = data;
+  if (strcmp (key, "tzid") == 0 && soltzmap_peek (parser) == '"')
+    return soltzmap_parse_string (parser, feature->zone,
+      sizeof (feature->zone));
+  return soltzmap_skip_value (parser);
+  }
+
+/*============================================================================
+  
+  soltzmap_geometry_member
+
+  ==========================================================================*/
+static BOOL soltzmap_geometry_member (SolTzMapParser *parser,
+      const char *key, void *data)
+  {
+  SolTzMapFeature *feature = data;
+  if (strcmp (key, "coordinates") == 0)
+    return soltzmap_parse_coordinates (parser, feature->w);
+  return soltzmap_skip_value (parser);
+  }
+
+/*============================================================================
+  
+  soltzmap_feature_member
+
+  ==========================================================================*/
+static BOOL soltzmap_feature_member (SolTzMapParser *parser,
+      const char *key, void *data)
+  {
+  if (strcmp (key, "properties") == 0 && soltzmap_peek (parser) == '{')
+    return soltzmap_parse_object (parser, soltzmap_properties_member, data);
+  if (strcmp (key, "geometry") == 0 && soltzmap_peek (parser) == '{')
+    return soltzmap_parse_object (parser, soltzmap_geometry_member, data);
+  return soltzmap_skip_value (parser);
+  }
+
+/*============================================================================
+  
+  soltzmap_add_zone
+
+  Add a zone name, if it is not already there, returning its number
+
+  ==========================================================================*/
+static uint32_t soltzmap_add_zone (SolTzMapWriter *w, const char *zone)
+  {
+  // There are only a few hundred zones, and the features for a zone are
+  //  usually together, so a search from the end is quick enough
+  for (uint32_t i = w->nzones; i > 0; i--)
+    if (strcmp (w->pool + w->zones[i - 1], zone) == 0) return i - 1;
+  size_t len = strlen (zone) + 1;
+  w->pool = realloc (w->pool, w->pool_len + len);
+  memcpy (w->pool + w->pool_len, zone, len);
+  w->zones = realloc (w->zones, (w->nzones + 1) * sizeof (uint32_t));
+  w->zones[w->nzones] = w->pool_len;
+  w->pool_len += len;
+  return w->nzones++;
+  }
+
+/*============================================================================
+  
+  soltzmap_parse_feature
+
+  Parse a feature, and give its polygons its zone or, if it has none,
+  drop them
+
+  ==========================================================================*/
+static BOOL soltzmap_parse_feature (SolTzMapParser *parser,
+      SolTzMapWriter *w)
+  {
+  SolTzMapFeature feature;
+  feature.w = w;
+  feature.zone[0] = 0;
+  uint32_t npolygons = w->npolygons;
+  uint32_t nrings = w->nrings;
+  uint32_t npoints = w->npoints;
+  if (!soltzmap_parse_object (parser, soltzmap_feature_member, &feature))
+    return FALSE;
+  if (feature.zone[0])
+    {
+    uint32_t zone = soltzmap_add_zone (w, feature.zone);
+    for (uint32_t i = npolygons; i < w->npolygons; i++)
+      w->polygons[i].zone = zone;
+    }
+  else
+    {
+    w->npolygons = npolygons;
+    w->nrings = nrings;
+    w->npoints = npoints;
+    }
+  return TRUE;
+  }
+
+/*============================================================================
+  
+  soltzmap_collection_member
+
+  ==========================================================================*/
+static BOOL soltzmap_collection_member (SolTzMapParser *parser,
+      const char *key, void *data)
+  {
+  SolTzMapWriter *w = data;
+  if (strcmp (key, "features") != 0)
+    return soltzmap_skip_value (parser);
+  if (!soltzmap_expect (parser, '[')) return FALSE;
+  if (soltzmap_peek (parser) != ']')
+    {
+    do
+      {
+      if (!soltzmap_parse_feature (parser, w)) return FALSE;
+      } while (soltzmap_peek (parser) == ',' && parser->p++);
+    }
+  return soltzmap_expect (parser, ']');
+  }
+
+/*============================================================================
+  
+  soltzmap_compare_centres
+
+  Order boxes by the centre of one axis, then by number, so the tree does
+  not depend on the sort algorithm
+
+  ==========================================================================*/
+typedef struct _SolTzMapSort
+  {
+  const int32_t (*boxes)[4];
+  int axis;
+  } SolTzMapSort;
+
+static int soltzmap_compare_centres (const void *p1, const void *p2,
+      void *arg)
+  {
+  const SolTzMapSort *sort = arg;
+  uint32_t i1 = *(const uint32_t *)p1, i2 = *(const uint32_t *)p2;
+  int64_t c1 = (int64_t)sort->boxes[i1][sort->axis]
+    + sort->boxes[i1][sort->axis + 2];
+  int64_t c2 = (int64_t)sort->boxes[i2][sort->axis]
+    + sort->boxes[i2][sort->axis + 2];
+  if (c1 != c2) return c1 < c2 ? -1 : 1;
+  return i1 < i2 ? -1 : i1 > i2;
+  }
+
+/*============================================================================
+  
+  soltzmap_str_order
+
+  Put n boxes in the order of the Sort-Tile-Recursive packing: sorted by
+  x into vertical slices, each of which holds enough boxes for a whole
+  number of nodes, and sorted by y within the slice. Consecutive runs of
+  SOLTZMAP_FANOUT boxes in this order make nodes that are compact and
+  overlap little. The result is a list of the boxes' numbers
+
+  ==========================================================================*/
+static uint32_t *soltzmap_str_order (const int32_t (*boxes)[4], uint32_t n)
+  {
+  uint32_t *order = malloc (n * sizeof (uint32_t));
+  for (uint32_t i = 0; i < n; i++) order[i] = i;
+  uint32_t nnodes = (n + SOLTZMAP_FANOUT - 1) / SOLTZMAP_FANOUT;
+  uint32_t nslices = ceil (sqrt (nnodes));
+  uint32_t slice = ((nnodes + nslices - 1) / nslices) * SOLTZMAP_FANOUT;
+
+  SolTzMapSort sort = { boxes, MIN_X };
+  qsort_r (order, n, sizeof (uint32_t), soltzmap_compare_centres, &sort);
+  sort.axis = MIN_Y;
+  for (uint32_t i = 0; i < n; i += slice)
+    qsort_r (order + i, i + slice < n ? slice : n - i, sizeof (uint32_t),
+      soltzmap_compare_centres, &sort);
+  return order;
+  }
+
+/*============================================================================
+  
+  soltzmap_add_parents
+
+  Add a level of nodes to the tree, over the n boxes given, in runs of
+  SOLTZMAP_FANOUT, whose children start at first
+
+  ==========================================================================*/
+static void soltzmap_add_parents (SolTzMapWriter *w,
+      const int32_t (*boxes)[4], uint32_t n, uint32_t first)
+  {
+  for (uint32_t i = 0; i < n; i += SOLTZMAP_FANOUT)
+    {
+    SolTzMapNode *node = &w->nodes[w->nnodes++];
+    node->first = first + i;
+    node->count = i + SOLTZMAP_FANOUT < n ? SOLTZMAP_FANOUT : n - i;
+    memcpy (node->box, boxes[i], sizeof (node->box));
+    for (uint32_t j = i + 1; j < i + node->count; j++)
+      {
+      if (boxes[j][MIN_X] < node->box[MIN_X])
+        node->box[MIN_X] = boxes[j][MIN_X];
+      if (boxes[j][MIN_Y] < node->box[MIN_Y])
+        node->box[MIN_Y] = boxes[j][MIN_Y];
+      if (boxes[j][MAX_X] > node->box[MAX_X])
+        node->box[MAX_X] = boxes[j][MAX_X];
+      if (boxes[j][MAX_Y] > node->box[MAX_Y])
+        node->box[MAX_Y] = boxes[j][MAX_Y];
+      }
+    }
+  }
+
+/*============================================================================
+  
+  soltzmap_build_tree
+
+  Build the R-tree from the bottom up, reordering the polygons, and each
+  level of nodes, so that the children of every node are together
+
+  ==========================================================================*/
+static void soltzmap_build_tree (SolTzMapWriter *w)
+  {
+  uint32_t n = w->npolygons;
+  int32_t (*boxes)[4] = malloc (n * sizeof (*boxes));
+  for (uint32_t i = 0; i < n; i++)
+    memcpy (boxes[i], w->polygons[i].box, sizeof (boxes[i]));
+  uint32_t *order = soltzmap_str_order ((const int32_t (*)[4])boxes, n);
+  SolTzMapPolygon *polygons = malloc (n * sizeof (SolTzMapPolygon));
+  for (uint32_t i = 0; i < n; i++)
+    {
+    polygons[i] = w->polygons[order[i]];
+    memcpy (boxes[i], polygons[i].box, sizeof (boxes[i]));
+    }
+  free (w->polygons);
+  w->polygons = polygons;
+  free (order);
+
+  // Each level has at most a sixteenth as many nodes as the one below,
+  //  so there are fewer nodes in all than a tenth of the polygons, and
+  //  one more for each level to be partly full
+  w->nodes = malloc ((n / 10 + SOLTZMAP_MAX_DEPTH + 1)
+    * sizeof (SolTzMapNode));
+  w->nnodes = 0;
+  soltzmap_add_parents (w, (const int32_t (*)[4])boxes, n, 0);
+  w->nleaves = w->nnodes;
+
+  uint32_t first = 0;
+  while (w->nnodes - first > 1)
+    {
+    uint32_t count = w->nnodes - first;
+    for (uint32_t i = 0; i < count; i++)
+      memcpy (boxes[i], w->nodes[first + i].box, sizeof (boxes[i]));
+    order = soltzmap_str_order ((const int32_t (*)[4])boxes, count);
+    SolTzMapNode *level = malloc (count * sizeof (SolTzMapNode));
+    for (uint32_t i = 0; i < count; i++)
+      {
+      level[i] = w->nodes[first + order[i]];
+      memcpy (boxes[i], level[i].box, sizeof (boxes[i]));
+      }
+    memcpy (w->nodes + first, level, count * sizeof (SolTzMapNode));
+    free (level);
+    free (order);
+    soltzmap_add_parents (w, (const int32_t (*)[4])boxes, count, first);
+    first += count;
+    }
+  free (boxes);
+  }
+
+/*============================================================================
+  
+  soltzmap_write_file
+
+  ==========================================================================*/
+BOOL soltzmap_write_file (const char *source, const char *path)
+  {
+  KLOG_IN
+  BOOL ret = FALSE;
+  int f = open (source, O_RDONLY);
+  if (f >= 0)
+    {
+    struct stat sb;
+    size_t size = fstat (f, &sb) == 0 ? sb.st_size : 0;
+    void *map = size > 0
+      ? mmap (NULL, size, PROT_READ, MAP_PRIVATE, f, 0) : MAP_FAILED;
+    close (f);
+    if (map != MAP_FAILED)
+      {
+      SolTzMapWriter w;
+      memset (&w, 0, sizeof (w));
+      SolTzMapParser parser;
+      parser.p = map;
+      parser.end = parser.p + size;
+      parser.error = FALSE;
+      BOOL parsed = soltzmap_parse_object (&parser,
+        soltzmap_collection_member, &w);
+      if (!parsed || parser.error)
+        klog_error (KLOG_CLASS, "%s is not valid GeoJSON, at byte %ld",
+          source, (long)(parser.p - (const char *)map));
+      else if (w.npolygons == 0)
+        klog_error (KLOG_CLASS, "%s has no timezone boundaries", source);
+      else
+        {
+        klog_debug (KLOG_CLASS, "Read %u zones, %u polygons, %u points",
+          w.nzones, w.npolygons, w.npoints);
+        soltzmap_build_tree (&w);
+
+        SolTzMapHeader h;
+        memset (&h, 0, sizeof (h));
+        memcpy (h.magic, SOLTZMAP_MAGIC, 8);
+        h.version = SOLTZMAP_VERSION;
+        h.byte_order = SOLTZMAP_BYTE_ORDER;
+        h.npolygons = w.npolygons;
+        h.nrings = w.nrings;
+        h.npoints = w.npoints;
+        h.nnodes = w.nnodes;
+        h.nleaves = w.nleaves;
+        h.nzones = w.nzones;
+        h.pool_size = w.pool_len;
+
+        FILE *out = fopen (path, "wb");
+        if (out)
+          {
+          BOOL ok = fwrite (&h, sizeof (h), 1, out) == 1
+            && fwrite (w.polygons, sizeof (SolTzMapPolygon), w.npolygons,
+                 out) == w.npolygons
+            && fwrite (w.rings, sizeof (SolTzMapRing), w.nrings, out)
+                 == w.nrings
+            && fwrite (w.points, 2 * sizeof (int32_t), w.npoints, out)
+                 == w.npoints
+            && fwrite (w.nodes, sizeof (SolTzMapNode), w.nnodes, out)
+                 == w.nnodes
+            && fwrite (w.zones, sizeof (uint32_t), w.nzones, out)
+                 == w.nzones
+            && fwrite (w.pool, 1, w.pool_len, out) == w.pool_len;
+          if (fclose (out) != 0) ok = FALSE;
+          if (ok)
+            {
+            klog_debug (KLOG_CLASS, "Wrote %u nodes to %s", w.nnodes,
+              path);
+            ret = TRUE;
+            }
+          else
+            klog_error (KLOG_CLASS, "Can't write %s: %s", path,
+              strerror (errno));
+          }
+        else
+          klog_error (KLOG_CLASS, "Can't open %s for writing: %s", path,
+            strerror (errno));
+        }
+      free (w.polygons);
+      free (w.rings);
+      free (w.points);
+      free (w.nodes);
+      free (w.zones);
+      free (w.pool);
+      munmap (map, size);
+      }
+    else
+      klog_error (KLOG_CLASS, "Can't read %s", source);
+    }
+  else
+    klog_error (KLOG_CLASS, "Can't open %s: %s", source, strerror (errno));
+
+  KLOG_OUT
+  return ret;
+  }
+
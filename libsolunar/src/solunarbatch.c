@@ -0,0 +1,248 @@
+/*============================================================================
+  
+  libsolunar
+  
+  solunarbatch.c
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <libsolunar/solunarbatch.h>
+#include <libsolunar/solephemeris.h>
+#include <libsolunar/moontimes.h>
+#include <klib/klog.h>
+
+#define KLOG_CLASS "libsolunar.solunarbatch"
+
+// The size of a tile. A tile should be small enough that there are
+//  many more tiles than threads, even for a batch of one place or
+//  one day, so that no thread is left with much more work than the
+//  others at the end, but large enough that taking a tile costs little
+//  compared with working it out
+#define SOLUNAR_BATCH_DAYS_PER_TILE 16
+#define SOLUNAR_BATCH_OBSERVERS_PER_TILE 8
+
+// A local day starts at most 14 hours before midnight UTC at the start
+//  of the same date, and ends at most 12 hours after midnight UTC at the
+//  end of it, give or take an hour for daylight saving. Historical
+//  offsets, from local mean time, can be a little larger
+#define SOLUNAR_BATCH_MARGIN (26 * 60 * 60)
+
+/*============================================================================
+  
+  SolunarBatch
+
+  The state shared by the threads. Tiles are numbered so that all the
+  tiles for one block of days come before any for the next block, so
+  the threads work on the same ephemeris at the same time
+
+  ==========================================================================*/
+typedef struct _SolunarBatch
+  {
+  const SolunarObserver *observers;
+  int nobservers;
+  int year;
+  int month;
+  int day;
+  int ndays;
+  SolunarDaySummary **results;
+  time_t first;      // Midnight UTC at the start of the first date
+  int nblocks;       // Blocks of days
+  int ngroups;       // Groups of observers
+  SolEphemeris **ephemerides; // One for each block, or NULL if not shared
+  atomic_int next_block;
+  atomic_int next_tile;
+  } SolunarBatch;
+
+/*============================================================================
+  
+  solunar_batch_do_block
+
+  Work out the ephemeris for a block of days
+
+  ==========================================================================*/
+static void solunar_batch_do_block (SolunarBatch *b, int block)
+  {
+  KLOG_IN
+  int first_day = block * SOLUNAR_BATCH_DAYS_PER_TILE;
+  int ndays = b->ndays - first_day;
+  if (ndays > SOLUNAR_BATCH_DAYS_PER_TILE)
+    ndays = SOLUNAR_BATCH_DAYS_PER_TILE;
+  time_t start = b->first + (time_t)first_day * 86400;
+  b->ephemerides[block] = solephemeris_new (start - SOLUNAR_BATCH_MARGIN,
+    start + (time_t)ndays * 86400 + SOLUNAR_BATCH_MARGIN,
+    MOONTIMES_INTERVAL);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solunar_batch_do_tile
+
+  ==========================================================================*/
+static void solunar_batch_do_tile (SolunarBatch *b, int tile)
+  {
+  KLOG_IN
+  int block = tile / b->ngroups;
+  int group = tile % b->ngroups;
+  int first_day = block * SOLUNAR_BATCH_DAYS_PER_TILE;
+  int ndays = b->ndays - first_day;
+  if (ndays > SOLUNAR_BATCH_DAYS_PER_TILE)
+    ndays = SOLUNAR_BATCH_DAYS_PER_TILE;
+  int first_observer = group * SOLUNAR_BATCH_OBSERVERS_PER_TILE;
+  int nobservers = b->nobservers - first_observer;
+  if (nobservers > SOLUNAR_BATCH_OBSERVERS_PER_TILE)
+    nobservers = SOLUNAR_BATCH_OBSERVERS_PER_TILE;
+  const SolEphemeris *eph = b->ephemerides ? b->ephemerides[block] : NULL;
+
+  for (int o = first_observer; o < first_observer + nobservers; o++)
+    {
+    const SolunarObserver *obs = &b->observers[o];
+    SolunarDayIter *iter = solunar_day_iter_new_from_date (b->year,
+      b->month, b->day + first_day, ndays, obs->latitude, obs->longitude,
+      obs->city, obs->tz, eph);
+    SolunarDaySummary **results = b->results + (size_t)o * b->ndays
+      + first_day;
+    for (int d = 0; d < ndays; d++)
+      results[d] = solunar_day_iter_next (iter);
+    solunar_day_iter_destroy (iter);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solunar_batch_block_worker
+
+  ==========================================================================*/
+static void *solunar_batch_block_worker (void *arg)
+  {
+  KLOG_IN
+  SolunarBatch *b = arg;
+  int block;
+  while ((block = atomic_fetch_add (&b->next_block, 1)) < b->nblocks)
+    solunar_batch_do_block (b, block);
+  KLOG_OUT
+  return NULL;
+  }
+
+/*============================================================================
+  
+  solunar_batch_tile_worker
+
+  ==========================================================================*/
+static void *solunar_batch_tile_worker (void *arg)
+  {
+  KLOG_IN
+  SolunarBatch *b = arg;
+  int ntiles = b->nblocks * b->ngroups;
+  int tile;
+  while ((tile = atomic_fetch_add (&b->next_tile, 1)) < ntiles)
+    solunar_batch_do_tile (b, tile);
+  KLOG_OUT
+  return NULL;
+  }
+
+/*============================================================================
+  
+  solunar_batch_run
+
+  Run worker on the specified number of threads, one of which is the
+  calling thread, and wait for them all to finish. If a thread can't be
+  started, the others just do more of the work
+
+  ==========================================================================*/
+static void solunar_batch_run (SolunarBatch *b, int threads,
+      void *(*worker)(void *))
+  {
+  KLOG_IN
+  pthread_t *workers = malloc (threads * sizeof (pthread_t));
+  int started = 0;
+  for (int i = 1; i < threads; i++)
+    {
+    int err = pthread_create (&workers[started], NULL, worker, b);
+    if (err == 0)
+      started++;
+    else
+      klog_warn (KLOG_CLASS, "Can't start thread: %s", strerror (err));
+    }
+  worker (b);
+  for (int i = 0; i < started; i++)
+    pthread_join (workers[i], NULL);
+  free (workers);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  solunar_batch_create_day_summaries
+
+  ==========================================================================*/
+void solunar_batch_create_day_summaries (const SolunarObserver *observers,
+       int nobservers, int year, int month, int day, int ndays,
+       int threads, SolunarDaySummary **results)
+  {
+  KLOG_IN
+  assert (nobservers >= 0);
+  assert (ndays >= 0);
+  if (nobservers == 0 || ndays == 0)
+    {
+    KLOG_OUT
+    return;
+    }
+
+  SolunarBatch b;
+  memset (&b, 0, sizeof (b));
+  b.observers = observers;
+  b.nobservers = nobservers;
+  b.year = year;
+  b.month = month;
+  b.day = day;
+  b.ndays = ndays;
+  b.results = results;
+  b.first = datetimeconv_maketime_r (year, month, day, 0, 0, 0,
+    ktimezone_get ("UTC"));
+  b.nblocks = (ndays + SOLUNAR_BATCH_DAYS_PER_TILE - 1)
+    / SOLUNAR_BATCH_DAYS_PER_TILE;
+  b.ngroups = (nobservers + SOLUNAR_BATCH_OBSERVERS_PER_TILE - 1)
+    / SOLUNAR_BATCH_OBSERVERS_PER_TILE;
+  atomic_init (&b.next_block, 0);
+  atomic_init (&b.next_tile, 0);
+
+  if (threads <= 0) threads = sysconf (_SC_NPROCESSORS_ONLN);
+  if (threads <= 0) threads = 1;
+  int ntiles = b.nblocks * b.ngroups;
+  if (threads > ntiles) threads = ntiles;
+  klog_debug (KLOG_CLASS, "%d places, %d days, %d tiles, %d threads",
+    nobservers, ndays, ntiles, threads);
+
+  // With only one place, every sample of the Moon's position is used
+  //  once anyway, and the day iterator already shares the boundaries
+  if (nobservers > 1)
+    {
+    b.ephemerides = calloc (b.nblocks, sizeof (SolEphemeris *));
+    solunar_batch_run (&b, threads < b.nblocks ? threads : b.nblocks,
+      solunar_batch_block_worker);
+    }
+
+  solunar_batch_run (&b, threads, solunar_batch_tile_worker);
+
+  if (b.ephemerides)
+    {
+    for (int i = 0; i < b.nblocks; i++)
+      solephemeris_destroy (b.ephemerides[i]);
+    free (b.ephemerides);
+    }
+  KLOG_OUT
+  }
+
@@ -24,9 +24,6 @@
 
 #define KLOG_CLASS "libsolunar.solunardaysummary"
 
-// Largest number of sunrises and sunsets (each) we can store
-#define N_MOON_EVENTS 3
-
 /*============================================================================
  
   SolunarDaySummary 
@@ -43,10 +40,7 @@ struct _SolunarDaySummary
   time_t end_astronomical_twilight;
   time_t start_astronomical_twilight;
   time_t high_noon;
-  int nrises;
-  int nsets;
-  time_t moonrises[N_MOON_EVENTS];
-  time_t moonsets[N_MOON_EVENTS];
+  MoonTimesEvents moon_events;
   double sun_max_altitude;
   double moon_distance; // km
   double moon_phase; // 0-1
@@ -60,17 +54,38 @@ struct _SolunarDaySummary
   int moon_flags;
   };
 
+/*============================================================================
+ 
+  SolunarDayIter
+
+  ==========================================================================*/
+struct _SolunarDayIter
+  {
+  KDayIter *days;
+  double latitude;
+  double longitude;
+  char *city;
+  char *tz;
+  const SolEphemeris *eph;
+  MoonTimesCarry carry;
+  };
 
 /*============================================================================
  
-  solunar_day_summary_create 
+  solunar_day_summary_create_on_day
+
+  Create the summary for a date in a local day that has already been
+  worked out. carry may be NULL or, if the days are consecutive, is
+  passed from one day to the next. eph may be NULL
 
   ==========================================================================*/
-SolunarDaySummary *solunar_day_summary_create 
-        (time_t date, double latitude, double longitude, const char *city, 
-	  const char *tz)
+static SolunarDaySummary *solunar_day_summary_create_on_day 
+        (time_t date, const KDay *day, double latitude, double longitude, 
+         const char *city, const char *tz, const SolEphemeris *eph,
+         MoonTimesCarry *carry)
   {
   KLOG_IN
+
   SolunarDaySummary *self = malloc (sizeof (SolunarDaySummary));
   memset (self, 0, sizeof (SolunarDaySummary));
 
@@ -78,37 +93,29 @@ SolunarDaySummary *solunar_day_summary_create
   self->latitude = latitude;
   self->date = date;
 
-  self->sunrise = suntimes_get_sunrise 
-	  (date, latitude, longitude, SUNTIMES_DEFAULT_ZENITH);
-
-  self->sunset = suntimes_get_sunset
-	  (date, latitude, longitude, SUNTIMES_DEFAULT_ZENITH);
-
-  self->end_civil_twilight = suntimes_get_sunset
-	  (date, latitude, longitude, SUNTIMES_CIVIL_TWILIGHT);
-
-  self->end_nautical_twilight = suntimes_get_sunset
-	  (date, latitude, longitude, SUNTIMES_NAUTICAL_TWILIGHT);
-
-  self->end_astronomical_twilight = suntimes_get_sunset
-	  (date, latitude, longitude, SUNTIMES_ASTRONOMICAL_TWILIGHT);
-
-  self->start_civil_twilight = suntimes_get_sunrise
-	  (date, latitude, longitude, SUNTIMES_CIVIL_TWILIGHT);
-
-  self->start_nautical_twilight = suntimes_get_sunrise
-	  (date, latitude, longitude, SUNTIMES_NAUTICAL_TWILIGHT);
-
-  self->start_astronomical_twilight = suntimes_get_sunrise
-	  (date, latitude, longitude, SUNTIMES_ASTRONOMICAL_TWILIGHT);
-
-  time_t tstart = datetimeconv_make_time_on_day (date, 0, 0, 0, tz);
-  time_t tend = datetimeconv_make_time_on_day (date, 23, 59, 0, tz);
-
-  moontimes_get_moonrises (tstart, tend, latitude, longitude, 
-    self->moonrises, N_MOON_EVENTS, &self->nrises); 
-  moontimes_get_moonsets (tstart, tend, latitude, longitude, 
-    self->moonsets, N_MOON_EVENTS, &self->nsets); 
+  SunTimesEvent sun_events[4] = 
+    {
+    { SUNTIMES_DEFAULT_ZENITH },
+    { SUNTIMES_CIVIL_TWILIGHT },
+    { SUNTIMES_NAUTICAL_TWILIGHT },
+    { SUNTIMES_ASTRONOMICAL_TWILIGHT }
+    };
+  suntimes_get_all_events (date, latitude, longitude, sun_events, 4);
+
+  self->sunrise = sun_events[0].rise;
+  self->sunset = sun_events[0].set;
+  self->start_civil_twilight = sun_events[1].rise;
+  self->end_civil_twilight = sun_events[1].set;
+  self->start_nautical_twilight = sun_events[2].rise;
+  self->end_nautical_twilight = sun_events[2].set;
+  self->start_astronomical_twilight = sun_events[3].rise;
+  self->end_astronomical_twilight = sun_events[3].set;
+
+  // A day that was skipped, when a zone moved across the date line, has
+  //  no moon events
+  if (day->end > day->start)
+    moontimes_get_events_ephemeris (day->start, day->end, latitude, 
+      longitude, eph, carry, &self->moon_events);
   
   // In principle, this calculation should take into account the
   //  fact that the Earth moves in its orbit between sunrise and
@@ -137,6 +144,147 @@ SolunarDaySummary *solunar_day_summary_create
   return self;
   }
 
+/*============================================================================
+ 
+  solunar_day_summary_create 
+
+  ==========================================================================*/
+SolunarDaySummary *solunar_day_summary_create 
+        (time_t date, double latitude, double longitude, const char *city, 
+	  const char *tz)
+  {
+  KLOG_IN
+  SolunarDaySummary *self = solunar_day_summary_create_with_ephemeris 
+    (date, latitude, longitude, city, tz, NULL);
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+ 
+  solunar_day_summary_create_with_ephemeris
+
+  ==========================================================================*/
+SolunarDaySummary *solunar_day_summary_create_with_ephemeris
+        (time_t date, double latitude, double longitude, const char *city, 
+	  const char *tz, const SolEphemeris *eph)
+  {
+  KLOG_IN
+  // Moon events are found over the whole of the local day in which 
+  //  'date' falls, which might not be 24 hours long
+  KDayIter *iter = kdayiter_new_from_time (tz ? ktimezone_get (tz) : NULL, 
+    date, 1);
+  KDay day;
+  kdayiter_next (iter, &day);
+  kdayiter_destroy (iter);
+
+  SolunarDaySummary *self = solunar_day_summary_create_on_day (date, &day,
+    latitude, longitude, city, tz, eph, NULL);
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+ 
+  solunar_day_summary_create_ephemeris
+
+  The local day containing date starts no more than a day before it, and
+  ends no more than a day after it, allowing an extra hour for the day 
+  on which daylight saving ends
+
+  ==========================================================================*/
+SolEphemeris *solunar_day_summary_create_ephemeris (time_t date)
+  {
+  KLOG_IN
+  const int margin = 25 * 60 * 60;
+  SolEphemeris *ret = solephemeris_new (date - margin, date + margin,
+    MOONTIMES_INTERVAL);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+ 
+  solunar_day_iter_new
+
+  ==========================================================================*/
+SolunarDayIter *solunar_day_iter_new (time_t first, int n, 
+        double latitude, double longitude, const char *city, const char *tz)
+  {
+  KLOG_IN
+  SolunarDayIter *self = malloc (sizeof (SolunarDayIter));
+  memset (self, 0, sizeof (SolunarDayIter));
+  self->days = kdayiter_new_from_time (tz ? ktimezone_get (tz) : NULL, 
+    first, n);
+  self->latitude = latitude;
+  self->longitude = longitude;
+  if (city) self->city = strdup (city);
+  if (tz) self->tz = strdup (tz);
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+ 
+  solunar_day_iter_new_from_date
+
+  ==========================================================================*/
+SolunarDayIter *solunar_day_iter_new_from_date (int year, int month, 
+        int day, int n, double latitude, double longitude, const char *city,
+        const char *tz, const SolEphemeris *eph)
+  {
+  KLOG_IN
+  assert (n > 0);
+  SolunarDayIter *self = malloc (sizeof (SolunarDayIter));
+  memset (self, 0, sizeof (SolunarDayIter));
+  self->days = kdayiter_new (tz ? ktimezone_get (tz) : NULL, 
+    year, month, day, year, month, day + n - 1);
+  self->latitude = latitude;
+  self->longitude = longitude;
+  self->eph = eph;
+  if (city) self->city = strdup (city);
+  if (tz) self->tz = strdup (tz);
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+ 
+  solunar_day_iter_next
+
+  ==========================================================================*/
+SolunarDaySummary *solunar_day_iter_next (SolunarDayIter *self)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  SolunarDaySummary *ret = NULL;
+  KDay day;
+  if (kdayiter_next (self->days, &day))
+    ret = solunar_day_summary_create_on_day (day.start, &day, 
+      self->latitude, self->longitude, self->city, self->tz, self->eph, 
+      &self->carry);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+ 
+  solunar_day_iter_destroy
+
+  ==========================================================================*/
+void solunar_day_iter_destroy (SolunarDayIter *self)
+  {
+  KLOG_IN
+  if (self)
+    {
+    kdayiter_destroy (self->days);
+    if (self->city) free (self->city);
+    if (self->tz) free (self->tz);
+    free (self);
+    }
+  KLOG_OUT
+  }
+
 /*============================================================================
  
   solunar_day_summary_destroy
@@ -316,6 +464,37 @@ int solunar_day_summary_get_moon_flags (const SolunarDaySummary *self)
   return ret; 
   }
 
+/*============================================================================
+ 
+  solunar_day_summary_get_moon_lower_transit
+
+  ==========================================================================*/
+time_t solunar_day_summary_get_moon_lower_transit
+                (const SolunarDaySummary *self, int n)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  assert (n < self->moon_events.nlower_transits);
+  time_t ret = self->moon_events.lower_transits[n];
+  KLOG_OUT
+  return ret; 
+  }
+
+/*============================================================================
+ 
+  solunar_day_summary_get_moon_max_altitude
+
+  ==========================================================================*/
+double solunar_day_summary_get_moon_max_altitude 
+                (const SolunarDaySummary *self)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  double ret = self->moon_events.max_altitude;
+  KLOG_OUT
+  return ret; 
+  }
+
 /*============================================================================
  
   solunar_day_summary_get_moon_phase
@@ -355,8 +534,8 @@ extern time_t solunar_day_summary_get_moon_rise
   {
   KLOG_IN
   assert (self != NULL);
-  assert (n < self->nrises);
-  time_t ret = self->moonrises[n];
+  assert (n < self->moon_events.nrises);
+  time_t ret = self->moon_events.rises[n];
   KLOG_OUT
   return ret; 
   }
@@ -371,8 +550,53 @@ time_t solunar_day_summary_get_moon_set
   {
   KLOG_IN
   assert (self != NULL);
-  assert (n < self->nsets);
-  time_t ret = self->moonsets[n];
+  assert (n < self->moon_events.nsets);
+  time_t ret = self->moon_events.sets[n];
+  KLOG_OUT
+  return ret; 
+  }
+
+/*============================================================================
+ 
+  solunar_day_summary_get_moon_transit
+
+  ==========================================================================*/
+time_t solunar_day_summary_get_moon_transit
+                (const SolunarDaySummary *self, int n)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  assert (n < self->moon_events.nupper_transits);
+  time_t ret = self->moon_events.upper_transits[n];
+  KLOG_OUT
+  return ret; 
+  }
+
+/*============================================================================
+ 
+  solunar_day_summary_get_n_moon_lower_transits
+
+  ==========================================================================*/
+int solunar_day_summary_get_n_moon_lower_transits 
+                (const SolunarDaySummary *self)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  int ret = self->moon_events.nlower_transits;
+  KLOG_OUT
+  return ret; 
+  }
+
+/*============================================================================
+ 
+  solunar_day_summary_get_n_moon_transits
+
+  ==========================================================================*/
+int solunar_day_summary_get_n_moon_transits (const SolunarDaySummary *self)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  int ret = self->moon_events.nupper_transits;
   KLOG_OUT
   return ret; 
   }
@@ -386,7 +610,7 @@ int solunar_day_summary_get_n_rises (const SolunarDaySummary *self)
   {
   KLOG_IN
   assert (self != NULL);
-  time_t ret = self->nrises;
+  time_t ret = self->moon_events.nrises;
   KLOG_OUT
   return ret; 
   }
@@ -400,7 +624,7 @@ int solunar_day_summary_get_n_sets (const SolunarDaySummary *self)
   {
   KLOG_IN
   assert (self != NULL);
-  time_t ret = self->nsets;
+  time_t ret = self->moon_events.nsets;
   KLOG_OUT
   return ret; 
   }
@@ -509,6 +733,26 @@ extern const char *solunar_day_summary_get_tz_city
   }
 
 
+/*============================================================================
+ 
+  solunar_day_summary_append_times
+
+  Append a list of times to a JSON array, as quoted strings separated
+  by commas
+
+  ==========================================================================*/
+static void solunar_day_summary_append_times (KString *json, 
+    const KTimeFormat *fmt, const time_t *times, int n)
+  {
+  KLOG_IN
+  char s[MOONTIMES_MAX_EVENTS][KTIMEFORMAT_MAX];
+  if (n > MOONTIMES_MAX_EVENTS) n = MOONTIMES_MAX_EVENTS;
+  ktimeformat_format_batch (fmt, times, n, s[0], KTIMEFORMAT_MAX);
+  for (int i = 0; i < n; i++)
+    kstring_append_printf (json, i == 0 ? "\"%s\"" : ",\"%s\"", s[i]);
+  KLOG_OUT
+  }
+
 /*============================================================================
  
   solunar_day_summary_to_json
@@ -530,73 +774,67 @@ KString *solunar_day_summary_to_json (const SolunarDaySummary *self)
     kstring_append_printf (json, "\"timezone\":\"%s\",\n", tz_city);
   else
     kstring_append_printf (json, "\"timezone\":\"sys\",\n", tz_city);
+
+  // The formats are compiled once, and bound to the zone once, for all
+  //  the times in the summary
+  const KTimeZone *zone = tz_city ? ktimezone_get (tz_city) : NULL;
+  KTimeFormat *date_fmt = ktimeformat_new ("long_date", zone);
+  KTimeFormat *time_fmt = ktimeformat_new ("24hr", zone);
+
   kstring_append_printf (json, "\"latitude\":%g,\n", self->latitude);
-  char *s = datetimeconv_format_time ("long_date", tz_city, self->date);
   kstring_append_printf (json, "\"longitude\":%g,\n", self->longitude);
+  char s[KTIMEFORMAT_MAX];
+  ktimeformat_format (date_fmt, self->date, s, sizeof (s));
   kstring_append_printf (json, "\"date\":\"%s\",\n", s);
-  free (s);
   kstring_append_printf (json, "\"sun\":{");
 
   if (self->sunrise)
     {
-    char *s = datetimeconv_format_time ("24hr", tz_city, self->sunrise);
+    ktimeformat_format (time_fmt, self->sunrise, s, sizeof (s));
     kstring_append_printf (json, "\"sunrise\":\"%s\",\n", s);
-    free (s);
     }
   if (self->sunset)
     {
-    char *s = datetimeconv_format_time ("24hr", tz_city, self->sunset);
+    ktimeformat_format (time_fmt, self->sunset, s, sizeof (s));
     kstring_append_printf (json, "\"sunset\":\"%s\",\n", s);
-    free (s);
     }
   if (self->start_civil_twilight)
     {
-    char *s = datetimeconv_format_time ("24hr", tz_city, 
-      self->start_civil_twilight);
+    ktimeformat_format (time_fmt, self->start_civil_twilight, s, sizeof (s));
     kstring_append_printf (json, "\"start civil twilight\":\"%s\",\n", s);
-    free (s);
     }
   if (self->end_civil_twilight)
     {
-    char *s = datetimeconv_format_time ("24hr", tz_city, 
-      self->end_civil_twilight);
+    ktimeformat_format (time_fmt, self->end_civil_twilight, s, sizeof (s));
     kstring_append_printf (json, "\"end civil twilight\":\"%s\",\n", s);
-    free (s);
     }
   if (self->start_nautical_twilight)
     {
-    char *s = datetimeconv_format_time ("24hr", tz_city, 
-      self->start_nautical_twilight);
+    ktimeformat_format (time_fmt, 
+      self->start_nautical_twilight, s, sizeof (s));
     kstring_append_printf (json, "\"start nautical twilight\":\"%s\",\n", s);
-    free (s);
     }
   if (self->end_nautical_twilight)
     {
-    char *s = datetimeconv_format_time ("24hr", tz_city, 
-      self->end_nautical_twilight);
+    ktimeformat_format (time_fmt, self->end_nautical_twilight, s, sizeof (s));
     kstring_append_printf (json, "\"end nautical twilight\":\"%s\",\n", s);
-    free (s);
     }
   if (self->start_astronomical_twilight)
     {
-    char *s = datetimeconv_format_time ("24hr", tz_city, 
-      self->start_astronomical_twilight);
+    ktimeformat_format (time_fmt, 
+      self->start_astronomical_twilight, s, sizeof (s));
     kstring_append_printf (json, "\"start astronomical twilight\":\"%s\",\n", s);
-    free (s);
     }
   if (self->end_astronomical_twilight)
     {
-    char *s = datetimeconv_format_time ("24hr", tz_city, 
-      self->end_astronomical_twilight);
+    ktimeformat_format (time_fmt, 
+      self->end_astronomical_twilight, s, sizeof (s));
     kstring_append_printf (json, "\"end astronomical twilight\":\"%s\",\n", s);
-    free (s);
     }
   if (self->high_noon)
     {
-    char *s = datetimeconv_format_time ("24hr", tz_city, 
-      self->high_noon);
+    ktimeformat_format (time_fmt, self->high_noon, s, sizeof (s));
     kstring_append_printf (json, "\"high noon\":\"%s\",\n", s);
-    free (s);
     kstring_append_printf (json, "\"sun altitude at high noon\":%g,\n", 
        self->sun_max_altitude);
     }
@@ -612,38 +850,29 @@ KString *solunar_day_summary_to_json (const SolunarDaySummary *self)
   kstring_append_printf (json, "\"moon\":{");
 
   kstring_append_printf (json, "\"rises\":[");
-  int nrises = self->nrises; 
-  for (int i = 0; i < nrises; i++)
-    {
-    char *s = datetimeconv_format_time ("24hr", tz_city, 
-	   self->moonrises[i]); 
-    kstring_append_printf (json, "\"%s\",", s);
-    free (s);
-    }
-
-  if (kstring_ends_with_utf8 (json, (UTF8 *)","))
-    {
-    int l = kstring_length (json);
-    kstring_delete (json, l - 1, 1);
-    }
+  int nrises = self->moon_events.nrises; 
+  solunar_day_summary_append_times (json, time_fmt, 
+    self->moon_events.rises, nrises);
   kstring_append_printf (json, "],\n");
 
   kstring_append_printf (json, "\"sets\":[");
-  int nsets = self->nsets; 
-  for (int i = 0; i < nsets; i++)
-    {
-    char *s = datetimeconv_format_time ("24hr", tz_city, 
-	   self->moonsets[i]); 
-    kstring_append_printf (json, "\"%s\",", s);
-    free (s);
-    }
+  int nsets = self->moon_events.nsets; 
+  solunar_day_summary_append_times (json, time_fmt, 
+    self->moon_events.sets, nsets);
+  kstring_append_printf (json, "],\n");
+  kstring_append_printf (json, "\"transits\":[");
+  int ntransits = self->moon_events.nupper_transits; 
+  solunar_day_summary_append_times (json, time_fmt, 
+    self->moon_events.upper_transits, ntransits);
+  kstring_append_printf (json, "],\n");
 
-  if (kstring_ends_with_utf8 (json, (UTF8 *)","))
-    {
-    int l = kstring_length (json);
-    kstring_delete (json, l - 1, 1);
-    }
+  kstring_append_printf (json, "\"lower transits\":[");
+  int nlower = self->moon_events.nlower_transits; 
+  solunar_day_summary_append_times (json, time_fmt, 
+    self->moon_events.lower_transits, nlower);
   kstring_append_printf (json, "],\n");
+  kstring_append_printf (json, "\"max altitude\":%g,\n", 
+    self->moon_events.max_altitude);
   kstring_append_printf (json, "\"moon phase name\":\"%s\",\n",    
     self->moon_phase_name);
   kstring_append_printf (json, "\"moon phase\":%g,\n", self->moon_phase);
@@ -651,10 +880,105 @@ KString *solunar_day_summary_to_json (const SolunarDaySummary *self)
 
   kstring_append_printf (json, "}");
   kstring_append_printf (json, "}");
+  ktimeformat_destroy (date_fmt);
+  ktimeformat_destroy (time_fmt);
   KLOG_OUT
   return json; 
   }
 
+/*============================================================================
+ 
+  solunar_day_summary_get_record
+
+  ==========================================================================*/
+void solunar_day_summary_get_record (const SolunarDaySummary *self,
+        SolunarDayRecord *record)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  memset (record, 0, sizeof (SolunarDayRecord));
+  record->date = self->date;
+  record->sunrise = self->sunrise;
+  record->sunset = self->sunset;
+  record->start_civil_twilight = self->start_civil_twilight;
+  record->end_civil_twilight = self->end_civil_twilight;
+  record->start_nautical_twilight = self->start_nautical_twilight;
+  record->end_nautical_twilight = self->end_nautical_twilight;
+  record->start_astronomical_twilight = self->start_astronomical_twilight;
+  record->end_astronomical_twilight = self->end_astronomical_twilight;
+  record->high_noon = self->high_noon;
+  const MoonTimesEvents *e = &self->moon_events;
+  for (int i = 0; i < MOONTIMES_MAX_EVENTS; i++)
+    {
+    record->moon_rises[i] = e->rises[i];
+    record->moon_sets[i] = e->sets[i];
+    record->moon_transits[i] = e->upper_transits[i];
+    record->moon_lower_transits[i] = e->lower_transits[i];
+    }
+  record->n_moon_rises = e->nrises;
+  record->n_moon_sets = e->nsets;
+  record->n_moon_transits = e->nupper_transits;
+  record->n_moon_lower_transits = e->nlower_transits;
+  record->moon_max_altitude = e->max_altitude;
+  record->moon_max_altitude_time = e->max_altitude_time;
+  record->sun_max_altitude = self->sun_max_altitude;
+  record->moon_distance = self->moon_distance;
+  record->moon_phase = self->moon_phase;
+  record->moon_age = self->moon_age;
+  record->latitude = self->latitude;
+  record->longitude = self->longitude;
+  record->moon_flags = self->moon_flags;
+  KLOG_OUT
+  }
 
+/*============================================================================
+ 
+  solunar_day_summary_new_from_record
 
+  The phase name is not stored, because it is found from the phase
+
+  ==========================================================================*/
+SolunarDaySummary *solunar_day_summary_new_from_record 
+        (const SolunarDayRecord *record, const char *city, const char *tz)
+  {
+  KLOG_IN
+  SolunarDaySummary *self = malloc (sizeof (SolunarDaySummary));
+  memset (self, 0, sizeof (SolunarDaySummary));
+  self->date = record->date;
+  self->sunrise = record->sunrise;
+  self->sunset = record->sunset;
+  self->start_civil_twilight = record->start_civil_twilight;
+  self->end_civil_twilight = record->end_civil_twilight;
+  self->start_nautical_twilight = record->start_nautical_twilight;
+  self->end_nautical_twilight = record->end_nautical_twilight;
+  self->start_astronomical_twilight = record->start_astronomical_twilight;
+  self->end_astronomical_twilight = record->end_astronomical_twilight;
+  self->high_noon = record->high_noon;
+  MoonTimesEvents *e = &self->moon_events;
+  for (int i = 0; i < MOONTIMES_MAX_EVENTS; i++)
+    {
+    e->rises[i] = record->moon_rises[i];
+    e->sets[i] = record->moon_sets[i];
+    e->upper_transits[i] = record->moon_transits[i];
+    e->lower_transits[i] = record->moon_lower_transits[i];
+    }
+  e->nrises = record->n_moon_rises;
+  e->nsets = record->n_moon_sets;
+  e->nupper_transits = record->n_moon_transits;
+  e->nlower_transits = record->n_moon_lower_transits;
+  e->max_altitude = record->moon_max_altitude;
+  e->max_altitude_time = record->moon_max_altitude_time;
+  self->sun_max_altitude = record->sun_max_altitude;
+  self->moon_distance = record->moon_distance;
+  self->moon_phase = record->moon_phase;
+  self->moon_age = record->moon_age;
+  self->moon_phase_name = moonephemera_get_phase_name (self->moon_phase);
+  self->latitude = record->latitude;
+  self->longitude = record->longitude;
+  self->moon_flags = record->moon_flags;
+  if (tz) self->tz_city = strdup (tz);
+  if (city) self->city = strdup (city);
+  KLOG_OUT
+  return self;
+  }
 
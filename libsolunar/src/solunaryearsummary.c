@@ -16,6 +16,7 @@
 #include <assert.h>
 #include <math.h>
 #include <libsolunar/moonephemera.h>
+#include <libsolunar/moonevents.h>
 #include <libsolunar/solunaryearsummary.h>
 #include <libsolunar/festival.h>
 #include <klib/klog.h>
@@ -27,8 +28,6 @@ static void solunar_year_summary_calculate_dst (SolunarYearSummary *self,
 static void solunar_year_summary_calculate_moons (SolunarYearSummary *self,
     int year, int latitude); // FWD
 
-static const int SEC_PER_DAY = 3600 * 24;
-
 /*============================================================================
  
   SolunarYearSummary 
@@ -51,6 +50,21 @@ SolunarYearSummary *solunar_year_summary_create
         (int year, double latitude, const char *tz)
   {
   KLOG_IN
+  SolunarYearSummary *self = solunar_year_summary_create_with_feasts
+    (year, latitude, tz, FESTIVAL_FEAST_SET (FESTIVAL_FEASTS_EASTER));
+  KLOG_OUT
+  return self;
+  }
+
+/*============================================================================
+ 
+  solunar_year_summary_create_with_feasts
+
+  ==========================================================================*/
+SolunarYearSummary *solunar_year_summary_create_with_feasts 
+        (int year, double latitude, const char *tz, int feasts)
+  {
+  KLOG_IN
   SolunarYearSummary *self = malloc (sizeof (SolunarYearSummary));
   memset (self, 0, sizeof (SolunarYearSummary));
 
@@ -61,32 +75,7 @@ SolunarYearSummary *solunar_year_summary_create
 
   self->list = klist_new_empty ((KListFreeFn) festival_destroy);
 
-  klist_append (self->list, 
-    festival_get_shrove_tuesday (year, tz));
-
-  klist_append (self->list, 
-    festival_get_ash_wednesday (year, tz));
-
-  klist_append (self->list, 
-    festival_get_mothering_sunday (year, tz));
-
-  klist_append (self->list, 
-    festival_get_palm_sunday (year, tz));
-
-  klist_append (self->list, 
-    festival_get_maundy_thursday (year, tz));
-
-  klist_append (self->list, 
-    festival_get_good_friday (year, tz));
-
-  klist_append (self->list, 
-    festival_get_easter_sunday (year, tz));
-
-  klist_append (self->list, 
-    festival_get_easter_monday (year, tz));
-
-  klist_append (self->list, 
-    festival_get_whitsun (year, tz));
+  festival_add_feasts (year, feasts, tz, self->list);
 
   klist_append (self->list, 
     festival_get_vernal_equinox (year));
@@ -134,79 +123,63 @@ void solunar_year_summary_destroy (SolunarYearSummary *self)
  
   solunar_year_summary_calculate_dst
 
+  Add the exact times at which daylight saving starts and ends, taken
+  from the zone's transitions. Changes of offset that don't change 
+  daylight saving, which happen when a region changes its standard time,
+  are not reported
+
   ==========================================================================*/
 static void solunar_year_summary_calculate_dst (SolunarYearSummary *self,
     int year)
   {
   KLOG_IN
-  int days_in_year = 365; // DST probably never changes on the last day
-                          //  in a leap year
-  // We use a base time of 3:00 AM, as most locations switch over
-  //  DST before this (usually 1-2 AM)
-  // Start the test on the last day of the previous year, to deal with
-  //  cases where the year starts in DST (e.g., Australia)
-  time_t soy = datetimeconv_maketime (year - 1, 12, 31, 
-         3, 0, 0, self->tz);
-  BOOL last_dst = FALSE;
-  for (int i = 0; i < days_in_year; i++)
+  const KTimeZone *zone = self->tz 
+    ? ktimezone_get (self->tz) : ktimezone_get_system ();
+  time_t soy = datetimeconv_maketime_r (year, 1, 1, 0, 0, 0, zone);
+  time_t eoy = datetimeconv_maketime_r (year + 1, 1, 1, 0, 0, 0, zone);
+  int count;
+  KTimeZoneTransition *transitions = ktimezone_get_transitions (zone, 
+    soy, eoy, &count);
+  for (int i = 0; i < count; i++)
     {
-    struct tm tm;
-
-    datetimeconv_localtime (&soy, &tm, self->tz);
-
-    if (tm.tm_year + 1900 == year)
-      {
-      if (last_dst && !tm.tm_isdst)
-        {
-        Festival *f = festival_new (soy, FALSE, 
-           "Daylight saving ends");
-        klist_append (self->list, f);
-        }
-      if (!last_dst && tm.tm_isdst)
-        {
-        Festival *f = festival_new (soy, FALSE, 
-           "Daylight saving starts");
-        klist_append (self->list, f);
-        }
-      }
-    last_dst = tm.tm_isdst;
-    soy += SEC_PER_DAY;
+    const KTimeZoneTransition *t = &transitions[i];
+    if (t->old_isdst == t->new_isdst) continue;
+    Festival *f = festival_new (t->time, TRUE, t->new_isdst 
+      ? "Daylight saving starts" : "Daylight saving ends");
+    klist_append (self->list, f);
     }
-
+  free (transitions);
   KLOG_OUT
   }
 
 
 /*============================================================================
  
-  solunar_year_summary_get_festivals
+  solunar_year_summary_calculate_moons
+
+  A supermoon is a full moon when the Moon is near perigee. 
 
   ==========================================================================*/
 static void solunar_year_summary_calculate_moons (SolunarYearSummary *self,
     int year, int latitude)
   {
   KLOG_IN
-  int days_in_year = 365; //TODO
-  time_t soy = datetimeconv_maketime (year, 1, 1, 
-         12, 0, 0, self->tz);
-  for (int i = 0; i < days_in_year; i++)
+  (void)latitude;
+  time_t soy = datetimeconv_maketime (year, 1, 1, 0, 0, 0, self->tz);
+  time_t eoy = datetimeconv_maketime (year + 1, 1, 1, 0, 0, 0, self->tz);
+  int count;
+  MoonEvent *events = moonevents_find (soy, eoy, 
+    MOONEVENTS_TYPE (MOONEVENT_FULL), &count);
+  for (int i = 0; i < count; i++)
     {
-    double phase, distance, age;
-    const char *dummys;
-    int moon_flags;
-    moonephemera_get_moon_state (latitude, 0, 
-               soy, &dummys, 
-               &phase, &age, &distance, &moon_flags);
-
-     if (moon_flags & MOONFLAG_SUPERMOON)
-       {
-        Festival *f = festival_new (soy, FALSE, 
-           "Supermoon");
-        klist_append (self->list, f);
-       }
-
-    soy += SEC_PER_DAY;
+    if (events[i].type == MOONEVENT_FULL 
+         && events[i].distance < MOONEPHEMERA_SUPERMOON_DISTANCE)
+      {
+      Festival *f = festival_new (events[i].time, TRUE, "Supermoon");
+      klist_append (self->list, f);
+      }
     }
+  free (events);
   KLOG_OUT
   }
 
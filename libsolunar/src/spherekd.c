@@ -0,0 +1,176 @@
+/*============================================================================
+  
+  libsolunar
+  
+  spherekd.c
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "spherekd.h"
+
+/*============================================================================
+  
+  spherekd_get_point
+
+  ==========================================================================*/
+void spherekd_get_point (double latitude, double longitude, double *xyz)
+  {
+  double lat = latitude * M_PI / 180.0;
+  double longt = longitude * M_PI / 180.0;
+  xyz[0] = cos (lat) * cos (longt);
+  xyz[1] = cos (lat) * sin (longt);
+  xyz[2] = sin (lat);
+  }
+
+/*============================================================================
+  
+  SphereKDSort
+
+  ==========================================================================*/
+typedef struct _SphereKDSort
+  {
+  const double (*xyz)[3];
+  int axis;
+  } SphereKDSort;
+
+/*============================================================================
+  
+  spherekd_compare
+
+  Order points by their coordinate on one axis, then by number, so the
+  tree does not depend on the sort algorithm
+
+  ==========================================================================*/
+static int spherekd_compare (const void *p1, const void *p2, void *arg)
+  {
+  const SphereKDSort *sort = arg;
+  uint32_t i1 = *(const uint32_t *)p1, i2 = *(const uint32_t *)p2;
+  double v1 = sort->xyz[i1][sort->axis], v2 = sort->xyz[i2][sort->axis];
+  if (v1 < v2) return -1;
+  if (v1 > v2) return 1;
+  return i1 < i2 ? -1 : i1 > i2;
+  }
+
+/*============================================================================
+  
+  spherekd_build_range
+
+  ==========================================================================*/
+static void spherekd_build_range (const double (*xyz)[3], uint32_t *order,
+     uint8_t *axis, uint32_t lo, uint32_t hi)
+  {
+  if (lo >= hi) return;
+  // Split on the axis along which the points are most spread out
+  int split = 0;
+  double widest = -1;
+  for (int a = 0; a < 3; a++)
+    {
+    double min = 2, max = -2;
+    for (uint32_t i = lo; i < hi; i++)
+      {
+      double v = xyz[order[i]][a];
+      if (v < min) min = v;
+      if (v > max) max = v;
+      }
+    if (max - min > widest)
+      {
+      widest = max - min;
+      split = a;
+      }
+    }
+  SphereKDSort sort = { xyz, split };
+  qsort_r (order + lo, hi - lo, sizeof (uint32_t), spherekd_compare, &sort);
+  uint32_t mid = lo + (hi - lo) / 2;
+  axis[mid] = split;
+  spherekd_build_range (xyz, order, axis, lo, mid);
+  spherekd_build_range (xyz, order, axis, mid + 1, hi);
+  }
+
+/*============================================================================
+  
+  spherekd_build
+
+  ==========================================================================*/
+void spherekd_build (const double (*xyz)[3], uint32_t n, uint32_t *order, 
+      uint8_t *axis)
+  {
+  for (uint32_t i = 0; i < n; i++)
+    {
+    order[i] = i;
+    axis[i] = 0;
+    }
+  spherekd_build_range (xyz, order, axis, 0, n);
+  }
+
+/*============================================================================
+  
+  spherekd_search_range
+
+  Search the part of the tree for [lo, hi), keeping the k nearest points
+  found so far in best, in order of distance
+
+  ==========================================================================*/
+static void spherekd_search_range (const double (*xyz)[3], 
+     const uint32_t *order, const uint8_t *axis, uint32_t lo, uint32_t hi,
+     const double *p, int k, SphereKDNeighbour *best, int *nbest)
+  {
+  if (lo >= hi) return;
+  uint32_t mid = lo + (hi - lo) / 2;
+  uint32_t c = order[mid];
+  const double *q = xyz[c];
+  double dx = p[0] - q[0], dy = p[1] - q[1], dz = p[2] - q[2];
+  double d2 = dx * dx + dy * dy + dz * dz;
+
+  if (*nbest < k || d2 < best[*nbest - 1].d2)
+    {
+    int i = *nbest < k ? (*nbest)++ : k - 1;
+    while (i > 0 && best[i - 1].d2 > d2)
+      {
+      best[i] = best[i - 1];
+      i--;
+      }
+    best[i].point = c;
+    best[i].d2 = d2;
+    }
+
+  // Search the side of the split that the point is on, then the other
+  //  side if it might be closer than the furthest of the k so far
+  double diff = p[axis[mid]] - q[axis[mid]];
+  if (diff < 0)
+    spherekd_search_range (xyz, order, axis, lo, mid, p, k, best, nbest);
+  else
+    spherekd_search_range (xyz, order, axis, mid + 1, hi, p, k, best, 
+      nbest);
+  if (*nbest < k || diff * diff < best[*nbest - 1].d2)
+    {
+    if (diff < 0)
+      spherekd_search_range (xyz, order, axis, mid + 1, hi, p, k, best, 
+        nbest);
+    else
+      spherekd_search_range (xyz, order, axis, lo, mid, p, k, best, 
+        nbest);
+    }
+  }
+
+/*============================================================================
+  
+  spherekd_search
+
+  ==========================================================================*/
+int spherekd_search (const double (*xyz)[3], uint32_t n, 
+      const uint32_t *order, const uint8_t *axis, const double *p, int k, 
+      SphereKDNeighbour *best)
+  {
+  int nbest = 0;
+  if (k > 0)
+    spherekd_search_range (xyz, order, axis, 0, n, p, k, best, &nbest);
+  return nbest;
+  }
+
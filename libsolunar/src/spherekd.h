@@ -0,0 +1,54 @@
+/*============================================================================
+  
+  libsolunar
+  
+  spherekd.h
+
+  Implicit k-d trees over points on the unit sphere, used to find the
+  places nearest to a point, both in the built-in city table and in a 
+  gazetteer. Straight-line distance between points on the sphere orders
+  places the same way as distance over the ground, so an ordinary 
+  three-dimensional tree will do.
+
+  The tree is held in two arrays. order is a permutation of the points;
+  the node for the range [lo, hi) of order is at (lo + hi) / 2, and 
+  splits on axis[(lo + hi) / 2], with points whose coordinate on that 
+  axis is no larger in [lo, mid), and no smaller in [mid + 1, hi).
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#pragma once
+
+#include <stdint.h>
+#include <klib/klib.h>
+
+/* A point found by spherekd_search(), with the square of its straight-line
+ * distance from the point searched for */
+typedef struct _SphereKDNeighbour
+  {
+  uint32_t point;
+  double d2;
+  } SphereKDNeighbour;
+
+BEGIN_DECLS
+
+/** Get the position on the unit sphere of a latitude and longitude, in
+ * degrees. */
+extern void spherekd_get_point (double latitude, double longitude, 
+              double *xyz);
+
+/** Build the tree over n points. order and axis must each have room
+ * for n entries. */
+extern void spherekd_build (const double (*xyz)[3], uint32_t n, 
+              uint32_t *order, uint8_t *axis);
+
+/** Find the k points nearest to p. best must have room for k entries;
+ * it is filled nearest first, and the number found -- k, unless there
+ * are fewer than k points -- is returned. */
+extern int spherekd_search (const double (*xyz)[3], uint32_t n,
+              const uint32_t *order, const uint8_t *axis, const double *p, 
+              int k, SphereKDNeighbour *best);
+
+END_DECLS
@@ -117,36 +117,75 @@ double suntimes_get_sun_mean_anomaly_at_sunset (int doy, double longitude)
 
 /*============================================================================
   
-  suntimes_get_sunrise
+  SunTimesSide
+
+  The quantities that all the sunrise-side (or all the sunset-side)
+  events of a day have in common -- that is, everything that doesn't
+  depend on the zenith
 
   ==========================================================================*/
-time_t suntimes_get_sunrise (time_t day, double latitude, double longitude, 
-       double zenith)
+typedef struct _SunTimesSide
+  {
+  BOOL rising;
+  double rah;      // Sun's right ascension, hours
+  double sin_dec;  // Sine and cosine of the sun's declination
+  double cos_dec;
+  double approx;   // Approximate time of the event, days
+  } SunTimesSide;
+
+/*============================================================================
+  
+  suntimes_get_side
+
+  ==========================================================================*/
+static void suntimes_get_side (int doy, double longitude, BOOL rising, 
+      SunTimesSide *side)
   {
   KLOG_IN
+  double sma = rising 
+    ? suntimes_get_sun_mean_anomaly_at_sunrise (doy, longitude)
+    : suntimes_get_sun_mean_anomaly_at_sunset (doy, longitude);
 
-  struct tm tm_day;
-  gmtime_r (&day, &tm_day);
-  int doy = tm_day.tm_yday + 1;
+  double stl = suntimes_get_sun_true_longitude (sma);
 
-  time_t ret = (time_t)0; // Let's hope that the Sun doesn't set in
-                          //  1970 again ;)
+  side->rising = rising;
+  side->rah = suntimes_get_sun_ra_hours (stl);
+  side->sin_dec = 0.39782 * mathutil_sin_deg (stl);
+  side->cos_dec = mathutil_cos_deg (mathutil_asin_deg (side->sin_dec));
+  double hours = astroutil_get_hours_from_meridian (longitude);
+  side->approx = rising 
+    ? suntimes_get_approx_sunrise_time (doy, hours)
+    : suntimes_get_approx_sunset_time (doy, hours);
+  KLOG_OUT
+  }
 
-  double sma = suntimes_get_sun_mean_anomaly_at_sunrise (doy, longitude);
+/*============================================================================
+  
+  suntimes_get_crossing
 
-  double stl = suntimes_get_sun_true_longitude (sma);
+  Get the time at which the sun crosses the specified zenith, on the side
+  of the day described by 'side'. midnight is the start of the UTC day.
+  sin_lat and cos_lat are for the observer's latitude. Returns 0 if
+  the sun doesn't reach the zenith on this day.
 
-  double rah = suntimes_get_sun_ra_hours (stl);
+  ==========================================================================*/
+static time_t suntimes_get_crossing (const SunTimesSide *side, 
+      time_t midnight, double sin_lat, double cos_lat, double longitude, 
+      double zenith)
+  {
+  KLOG_IN
+  time_t ret = (time_t)0; // Let's hope that the Sun doesn't set in
+                          //  1970 again ;)
 
-  double clha = suntimes_get_cos_local_hour_angle (stl, latitude, zenith);
+  double clha = (mathutil_cos_deg (zenith) - (side->sin_dec * sin_lat)) 
+        / (side->cos_dec * cos_lat);
 
   if (clha >= -1 && clha <= 1)
     {
-    double lha = 360.0 - mathutil_acos_deg (clha);
+    double lha = mathutil_acos_deg (clha);
+    if (side->rising) lha = 360.0 - lha;
     double lh = lha / DEG_PER_HOUR;
-    double lmt = suntimes_get_local_mean_time (lh, rah, 
-      suntimes_get_approx_sunrise_time (doy, 
-         astroutil_get_hours_from_meridian (longitude)));
+    double lmt = suntimes_get_local_mean_time (lh, side->rah, side->approx);
 
     double temp = lmt - astroutil_get_hours_from_meridian (longitude);
     if (temp < 0) temp += 24;
@@ -155,11 +194,7 @@ time_t suntimes_get_sunrise (time_t day, double latitude, double longitude,
     int utc_h = (int) temp;
     int utc_m = (int) ((temp - utc_h) * 60);
 
-    tm_day.tm_hour = utc_h;
-    tm_day.tm_min = utc_m;
-    tm_day.tm_sec = 0;
-
-    ret = timegm (&tm_day);
+    ret = midnight + 3600 * utc_h + 60 * utc_m;
     }
 
   KLOG_OUT
@@ -168,51 +203,90 @@ time_t suntimes_get_sunrise (time_t day, double latitude, double longitude,
 
 /*============================================================================
   
-  suntimes_get_sunset
+  suntimes_get_utc_day
+
+  Get the day of year, and the time of midnight UTC, on the day that 
+  includes 'day'
 
   ==========================================================================*/
-time_t suntimes_get_sunset (time_t day, double latitude, double longitude, 
-       double zenith)
+static time_t suntimes_get_utc_day (time_t day, int *doy)
   {
   KLOG_IN
-
   struct tm tm_day;
   gmtime_r (&day, &tm_day);
-  int doy = tm_day.tm_yday + 1;
-
-  time_t ret = (time_t)0; // Let's hope that the Sun doesn't set in
-                          //  1970 again ;)
-
-  double sma = suntimes_get_sun_mean_anomaly_at_sunset (doy, longitude);
+  *doy = tm_day.tm_yday + 1;
+  tm_day.tm_hour = 0;
+  tm_day.tm_min = 0;
+  tm_day.tm_sec = 0;
+  time_t ret = timegm (&tm_day);
+  KLOG_OUT
+  return ret;
+  }
 
-  double stl = suntimes_get_sun_true_longitude (sma);
+/*============================================================================
+  
+  suntimes_get_all_events
 
-  double rah = suntimes_get_sun_ra_hours (stl);
+  ==========================================================================*/
+void suntimes_get_all_events (time_t day, double latitude, double longitude,
+       SunTimesEvent *events, int n)
+  {
+  KLOG_IN
+  int doy;
+  time_t midnight = suntimes_get_utc_day (day, &doy);
+  double sin_lat = mathutil_sin_deg (latitude);
+  double cos_lat = mathutil_cos_deg (latitude);
 
-  double clha = suntimes_get_cos_local_hour_angle (stl, latitude, zenith);
+  SunTimesSide rise, set;
+  suntimes_get_side (doy, longitude, TRUE, &rise);
+  suntimes_get_side (doy, longitude, FALSE, &set);
 
-  if (clha >= -1 && clha <= 1)
+  for (int i = 0; i < n; i++)
     {
-    double lha = mathutil_acos_deg (clha);
-    double lh = lha / DEG_PER_HOUR;
-    double lmt = suntimes_get_local_mean_time (lh, rah, 
-      suntimes_get_approx_sunset_time (doy, 
-         astroutil_get_hours_from_meridian (longitude)));
-
-    double temp = lmt - astroutil_get_hours_from_meridian (longitude);
-    if (temp < 0) temp += 24;
-    if (temp > 24) temp -= 24;
+    events[i].rise = suntimes_get_crossing (&rise, midnight, sin_lat, 
+      cos_lat, longitude, events[i].zenith);
+    events[i].set = suntimes_get_crossing (&set, midnight, sin_lat, 
+      cos_lat, longitude, events[i].zenith);
+    }
+  KLOG_OUT
+  }
 
-    int utc_h = (int) temp;
-    int utc_m = (int) ((temp - utc_h) * 60);
+/*============================================================================
+  
+  suntimes_get_sunrise
 
-    tm_day.tm_hour = utc_h;
-    tm_day.tm_min = utc_m;
-    tm_day.tm_sec = 0;
+  ==========================================================================*/
+time_t suntimes_get_sunrise (time_t day, double latitude, double longitude, 
+       double zenith)
+  {
+  KLOG_IN
+  int doy;
+  time_t midnight = suntimes_get_utc_day (day, &doy);
+  SunTimesSide side;
+  suntimes_get_side (doy, longitude, TRUE, &side);
+  time_t ret = suntimes_get_crossing (&side, midnight, 
+    mathutil_sin_deg (latitude), mathutil_cos_deg (latitude), longitude, 
+    zenith);
+  KLOG_OUT
+  return ret;
+  }
 
-    ret = timegm (&tm_day);
-    }
+/*============================================================================
+  
+  suntimes_get_sunset
 
+  ==========================================================================*/
+time_t suntimes_get_sunset (time_t day, double latitude, double longitude, 
+       double zenith)
+  {
+  KLOG_IN
+  int doy;
+  time_t midnight = suntimes_get_utc_day (day, &doy);
+  SunTimesSide side;
+  suntimes_get_side (doy, longitude, FALSE, &side);
+  time_t ret = suntimes_get_crossing (&side, midnight, 
+    mathutil_sin_deg (latitude), mathutil_cos_deg (latitude), longitude, 
+    zenith);
   KLOG_OUT
   return ret;
   }
@@ -13,6 +13,10 @@
 #include <stdlib.h> 
 #include <string.h> 
 #include <errno.h> 
+#include <limits.h> 
+#include <math.h> 
+#include <unistd.h> 
+#include <pthread.h> 
 #include <klib/klib.h> 
 #include <libsolunar/libsolunar.h> 
 #include "program_context.h" 
@@ -24,22 +28,100 @@
 #define GET_INTEGER(x,y) program_context_get_integer(context,x,y)
 #define GET(x) program_context_get(context,x)
 
+// The number of years, for each thread, that --years can have worked out
+//  but not yet printed
+#define PROGRAM_YEARS_SLOTS_PER_THREAD 4
+
 BOOL program_get_lat (const ProgramContext *context, double *lat); // FWD
 BOOL program_get_longt (const ProgramContext *context, double *longt); // FWD
 char *program_get_tz (const ProgramContext *context); //FWD
 static void program_format_day_summary (const ProgramContext *context, 
               const SolunarDaySummary *sds); // FWD
 
+/*============================================================================
+  
+  program_check_ephemeris
+
+  Handle the --check-ephemeris option, by comparing the contents of the
+  ephemeris file with the series it was made from
+
+  ==========================================================================*/
+int program_check_ephemeris (const ProgramContext *context)
+  {
+  KLOG_IN
+  int ret = 0;
+  char *file = GET ("check-ephemeris");
+  MoonChebyshev *mc = moonchebyshev_open (file);
+  if (mc)
+    {
+    time_t start, end;
+    moonchebyshev_get_range (mc, &start, &end);
+    char *s1 = datetimeconv_format_time ("%Y-%m-%d", "UTC", start);
+    char *s2 = datetimeconv_format_time ("%Y-%m-%d", "UTC", end);
+    printf ("Ephemeris covers %s to %s\n", s1, s2);
+    free (s1);
+    free (s2);
+    double max_arcsec, max_km;
+    moonchebyshev_check (mc, 16, &max_arcsec, &max_km);
+    printf ("Maximum position error %g arcsec\n", max_arcsec);
+    printf ("Maximum distance error %g km\n", max_km);
+    moonchebyshev_close (mc);
+    }
+  else
+    ret = EINVAL;
+  free (file);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_check_grid
+
+  Handle the --check-grid option, by comparing times interpolated from 
+  the grid table with times worked out in full
+
+  ==========================================================================*/
+int program_check_grid (const ProgramContext *context)
+  {
+  KLOG_IN
+  int ret = 0;
+  char *file = GET ("check-grid");
+  SolGrid *grid = solgrid_open (file);
+  if (grid)
+    {
+    int year;
+    double step;
+    solgrid_get_range (grid, &year, &step);
+    printf ("Grid covers %d, every %g degrees\n", year, step);
+    const int samples = 10000;
+    int answered, max_error, over_bound;
+    solgrid_check (grid, samples, &answered, &max_error, &over_bound);
+    printf ("Interpolated %d of %d samples\n", answered, samples);
+    printf ("Maximum error %d sec\n", max_error);
+    printf ("Samples with more than the cell's error %d\n", over_bound);
+    solgrid_close (grid);
+    }
+  else
+    ret = EINVAL;
+  free (file);
+  KLOG_OUT
+  return ret;
+  }
+
 /*============================================================================
   
   program_format_year_summary
 
   ==========================================================================*/
-void program_format_year_summary (const ProgramContext *context, 
-      const SolunarYearSummary *sys, const char *tz)
+void program_format_year_summary (FILE *out, const SolunarYearSummary *sys, 
+      const char *tz)
   {
   KLOG_IN
   const KList *list = solunar_year_summary_get_festivals (sys);
+  const KTimeZone *zone = tz ? ktimezone_get (tz) : NULL;
+  KTimeFormat *time_fmt = ktimeformat_new ("%a %b %d %Y (%H:%M)", zone);
+  KTimeFormat *date_fmt = ktimeformat_new ("%a %b %d %Y        ", zone);
   int l = klist_length (list); 
   for (int i = 0; i < l; i++)
     {
@@ -47,19 +129,108 @@ void program_format_year_summary (const ProgramContext *context,
     time_t date = festival_get_date (f);
     BOOL has_time = festival_has_time (f);
     const char *name = festival_get_name (f);
-    char *s;
-    if (has_time)
-      s = datetimeconv_format_time ("%a %b %d %Y (%H:%M)", tz, date);
-    else
-      s = datetimeconv_format_time ("%a %b %d %Y        ", tz, date);
-    
-    printf ("%s %s\n", s, name);
-    free (s);
+    char s[KTIMEFORMAT_MAX];
+    ktimeformat_format (has_time ? time_fmt : date_fmt, date, s, sizeof (s));
+    fprintf (out, "%s %s\n", s, name);
+    }
+  ktimeformat_destroy (time_fmt);
+  ktimeformat_destroy (date_fmt);
+
+  KLOG_OUT
+  }
+
+
+/*============================================================================
+  
+  program_write_year_summary
+
+  Write the year summary for one year, as text or JSON. This does not
+  use the program context, so it is safe to call from any thread
+
+  ==========================================================================*/
+static void program_write_year_summary (FILE *out, int year, double lat, 
+      const char *tz, int feasts, BOOL json)
+  {
+  KLOG_IN
+  SolunarYearSummary *sys = solunar_year_summary_create_with_feasts
+        (year, lat, tz, feasts);
+
+  if (json)
+    {
+    KString *s = solunar_year_summary_to_json (sys);
+    fprintf (out, "%S\n", kstring_cstr(s));
+    kstring_destroy (s);
     }
+  else
+    program_format_year_summary (out, sys, tz);
 
+  solunar_year_summary_destroy (sys);
   KLOG_OUT
   }
 
+/*============================================================================
+  
+  program_parse_feasts
+
+  ==========================================================================*/
+BOOL program_parse_feasts (const char *s, int *feasts, char *error,
+      size_t size)
+  {
+  KLOG_IN
+  BOOL ret = TRUE;
+  char *copy = strdup (s);
+  *feasts = 0;
+  char *saveptr;
+  for (char *tok = strtok_r (copy, ",", &saveptr); tok && ret; 
+        tok = strtok_r (NULL, ",", &saveptr))
+    {
+    if (strcmp (tok, "all") == 0)
+      {
+      *feasts |= FESTIVAL_FEAST_SETS_ALL;
+      continue;
+      }
+    int i;
+    for (i = 0; i < FESTIVAL_FEAST_SET_COUNT; i++)
+      if (strcmp (tok, festival_get_feast_set_name (i)) == 0) break;
+    if (i < FESTIVAL_FEAST_SET_COUNT)
+      *feasts |= FESTIVAL_FEAST_SET (i);
+    else
+      {
+      snprintf (error, size, "Unknown feasts: %s", tok);
+      ret = FALSE;
+      }
+    }
+  free (copy);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_get_feasts
+
+  Get the sets of movable feasts from the --feasts option, a list of set
+  names separated by commas, or "all". Returns FALSE, having logged the
+  reason, if a name is not known
+
+  ==========================================================================*/
+BOOL program_get_feasts (const ProgramContext *context, int *feasts)
+  {
+  KLOG_IN
+  BOOL ret = TRUE;
+  char *s = GET ("feasts");
+  if (s)
+    {
+    char error[256];
+    ret = program_parse_feasts (s, feasts, error, sizeof (error));
+    if (!ret) klog_error (KLOG_CLASS, "%s", error);
+    free (s);
+    }
+  else
+    *feasts = FESTIVAL_FEAST_SET (FESTIVAL_FEASTS_EASTER);
+  KLOG_OUT
+  return ret;
+  }
 
 /*============================================================================
   
@@ -71,6 +242,12 @@ void program_format_year_summary (const ProgramContext *context,
 int program_days (const ProgramContext *context)
   {
   KLOG_IN
+  int feasts;
+  if (!program_get_feasts (context, &feasts))
+    {
+    KLOG_OUT
+    return EINVAL;
+    }
   char *tz = program_get_tz (context);
   int days_year = GET_INTEGER("days-year",-1);
   if (days_year == -1)
@@ -80,22 +257,171 @@ int program_days (const ProgramContext *context)
 
   BOOL json = HAS_OPTION ("json");
 
-  SolunarYearSummary *sys = solunar_year_summary_create 
-        (days_year, lat, tz);
+  program_write_year_summary (stdout, days_year, lat, tz, feasts, json);
 
-  if (json)
+  if (tz) free (tz);
+  KLOG_OUT
+  return 0;
+  }
+
+/*============================================================================
+  
+  ProgramYears
+
+  The state shared by the threads that work out the summaries for 
+  --years. Each worker takes the next year, and writes its summary into
+  the slot for that year, in a ring of slots; the main thread prints the
+  slots in order of year, as they are filled. The ring is a reorder
+  buffer: a worker does not start a year until the year that was in its
+  slot has been printed, so a slow year holds up only a few others, and
+  the output is streamed
+
+  ==========================================================================*/
+typedef struct _ProgramYears
+  {
+  double lat;
+  const char *tz;
+  int feasts;
+  BOOL json;
+  int last_year;
+  int next_year;  // The next year for a worker to take
+  int print_year; // The next year to print
+  int nslots;
+  char **outputs; // For year y, outputs[y % nslots], or NULL if not done
+  size_t *sizes;
+  pthread_mutex_t lock;
+  pthread_cond_t done;    // Signalled when a slot is filled
+  pthread_cond_t printed; // Signalled when a slot is emptied
+  } ProgramYears;
+
+/*============================================================================
+  
+  program_years_worker
+
+  ==========================================================================*/
+static void *program_years_worker (void *arg)
+  {
+  KLOG_IN
+  ProgramYears *py = arg;
+  pthread_mutex_lock (&py->lock);
+  while (py->next_year <= py->last_year)
     {
-    KString *s = solunar_year_summary_to_json (sys);
-    printf ("%S\n", kstring_cstr(s));
-    kstring_destroy (s);
+    int year = py->next_year++;
+    while (year >= py->print_year + py->nslots)
+      pthread_cond_wait (&py->printed, &py->lock);
+    pthread_mutex_unlock (&py->lock);
+
+    char *output = NULL;
+    size_t size = 0;
+    FILE *out = open_memstream (&output, &size);
+    if (out)
+      {
+      program_write_year_summary (out, year, py->lat, py->tz, py->feasts, 
+        py->json);
+      fclose (out);
+      }
+    else
+      klog_error (KLOG_CLASS, "Can't make summary for %d: %s", year,
+        strerror (errno));
+
+    pthread_mutex_lock (&py->lock);
+    // An empty string, rather than NULL, if the summary failed, so the
+    //  main thread does not wait for it 
+    py->outputs[year % py->nslots] = output ? output : strdup ("");
+    py->sizes[year % py->nslots] = output ? size : 0;
+    pthread_cond_broadcast (&py->done);
     }
-  else
-    program_format_year_summary (context, sys, tz);
+  pthread_mutex_unlock (&py->lock);
+  KLOG_OUT
+  return NULL;
+  }
 
-  solunar_year_summary_destroy (sys);
-  if (tz) free (tz);
+/*============================================================================
+  
+  program_years
+
+  Handle the --years option by printing a year summary for each year in
+  a range, working them out in parallel
+
+  ==========================================================================*/
+int program_years (const ProgramContext *context)
+  {
+  KLOG_IN
+  int ret = 0;
+  int first_year = 0, last_year = 0;
+  char *years = GET ("years");
+  if (sscanf (years, "%d-%d", &first_year, &last_year) != 2 
+       || first_year < 1 || last_year > 9999 || last_year < first_year)
+    {
+    klog_error (KLOG_CLASS, "Invalid years: %s", years);
+    ret = EINVAL;
+    }
+  free (years);
+  int feasts;
+  if (ret == 0 && !program_get_feasts (context, &feasts))
+    ret = EINVAL;
+  if (ret != 0)
+    {
+    KLOG_OUT
+    return ret;
+    }
+
+  int threads = GET_INTEGER ("threads", 0);
+  if (threads <= 0) threads = sysconf (_SC_NPROCESSORS_ONLN);
+  if (threads <= 0) threads = 1;
+  if (threads > last_year - first_year + 1) 
+    threads = last_year - first_year + 1;
+
+  ProgramYears py;
+  memset (&py, 0, sizeof (py));
+  py.tz = program_get_tz (context);
+  py.lat = 51.0; // Assume northern hemisphere if not given
+  program_get_lat (context, &py.lat);
+  py.feasts = feasts;
+  py.json = HAS_OPTION ("json");
+  py.last_year = last_year;
+  py.next_year = first_year;
+  py.print_year = first_year;
+  py.nslots = threads * PROGRAM_YEARS_SLOTS_PER_THREAD;
+  py.outputs = calloc (py.nslots, sizeof (char *));
+  py.sizes = calloc (py.nslots, sizeof (size_t));
+  pthread_mutex_init (&py.lock, NULL);
+  pthread_cond_init (&py.done, NULL);
+  pthread_cond_init (&py.printed, NULL);
+  klog_debug (KLOG_CLASS, "Summarizing %d-%d on %d threads", first_year,
+    last_year, threads);
+
+  pthread_t *workers = malloc (threads * sizeof (pthread_t));
+  for (int i = 0; i < threads; i++)
+    pthread_create (&workers[i], NULL, program_years_worker, &py);
+
+  for (int year = first_year; year <= last_year; year++)
+    {
+    int slot = year % py.nslots;
+    pthread_mutex_lock (&py.lock);
+    while (!py.outputs[slot])
+      pthread_cond_wait (&py.done, &py.lock);
+    char *output = py.outputs[slot];
+    size_t size = py.sizes[slot];
+    py.outputs[slot] = NULL;
+    py.print_year++;
+    pthread_cond_broadcast (&py.printed);
+    pthread_mutex_unlock (&py.lock);
+    fwrite (output, 1, size, stdout);
+    free (output);
+    }
+
+  for (int i = 0; i < threads; i++)
+    pthread_join (workers[i], NULL);
+  free (workers);
+  pthread_cond_destroy (&py.printed);
+  pthread_cond_destroy (&py.done);
+  pthread_mutex_destroy (&py.lock);
+  free (py.outputs);
+  free (py.sizes);
+  free ((char *)py.tz);
   KLOG_OUT
-  return 0;
+  return ret;
   }
 
 /*============================================================================
@@ -141,8 +467,10 @@ int program_day_summary (const ProgramContext *context)
                 0, 0, tz);
       }
 
-    SolunarDaySummary *sds = solunar_day_summary_create 
-      (d, lat, longt, city, tz);
+    SolCache *cache = program_context_get_cache (context);
+    SolunarDaySummary *sds = cache 
+      ? solcache_create_day_summary (cache, d, lat, longt, city, tz)
+      : solunar_day_summary_create (d, lat, longt, city, tz);
     if (json)
       {
       KString *s = solunar_day_summary_to_json (sds);
@@ -169,6 +497,226 @@ int program_day_summary (const ProgramContext *context)
   return ret;
   }
 
+/*============================================================================
+  
+  program_format_times
+
+  Format up to n times, separated by spaces, or "-" if there are none
+
+  ==========================================================================*/
+static void program_format_times (const KTimeFormat *fmt, 
+      const time_t *times, int n, char *s, size_t size)
+  {
+  size_t len = 0;
+  s[0] = 0;
+  for (int i = 0; i < n && len + 1 < size; i++)
+    {
+    if (i > 0) s[len++] = ' ';
+    len += ktimeformat_format (fmt, times[i], s + len, size - len);
+    }
+  if (n == 0 && size > 1) strcpy (s, "-");
+  }
+
+/*============================================================================
+  
+  program_write_day_line
+
+  Write a day summary on a single line, as text, JSON, or comma-separated 
+  values, for --from, --days and --batch
+
+  ==========================================================================*/
+void program_write_day_line (FILE *out, const SolunarDaySummary *sds,
+      const char *format, const KTimeFormat *date_fmt, 
+      const KTimeFormat *time_fmt)
+  {
+  KLOG_IN
+  if (strcmp (format, "jsonl") == 0)
+    {
+    KString *s = solunar_day_summary_to_json (sds);
+    UTF8 *json = kstring_to_utf8 (s);
+    for (const UTF8 *p = json; *p; p++)
+      if (*p != '\n') fputc (*p, out);
+    fputc ('\n', out);
+    free (json);
+    kstring_destroy (s);
+    KLOG_OUT
+    return;
+    }
+
+  BOOL csv = strcmp (format, "csv") == 0;
+  char date[KTIMEFORMAT_MAX];
+  ktimeformat_format (date_fmt, solunar_day_summary_get_date (sds), 
+    date, sizeof (date));
+
+  // The sun times, in the order of the CSV heading
+  time_t sun[9] = 
+    {
+    solunar_day_summary_get_sunrise (sds),
+    solunar_day_summary_get_sunset (sds),
+    solunar_day_summary_get_start_civil_twilight (sds),
+    solunar_day_summary_get_end_civil_twilight (sds),
+    solunar_day_summary_get_start_nautical_twilight (sds),
+    solunar_day_summary_get_end_nautical_twilight (sds),
+    solunar_day_summary_get_start_astronomical_twilight (sds),
+    solunar_day_summary_get_end_astronomical_twilight (sds),
+    solunar_day_summary_get_high_noon (sds)
+    };
+  int nsun = csv ? 9 : 2;
+
+  time_t rises[MOONTIMES_MAX_EVENTS], sets[MOONTIMES_MAX_EVENTS];
+  time_t transits[MOONTIMES_MAX_EVENTS];
+  int nrises = solunar_day_summary_get_n_rises (sds);
+  int nsets = solunar_day_summary_get_n_sets (sds);
+  int ntransits = solunar_day_summary_get_n_moon_transits (sds);
+  for (int i = 0; i < nrises; i++)
+    rises[i] = solunar_day_summary_get_moon_rise (sds, i);
+  for (int i = 0; i < nsets; i++)
+    sets[i] = solunar_day_summary_get_moon_set (sds, i);
+  for (int i = 0; i < ntransits; i++)
+    transits[i] = solunar_day_summary_get_moon_transit (sds, i);
+
+  char s[3 * KTIMEFORMAT_MAX];
+  const char *sep = csv ? "," : " ";
+  fprintf (out, "%s", date);
+  for (int i = 0; i < nsun; i++)
+    {
+    program_format_times (time_fmt, &sun[i], sun[i] ? 1 : 0, s, sizeof (s));
+    fprintf (out, "%s%s", sep, csv && !sun[i] ? "" : s);
+    }
+  program_format_times (time_fmt, rises, nrises, s, sizeof (s));
+  fprintf (out, "%s%s", sep, csv && !nrises ? "" : s);
+  program_format_times (time_fmt, sets, nsets, s, sizeof (s));
+  fprintf (out, "%s%s", sep, csv && !nsets ? "" : s);
+  if (csv)
+    {
+    program_format_times (time_fmt, transits, ntransits, s, sizeof (s));
+    fprintf (out, ",%s,%g,%g,%g,%g,%s\n", ntransits ? s : "",
+      solunar_day_summary_get_moon_max_altitude (sds),
+      solunar_day_summary_get_moon_phase (sds),
+      solunar_day_summary_get_moon_age (sds),
+      solunar_day_summary_get_moon_distance (sds),
+      solunar_day_summary_get_moon_phase_name (sds));
+    }
+  else
+    fprintf (out, " %.2f %s\n", solunar_day_summary_get_moon_phase (sds),
+      solunar_day_summary_get_moon_phase_name (sds));
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_write_csv_heading
+
+  Write the heading line for the csv format of program_write_day_line()
+
+  ==========================================================================*/
+void program_write_csv_heading (FILE *out)
+  {
+  fprintf (out, "date,sunrise,sunset,start civil twilight,"
+    "end civil twilight,start nautical twilight,end nautical twilight,"
+    "start astronomical twilight,end astronomical twilight,high noon,"
+    "moonrises,moonsets,moon transits,moon max altitude,moon phase,"
+    "moon age,moon distance,moon phase name\n");
+  }
+
+/*============================================================================
+  
+  program_day_range
+
+  Handle the --from, --to and --days options, by writing a summary for
+  each day in the range, a line at a time
+
+  ==========================================================================*/
+int program_day_range (const ProgramContext *context)
+  {
+  KLOG_IN
+  int ret = 0;
+  char *tz = program_get_tz (context);
+  double lat, longt;
+  BOOL has_lat = program_get_lat (context, &lat);
+  BOOL has_longt = program_get_longt (context, &longt);
+  const SolCity *c = program_context_get_city (context);
+  const char *city = c ? solcity_get_name (c) : NULL;
+
+  char *format = GET ("format");
+  if (!format) format = strdup (HAS_OPTION ("json") ? "jsonl" : "text");
+  if (strcmp (format, "text") != 0 && strcmp (format, "jsonl") != 0
+       && strcmp (format, "csv") != 0)
+    {
+    klog_error (KLOG_CLASS, "Unknown format: %s", format);
+    ret = EINVAL;
+    }
+
+  // The first day is the start of the --from date, or today
+  time_t first;
+  char *from = GET ("from");
+  if (from)
+    {
+    first = datetimeconv_parse_date (from, 0, 0, tz);
+    free (from);
+    }
+  else
+    first = datetimeconv_make_time_on_day (time (NULL), 0, 0, 0, tz);
+
+  // The number of days is given by --days or, failing that, by --to. 
+  //  The days from one midnight to another are not always 24 hours 
+  //  long, but there are few enough changes of clock for rounding to
+  //  give the right number
+  int n = GET_INTEGER ("day-count", 0);
+  char *to = GET ("to");
+  if (n <= 0 && to)
+    {
+    time_t last = datetimeconv_parse_date (to, 0, 0, tz);
+    n = (int)floor ((last - first) / 86400.0 + 0.5) + 1;
+    if (n <= 0)
+      {
+      klog_error (KLOG_CLASS, "--to date is before --from date");
+      ret = EINVAL;
+      }
+    }
+  if (to) free (to);
+  if (n <= 0) n = 1;
+
+  if (ret == 0 && !(has_lat && has_longt))
+    {
+    klog_error (KLOG_CLASS, 
+      "No location specified. Specify a city using the --city switch, or\n"
+      "  latitute and longitude in degrees using --lat and --long.");
+    ret = EINVAL;
+    }
+
+  if (ret == 0)
+    {
+    if (!tz)
+      klog_warn (KLOG_CLASS, "Using system timezone");
+    const KTimeZone *zone = tz ? ktimezone_get (tz) : NULL;
+    KTimeFormat *date_fmt = ktimeformat_new ("%Y-%m-%d", zone);
+    KTimeFormat *time_fmt = ktimeformat_new 
+      (HAS_OPTION ("ampm") ? "12hr" : "24hr", zone);
+
+    if (strcmp (format, "csv") == 0)
+      program_write_csv_heading (stdout);
+
+    SolunarDayIter *iter = solunar_day_iter_new (first, n, lat, longt, 
+      city, tz);
+    SolunarDaySummary *sds;
+    while ((sds = solunar_day_iter_next (iter)))
+      {
+      program_write_day_line (stdout, sds, format, date_fmt, time_fmt);
+      solunar_day_summary_destroy (sds);
+      }
+    solunar_day_iter_destroy (iter);
+
+    ktimeformat_destroy (time_fmt);
+    ktimeformat_destroy (date_fmt);
+    }
+
+  free (format);
+  if (tz) free (tz);
+  KLOG_OUT
+  return ret;
+  }
+
 /*============================================================================
   
   program_format_day_summary
@@ -196,25 +744,27 @@ static void program_format_day_summary (const ProgramContext *context,
   else
     printf ("%.1fW", -display_long);
   printf ("\n");
+  const char *clocktime = "24hr";
+  if (HAS_OPTION ("ampm")) clocktime = "12hr";
+  const KTimeZone *zone = tz_city ? ktimezone_get (tz_city) : NULL;
+  KTimeFormat *date_fmt = ktimeformat_new ("long_date", zone);
+  KTimeFormat *time_fmt = ktimeformat_new (clocktime, zone);
+  char s[KTIMEFORMAT_MAX];
+
   time_t date = solunar_day_summary_get_date (sds); 
-  char *s = datetimeconv_format_time ("long_date", tz_city, date);
+  ktimeformat_format (date_fmt, date, s, sizeof (s));
   printf ("%s\n", s);
-  free (s);
 
   printf ("Sun:\n");
 
-  const char *clocktime = "24hr";
-  if (HAS_OPTION ("ampm")) clocktime = "12hr";
-
   time_t t;
   if (full)
     {
     t = solunar_day_summary_get_start_astronomical_twilight (sds);
     if (t)
       {
-      char *s = datetimeconv_format_time (clocktime, tz_city, t);
+      ktimeformat_format (time_fmt, t, s, sizeof (s));
       printf ("  Start of astronomical twilight %s\n", s);
-      free (s);
       }
     else
       printf ("  No astronomical twilight\n");
@@ -222,9 +772,8 @@ static void program_format_day_summary (const ProgramContext *context,
     t = solunar_day_summary_get_start_nautical_twilight (sds);
     if (t)
       {
-      char *s = datetimeconv_format_time (clocktime, tz_city, t);
+      ktimeformat_format (time_fmt, t, s, sizeof (s));
       printf ("  Start of nautical twilight %s\n", s);
-      free (s);
       }
     else
       printf ("  No nautical twilight\n");
@@ -232,9 +781,8 @@ static void program_format_day_summary (const ProgramContext *context,
     t = solunar_day_summary_get_start_civil_twilight (sds);
     if (t)
       {
-      char *s = datetimeconv_format_time (clocktime, tz_city, t);
+      ktimeformat_format (time_fmt, t, s, sizeof (s));
       printf ("  Start of civil twilight %s\n", s);
-      free (s);
       }
     else
       printf ("  No civil twilight\n");
@@ -243,9 +791,8 @@ static void program_format_day_summary (const ProgramContext *context,
   t = solunar_day_summary_get_sunrise (sds);
   if (t)
     {
-    char *s = datetimeconv_format_time (clocktime, tz_city, t);
+    ktimeformat_format (time_fmt, t, s, sizeof (s));
     printf ("  Sunrise %s\n", s);
-    free (s);
     }
   else
     printf ("  No sunrise\n");
@@ -255,9 +802,8 @@ static void program_format_day_summary (const ProgramContext *context,
     t = solunar_day_summary_get_high_noon (sds);
     if (t)
       {
-      char *s = datetimeconv_format_time (clocktime, tz_city, t);
+      ktimeformat_format (time_fmt, t, s, sizeof (s));
       printf ("  High noon %s\n", s);
-      free (s);
       double a = solunar_day_summary_get_sun_max_altitude (sds);
       printf ("  Sun's altitude at high noon %g deg\n", a);
       }
@@ -268,9 +814,8 @@ static void program_format_day_summary (const ProgramContext *context,
   t = solunar_day_summary_get_sunset (sds);
   if (t)
     {
-    char *s = datetimeconv_format_time (clocktime, tz_city, t);
+    ktimeformat_format (time_fmt, t, s, sizeof (s));
     printf ("  Sunset %s\n", s);
-    free (s);
     }
   else
     printf ("  No sunset\n");
@@ -280,9 +825,8 @@ static void program_format_day_summary (const ProgramContext *context,
     t = solunar_day_summary_get_end_civil_twilight (sds);
     if (t)
       {
-      char *s = datetimeconv_format_time (clocktime, tz_city, t);
+      ktimeformat_format (time_fmt, t, s, sizeof (s));
       printf ("  End of civil twilight %s\n", s);
-      free (s);
       }
     else
       printf ("  No civil twilight\n");
@@ -290,9 +834,8 @@ static void program_format_day_summary (const ProgramContext *context,
     t = solunar_day_summary_get_end_nautical_twilight (sds);
     if (t)
       {
-      char *s = datetimeconv_format_time (clocktime, tz_city, t);
+      ktimeformat_format (time_fmt, t, s, sizeof (s));
       printf ("  End of nautical twilight %s\n", s);
-      free (s);
       }
     else
       printf ("  No nautical twilight\n");
@@ -300,9 +843,8 @@ static void program_format_day_summary (const ProgramContext *context,
     t = solunar_day_summary_get_end_astronomical_twilight (sds);
     if (t)
       {
-      char *s = datetimeconv_format_time (clocktime, tz_city, t);
+      ktimeformat_format (time_fmt, t, s, sizeof (s));
       printf ("  End of astronomical twilight %s\n", s);
-      free (s);
       }
     else
       printf ("  No astronomical twilight\n");
@@ -316,10 +858,9 @@ static void program_format_day_summary (const ProgramContext *context,
     printf ("  Moonrise "); 
     for (int i = 0; i < nrises; i++)
       {
-      char *s = datetimeconv_format_time (clocktime, tz_city, 
-	 solunar_day_summary_get_moon_rise (sds, i));
+      ktimeformat_format (time_fmt, 
+        solunar_day_summary_get_moon_rise (sds, i), s, sizeof (s));
       printf ("%s  ", s); 
-      free (s);
       }
     printf ("\n"); 
     }
@@ -332,16 +873,35 @@ static void program_format_day_summary (const ProgramContext *context,
     printf ("  Moonset "); 
     for (int i = 0; i < nsets; i++)
       {
-      char *s = datetimeconv_format_time (clocktime, tz_city, 
-	 solunar_day_summary_get_moon_set (sds, i));
+      ktimeformat_format (time_fmt, 
+        solunar_day_summary_get_moon_set (sds, i), s, sizeof (s));
       printf ("%s ", s); 
-      free (s);
       }
     printf ("\n"); 
     }
   else
     printf ("  No moonsets on this day\n");
 
+  if (full)
+    {
+    int ntransits = solunar_day_summary_get_n_moon_transits (sds);
+    for (int i = 0; i < ntransits; i++)
+      {
+      ktimeformat_format (time_fmt, 
+        solunar_day_summary_get_moon_transit (sds, i), s, sizeof (s));
+      printf ("  Moon transit %s\n", s); 
+      }
+    int nlower = solunar_day_summary_get_n_moon_lower_transits (sds);
+    for (int i = 0; i < nlower; i++)
+      {
+      ktimeformat_format (time_fmt, 
+        solunar_day_summary_get_moon_lower_transit (sds, i), s, sizeof (s));
+      printf ("  Moon lower transit %s\n", s); 
+      }
+    printf ("  Moon's maximum altitude %g deg\n", 
+      solunar_day_summary_get_moon_max_altitude (sds));
+    }
+
   double moon_age = solunar_day_summary_get_moon_age (sds);
   double moon_phase = solunar_day_summary_get_moon_phase (sds);
   double moon_distance = solunar_day_summary_get_moon_distance (sds);
@@ -364,7 +924,189 @@ static void program_format_day_summary (const ProgramContext *context,
     printf ("  moon distance %g km\n", moon_distance); 
     }
 
+  ktimeformat_destroy (date_fmt);
+  ktimeformat_destroy (time_fmt);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_make_ephemeris
+
+  Handle the --make-ephemeris option
+
+  ==========================================================================*/
+int program_make_ephemeris (const ProgramContext *context)
+  {
+  KLOG_IN
+  int ret = 0;
+  char *file = GET ("make-ephemeris");
+  int first_year = 1970, last_year = 2070;
+  char *years = GET ("ephemeris-years");
+  if (years)
+    {
+    if (sscanf (years, "%d-%d", &first_year, &last_year) != 2 
+         || last_year < first_year)
+      {
+      klog_error (KLOG_CLASS, "Invalid ephemeris years: %s", years);
+      ret = EINVAL;
+      }
+    free (years);
+    }
+  if (ret == 0)
+    {
+    if (!moonchebyshev_write_file (file, first_year, last_year, 
+          MOONCHEBYSHEV_DEFAULT_SEGMENT_DAYS, MOONCHEBYSHEV_DEFAULT_ORDER))
+      ret = EIO;
+    }
+  free (file);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_make_gazetteer
+
+  Handle the --make-gazetteer option
+
+  ==========================================================================*/
+int program_make_gazetteer (const ProgramContext *context)
+  {
+  KLOG_IN
+  int ret = 0;
+  char *file = GET ("make-gazetteer");
+  char *source = GET ("gazetteer-source");
+  if (source)
+    {
+    if (!solgazetteer_write_file (source, file))
+      ret = EIO;
+    free (source);
+    }
+  else
+    {
+    klog_error (KLOG_CLASS, 
+      "--make-gazetteer needs a list of places from --gazetteer-source");
+    ret = EINVAL;
+    }
+  free (file);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_make_grid
+
+  Handle the --make-grid option
+
+  ==========================================================================*/
+int program_make_grid (const ProgramContext *context)
+  {
+  KLOG_IN
+  int ret = 0;
+  char *file = GET ("make-grid");
+  double step = 0.25;
+  char *s = GET ("grid-step");
+  if (s)
+    {
+    char *end;
+    step = strtod (s, &end);
+    if (end == s || *end)
+      {
+      klog_error (KLOG_CLASS, "Invalid grid step: %s", s);
+      ret = EINVAL;
+      }
+    free (s);
+    }
+  time_t now = time (NULL);
+  struct tm tm;
+  localtime_r (&now, &tm);
+  int year = GET_INTEGER ("grid-year", tm.tm_year + 1900);
+  if (ret == 0)
+    {
+    if (!solgrid_write_file (file, year, step, GET_INTEGER ("threads", 0)))
+      ret = EIO;
+    }
+  free (file);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_make_tzmap
+
+  Handle the --make-tzmap option
+
+  ==========================================================================*/
+int program_make_tzmap (const ProgramContext *context)
+  {
+  KLOG_IN
+  int ret = 0;
+  char *file = GET ("make-tzmap");
+  char *source = GET ("tzmap-source");
+  if (source)
+    {
+    if (!soltzmap_write_file (source, file))
+      ret = EIO;
+    free (source);
+    }
+  else
+    {
+    klog_error (KLOG_CLASS, 
+      "--make-tzmap needs timezone boundaries from --tzmap-source");
+    ret = EINVAL;
+    }
+  free (file);
   KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_nearest
+
+  Handle the --nearest option, by listing the cities nearest to the
+  latitude and longitude, or to the city, with their distances
+
+  ==========================================================================*/
+int program_nearest (const ProgramContext *context)
+  {
+  KLOG_IN
+  int ret = 0;
+  double lat, longt;
+  char *s = GET ("nearest");
+  char *end;
+  errno = 0;
+  long k = strtol (s, &end, 10);
+  if (end == s || *end || errno || k < 1 || k > INT_MAX)
+    {
+    klog_error (KLOG_CLASS, "Invalid count for --nearest: %s", s);
+    ret = EINVAL;
+    }
+  else if (program_get_lat (context, &lat) 
+       && program_get_longt (context, &longt))
+    {
+    KList *list = solcity_find_nearest (lat, longt, (int)k);
+    int cities = list ? klist_length (list) : 0;
+    for (int i = 0; i < cities; i++)
+      {
+      const SolCity *c = klist_get (list, i);
+      printf ("%-32s %8.1f km\n", solcity_get_name (c), 
+        solcity_get_distance (c, lat, longt));
+      }
+    if (list) klist_destroy (list);
+    }
+  else
+    {
+    klog_error (KLOG_CLASS, 
+      "--nearest needs a latitude and longitude, or a city");
+    ret = EINVAL;
+    }
+  free (s);
+  KLOG_OUT
+  return ret;
   }
 
 /*============================================================================
@@ -465,8 +1207,10 @@ BOOL program_get_lat (const ProgramContext *context, double *lat)
   program_get_tz
 
   Get the timezone. Use the value on the command-line (or RC file) if
-  given, else the value in the city, if given, else NULL. Note that if
-  the return value is not NULL, the caller must free it.
+  given, else the value in the city, if given, else the zone in the
+  timezone map at the latitude and longitude, if there is a map, else 
+  NULL. Note that if the return value is not NULL, the caller must 
+  free it.
 
   ==========================================================================*/
 char *program_get_tz (const ProgramContext *context)
@@ -502,6 +1246,24 @@ char *program_get_tz (const ProgramContext *context)
       }
     }
 
+  if (!ret)
+    {
+    const SolTzMap *tzmap = program_context_get_tzmap (context);
+    double lat, longt;
+    if (tzmap && program_get_lat (context, &lat) 
+         && program_get_longt (context, &longt))
+      {
+      const char *zone = soltzmap_find_zone (tzmap, lat, longt);
+      if (zone)
+        {
+        klog_debug (KLOG_CLASS, "Timezone from map is %s", zone);
+        ret = strdup (zone);
+        }
+      else
+        klog_warn (KLOG_CLASS, "No timezone in map at %g,%g", lat, longt);
+      }
+    }
+
   KLOG_IN
   done:
   return ret;
@@ -535,13 +1297,89 @@ int program_run (const ProgramContext *context)
   int ret = 0;
   klog_set_handler (program_log_handler);
 
-  if (HAS_OPTION ("days"))
+  char *s;
+  if ((s = GET ("make-ephemeris")))
     {
-    ret = program_days (context);
+    ret = program_make_ephemeris (context);
+    free (s);
+    }
+  else if ((s = GET ("make-gazetteer")))
+    {
+    ret = program_make_gazetteer (context);
+    free (s);
+    }
+  else if ((s = GET ("make-grid")))
+    {
+    ret = program_make_grid (context);
+    free (s);
+    }
+  else if ((s = GET ("make-tzmap")))
+    {
+    ret = program_make_tzmap (context);
+    free (s);
+    }
+  else if ((s = GET ("check-ephemeris")))
+    {
+    ret = program_check_ephemeris (context);
+    free (s);
+    }
+  else if ((s = GET ("check-grid")))
+    {
+    ret = program_check_grid (context);
+    free (s);
     }
   else
     {
-    ret = program_day_summary (context);
+    MoonChebyshev *mc = NULL;
+    if ((s = GET ("ephemeris")))
+      {
+      mc = moonchebyshev_open (s);
+      if (mc)
+        moonephemera_set_chebyshev (mc);
+      else
+        klog_warn (KLOG_CLASS, "Ephemeris file not used");
+      free (s);
+      }
+
+    if ((s = GET ("serve")))
+      {
+      free (s);
+      ret = program_serve (context);
+      }
+    else if (HAS_OPTION ("batch"))
+      {
+      ret = program_batch (context);
+      }
+    else if ((s = GET ("nearest")))
+      {
+      free (s);
+      ret = program_nearest (context);
+      }
+    else if ((s = GET ("years")))
+      {
+      free (s);
+      ret = program_years (context);
+      }
+    else if ((s = GET ("from")) || (s = GET ("to")) 
+           || GET_INTEGER ("day-count", 0) > 0)
+      {
+      free (s);
+      ret = program_day_range (context);
+      }
+    else if (HAS_OPTION ("days"))
+      {
+      ret = program_days (context);
+      }
+    else
+      {
+      ret = program_day_summary (context);
+      }
+
+    if (mc)
+      {
+      moonephemera_set_chebyshev (NULL);
+      moonchebyshev_close (mc);
+      }
     }
 
   KLOG_OUT
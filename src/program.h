@@ -10,7 +10,72 @@
   ==========================================================================*/
 #pragma once
 
+#include <stdio.h>
+#include <klib/klib.h>
+#include <libsolunar/libsolunar.h>
 #include "program_context.h"
 
 int program_run (const ProgramContext *context);
 
+/** Handle --batch, reading requests from stdin and writing a result for
+ * each to stdout. See program_batch.c. */
+int program_batch (const ProgramContext *context);
+
+/** Handle --serve, answering requests over HTTP until interrupted. See
+ * program_serve.c. */
+int program_serve (const ProgramContext *context);
+
+/** A request for a day summary from --batch or --serve. Any of the
+ * strings may be NULL, and belong to the request. */
+typedef struct _ProgramRequest
+  {
+  char *city;
+  char *tz;
+  char *date;
+  double lat;
+  double longt;
+  BOOL has_lat;
+  BOOL has_longt;
+  } ProgramRequest;
+
+/** Fill in the position and timezone of a request from its city, if it
+ * has one, then the timezone from tzmap or, failing that, tz. Either may
+ * be NULL. city is set to the name of the city, or NULL. Returns FALSE,
+ * with the reason in error, if the city is unknown or ambiguous, or
+ * there is no position. */
+BOOL program_request_resolve (ProgramRequest *req, const SolTzMap *tzmap,
+      const char *tz, const char **city, char *error, size_t size);
+
+/** Get the start of the day of a request, which is today if it has no
+ * date. Returns FALSE, with the reason in error, if the date is
+ * invalid. */
+BOOL program_request_get_date (const ProgramRequest *req, time_t *date,
+      char *error, size_t size);
+
+/** Free the strings in a request, and clear it. */
+void program_request_free (ProgramRequest *req);
+
+/** Parse a list of sets of movable feasts, separated by commas, or 
+ * "all". Returns FALSE, with the reason in error, if a name is not 
+ * known. */
+BOOL program_parse_feasts (const char *s, int *feasts, char *error,
+      size_t size);
+
+/** Get the sets of movable feasts from --feasts. Returns FALSE, having
+ * logged the reason, if a name is not known. */
+BOOL program_get_feasts (const ProgramContext *context, int *feasts);
+
+/** Get the timezone from the command line or RC files, or from the city
+ * or position. The caller must free the result, which may be NULL. */
+char *program_get_tz (const ProgramContext *context);
+
+/** Write a day summary on one line, in the specified format: text, 
+ * jsonl or csv. */
+void program_write_day_line (FILE *out, const SolunarDaySummary *sds,
+      const char *format, const KTimeFormat *date_fmt, 
+      const KTimeFormat *time_fmt);
+
+/** Write the heading line for the csv format of 
+ * program_write_day_line(). */
+void program_write_csv_heading (FILE *out);
+
@@ -0,0 +1,669 @@
+/*============================================================================
+  
+  solunar
+  
+  program_batch.c
+
+  The --batch mode, which reads requests from stdin, one to a line, and
+  writes a result for each to stdout, in the same order. A request is
+  either comma-separated values:
+
+    city[,date]
+    latitude,longitude[,timezone[,date]]
+
+  or a JSON object with some of the members "city", "latitude" (or
+  "lat"), "longitude" (or "lon"), "tz" (or "timezone") and "date". Any
+  value left out is found from the city or the timezone map, or is the
+  same as it would be for a single day on the command line. Blank lines,
+  and lines that start with '#', are ignored.
+
+  The work is done in three stages, connected by bounded queues: a
+  thread that reads lines, the worker threads that parse the lines and
+  work out the results, and the main thread, which writes the results.
+  The parsing is done by the workers, because finding a city is the
+  most expensive part of it. A worker can't take a line so far ahead of
+  the last result written that there's nowhere to put its result, so the
+  memory used does not depend on the number of requests.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <klib/klib.h>
+#include <libsolunar/libsolunar.h>
+#include "program_context.h"
+#include "program.h"
+
+#define KLOG_CLASS "solunar.program_batch"
+
+#define HAS_OPTION(x) program_context_get_boolean(context,x,FALSE)
+#define GET_INTEGER(x,y) program_context_get_integer(context,x,y)
+#define GET(x) program_context_get(context,x)
+
+// The number of lines, for each thread, that can be waiting for a worker,
+//  and the number of results that can be waiting to be written
+#define PROGRAM_BATCH_SLOTS_PER_THREAD 16
+
+// A worker reuses its ephemeris for a request whose day starts within
+//  this many seconds of the day for which the ephemeris was made
+#define PROGRAM_BATCH_EPHEMERIS_REUSE (12 * 60 * 60)
+
+/*============================================================================
+  
+  ProgramBatch
+
+  The state shared by the three stages. Line i is in lines[i % nslots]
+  from when it is read until a worker takes it, and its result is in
+  outputs[i % nslots] from when the worker stores it until it is
+  written
+
+  ==========================================================================*/
+typedef struct _ProgramBatch
+  {
+  const char *format;
+  const char *tz;         // --tz, or NULL
+  const SolTzMap *tzmap;
+  BOOL ampm;
+  int nslots;
+  char **lines;
+  long nread;             // Lines read so far
+  long ntaken;            // Lines taken by workers so far
+  BOOL eof;
+  char **outputs;
+  size_t *sizes;
+  long nwritten;          // Results written so far
+  pthread_mutex_t lock;
+  pthread_cond_t read;    // Signalled when a line is read, or at the end
+  pthread_cond_t taken;   // Signalled when a line is taken
+  pthread_cond_t done;    // Signalled when a result is stored, or at the end
+  pthread_cond_t written; // Signalled when a result is written
+  } ProgramBatch;
+
+/*============================================================================
+  
+  ProgramBatchWorker
+
+  The state that each worker keeps from one request to the next.
+  Requests for many places on the same date can share an ephemeris
+
+  ==========================================================================*/
+typedef struct _ProgramBatchWorker
+  {
+  ProgramBatch *pb;
+  SolEphemeris *eph;
+  time_t eph_date;
+  } ProgramBatchWorker;
+
+/*============================================================================
+  
+  program_batch_trim
+
+  Remove leading and trailing white space, in place
+
+  ==========================================================================*/
+static char *program_batch_trim (char *s)
+  {
+  while (isspace ((unsigned char)*s)) s++;
+  size_t len = strlen (s);
+  while (len > 0 && isspace ((unsigned char)s[len - 1])) s[--len] = 0;
+  return s;
+  }
+
+/*============================================================================
+  
+  program_batch_parse_number
+
+  ==========================================================================*/
+static BOOL program_batch_parse_number (const char *s, double *d)
+  {
+  char *end;
+  *d = strtod (s, &end);
+  return end != s && *end == 0;
+  }
+
+/*============================================================================
+  
+  program_batch_parse_csv
+
+  ==========================================================================*/
+static BOOL program_batch_parse_csv (const char *line,
+      ProgramRequest *req, char *error, size_t size)
+  {
+  KLOG_IN
+  BOOL ret = TRUE;
+  char *copy = strdup (line);
+  char *fields[4];
+  int nfields = 0;
+  char *p = copy;
+  char *field;
+  while (ret && (field = strsep (&p, ",")))
+    {
+    if (nfields == 4)
+      {
+      snprintf (error, size, "Too many fields");
+      ret = FALSE;
+      }
+    else
+      fields[nfields++] = program_batch_trim (field);
+    }
+
+  if (ret)
+    {
+    double lat, longt;
+    if (nfields >= 2 && program_batch_parse_number (fields[0], &lat)
+         && program_batch_parse_number (fields[1], &longt))
+      {
+      req->lat = lat;
+      req->longt = longt;
+      req->has_lat = req->has_longt = TRUE;
+      if (nfields > 2 && fields[2][0]) req->tz = strdup (fields[2]);
+      if (nfields > 3 && fields[3][0]) req->date = strdup (fields[3]);
+      }
+    else if (nfields <= 2)
+      {
+      if (fields[0][0]) req->city = strdup (fields[0]);
+      if (nfields > 1 && fields[1][0]) req->date = strdup (fields[1]);
+      }
+    else
+      {
+      snprintf (error, size, "Invalid latitude or longitude");
+      ret = FALSE;
+      }
+    }
+
+  free (copy);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_batch_parse_json_string
+
+  Parse a JSON string, starting at the opening quote, into a new string
+  which the caller must free. Escaped characters are written as UTF-8.
+  Returns the position after the closing quote, or NULL if the string
+  is invalid
+
+  ==========================================================================*/
+static const char *program_batch_parse_json_string (const char *p,
+      char **s)
+  {
+  // Unescaping never makes the string longer
+  char *out = malloc (strlen (p) + 1);
+  size_t len = 0;
+  p++;
+  while (*p && *p != '"')
+    {
+    if (*p != '\\')
+      {
+      out[len++] = *p++;
+      continue;
+      }
+    p++;
+    unsigned int u;
+    switch (*p++)
+      {
+      case 'b': out[len++] = '\b'; break;
+      case 'f': out[len++] = '\f'; break;
+      case 'n': out[len++] = '\n'; break;
+      case 'r': out[len++] = '\r'; break;
+      case 't': out[len++] = '\t'; break;
+      case '"': out[len++] = '"'; break;
+      case '\\': out[len++] = '\\'; break;
+      case '/': out[len++] = '/'; break;
+      case 'u':
+        if (!(isxdigit ((unsigned char)p[0]) && isxdigit ((unsigned char)p[1])
+             && isxdigit ((unsigned char)p[2]) 
+             && isxdigit ((unsigned char)p[3])
+             && sscanf (p, "%4x", &u) == 1))
+          {
+          free (out);
+          return NULL;
+          }
+        p += 4;
+        if (u < 0x80)
+          out[len++] = u;
+        else if (u < 0x800)
+          {
+          out[len++] = 0xC0 | (u >> 6);
+          out[len++] = 0x80 | (u & 0x3F);
+          }
+        else
+          {
+          out[len++] = 0xE0 | (u >> 12);
+          out[len++] = 0x80 | ((u >> 6) & 0x3F);
+          out[len++] = 0x80 | (u & 0x3F);
+          }
+        break;
+      default:
+        free (out);
+        return NULL;
+      }
+    }
+  if (*p != '"')
+    {
+    free (out);
+    return NULL;
+    }
+  out[len] = 0;
+  *s = out;
+  return p + 1;
+  }
+
+/*============================================================================
+  
+  program_batch_parse_json
+
+  Parse a JSON object whose members have string or number values.
+  Members that aren't part of a request are ignored, so long as their
+  values are not objects or arrays, and a member whose value is null is
+  the same as one left out
+
+  ==========================================================================*/
+static BOOL program_batch_parse_json (const char *line,
+      ProgramRequest *req, char *error, size_t size)
+  {
+  KLOG_IN
+  BOOL ret = TRUE;
+  const char *p = line + 1; // The caller checked that it starts with {
+  while (isspace ((unsigned char)*p)) p++;
+  BOOL first = TRUE;
+  while (ret && *p != '}')
+    {
+    char *key = NULL;
+    char *value = NULL;
+    BOOL is_string = FALSE;
+    if (!first)
+      {
+      if (*p == ',') p++; else p = NULL;
+      while (p && isspace ((unsigned char)*p)) p++;
+      }
+    first = FALSE;
+
+    if (p && *p == '"') 
+      p = program_batch_parse_json_string (p, &key);
+    else 
+      p = NULL;
+    while (p && isspace ((unsigned char)*p)) p++;
+    if (p && *p == ':') p++; else p = NULL;
+    while (p && isspace ((unsigned char)*p)) p++;
+    if (p && *p == '"')
+      {
+      is_string = TRUE;
+      p = program_batch_parse_json_string (p, &value);
+      }
+    else if (p)
+      {
+      // A number, true, false or null
+      const char *q = p;
+      while (isalnum ((unsigned char)*q) || *q == '-' || *q == '+' 
+          || *q == '.')
+        q++;
+      if (q == p)
+        p = NULL;
+      else
+        {
+        value = strndup (p, q - p);
+        p = q;
+        }
+      }
+    while (p && isspace ((unsigned char)*p)) p++;
+
+    if (!p)
+      {
+      snprintf (error, size, "Invalid JSON");
+      ret = FALSE;
+      }
+    else if (!is_string && strcmp (value, "null") == 0)
+      ;
+    else if (strcmp (key, "city") == 0)
+      {
+      free (req->city);
+      req->city = value; value = NULL;
+      }
+    else if (strcmp (key, "tz") == 0 || strcmp (key, "timezone") == 0)
+      {
+      free (req->tz);
+      req->tz = value; value = NULL;
+      }
+    else if (strcmp (key, "date") == 0)
+      {
+      free (req->date);
+      req->date = value; value = NULL;
+      }
+    else if (strcmp (key, "lat") == 0 || strcmp (key, "latitude") == 0)
+      {
+      req->has_lat = program_batch_parse_number (value, &req->lat);
+      if (!req->has_lat)
+        {
+        snprintf (error, size, "Invalid latitude");
+        ret = FALSE;
+        }
+      }
+    else if (strcmp (key, "lon") == 0 || strcmp (key, "longitude") == 0)
+      {
+      req->has_longt = program_batch_parse_number (value, &req->longt);
+      if (!req->has_longt)
+        {
+        snprintf (error, size, "Invalid longitude");
+        ret = FALSE;
+        }
+      }
+
+    if (key) free (key);
+    if (value) free (value);
+    if (!p) break;
+    }
+
+  if (ret && *p != '}')
+    {
+    snprintf (error, size, "Invalid JSON");
+    ret = FALSE;
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_batch_write_error
+
+  Write the result for a request that could not be carried out, so
+  that there is still one result for each request
+
+  ==========================================================================*/
+static void program_batch_write_error (FILE *out, const char *format,
+      const char *error)
+  {
+  KLOG_IN
+  if (strcmp (format, "jsonl") == 0)
+    {
+    fprintf (out, "{\"error\":\"");
+    for (const char *p = error; *p; p++)
+      {
+      if (*p == '"' || *p == '\\') fputc ('\\', out);
+      if ((unsigned char)*p >= ' ') fputc (*p, out);
+      }
+    fprintf (out, "\"}\n");
+    }
+  else
+    {
+    // Keep the error in the first field of a CSV line
+    fprintf (out, "error: ");
+    for (const char *p = error; *p; p++)
+      fputc (*p == ',' ? ';' : *p, out);
+    fputc ('\n', out);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_batch_process
+
+  Parse a line, and write the result to out
+
+  ==========================================================================*/
+static void program_batch_process (ProgramBatchWorker *w, const char *line,
+      FILE *out)
+  {
+  KLOG_IN
+  ProgramBatch *pb = w->pb;
+  ProgramRequest req;
+  memset (&req, 0, sizeof (req));
+  char error[256];
+  const char *city = NULL;
+
+  BOOL ok;
+  if (line[0] == '{')
+    ok = program_batch_parse_json (line, &req, error, sizeof (error));
+  else
+    ok = program_batch_parse_csv (line, &req, error, sizeof (error));
+  if (ok)
+    ok = program_request_resolve (&req, pb->tzmap, pb->tz, &city, error,
+      sizeof (error));
+
+  time_t d = 0;
+  if (ok)
+    ok = program_request_get_date (&req, &d, error, sizeof (error));
+
+  if (ok)
+    {
+    if (!w->eph || d < w->eph_date - PROGRAM_BATCH_EPHEMERIS_REUSE
+         || d > w->eph_date + PROGRAM_BATCH_EPHEMERIS_REUSE)
+      {
+      solephemeris_destroy (w->eph);
+      w->eph = solunar_day_summary_create_ephemeris (d);
+      w->eph_date = d;
+      }
+    SolunarDaySummary *sds = solunar_day_summary_create_with_ephemeris
+      (d, req.lat, req.longt, city, req.tz, w->eph);
+    const KTimeZone *zone = req.tz ? ktimezone_get (req.tz) : NULL;
+    KTimeFormat *date_fmt = ktimeformat_new ("%Y-%m-%d", zone);
+    KTimeFormat *time_fmt = ktimeformat_new (pb->ampm ? "12hr" : "24hr",
+      zone);
+    program_write_day_line (out, sds, pb->format, date_fmt, time_fmt);
+    ktimeformat_destroy (time_fmt);
+    ktimeformat_destroy (date_fmt);
+    solunar_day_summary_destroy (sds);
+    }
+  else
+    program_batch_write_error (out, pb->format, error);
+
+  program_request_free (&req);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_batch_reader
+
+  ==========================================================================*/
+static void *program_batch_reader (void *arg)
+  {
+  KLOG_IN
+  ProgramBatch *pb = arg;
+  char *line = NULL;
+  size_t n = 0;
+  ssize_t len;
+  while ((len = getline (&line, &n, stdin)) >= 0)
+    {
+    char *s = program_batch_trim (line);
+    if (*s == 0 || *s == '#') continue;
+    char *copy = strdup (s);
+    pthread_mutex_lock (&pb->lock);
+    while (pb->nread - pb->ntaken >= pb->nslots)
+      pthread_cond_wait (&pb->taken, &pb->lock);
+    pb->lines[pb->nread % pb->nslots] = copy;
+    pb->nread++;
+    pthread_cond_signal (&pb->read);
+    pthread_mutex_unlock (&pb->lock);
+    }
+  free (line);
+  pthread_mutex_lock (&pb->lock);
+  pb->eof = TRUE;
+  pthread_cond_broadcast (&pb->read);
+  pthread_cond_broadcast (&pb->done);
+  pthread_mutex_unlock (&pb->lock);
+  KLOG_OUT
+  return NULL;
+  }
+
+/*============================================================================
+  
+  program_batch_worker
+
+  ==========================================================================*/
+static void *program_batch_worker (void *arg)
+  {
+  KLOG_IN
+  ProgramBatchWorker *w = arg;
+  ProgramBatch *pb = w->pb;
+  pthread_mutex_lock (&pb->lock);
+  for (;;)
+    {
+    while (pb->ntaken == pb->nread && !pb->eof)
+      pthread_cond_wait (&pb->read, &pb->lock);
+    if (pb->ntaken == pb->nread) break;
+    long i = pb->ntaken++;
+    char *line = pb->lines[i % pb->nslots];
+    pthread_cond_signal (&pb->taken);
+    while (i >= pb->nwritten + pb->nslots)
+      pthread_cond_wait (&pb->written, &pb->lock);
+    pthread_mutex_unlock (&pb->lock);
+
+    char *output = NULL;
+    size_t size = 0;
+    FILE *out = open_memstream (&output, &size);
+    if (out)
+      {
+      program_batch_process (w, line, out);
+      fclose (out);
+      }
+    else
+      klog_error (KLOG_CLASS, "Can't process request: %s",
+        strerror (errno));
+    free (line);
+
+    pthread_mutex_lock (&pb->lock);
+    // An empty string, rather than NULL, if the request failed, so the
+    //  main thread does not wait for it
+    pb->outputs[i % pb->nslots] = output ? output : strdup ("");
+    pb->sizes[i % pb->nslots] = output ? size : 0;
+    pthread_cond_broadcast (&pb->done);
+    }
+  pthread_mutex_unlock (&pb->lock);
+  KLOG_OUT
+  return NULL;
+  }
+
+/*============================================================================
+  
+  program_batch
+
+  Handle the --batch option
+
+  ==========================================================================*/
+int program_batch (const ProgramContext *context)
+  {
+  KLOG_IN
+  int ret = 0;
+  char *format = GET ("format");
+  if (!format) format = strdup (HAS_OPTION ("json") ? "jsonl" : "text");
+  if (strcmp (format, "text") != 0 && strcmp (format, "jsonl") != 0
+       && strcmp (format, "csv") != 0)
+    {
+    klog_error (KLOG_CLASS, "Unknown format: %s", format);
+    free (format);
+    KLOG_OUT
+    return EINVAL;
+    }
+
+  int threads = GET_INTEGER ("threads", 0);
+  if (threads <= 0) threads = sysconf (_SC_NPROCESSORS_ONLN);
+  if (threads <= 0) threads = 1;
+
+  ProgramBatch pb;
+  memset (&pb, 0, sizeof (pb));
+  pb.format = format;
+  // Only the zone given by --tz is the default for all the requests, not
+  //  that of the city or position on the command line
+  char *tz = GET ("tz");
+  if (tz && (strstr (tz, "sys") || strstr (tz, "system")))
+    {
+    free (tz);
+    tz = NULL;
+    }
+  pb.tz = tz;
+  pb.tzmap = program_context_get_tzmap (context);
+  pb.ampm = HAS_OPTION ("ampm");
+  pb.nslots = threads * PROGRAM_BATCH_SLOTS_PER_THREAD;
+  pb.lines = calloc (pb.nslots, sizeof (char *));
+  pb.outputs = calloc (pb.nslots, sizeof (char *));
+  pb.sizes = calloc (pb.nslots, sizeof (size_t));
+  pthread_mutex_init (&pb.lock, NULL);
+  pthread_cond_init (&pb.read, NULL);
+  pthread_cond_init (&pb.taken, NULL);
+  pthread_cond_init (&pb.done, NULL);
+  pthread_cond_init (&pb.written, NULL);
+  klog_debug (KLOG_CLASS, "Batch on %d threads", threads);
+
+  if (strcmp (format, "csv") == 0)
+    program_write_csv_heading (stdout);
+
+  pthread_t reader;
+  pthread_create (&reader, NULL, program_batch_reader, &pb);
+  pthread_t *workers = malloc (threads * sizeof (pthread_t));
+  ProgramBatchWorker *states = calloc (threads,
+    sizeof (ProgramBatchWorker));
+  for (int i = 0; i < threads; i++)
+    {
+    states[i].pb = &pb;
+    pthread_create (&workers[i], NULL, program_batch_worker, &states[i]);
+    }
+
+  for (long i = 0; ; i++)
+    {
+    int slot = i % pb.nslots;
+    BOOL flushed = FALSE;
+    pthread_mutex_lock (&pb.lock);
+    while (!pb.outputs[slot] && !(pb.eof && i >= pb.nread))
+      {
+      if (!flushed)
+        {
+        // Don't hold back the results already written while waiting,
+        //  since the requests might be coming interactively
+        pthread_mutex_unlock (&pb.lock);
+        fflush (stdout);
+        pthread_mutex_lock (&pb.lock);
+        flushed = TRUE;
+        continue;
+        }
+      pthread_cond_wait (&pb.done, &pb.lock);
+      }
+    char *output = pb.outputs[slot];
+    size_t size = pb.sizes[slot];
+    if (output)
+      {
+      pb.outputs[slot] = NULL;
+      pb.nwritten++;
+      pthread_cond_broadcast (&pb.written);
+      }
+    pthread_mutex_unlock (&pb.lock);
+    if (!output) break;
+    fwrite (output, 1, size, stdout);
+    free (output);
+    }
+  fflush (stdout);
+
+  pthread_join (reader, NULL);
+  for (int i = 0; i < threads; i++)
+    {
+    pthread_join (workers[i], NULL);
+    solephemeris_destroy (states[i].eph);
+    }
+  free (states);
+  free (workers);
+  pthread_cond_destroy (&pb.written);
+  pthread_cond_destroy (&pb.done);
+  pthread_cond_destroy (&pb.taken);
+  pthread_cond_destroy (&pb.read);
+  pthread_mutex_destroy (&pb.lock);
+  free (pb.sizes);
+  free (pb.outputs);
+  free (pb.lines);
+  if (tz) free (tz);
+  free (format);
+  KLOG_OUT
+  return ret;
+  }
+
@@ -12,6 +12,9 @@
 #include <stdio.h> 
 #include <time.h> 
 #include <stdlib.h> 
+#include <errno.h> 
+#include <limits.h> 
+#include <sys/stat.h> 
 #include <klib/klib.h> 
 #include <string.h> 
 #include <getopt.h> 
@@ -40,6 +43,9 @@ struct _ProgramContext
   int nonswitch_argc;
   char **nonswitch_argv;
   const SolCity *city;
+  SolGazetteer *gazetteer;
+  SolTzMap *tzmap;
+  SolCache *cache;
   };
 
 /*============================================================================
@@ -71,11 +77,78 @@ void program_context_destroy (ProgramContext *self)
     for (int i = 0; i < self->nonswitch_argc; i++)
       free (self->nonswitch_argv[i]);
     free (self->nonswitch_argv);
+    if (self->gazetteer)
+      {
+      solcity_set_gazetteer (NULL);
+      solgazetteer_close (self->gazetteer);
+      }
+    if (self->tzmap) soltzmap_close (self->tzmap);
+    if (self->cache) solcache_close (self->cache);
     free (self);
     }
   KLOG_OUT
   }
 
+/*============================================================================
+  
+  program_context_open_cache
+
+  Open the cache given by --cache, which is in $XDG_CACHE_HOME/solunar
+  if no file is given. The source of the cached summaries includes the
+  size and time of the ephemeris file, if one is used, so that replacing
+  it discards them
+
+  ==========================================================================*/
+static SolCache *program_context_open_cache (const ProgramContext *self,
+        const char *file)
+  {
+  KLOG_IN
+  SolCache *ret = NULL;
+  char *path = NULL;
+  if (file[0])
+    path = strdup (file);
+  else
+    {
+    const char *xdg = getenv ("XDG_CACHE_HOME");
+    const char *home = getenv ("HOME");
+    char dir[PATH_MAX];
+    dir[0] = 0;
+    if (xdg && xdg[0])
+      snprintf (dir, sizeof (dir), "%s/solunar", xdg);
+    else if (home)
+      {
+      snprintf (dir, sizeof (dir), "%s/.cache", home);
+      mkdir (dir, 0700);
+      strncat (dir, "/solunar", sizeof (dir) - strlen (dir) - 1);
+      }
+    if (dir[0])
+      {
+      if (mkdir (dir, 0700) != 0 && errno != EEXIST)
+        klog_warn (KLOG_CLASS, "Can't create %s: %s", dir, strerror (errno));
+      path = malloc (strlen (dir) + 6);
+      sprintf (path, "%s/days", dir);
+      }
+    else
+      klog_warn (KLOG_CLASS, "No cache directory: HOME is not set");
+    }
+
+  if (path)
+    {
+    char source[512];
+    source[0] = 0;
+    char *ephemeris = program_context_get (self, "ephemeris");
+    struct stat sb;
+    if (ephemeris && stat (ephemeris, &sb) == 0)
+      snprintf (source, sizeof (source), "ephemeris %s %ld %ld", ephemeris,
+        (long)sb.st_size, (long)sb.st_mtime);
+    if (ephemeris) free (ephemeris);
+    ret = solcache_open (path, source);
+    free (path);
+    }
+  KLOG_OUT
+  return ret;
+  }
+
 /*============================================================================
   
   program_context_check_and_resolve
@@ -85,6 +158,35 @@ BOOL program_context_check_and_resolve (ProgramContext *self)
   {
   KLOG_IN
   BOOL ret = TRUE;
+  char *gazetteer = program_context_get (self, "gazetteer");
+  if (gazetteer)
+    {
+    self->gazetteer = solgazetteer_open (gazetteer);
+    if (self->gazetteer)
+      solcity_set_gazetteer (self->gazetteer);
+    else
+      klog_warn (KLOG_CLASS, "Gazetteer not used");
+    free (gazetteer);
+    }
+
+  char *tzmap = program_context_get (self, "tzmap");
+  if (tzmap)
+    {
+    self->tzmap = soltzmap_open (tzmap);
+    if (!self->tzmap)
+      klog_warn (KLOG_CLASS, "Timezone map not used");
+    free (tzmap);
+    }
+
+  char *cache = program_context_get (self, "cache");
+  if (cache)
+    {
+    self->cache = program_context_open_cache (self, cache);
+    if (!self->cache)
+      klog_warn (KLOG_CLASS, "Cache not used");
+    free (cache);
+    }
+
   char *city = program_context_get (self, "city");
   if (city)
     {
@@ -158,6 +260,23 @@ BOOL program_context_check_and_resolve (ProgramContext *self)
       }
     }
 
+  // The dates that bound a range of days must be full dates
+  const char *range_dates[] = {"from", "to"};
+  for (int i = 0; i < 2 && ret; i++)
+    {
+    char *date = PCG (self, range_dates[i]);
+    if (date)
+      {
+      if (datetimeconv_parse_date (date, 0, 0, NULL) == 0)
+        {
+        printf ("Invalid date '%s'.\n", date);
+        printf ("'" NAME " --date=help' for format information.\n");
+        ret = FALSE;
+        }
+      free (date);
+      }
+    }
+
   if (city) free (city);
   KLOG_OUT
   return ret;
@@ -199,6 +318,34 @@ BOOL program_context_get_boolean (const ProgramContext *self,
   return ret;
   }
 
+/*==========================================================================
+
+  program_context_get_tzmap
+
+  ========================================================================*/
+const SolTzMap *program_context_get_tzmap (const ProgramContext *self)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  const SolTzMap *ret = self->tzmap;
+  KLOG_OUT
+  return ret;
+  }
+
+/*==========================================================================
+
+  program_context_get_cache
+
+  ========================================================================*/
+SolCache *program_context_get_cache (const ProgramContext *self)
+  {
+  KLOG_IN
+  assert (self != NULL);
+  SolCache *ret = self->cache;
+  KLOG_OUT
+  return ret;
+  }
+
 /*==========================================================================
 
   program_context_get_city
@@ -242,17 +389,42 @@ BOOL program_context_parse_command_line (ProgramContext *self,
   static struct option long_options[] =
     {
       {"ampm", no_argument, NULL, 'a'},
+      {"batch", no_argument, NULL, 0},
+      {"cache", optional_argument, NULL, 0},
       {"full", no_argument, NULL, 'f'},
       {"help", no_argument, NULL, 'h'},
       {"city", required_argument, NULL, 'c'},
+      {"check-ephemeris", required_argument, NULL, 0},
+      {"check-grid", required_argument, NULL, 0},
       {"json", no_argument, NULL, 'j'},
       {"date", required_argument, NULL, 'd'},
+      {"days", required_argument, NULL, 0},
+      {"ephemeris", required_argument, NULL, 0},
+      {"ephemeris-years", required_argument, NULL, 0},
+      {"feasts", required_argument, NULL, 0},
+      {"format", required_argument, NULL, 0},
+      {"from", required_argument, NULL, 0},
+      {"gazetteer", required_argument, NULL, 0},
+      {"gazetteer-source", required_argument, NULL, 0},
+      {"grid-step", required_argument, NULL, 0},
+      {"grid-year", required_argument, NULL, 0},
       {"list-cities", no_argument, NULL, 0},
+      {"serve", required_argument, NULL, 0},
+      {"threads", required_argument, NULL, 0},
+      {"to", required_argument, NULL, 0},
       {"tz", required_argument, NULL, 't'},
+      {"tzmap", required_argument, NULL, 0},
+      {"tzmap-source", required_argument, NULL, 0},
       {"year", optional_argument, NULL, 'y'},
+      {"years", required_argument, NULL, 0},
       {"log-level", required_argument, NULL, 0},
       {"latitude", required_argument, NULL, 'l'},
       {"longitude", required_argument, NULL, 'o'},
+      {"make-ephemeris", required_argument, NULL, 0},
+      {"make-gazetteer", required_argument, NULL, 0},
+      {"make-grid", required_argument, NULL, 0},
+      {"make-tzmap", required_argument, NULL, 0},
+      {"nearest", optional_argument, NULL, 0},
       {"version", no_argument, NULL, 'v'},
       {0, 0, 0, 0}
     };
@@ -273,6 +445,63 @@ BOOL program_context_parse_command_line (ProgramContext *self,
            PCPI (self, "log-level", atoi (optarg));
          else if (strcmp (long_options[option_index].name, "list-cities") == 0)
            PCPB (self, "list-cities", TRUE);
+         else if (strcmp (long_options[option_index].name, "batch") == 0)
+           PCPB (self, "batch", TRUE);
+         else if (strcmp (long_options[option_index].name, 
+                "check-ephemeris") == 0)
+           PCP (self, "check-ephemeris", optarg);
+         else if (strcmp (long_options[option_index].name, "check-grid") == 0)
+           PCP (self, "check-grid", optarg);
+         else if (strcmp (long_options[option_index].name, "ephemeris") == 0)
+           PCP (self, "ephemeris", optarg);
+         else if (strcmp (long_options[option_index].name, 
+                "ephemeris-years") == 0)
+           PCP (self, "ephemeris-years", optarg);
+         else if (strcmp (long_options[option_index].name, "days") == 0)
+           PCPI (self, "day-count", atoi (optarg));
+         else if (strcmp (long_options[option_index].name, "feasts") == 0)
+           PCP (self, "feasts", optarg);
+         else if (strcmp (long_options[option_index].name, "format") == 0)
+           PCP (self, "format", optarg);
+         else if (strcmp (long_options[option_index].name, "from") == 0)
+           PCP (self, "from", optarg);
+         else if (strcmp (long_options[option_index].name, "gazetteer") == 0)
+           PCP (self, "gazetteer", optarg);
+         else if (strcmp (long_options[option_index].name, 
+                "gazetteer-source") == 0)
+           PCP (self, "gazetteer-source", optarg);
+         else if (strcmp (long_options[option_index].name, "grid-step") == 0)
+           PCP (self, "grid-step", optarg);
+         else if (strcmp (long_options[option_index].name, "grid-year") == 0)
+           PCPI (self, "grid-year", atoi (optarg));
+         else if (strcmp (long_options[option_index].name, 
+                "make-ephemeris") == 0)
+           PCP (self, "make-ephemeris", optarg);
+         else if (strcmp (long_options[option_index].name, 
+                "make-gazetteer") == 0)
+           PCP (self, "make-gazetteer", optarg);
+         else if (strcmp (long_options[option_index].name, "make-grid") == 0)
+           PCP (self, "make-grid", optarg);
+         else if (strcmp (long_options[option_index].name, 
+                "make-tzmap") == 0)
+           PCP (self, "make-tzmap", optarg);
+         else if (strcmp (long_options[option_index].name, "nearest") == 0)
+           PCP (self, "nearest", optarg ? optarg : "1");
+         else if (strcmp (long_options[option_index].name, "cache") == 0)
+           PCP (self, "cache", optarg ? optarg : "");
+         else if (strcmp (long_options[option_index].name, "serve") == 0)
+           PCP (self, "serve", optarg);
+         else if (strcmp (long_options[option_index].name, "threads") == 0)
+           PCPI (self, "threads", atoi (optarg));
+         else if (strcmp (long_options[option_index].name, "to") == 0)
+           PCP (self, "to", optarg);
+         else if (strcmp (long_options[option_index].name, "tzmap") == 0)
+           PCP (self, "tzmap", optarg);
+         else if (strcmp (long_options[option_index].name, 
+                "tzmap-source") == 0)
+           PCP (self, "tzmap-source", optarg);
+         else if (strcmp (long_options[option_index].name, "years") == 0)
+           PCP (self, "years", optarg);
          else
            exit (-1);
          break;
@@ -466,17 +695,42 @@ void program_context_show_usage (FILE *fout, const char *argv0)
   KLOG_IN
   fprintf (fout, "Usage: %s [options]\n", argv0);
   fprintf (fout, "  -a,--ampm                show AM/PM times\n");
+  fprintf (fout, "     --batch               read requests from stdin\n");
+  fprintf (fout, "     --cache=[file]        keep day summaries in cache\n");
   fprintf (fout, "  -c,--city=[name]         set city\n");
+  fprintf (fout, "     --check-ephemeris=[file] check ephemeris file\n");
+  fprintf (fout, "     --check-grid=[file]   check grid table file\n");
   fprintf (fout, "  -d,--date=[date,help]    set date, or see format\n");
+  fprintf (fout, "     --days=[count]        summarize count days\n");
+  fprintf (fout, "     --ephemeris=[file]    use moon ephemeris file\n");
+  fprintf (fout, "     --ephemeris-years=[first-last] years for --make-ephemeris\n");
+  fprintf (fout, "     --feasts=[sets]       feasts for --year, or 'all'\n");
+  fprintf (fout, "     --format=[text,jsonl,csv] format for --days, --batch\n");
+  fprintf (fout, "     --from=[date]         summarize days from date\n");
   fprintf (fout, "  -f,--full                show more results\n");
+  fprintf (fout, "     --gazetteer=[file]    also find places in gazetteer\n");
+  fprintf (fout, "     --gazetteer-source=[file] places for --make-gazetteer\n");
+  fprintf (fout, "     --grid-step=[degrees] grid step for --make-grid\n");
+  fprintf (fout, "     --grid-year=[year]    year for --make-grid\n");
   fprintf (fout, "     --help                show this message\n");
   fprintf (fout, "     --list-cities         list cities\n");
   fprintf (fout, "     --log-level=[0..5]    log level (default 2)\n");
   fprintf (fout, "  -l,--latitude=[degrees]  set latitude\n");
+  fprintf (fout, "     --make-ephemeris=[file] write moon ephemeris file\n");
+  fprintf (fout, "     --make-gazetteer=[file] write gazetteer file\n");
+  fprintf (fout, "     --make-grid=[file]    write grid table file\n");
+  fprintf (fout, "     --make-tzmap=[file]   write timezone map file\n");
+  fprintf (fout, "     --nearest=[count]     list nearest cities\n");
   fprintf (fout, "  -o,--longitude=[degrees] set longitude\n");
+  fprintf (fout, "     --serve=[socket,port] answer requests over HTTP\n");
+  fprintf (fout, "     --threads=[count]     threads for --years, --batch, --serve\n");
+  fprintf (fout, "     --to=[date]           summarize days to date\n");
   fprintf (fout, "  -t,--tz=[timezone]       set timezone\n");
+  fprintf (fout, "     --tzmap=[file]        find timezone from position\n");
+  fprintf (fout, "     --tzmap-source=[file] boundaries for --make-tzmap\n");
   fprintf (fout, "  -v,--version             show version\n");
   fprintf (fout, "  -y,--year=[year]         show year summary\n");
+  fprintf (fout, "     --years=[first-last]  show year summaries\n");
   KLOG_OUT
   }
 
@@ -53,10 +53,20 @@ extern char     *program_context_get (const ProgramContext *self,
 extern BOOL      program_context_get_boolean (const ProgramContext *self, 
                    const char *key, BOOL deflt);
 
+/** Gets the cache of day summaries given by the --cache command-line
+ * argument. This will be NULL if no --cache argument was given, or the
+ * cache could not be opened. */
+SolCache        *program_context_get_cache (const ProgramContext *self);
+
 /** Gets the SolCity instance that corresponds to the --city command-line
  * argument. This will be NULL if no --city argument was given. */
 const SolCity   *program_context_get_city (const ProgramContext *self);
 
+/** Gets the timezone map given by the --tzmap command-line argument. This
+ * will be NULL if no --tzmap argument was given, or the map could not be
+ * opened. */
+const SolTzMap  *program_context_get_tzmap (const ProgramContext *self);
+
 extern int       program_context_get_integer (const ProgramContext *self, 
                    const char *key, int deflt);
 
@@ -0,0 +1,127 @@
+/*============================================================================
+  
+  solunar
+  
+  program_request.c
+
+  The requests for a single day summary that come from --batch and
+  --serve, rather than from the command line, and the rules for filling
+  in what a request leaves out. These do not use the program context, so
+  they are safe to call from any thread
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <klib/klib.h>
+#include <libsolunar/libsolunar.h>
+#include "program.h"
+
+#define KLOG_CLASS "solunar.program_request"
+
+/*============================================================================
+  
+  program_request_resolve
+
+  ==========================================================================*/
+BOOL program_request_resolve (ProgramRequest *req, const SolTzMap *tzmap,
+      const char *tz, const char **city, char *error, size_t size)
+  {
+  KLOG_IN
+  BOOL ret = TRUE;
+  *city = NULL;
+  if (req->city)
+    {
+    KList *list = solcity_find_matching ((UTF8 *)req->city);
+    int n = list ? klist_length (list) : 0;
+    const SolCity *c = n == 1 ? klist_get (list, 0) : NULL;
+    // A name that is part of other names, like America/Bahia, can still
+    //  be given exactly
+    for (int i = 0; i < n && !c; i++)
+      if (strcasecmp (solcity_get_name (klist_get (list, i)),
+            req->city) == 0)
+        c = klist_get (list, i);
+    if (c)
+      {
+      *city = solcity_get_name (c);
+      if (!req->has_lat) req->lat = solcity_get_latitude (c);
+      if (!req->has_longt) req->longt = solcity_get_longitude (c);
+      req->has_lat = req->has_longt = TRUE;
+      if (!req->tz) req->tz = strdup (solcity_get_tz_name (c));
+      }
+    else if (n == 0)
+      {
+      snprintf (error, size, "No city matches '%s'", req->city);
+      ret = FALSE;
+      }
+    else
+      {
+      snprintf (error, size, "Ambiguous city '%s'", req->city);
+      ret = FALSE;
+      }
+    if (list) klist_destroy (list);
+    }
+
+  if (ret && !(req->has_lat && req->has_longt))
+    {
+    snprintf (error, size, "No location");
+    ret = FALSE;
+    }
+
+  if (ret && !req->tz && tzmap)
+    {
+    const char *zone = soltzmap_find_zone (tzmap, req->lat, req->longt);
+    if (zone) req->tz = strdup (zone);
+    }
+  if (ret && !req->tz && tz)
+    req->tz = strdup (tz);
+
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_request_get_date
+
+  ==========================================================================*/
+BOOL program_request_get_date (const ProgramRequest *req, time_t *date,
+      char *error, size_t size)
+  {
+  KLOG_IN
+  BOOL ret = TRUE;
+  if (req->date)
+    {
+    *date = datetimeconv_parse_date (req->date, 0, 0, req->tz);
+    if (*date == 0)
+      {
+      snprintf (error, size, "Invalid date '%s'", req->date);
+      ret = FALSE;
+      }
+    }
+  else
+    *date = datetimeconv_make_time_on_day (time (NULL), 0, 0, 0, req->tz);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_request_free
+
+  ==========================================================================*/
+void program_request_free (ProgramRequest *req)
+  {
+  KLOG_IN
+  free (req->city);
+  free (req->tz);
+  free (req->date);
+  memset (req, 0, sizeof (ProgramRequest));
+  KLOG_OUT
+  }
+
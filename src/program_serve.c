@@ -0,0 +1,1524 @@
+/*============================================================================
+  
+  solunar
+  
+  program_serve.c
+
+  The --serve mode, which stays resident and answers HTTP requests on a
+  Unix-domain socket or a TCP port, so the cost of starting the program,
+  and of loading the city table, timezones and ephemeris, is paid only
+  once. The requests are
+
+    GET /day?city=...&date=...
+    GET /day?lat=...&lon=...&tz=...&date=...
+    GET /year?city=...&year=...&feasts=...
+    GET /year?lat=...&tz=...&year=...
+    GET /cities?q=...
+    GET /cities?prefix=...
+    GET /cities?lat=...&lon=...
+
+  and the results are the JSON of solunar_day_summary_to_json() and
+  solunar_year_summary_to_json(), or a list of cities. Anything a request
+  leaves out is filled in as it is for --batch, and an error is reported
+  as {"error":"..."}.
+
+  The main thread runs an event loop, which accepts connections, reads
+  and parses requests, and writes responses; the work of answering them
+  is done by a pool of worker threads, which tell the event loop that a
+  response is ready through an eventfd. Connections are kept alive, and
+  requests can be pipelined: the event loop parses and hands out up to
+  PROGRAM_SERVE_MAX_PIPELINE requests from a connection at a time, and
+  holds back a response until those before it on the same connection
+  have been written.
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <klib/klib.h>
+#include <libsolunar/libsolunar.h>
+#include "program_context.h"
+#include "program.h"
+
+#define KLOG_CLASS "solunar.program_serve"
+
+#define HAS_OPTION(x) program_context_get_boolean(context,x,FALSE)
+#define GET_INTEGER(x,y) program_context_get_integer(context,x,y)
+#define GET(x) program_context_get(context,x)
+
+// The most requests from one connection that can be waiting for, or
+//  with, a worker, or waiting to be written
+#define PROGRAM_SERVE_MAX_PIPELINE 32
+
+// The longest request line and headers, and the most unparsed input
+//  held for a connection, including a request body
+#define PROGRAM_SERVE_MAX_HEADER 8192
+#define PROGRAM_SERVE_MAX_INPUT 65536
+
+// The most output held for a connection before it stops reading; a
+//  client that sends requests but doesn't read the responses can't make
+//  the server hold more
+#define PROGRAM_SERVE_MAX_OUTPUT (256 * 1024)
+
+#define PROGRAM_SERVE_MAX_EVENTS 64
+#define PROGRAM_SERVE_MAX_PARAMS 16
+
+// The longest timezone name accepted from a client. The longest in the
+//  zoneinfo database is about 30 characters
+#define PROGRAM_SERVE_MAX_ZONE 64
+
+// The most cities in the answer to /cities, unless limit is given, and
+//  the most that limit can ask for
+#define PROGRAM_SERVE_CITY_LIMIT 100
+#define PROGRAM_SERVE_MAX_CITY_LIMIT 1000
+
+// A worker reuses its ephemeris for a request whose day starts within
+//  this many seconds of the day for which the ephemeris was made
+#define PROGRAM_SERVE_EPHEMERIS_REUSE (12 * 60 * 60)
+
+struct _ProgramServeConn;
+
+/*============================================================================
+  
+  ProgramServeJob
+
+  A request, from when it is parsed until its response is written
+
+  ==========================================================================*/
+typedef struct _ProgramServeJob
+  {
+  struct _ProgramServeConn *conn;
+  long seq;            // The position of the request on its connection
+  char *target;        // The path and query
+  BOOL head;           // HEAD, rather than GET
+  BOOL close;          // Close the connection after the response
+  char *response;
+  size_t size;
+  struct _ProgramServeJob *next;
+  } ProgramServeJob;
+
+/*============================================================================
+  
+  ProgramServeConn
+
+  A connection. Only the event loop uses it. When its socket is closed
+  it is moved to the list of closed connections, and freed at the end
+  of an iteration of the loop in which no worker has its requests
+
+  ==========================================================================*/
+typedef struct _ProgramServeConn
+  {
+  int fd;              // -1 when closed
+  uint32_t events;     // The events being waited for
+  char *in;            // Input not yet parsed
+  size_t in_len;
+  size_t in_size;
+  char *out;           // Responses not yet written
+  size_t out_len;
+  size_t out_pos;
+  long next_seq;       // For the next request parsed
+  long write_seq;      // Of the next response to write
+  int pending;         // Requests parsed, whose responses aren't written
+  ProgramServeJob *ready; // Responses waiting for earlier ones
+  BOOL eof;            // The client will send no more
+  BOOL closing;        // Read no more, and close when all is written
+  struct _ProgramServeConn *prev;
+  struct _ProgramServeConn *next;
+  } ProgramServeConn;
+
+/*============================================================================
+  
+  ProgramServe
+
+  The state shared by the event loop and the workers. Option defaults
+  are read from the context once, at the start
+
+  ==========================================================================*/
+typedef struct _ProgramServe
+  {
+  const SolTzMap *tzmap;
+  char *tz;                  // --tz, or NULL
+  int feasts;                // --feasts
+  int epfd;
+  int listen_fd;
+  int event_fd;              // Written by a worker when a job is done
+  int signal_fd;
+  ProgramServeConn *conns;
+  ProgramServeConn *closed;
+  pthread_mutex_t lock;
+  pthread_cond_t queued;     // Signalled when a job is queued, or at the end
+  ProgramServeJob *queue;    // Jobs waiting for a worker, oldest first
+  ProgramServeJob *queue_tail;
+  ProgramServeJob *done;     // Jobs waiting for the event loop
+  BOOL stop;
+  } ProgramServe;
+
+/*============================================================================
+  
+  ProgramServeWorker
+
+  ==========================================================================*/
+typedef struct _ProgramServeWorker
+  {
+  ProgramServe *ps;
+  SolEphemeris *eph;
+  time_t eph_date;
+  } ProgramServeWorker;
+
+/*============================================================================
+  
+  ProgramServeParams
+
+  The decoded members of a query string
+
+  ==========================================================================*/
+typedef struct _ProgramServeParams
+  {
+  char *copy;
+  int count;
+  const char *names[PROGRAM_SERVE_MAX_PARAMS];
+  const char *values[PROGRAM_SERVE_MAX_PARAMS];
+  } ProgramServeParams;
+
+/*============================================================================
+  
+  program_serve_decode
+
+  Decode %-escapes, and '+' for space, in place
+
+  ==========================================================================*/
+static void program_serve_decode (char *s)
+  {
+  char *out = s;
+  while (*s)
+    {
+    unsigned int c;
+    if (*s == '%' && isxdigit ((unsigned char)s[1])
+         && isxdigit ((unsigned char)s[2]) && sscanf (s + 1, "%2x", &c) == 1)
+      {
+      *out++ = c;
+      s += 3;
+      }
+    else if (*s == '+')
+      {
+      *out++ = ' ';
+      s++;
+      }
+    else
+      *out++ = *s++;
+    }
+  *out = 0;
+  }
+
+/*============================================================================
+  
+  program_serve_params_parse
+
+  ==========================================================================*/
+static void program_serve_params_parse (ProgramServeParams *params,
+      const char *query)
+  {
+  KLOG_IN
+  memset (params, 0, sizeof (ProgramServeParams));
+  params->copy = strdup (query ? query : "");
+  char *p = params->copy;
+  char *member;
+  while ((member = strsep (&p, "&"))
+      && params->count < PROGRAM_SERVE_MAX_PARAMS)
+    {
+    if (*member == 0) continue;
+    char *value = strchr (member, '=');
+    if (value) *value++ = 0; else value = member + strlen (member);
+    program_serve_decode (member);
+    program_serve_decode (value);
+    params->names[params->count] = member;
+    params->values[params->count] = value;
+    params->count++;
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_param
+
+  Get the value of the first of two names that is present, or NULL.
+  name2 may be NULL
+
+  ==========================================================================*/
+static const char *program_serve_param (const ProgramServeParams *params,
+      const char *name1, const char *name2)
+  {
+  for (int i = 0; i < params->count; i++)
+    if (strcmp (params->names[i], name1) == 0) return params->values[i];
+  for (int i = 0; name2 && i < params->count; i++)
+    if (strcmp (params->names[i], name2) == 0) return params->values[i];
+  return NULL;
+  }
+
+/*============================================================================
+  
+  program_serve_parse_number
+
+  ==========================================================================*/
+static BOOL program_serve_parse_number (const char *s, double *d)
+  {
+  char *end;
+  *d = strtod (s, &end);
+  return end != s && *end == 0;
+  }
+
+/*============================================================================
+  
+  program_serve_is_zone
+
+  Check that a timezone from a client is the name of a zone in the 
+  zoneinfo database. Anything else -- a path, a POSIX TZ string, or an
+  unknown name -- is rejected, before it reaches ktimezone_get(), which
+  would read any file, and would cache every distinct name for ever
+
+  ==========================================================================*/
+static BOOL program_serve_is_zone (const char *s)
+  {
+  if (*s == '/' || strstr (s, "..") || strlen (s) > PROGRAM_SERVE_MAX_ZONE)
+    return FALSE;
+  for (const char *p = s; *p; p++)
+    {
+    if (!isalnum ((unsigned char)*p) && !strchr ("/_+-", *p))
+      return FALSE;
+    }
+  return ktimezone_is_file (s);
+  }
+
+/*============================================================================
+  
+  program_serve_get_request
+
+  Fill in a request from the members of a query string. Returns FALSE,
+  with the reason in error, if a number or the timezone is invalid
+
+  ==========================================================================*/
+static BOOL program_serve_get_request (const ProgramServeParams *params,
+      ProgramRequest *req, char *error, size_t size)
+  {
+  KLOG_IN
+  BOOL ret = TRUE;
+  const char *s;
+  if ((s = program_serve_param (params, "city", NULL)) && *s)
+    req->city = strdup (s);
+  if ((s = program_serve_param (params, "tz", "timezone")) && *s)
+    {
+    if (program_serve_is_zone (s))
+      req->tz = strdup (s);
+    else
+      {
+      snprintf (error, size, "Unknown timezone");
+      ret = FALSE;
+      }
+    }
+  if ((s = program_serve_param (params, "date", NULL)) && *s)
+    req->date = strdup (s);
+  if (ret && (s = program_serve_param (params, "lat", "latitude")))
+    {
+    req->has_lat = program_serve_parse_number (s, &req->lat);
+    if (!req->has_lat)
+      {
+      snprintf (error, size, "Invalid latitude");
+      ret = FALSE;
+      }
+    }
+  if (ret && (s = program_serve_param (params, "lon", "longitude")))
+    {
+    req->has_longt = program_serve_parse_number (s, &req->longt);
+    if (!req->has_longt)
+      {
+      snprintf (error, size, "Invalid longitude");
+      ret = FALSE;
+      }
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_serve_json_string
+
+  Write a string as a JSON string
+
+  ==========================================================================*/
+static void program_serve_json_string (FILE *out, const char *s)
+  {
+  fputc ('"', out);
+  for (const char *p = s; *p; p++)
+    {
+    if (*p == '"' || *p == '\\') fputc ('\\', out);
+    if ((unsigned char)*p >= ' ') fputc (*p, out);
+    }
+  fputc ('"', out);
+  }
+
+/*============================================================================
+  
+  program_serve_day
+
+  Answer /day. Returns the HTTP status
+
+  ==========================================================================*/
+static int program_serve_day (ProgramServeWorker *w,
+      const ProgramServeParams *params, FILE *out)
+  {
+  KLOG_IN
+  ProgramServe *ps = w->ps;
+  ProgramRequest req;
+  memset (&req, 0, sizeof (req));
+  char error[256];
+  const char *city = NULL;
+  time_t d = 0;
+
+  BOOL ok = program_serve_get_request (params, &req, error, sizeof (error));
+  if (ok)
+    ok = program_request_resolve (&req, ps->tzmap, ps->tz, &city, error,
+      sizeof (error));
+  if (ok)
+    ok = program_request_get_date (&req, &d, error, sizeof (error));
+
+  if (ok)
+    {
+    if (!w->eph || d < w->eph_date - PROGRAM_SERVE_EPHEMERIS_REUSE
+         || d > w->eph_date + PROGRAM_SERVE_EPHEMERIS_REUSE)
+      {
+      solephemeris_destroy (w->eph);
+      w->eph = solunar_day_summary_create_ephemeris (d);
+      w->eph_date = d;
+      }
+    SolunarDaySummary *sds = solunar_day_summary_create_with_ephemeris
+      (d, req.lat, req.longt, city, req.tz, w->eph);
+    KString *s = solunar_day_summary_to_json (sds);
+    UTF8 *json = kstring_to_utf8 (s);
+    fprintf (out, "%s\n", json);
+    free (json);
+    kstring_destroy (s);
+    solunar_day_summary_destroy (sds);
+    }
+  else
+    {
+    fprintf (out, "{\"error\":");
+    program_serve_json_string (out, error);
+    fprintf (out, "}\n");
+    }
+
+  program_request_free (&req);
+  KLOG_OUT
+  return ok ? 200 : 400;
+  }
+
+/*============================================================================
+  
+  program_serve_year
+
+  Answer /year. Only the latitude matters, so a request need not give a
+  longitude; one with no position at all is for the northern hemisphere,
+  as on the command line. Returns the HTTP status
+
+  ==========================================================================*/
+static int program_serve_year (ProgramServeWorker *w,
+      const ProgramServeParams *params, FILE *out)
+  {
+  KLOG_IN
+  ProgramServe *ps = w->ps;
+  ProgramRequest req;
+  memset (&req, 0, sizeof (req));
+  char error[256];
+  const char *city = NULL;
+  int feasts = ps->feasts;
+  int year = 0;
+
+  BOOL ok = program_serve_get_request (params, &req, error, sizeof (error));
+  if (ok && (req.city || (req.has_lat && req.has_longt)))
+    ok = program_request_resolve (&req, ps->tzmap, ps->tz, &city, error,
+      sizeof (error));
+  else if (ok)
+    {
+    if (!req.has_lat) req.lat = 51.0;
+    if (!req.tz && ps->tz) req.tz = strdup (ps->tz);
+    }
+
+  const char *s;
+  if (ok && (s = program_serve_param (params, "feasts", NULL)))
+    ok = program_parse_feasts (s, &feasts, error, sizeof (error));
+  if (ok && (s = program_serve_param (params, "year", NULL)))
+    {
+    char *end;
+    year = strtol (s, &end, 10);
+    if (end == s || *end != 0 || year < 1 || year > 9999)
+      {
+      snprintf (error, sizeof (error), "Invalid year '%s'", s);
+      ok = FALSE;
+      }
+    }
+  else if (ok)
+    year = datetimeconv_get_current_year (req.tz);
+
+  if (ok)
+    {
+    SolunarYearSummary *sys = solunar_year_summary_create_with_feasts
+      (year, req.lat, req.tz, feasts);
+    KString *js = solunar_year_summary_to_json (sys);
+    UTF8 *json = kstring_to_utf8 (js);
+    fprintf (out, "%s\n", json);
+    free (json);
+    kstring_destroy (js);
+    solunar_year_summary_destroy (sys);
+    }
+  else
+    {
+    fprintf (out, "{\"error\":");
+    program_serve_json_string (out, error);
+    fprintf (out, "}\n");
+    }
+
+  program_request_free (&req);
+  KLOG_OUT
+  return ok ? 200 : 400;
+  }
+
+/*============================================================================
+  
+  program_serve_cities
+
+  Answer /cities, with the cities whose names contain q, or start with
+  prefix, or that are nearest to lat and lon. Returns the HTTP status
+
+  ==========================================================================*/
+static int program_serve_cities (const ProgramServeParams *params,
+      FILE *out)
+  {
+  KLOG_IN
+  int ret = 200;
+  const char *error = NULL;
+  int limit = PROGRAM_SERVE_CITY_LIMIT;
+  const char *s;
+  if ((s = program_serve_param (params, "limit", NULL)))
+    {
+    char *end;
+    long l = strtol (s, &end, 10);
+    if (end == s || *end != 0 || l < 1) error = "Invalid limit";
+    limit = l > PROGRAM_SERVE_MAX_CITY_LIMIT 
+      ? PROGRAM_SERVE_MAX_CITY_LIMIT : l;
+    }
+
+  KList *list = NULL;
+  double lat, longt;
+  const char *slat = program_serve_param (params, "lat", "latitude");
+  const char *slongt = program_serve_param (params, "lon", "longitude");
+  if (error)
+    ;
+  else if ((s = program_serve_param (params, "q", NULL)))
+    list = solcity_find_matching ((UTF8 *)s);
+  else if ((s = program_serve_param (params, "prefix", NULL)))
+    list = solcity_find_prefix ((UTF8 *)s);
+  else if (slat && slongt)
+    {
+    if (program_serve_parse_number (slat, &lat)
+         && program_serve_parse_number (slongt, &longt))
+      list = solcity_find_nearest (lat, longt, limit);
+    else
+      error = "Invalid latitude or longitude";
+    }
+  else
+    error = "No q, prefix, or position";
+
+  if (error)
+    {
+    fprintf (out, "{\"error\":");
+    program_serve_json_string (out, error);
+    fprintf (out, "}\n");
+    ret = 400;
+    }
+  else
+    {
+    int n = list ? klist_length (list) : 0;
+    fprintf (out, "[");
+    for (int i = 0; i < n && i < limit; i++)
+      {
+      const SolCity *c = klist_get (list, i);
+      fprintf (out, "%s{\"name\":", i ? ",\n" : "");
+      program_serve_json_string (out, solcity_get_name (c));
+      fprintf (out, ",\"latitude\":%g,\"longitude\":%g,\"timezone\":",
+        solcity_get_latitude (c), solcity_get_longitude (c));
+      program_serve_json_string (out, solcity_get_tz_name (c));
+      fprintf (out, "}");
+      }
+    fprintf (out, "]\n");
+    }
+  if (list) klist_destroy (list);
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_serve_status_text
+
+  ==========================================================================*/
+static const char *program_serve_status_text (int status)
+  {
+  switch (status)
+    {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Content Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 505: return "HTTP Version Not Supported";
+    }
+  return "Internal Server Error";
+  }
+
+/*============================================================================
+  
+  program_serve_respond
+
+  Make the response for a job from a status and body
+
+  ==========================================================================*/
+static void program_serve_respond (ProgramServeJob *job, int status,
+      const char *body, size_t size)
+  {
+  KLOG_IN
+  char *response = NULL;
+  size_t len = 0;
+  FILE *out = open_memstream (&response, &len);
+  if (out)
+    {
+    fprintf (out, "HTTP/1.1 %d %s\r\n", status,
+      program_serve_status_text (status));
+    fprintf (out, "Content-Type: application/json\r\n");
+    fprintf (out, "Content-Length: %zu\r\n", size);
+    if (status == 405) fprintf (out, "Allow: GET, HEAD\r\n");
+    if (job->close) fprintf (out, "Connection: close\r\n");
+    fprintf (out, "\r\n");
+    if (!job->head) fwrite (body, 1, size, out);
+    fclose (out);
+    }
+  else
+    {
+    klog_error (KLOG_CLASS, "Can't make response: %s", strerror (errno));
+    // The connection can't carry on if a response is missing
+    job->close = TRUE;
+    }
+  job->response = response;
+  job->size = response ? len : 0;
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_respond_error
+
+  ==========================================================================*/
+static void program_serve_respond_error (ProgramServeJob *job, int status,
+      const char *error)
+  {
+  KLOG_IN
+  char body[256];
+  int len = snprintf (body, sizeof (body), "{\"error\":\"%s\"}\n", error);
+  program_serve_respond (job, status, body, len);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_process
+
+  Work out the response to a job. This is done by a worker
+
+  ==========================================================================*/
+static void program_serve_process (ProgramServeWorker *w,
+      ProgramServeJob *job)
+  {
+  KLOG_IN
+  char *path = strdup (job->target);
+  char *query = strchr (path, '?');
+  if (query) *query++ = 0;
+  program_serve_decode (path);
+  ProgramServeParams params;
+  program_serve_params_parse (&params, query);
+
+  char *body = NULL;
+  size_t size = 0;
+  int status = 404;
+  FILE *out = open_memstream (&body, &size);
+  if (!out)
+    {
+    klog_error (KLOG_CLASS, "Can't process request: %s", strerror (errno));
+    status = 500;
+    }
+  else if (strcmp (path, "/day") == 0)
+    status = program_serve_day (w, &params, out);
+  else if (strcmp (path, "/year") == 0)
+    status = program_serve_year (w, &params, out);
+  else if (strcmp (path, "/cities") == 0)
+    status = program_serve_cities (&params, out);
+  if (out) fclose (out);
+
+  if (status == 404)
+    program_serve_respond_error (job, status, "Not found");
+  else if (status == 500)
+    program_serve_respond_error (job, status, "Internal error");
+  else
+    program_serve_respond (job, status, body, size);
+
+  if (body) free (body);
+  free (params.copy);
+  free (path);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_worker
+
+  ==========================================================================*/
+static void *program_serve_worker (void *arg)
+  {
+  KLOG_IN
+  ProgramServeWorker *w = arg;
+  ProgramServe *ps = w->ps;
+  pthread_mutex_lock (&ps->lock);
+  for (;;)
+    {
+    while (!ps->queue && !ps->stop)
+      pthread_cond_wait (&ps->queued, &ps->lock);
+    if (ps->stop) break;
+    ProgramServeJob *job = ps->queue;
+    ps->queue = job->next;
+    if (!ps->queue) ps->queue_tail = NULL;
+    pthread_mutex_unlock (&ps->lock);
+
+    program_serve_process (w, job);
+
+    pthread_mutex_lock (&ps->lock);
+    job->next = ps->done;
+    ps->done = job;
+    uint64_t one = 1;
+    write (ps->event_fd, &one, sizeof (one));
+    }
+  pthread_mutex_unlock (&ps->lock);
+  KLOG_OUT
+  return NULL;
+  }
+
+/*============================================================================
+  
+  program_serve_job_destroy
+
+  ==========================================================================*/
+static void program_serve_job_destroy (ProgramServeJob *job)
+  {
+  if (job->response) free (job->response);
+  free (job->target);
+  free (job);
+  }
+
+/*============================================================================
+  
+  program_serve_conn_close
+
+  Close the socket of a connection, and move it to the closed list
+
+  ==========================================================================*/
+static void program_serve_conn_close (ProgramServe *ps,
+      ProgramServeConn *conn)
+  {
+  KLOG_IN
+  if (conn->fd >= 0)
+    {
+    epoll_ctl (ps->epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close (conn->fd);
+    conn->fd = -1;
+    // Responses waiting for earlier ones will never be written
+    while (conn->ready)
+      {
+      ProgramServeJob *job = conn->ready;
+      conn->ready = job->next;
+      program_serve_job_destroy (job);
+      conn->pending--;
+      }
+    if (conn->prev) conn->prev->next = conn->next;
+    else ps->conns = conn->next;
+    if (conn->next) conn->next->prev = conn->prev;
+    conn->prev = NULL;
+    conn->next = ps->closed;
+    ps->closed = conn;
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_reap
+
+  Free the closed connections that no worker has requests for
+
+  ==========================================================================*/
+static void program_serve_reap (ProgramServe *ps)
+  {
+  KLOG_IN
+  ProgramServeConn **p = &ps->closed;
+  while (*p)
+    {
+    ProgramServeConn *conn = *p;
+    if (conn->pending > 0)
+      {
+      p = &conn->next;
+      continue;
+      }
+    *p = conn->next;
+    free (conn->in);
+    free (conn->out);
+    free (conn);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_conn_update
+
+  Wait for the events the connection is ready for, and close it if it
+  is finished. Returns FALSE if it was closed
+
+  ==========================================================================*/
+static BOOL program_serve_conn_update (ProgramServe *ps,
+      ProgramServeConn *conn)
+  {
+  KLOG_IN
+  BOOL ret = TRUE;
+  BOOL writing = conn->out_pos < conn->out_len;
+  if (conn->fd < 0)
+    ret = FALSE;
+  else if (!writing && conn->pending == 0 && (conn->closing || conn->eof))
+    {
+    program_serve_conn_close (ps, conn);
+    ret = FALSE;
+    }
+  else
+    {
+    uint32_t events = 0;
+    if (!conn->eof && !conn->closing
+         && conn->in_len < PROGRAM_SERVE_MAX_INPUT
+         && conn->out_len - conn->out_pos < PROGRAM_SERVE_MAX_OUTPUT)
+      events |= EPOLLIN;
+    if (writing) events |= EPOLLOUT;
+    if (events != conn->events)
+      {
+      struct epoll_event ev;
+      memset (&ev, 0, sizeof (ev));
+      ev.events = events;
+      ev.data.ptr = conn;
+      epoll_ctl (ps->epfd, EPOLL_CTL_MOD, conn->fd, &ev);
+      conn->events = events;
+      }
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_serve_conn_write
+
+  Write as much of the waiting output as the socket will take. Returns
+  FALSE if the connection failed, and has been closed
+
+  ==========================================================================*/
+static BOOL program_serve_conn_write (ProgramServe *ps,
+      ProgramServeConn *conn)
+  {
+  KLOG_IN
+  BOOL ret = conn->fd >= 0;
+  while (ret && conn->out_pos < conn->out_len)
+    {
+    ssize_t n = send (conn->fd, conn->out + conn->out_pos,
+      conn->out_len - conn->out_pos, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n > 0)
+      conn->out_pos += n;
+    else if (n < 0 && errno == EINTR)
+      continue;
+    else
+      {
+      if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+        klog_debug (KLOG_CLASS, "Write failed: %s", strerror (errno));
+        program_serve_conn_close (ps, conn);
+        ret = FALSE;
+        }
+      break;
+      }
+    }
+  if (ret && conn->out_pos == conn->out_len)
+    conn->out_pos = conn->out_len = 0;
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_serve_queue
+
+  Give a job to the workers
+
+  ==========================================================================*/
+static void program_serve_queue (ProgramServe *ps, ProgramServeJob *job)
+  {
+  KLOG_IN
+  job->next = NULL;
+  pthread_mutex_lock (&ps->lock);
+  if (ps->queue_tail) ps->queue_tail->next = job;
+  else ps->queue = job;
+  ps->queue_tail = job;
+  pthread_cond_signal (&ps->queued);
+  pthread_mutex_unlock (&ps->lock);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_deliver
+
+  Take a job whose response is ready, and add to the output of its
+  connection all the responses that are now in order
+
+  ==========================================================================*/
+static void program_serve_deliver (ProgramServe *ps, ProgramServeJob *job)
+  {
+  KLOG_IN
+  ProgramServeConn *conn = job->conn;
+  if (conn->fd < 0)
+    {
+    conn->pending--;
+    program_serve_job_destroy (job);
+    KLOG_OUT
+    return;
+    }
+  job->next = conn->ready;
+  conn->ready = job;
+
+  BOOL found = TRUE;
+  while (found)
+    {
+    found = FALSE;
+    for (ProgramServeJob **p = &conn->ready; *p; p = &(*p)->next)
+      {
+      ProgramServeJob *j = *p;
+      if (j->seq != conn->write_seq) continue;
+      *p = j->next;
+      if (j->size > 0)
+        {
+        conn->out = realloc (conn->out, conn->out_len + j->size);
+        memcpy (conn->out + conn->out_len, j->response, j->size);
+        conn->out_len += j->size;
+        }
+      if (j->close) conn->closing = TRUE;
+      conn->write_seq++;
+      conn->pending--;
+      program_serve_job_destroy (j);
+      found = TRUE;
+      break;
+      }
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_find_header_end
+
+  Find the end of the request line and headers, returning its length,
+  including the blank line, or 0 if it has not all been read
+
+  ==========================================================================*/
+static size_t program_serve_find_header_end (const char *in, size_t len)
+  {
+  for (size_t i = 0; i + 1 < len; i++)
+    {
+    if (in[i] != '\n') continue;
+    if (in[i + 1] == '\n') return i + 2;
+    if (i + 2 < len && in[i + 1] == '\r' && in[i + 2] == '\n') return i + 3;
+    }
+  return 0;
+  }
+
+/*============================================================================
+  
+  program_serve_parse_length
+
+  Parse the value of a Content-Length header, which must be only digits,
+  and perhaps trailing spaces. A length larger than the input buffer can
+  hold is given as PROGRAM_SERVE_MAX_INPUT + 1, so it can't overflow.
+  Returns FALSE if the value is malformed
+
+  ==========================================================================*/
+static BOOL program_serve_parse_length (const char *s, size_t *len)
+  {
+  size_t n = 0;
+  const char *p = s;
+  for (; *p >= '0' && *p <= '9'; p++)
+    {
+    n = n * 10 + (size_t)(*p - '0');
+    if (n > PROGRAM_SERVE_MAX_INPUT) n = PROGRAM_SERVE_MAX_INPUT + 1;
+    }
+  if (p == s) return FALSE;
+  while (*p == ' ' || *p == '\t') p++;
+  if (*p) return FALSE;
+  *len = n;
+  return TRUE;
+  }
+
+/*============================================================================
+  
+  program_serve_parse
+
+  Parse the complete requests in the input of a connection, so far as
+  the pipeline allows, and queue them for the workers. Requests that
+  can be answered at once, because they are invalid, are delivered
+  straight away
+
+  ==========================================================================*/
+static void program_serve_parse (ProgramServe *ps, ProgramServeConn *conn)
+  {
+  KLOG_IN
+  while (conn->fd >= 0 && !conn->closing
+      && conn->pending < PROGRAM_SERVE_MAX_PIPELINE
+      && conn->out_len - conn->out_pos < PROGRAM_SERVE_MAX_OUTPUT)
+    {
+    size_t header_len = program_serve_find_header_end (conn->in,
+      conn->in_len);
+    int status = 0;
+    if (header_len == 0)
+      {
+      if (conn->in_len <= PROGRAM_SERVE_MAX_HEADER) break;
+      status = 431;
+      header_len = conn->in_len;
+      }
+    else if (header_len > PROGRAM_SERVE_MAX_HEADER)
+      status = 431;
+
+    ProgramServeJob *job = malloc (sizeof (ProgramServeJob));
+    memset (job, 0, sizeof (ProgramServeJob));
+    job->conn = conn;
+    size_t body_len = 0;
+    if (status == 0)
+      {
+      char *header = strndup (conn->in, header_len);
+      char *p = header;
+      char *line = strsep (&p, "\n");
+      line[strcspn (line, "\r")] = 0;
+      char *method = strsep (&line, " ");
+      char *target = line ? strsep (&line, " ") : NULL;
+      char *version = line;
+      if (!target || !version || strncmp (version, "HTTP/", 5) != 0
+           || *target != '/')
+        status = 400;
+      else if (strncmp (version, "HTTP/1.", 7) != 0)
+        status = 505;
+      else if (strcmp (method, "GET") != 0 && strcmp (method, "HEAD") != 0)
+        status = 405;
+      if (status != 400 && status != 505)
+        {
+        job->target = strdup (target);
+        job->head = strcmp (method, "HEAD") == 0;
+        // Connections are kept alive by default only in HTTP/1.1
+        BOOL keep_alive = strcmp (version, "HTTP/1.0") != 0;
+        BOOL has_length = FALSE;
+        while ((line = strsep (&p, "\n")))
+          {
+          line[strcspn (line, "\r")] = 0;
+          char *value = strchr (line, ':');
+          if (!value) continue;
+          *value++ = 0;
+          while (*value == ' ' || *value == '\t') value++;
+          if (strcasecmp (line, "Connection") == 0)
+            {
+            if (strcasestr (value, "close")) keep_alive = FALSE;
+            else if (strcasestr (value, "keep-alive")) keep_alive = TRUE;
+            }
+          else if (strcasecmp (line, "Content-Length") == 0)
+            {
+            if (has_length || !program_serve_parse_length (value, &body_len))
+              status = 400; // Can't tell where the next request starts
+            has_length = TRUE;
+            }
+          else if (strcasecmp (line, "Transfer-Encoding") == 0)
+            status = 400; // A chunked body can't be skipped
+          }
+        job->close = !keep_alive;
+        }
+      free (header);
+      if (status != 400 
+           && body_len > PROGRAM_SERVE_MAX_INPUT - header_len)
+        status = 413;
+      else if ((status == 0 || status == 405)
+           && header_len + body_len > conn->in_len)
+        {
+        // Wait for the rest of the body
+        free (job->target);
+        free (job);
+        break;
+        }
+      }
+
+    job->seq = conn->next_seq++;
+    conn->pending++;
+    if (status != 0)
+      {
+      // The rest of the input can't be relied on after a bad request
+      if (status != 405) job->close = TRUE;
+      program_serve_respond_error (job, status,
+        program_serve_status_text (status));
+      }
+    if (job->close)
+      {
+      conn->closing = TRUE;
+      conn->in_len = 0;
+      }
+    else
+      {
+      size_t used = header_len + body_len;
+      memmove (conn->in, conn->in + used, conn->in_len - used);
+      conn->in_len -= used;
+      }
+    if (status != 0)
+      program_serve_deliver (ps, job);
+    else
+      program_serve_queue (ps, job);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_conn_read
+
+  Read what is available. Returns FALSE if the connection failed, and
+  has been closed
+
+  ==========================================================================*/
+static BOOL program_serve_conn_read (ProgramServe *ps,
+      ProgramServeConn *conn)
+  {
+  KLOG_IN
+  BOOL ret = TRUE;
+  if (conn->in_size - conn->in_len < 4096
+       && conn->in_size < PROGRAM_SERVE_MAX_INPUT)
+    {
+    conn->in_size = conn->in_size ? conn->in_size * 2 : 4096;
+    conn->in = realloc (conn->in, conn->in_size);
+    }
+  ssize_t n = recv (conn->fd, conn->in + conn->in_len,
+    conn->in_size - conn->in_len, MSG_DONTWAIT);
+  if (n > 0)
+    conn->in_len += n;
+  else if (n == 0)
+    conn->eof = TRUE;
+  else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+    {
+    klog_debug (KLOG_CLASS, "Read failed: %s", strerror (errno));
+    program_serve_conn_close (ps, conn);
+    ret = FALSE;
+    }
+  KLOG_OUT
+  return ret;
+  }
+
+/*============================================================================
+  
+  program_serve_conn_run
+
+  Parse what has been read, write what is ready, and wait for whatever
+  the connection needs next
+
+  ==========================================================================*/
+static void program_serve_conn_run (ProgramServe *ps, ProgramServeConn *conn)
+  {
+  KLOG_IN
+  program_serve_parse (ps, conn);
+  if (program_serve_conn_write (ps, conn))
+    program_serve_conn_update (ps, conn);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_accept
+
+  ==========================================================================*/
+static void program_serve_accept (ProgramServe *ps)
+  {
+  KLOG_IN
+  int fd;
+  while ((fd = accept4 (ps->listen_fd, NULL, NULL,
+            SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+    {
+    // Responses are small, and a client that pipelines will not
+    //  acknowledge one before sending the next request
+    int one = 1;
+    setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof (one));
+    ProgramServeConn *conn = malloc (sizeof (ProgramServeConn));
+    memset (conn, 0, sizeof (ProgramServeConn));
+    conn->fd = fd;
+    conn->events = EPOLLIN;
+    struct epoll_event ev;
+    memset (&ev, 0, sizeof (ev));
+    ev.events = conn->events;
+    ev.data.ptr = conn;
+    if (epoll_ctl (ps->epfd, EPOLL_CTL_ADD, fd, &ev) != 0)
+      {
+      klog_warn (KLOG_CLASS, "Can't add connection: %s", strerror (errno));
+      close (fd);
+      free (conn);
+      continue;
+      }
+    conn->next = ps->conns;
+    if (ps->conns) ps->conns->prev = conn;
+    ps->conns = conn;
+    }
+  if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR
+       && errno != ECONNABORTED)
+    klog_warn (KLOG_CLASS, "Can't accept connection: %s", strerror (errno));
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_finish
+
+  Deliver the responses the workers have finished
+
+  ==========================================================================*/
+static void program_serve_finish (ProgramServe *ps)
+  {
+  KLOG_IN
+  uint64_t count;
+  read (ps->event_fd, &count, sizeof (count));
+  pthread_mutex_lock (&ps->lock);
+  ProgramServeJob *done = ps->done;
+  ps->done = NULL;
+  pthread_mutex_unlock (&ps->lock);
+
+  // The list is newest first; reversed, the responses on a connection
+  //  usually come in the order they are written
+  ProgramServeJob *jobs = NULL;
+  while (done)
+    {
+    ProgramServeJob *job = done;
+    done = job->next;
+    job->next = jobs;
+    jobs = job;
+    }
+
+  while (jobs)
+    {
+    ProgramServeJob *job = jobs;
+    jobs = job->next;
+    ProgramServeConn *conn = job->conn;
+    program_serve_deliver (ps, job);
+    if (conn->fd >= 0) program_serve_conn_run (ps, conn);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_listen
+
+  Open a socket listening on address, which is the path of a Unix-domain
+  socket if it contains a '/', or otherwise a TCP port, with or without
+  a host name or address in front of it, separated by a ':'. The host
+  is the loopback address if it isn't given. Returns -1, having logged
+  the reason, if the socket can't be opened
+
+  ==========================================================================*/
+static int program_serve_listen (const char *address)
+  {
+  KLOG_IN
+  int fd = -1;
+  if (strchr (address, '/'))
+    {
+    struct sockaddr_un sa;
+    memset (&sa, 0, sizeof (sa));
+    sa.sun_family = AF_UNIX;
+    if (strlen (address) >= sizeof (sa.sun_path))
+      {
+      klog_error (KLOG_CLASS, "Socket path too long: %s", address);
+      KLOG_OUT
+      return -1;
+      }
+    strcpy (sa.sun_path, address);
+    // A socket left by a server that did not exit cleanly would stop
+    //  this one binding
+    struct stat st;
+    if (stat (address, &st) == 0 && S_ISSOCK (st.st_mode))
+      unlink (address);
+    fd = socket (AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind (fd, (struct sockaddr *)&sa, sizeof (sa)) != 0
+         || listen (fd, SOMAXCONN) != 0)
+      {
+      klog_error (KLOG_CLASS, "Can't listen on %s: %s", address,
+        strerror (errno));
+      if (fd >= 0) close (fd);
+      fd = -1;
+      }
+    }
+  else
+    {
+    char *host = strdup (address);
+    char *port = strrchr (host, ':');
+    if (port) *port++ = 0; else port = host;
+    struct addrinfo hints;
+    memset (&hints, 0, sizeof (hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV;
+    struct addrinfo *ai = NULL;
+    int err = getaddrinfo (port == host || *host == 0 ? "127.0.0.1" : host,
+      port, &hints, &ai);
+    if (err != 0)
+      klog_error (KLOG_CLASS, "Can't listen on %s: %s", address,
+        gai_strerror (err));
+    for (struct addrinfo *a = ai; a && fd < 0; a = a->ai_next)
+      {
+      fd = socket (a->ai_family, a->ai_socktype | SOCK_NONBLOCK
+        | SOCK_CLOEXEC, a->ai_protocol);
+      if (fd < 0) continue;
+      int one = 1;
+      setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof (one));
+      if (bind (fd, a->ai_addr, a->ai_addrlen) != 0
+           || listen (fd, SOMAXCONN) != 0)
+        {
+        if (!a->ai_next)
+          klog_error (KLOG_CLASS, "Can't listen on %s: %s", address,
+            strerror (errno));
+        close (fd);
+        fd = -1;
+        }
+      }
+    if (ai) freeaddrinfo (ai);
+    free (host);
+    }
+  KLOG_OUT
+  return fd;
+  }
+
+/*============================================================================
+  
+  program_serve_add
+
+  Add one of the server's own descriptors to the event loop. The event
+  data of every descriptor is a pointer: to the descriptor itself for
+  these, and to the connection for a connection
+
+  ==========================================================================*/
+static void program_serve_add (ProgramServe *ps, int *fd)
+  {
+  KLOG_IN
+  struct epoll_event ev;
+  memset (&ev, 0, sizeof (ev));
+  ev.events = EPOLLIN;
+  ev.data.ptr = fd;
+  epoll_ctl (ps->epfd, EPOLL_CTL_ADD, *fd, &ev);
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve_loop
+
+  Run the event loop until SIGINT or SIGTERM
+
+  ==========================================================================*/
+static void program_serve_loop (ProgramServe *ps)
+  {
+  KLOG_IN
+  struct epoll_event events[PROGRAM_SERVE_MAX_EVENTS];
+  BOOL stop = FALSE;
+  while (!stop)
+    {
+    int n = epoll_wait (ps->epfd, events, PROGRAM_SERVE_MAX_EVENTS, -1);
+    if (n < 0 && errno != EINTR)
+      {
+      klog_error (KLOG_CLASS, "Event loop failed: %s", strerror (errno));
+      break;
+      }
+    for (int i = 0; i < n; i++)
+      {
+      struct epoll_event *ev = &events[i];
+      if (ev->data.ptr == &ps->signal_fd)
+        stop = TRUE;
+      else if (ev->data.ptr == &ps->listen_fd)
+        program_serve_accept (ps);
+      else if (ev->data.ptr == &ps->event_fd)
+        program_serve_finish (ps);
+      else
+        {
+        // A connection closed earlier in this iteration is not freed
+        //  until the end of it, so its events can still be looked at
+        ProgramServeConn *conn = ev->data.ptr;
+        if (conn->fd < 0)
+          ;
+        else if (ev->events & (EPOLLERR | EPOLLHUP))
+          program_serve_conn_close (ps, conn);
+        else if (!(ev->events & EPOLLIN)
+              || program_serve_conn_read (ps, conn))
+          program_serve_conn_run (ps, conn);
+        }
+      }
+    program_serve_reap (ps);
+    }
+  KLOG_OUT
+  }
+
+/*============================================================================
+  
+  program_serve
+
+  Handle the --serve option
+
+  ==========================================================================*/
+int program_serve (const ProgramContext *context)
+  {
+  KLOG_IN
+  int ret = 0;
+  ProgramServe ps;
+  memset (&ps, 0, sizeof (ps));
+  if (!program_get_feasts (context, &ps.feasts))
+    {
+    KLOG_OUT
+    return EINVAL;
+    }
+
+  int threads = GET_INTEGER ("threads", 0);
+  if (threads <= 0) threads = sysconf (_SC_NPROCESSORS_ONLN);
+  if (threads <= 0) threads = 1;
+
+  char *address = GET ("serve");
+  ps.listen_fd = program_serve_listen (address);
+  if (ps.listen_fd < 0)
+    {
+    free (address);
+    KLOG_OUT
+    return EADDRNOTAVAIL;
+    }
+
+  // As for --batch, only the zone given by --tz is the default
+  char *tz = GET ("tz");
+  if (tz && (strstr (tz, "sys") || strstr (tz, "system")))
+    {
+    free (tz);
+    tz = NULL;
+    }
+  ps.tz = tz;
+  ps.tzmap = program_context_get_tzmap (context);
+
+  // The signals are blocked before the workers start, so they are
+  //  blocked in every thread, and only seen by the event loop
+  sigset_t signals, old_signals;
+  sigemptyset (&signals);
+  sigaddset (&signals, SIGINT);
+  sigaddset (&signals, SIGTERM);
+  pthread_sigmask (SIG_BLOCK, &signals, &old_signals);
+  ps.signal_fd = signalfd (-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+  ps.event_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  ps.epfd = epoll_create1 (EPOLL_CLOEXEC);
+  pthread_mutex_init (&ps.lock, NULL);
+  pthread_cond_init (&ps.queued, NULL);
+  program_serve_add (&ps, &ps.listen_fd);
+  program_serve_add (&ps, &ps.event_fd);
+  program_serve_add (&ps, &ps.signal_fd);
+
+  pthread_t *workers = malloc (threads * sizeof (pthread_t));
+  ProgramServeWorker *states = calloc (threads,
+    sizeof (ProgramServeWorker));
+  for (int i = 0; i < threads; i++)
+    {
+    states[i].ps = &ps;
+    pthread_create (&workers[i], NULL, program_serve_worker, &states[i]);
+    }
+  klog_info (KLOG_CLASS, "Serving on %s with %d threads", address,
+    threads);
+
+  program_serve_loop (&ps);
+
+  klog_info (KLOG_CLASS, "Stopping");
+  pthread_mutex_lock (&ps.lock);
+  ps.stop = TRUE;
+  pthread_cond_broadcast (&ps.queued);
+  pthread_mutex_unlock (&ps.lock);
+  for (int i = 0; i < threads; i++)
+    {
+    pthread_join (workers[i], NULL);
+    solephemeris_destroy (states[i].eph);
+    }
+  free (states);
+  free (workers);
+
+  // Every job is now waiting for a worker, or for the event loop, or
+  //  for an earlier response on its connection, which closing the
+  //  connection discards
+  while (ps.queue)
+    {
+    ProgramServeJob *job = ps.queue;
+    ps.queue = job->next;
+    job->conn->pending--;
+    program_serve_job_destroy (job);
+    }
+  while (ps.done)
+    {
+    ProgramServeJob *job = ps.done;
+    ps.done = job->next;
+    job->conn->pending--;
+    program_serve_job_destroy (job);
+    }
+  while (ps.conns)
+    program_serve_conn_close (&ps, ps.conns);
+  program_serve_reap (&ps);
+
+  close (ps.epfd);
+  close (ps.event_fd);
+  close (ps.signal_fd);
+  close (ps.listen_fd);
+  if (strchr (address, '/')) unlink (address);
+  pthread_sigmask (SIG_SETMASK, &old_signals, NULL);
+  pthread_cond_destroy (&ps.queued);
+  pthread_mutex_destroy (&ps.lock);
+  if (tz) free (tz);
+  free (address);
+  KLOG_OUT
+  return ret;
+  }
+
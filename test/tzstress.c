@@ -0,0 +1,323 @@
+/*============================================================================
+
+  solunar
+
+  tzstress.c
+
+  A stress test of the thread-safety of the timezone code. A number of
+  threads convert the same times, in a number of zones, through the _r
+  calls in datetimeconv, all at once, and starting from a cold cache of
+  zones, so that zones are also loaded concurrently. Each thread's
+  results are then compared with those of the same conversions done on
+  one thread. Any difference is reported, and the exit status is 1.
+
+  The times are spread at random over 1900-2100 and then, in a second
+  run, are a second either side of each change of offset in each zone
+  from 1970 to 2040, where conversions are most likely to go wrong.
+
+  Run it with "make check", which builds it with the same flags as the
+  program. To look for races, rather than only for wrong answers, build
+  it with ThreadSanitizer:
+
+    make clean; make check EXTRA_CFLAGS=-fsanitize=thread \
+      EXTRA_LDFLAGS=-fsanitize=thread
+
+  Usage: tzstress [threads [times]]
+
+  Copyright (c)1990-2020 Kevin Boone. Distributed under the terms of the
+  GNU Public Licence, v3.0
+
+  ==========================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <klib/klib.h>
+
+// Threads, and random times in each zone, if not given
+#define DEFAULT_THREADS 8
+#define DEFAULT_TIMES 5000
+
+#define START_1900 ((time_t)-2208988800LL)
+#define END_2100 ((time_t)4102444800LL)
+#define START_1970 ((time_t)0)
+#define END_2040 ((time_t)2208988800LL)
+
+// Zones with the awkward features: half-hour and 45-minute offsets,
+//  DST of half an hour, days that were skipped, changes of rule, and
+//  POSIX TZ strings, which are not files
+static const char *zone_names[] =
+  {
+  "UTC",
+  "Europe/London",
+  "America/New_York",
+  "America/St_Johns",
+  "Asia/Kolkata",
+  "Asia/Kathmandu",
+  "Australia/Lord_Howe",
+  "Pacific/Chatham",
+  "Pacific/Apia",
+  "Africa/Casablanca",
+  "EST5EDT,M3.2.0,M11.1.0",
+  "UTC-5:30"
+  };
+
+#define NZONES (sizeof (zone_names) / sizeof (zone_names[0]))
+
+/*============================================================================
+
+  Case
+
+  A zone and a time to convert
+
+  ==========================================================================*/
+typedef struct _Case
+  {
+  const char *zone;
+  time_t t;
+  } Case;
+
+/*============================================================================
+
+  Result
+
+  Everything worked out for a case. It is cleared before it is filled
+  in, so results can be compared with memcmp()
+
+  ==========================================================================*/
+typedef struct _Result
+  {
+  int fields[7]; // year, month, day, hour, minute, second, isdst
+  long gmtoff;
+  char zone[16];
+  char text[64];
+  time_t back;   // The local time made into a time_t again
+  time_t noon;   // Noon on the same local day
+  time_t parsed; // The local date, parsed, at 09:30
+  int current_year;
+  } Result;
+
+/*============================================================================
+
+  Worker
+
+  ==========================================================================*/
+typedef struct _Worker
+  {
+  pthread_t thread;
+  const Case *cases;
+  int ncases;
+  int first;
+  Result *results;
+  } Worker;
+
+/*============================================================================
+
+  tzstress_convert
+
+  ==========================================================================*/
+static void tzstress_convert (const Case *c, Result *r)
+  {
+  memset (r, 0, sizeof (Result));
+  const KTimeZone *tz = ktimezone_get (c->zone);
+
+  struct tm tm;
+  datetimeconv_localtime_r (c->t, &tm, tz);
+  r->fields[0] = tm.tm_year + 1900;
+  r->fields[1] = tm.tm_mon + 1;
+  r->fields[2] = tm.tm_mday;
+  r->fields[3] = tm.tm_hour;
+  r->fields[4] = tm.tm_min;
+  r->fields[5] = tm.tm_sec;
+  r->fields[6] = tm.tm_isdst;
+  r->gmtoff = tm.tm_gmtoff;
+  if (tm.tm_zone)
+    strncpy (r->zone, tm.tm_zone, sizeof (r->zone) - 1);
+
+  datetimeconv_format_time_r ("%Y-%m-%d %H:%M:%S %Z %z", tz, c->t,
+    r->text, sizeof (r->text));
+  r->back = datetimeconv_maketime_r (r->fields[0], r->fields[1],
+    r->fields[2], r->fields[3], r->fields[4], r->fields[5], tz);
+  r->noon = datetimeconv_make_time_on_day_r (c->t, 12, 0, 0, tz);
+
+  char date[32];
+  snprintf (date, sizeof (date), "%04d-%02d-%02d", r->fields[0],
+    r->fields[1], r->fields[2]);
+  r->parsed = datetimeconv_parse_date_r (date, 9, 30, tz);
+  r->current_year = datetimeconv_get_current_year_r (tz);
+  }
+
+/*============================================================================
+
+  tzstress_worker
+
+  Convert all the cases, starting at a different one in each thread, so
+  that the threads are not all converting the same case at once
+
+  ==========================================================================*/
+static void *tzstress_worker (void *arg)
+  {
+  Worker *w = arg;
+  for (int i = 0; i < w->ncases; i++)
+    {
+    int n = (w->first + i) % w->ncases;
+    tzstress_convert (&w->cases[n], &w->results[n]);
+    }
+  return NULL;
+  }
+
+/*============================================================================
+
+  tzstress_random_time
+
+  A time from 1900 to 2100. rand_r() gives only 31 bits, which is not
+  enough for 200 years of seconds, so two values are combined
+
+  ==========================================================================*/
+static time_t tzstress_random_time (unsigned int *seed)
+  {
+  double f = rand_r (seed) / (RAND_MAX + 1.0);
+  f += rand_r (seed) / ((RAND_MAX + 1.0) * (RAND_MAX + 1.0));
+  return START_1900 + (time_t)(f * (END_2100 - START_1900));
+  }
+
+/*============================================================================
+
+  tzstress_make_random_cases
+
+  ntimes random times in each zone. The zones are not loaded. Returns
+  the number of cases, which the caller must free
+
+  ==========================================================================*/
+static int tzstress_make_random_cases (int ntimes, Case **cases)
+  {
+  int n = NZONES * ntimes;
+  *cases = malloc (n * sizeof (Case));
+  unsigned int seed = 1;
+  for (int i = 0; i < n; i++)
+    {
+    (*cases)[i].zone = zone_names[i % NZONES];
+    (*cases)[i].t = tzstress_random_time (&seed);
+    }
+  return n;
+  }
+
+/*============================================================================
+
+  tzstress_make_transition_cases
+
+  A second either side of each change of offset in each zone. Returns
+  the number of cases, which the caller must free
+
+  ==========================================================================*/
+static int tzstress_make_transition_cases (Case **cases)
+  {
+  int size = 1024;
+  int n = 0;
+  *cases = malloc (size * sizeof (Case));
+  for (size_t z = 0; z < NZONES; z++)
+    {
+    int ntransitions;
+    KTimeZoneTransition *transitions = ktimezone_get_transitions
+      (ktimezone_get (zone_names[z]), START_1970, END_2040, &ntransitions);
+    for (int i = 0; i < ntransitions; i++)
+      {
+      for (int d = -1; d <= 1; d++)
+        {
+        if (n == size)
+          {
+          size *= 2;
+          *cases = realloc (*cases, size * sizeof (Case));
+          }
+        (*cases)[n].zone = zone_names[z];
+        (*cases)[n].t = transitions[i].time + d;
+        n++;
+        }
+      }
+    free (transitions);
+    }
+  return n;
+  }
+
+/*============================================================================
+
+  tzstress_run
+
+  Convert the cases on nthreads threads at once, and then on this one,
+  and compare. Returns the number of results that differ
+
+  ==========================================================================*/
+static int tzstress_run (const Case *cases, int ncases, int nthreads)
+  {
+  Worker *workers = malloc (nthreads * sizeof (Worker));
+  for (int t = 0; t < nthreads; t++)
+    {
+    workers[t].cases = cases;
+    workers[t].ncases = ncases;
+    workers[t].first = (int)((long)ncases * t / nthreads);
+    workers[t].results = malloc (ncases * sizeof (Result));
+    pthread_create (&workers[t].thread, NULL, tzstress_worker, &workers[t]);
+    }
+  for (int t = 0; t < nthreads; t++)
+    pthread_join (workers[t].thread, NULL);
+
+  int failures = 0;
+  for (int i = 0; i < ncases; i++)
+    {
+    Result expected;
+    tzstress_convert (&cases[i], &expected);
+    for (int t = 0; t < nthreads; t++)
+      {
+      const Result *r = &workers[t].results[i];
+      if (memcmp (r, &expected, sizeof (Result)) != 0)
+        {
+        if (failures < 10)
+          fprintf (stderr, "Thread %d, %s at %ld: got '%s', "
+            "expected '%s'\n", t, cases[i].zone, (long)cases[i].t,
+            r->text, expected.text);
+        failures++;
+        }
+      }
+    }
+
+  for (int t = 0; t < nthreads; t++)
+    free (workers[t].results);
+  free (workers);
+  return failures;
+  }
+
+/*============================================================================
+
+  main
+
+  ==========================================================================*/
+int main (int argc, char **argv)
+  {
+  int nthreads = argc > 1 ? atoi (argv[1]) : DEFAULT_THREADS;
+  int ntimes = argc > 2 ? atoi (argv[2]) : DEFAULT_TIMES;
+  if (nthreads < 1 || ntimes < 1)
+    {
+    fprintf (stderr, "Usage: %s [threads [times]]\n", argv[0]);
+    return 2;
+    }
+  klog_set_log_level (KLOG_ERROR);
+
+  // The random times come first, while no zone is loaded, so the
+  //  threads load them concurrently
+  Case *cases;
+  int ncases = tzstress_make_random_cases (ntimes, &cases);
+  int failures = tzstress_run (cases, ncases, nthreads);
+  printf ("Random times: %d threads x %d conversions, %d differ\n",
+    nthreads, ncases, failures);
+  free (cases);
+
+  ncases = tzstress_make_transition_cases (&cases);
+  int f = tzstress_run (cases, ncases, nthreads);
+  printf ("Transitions:  %d threads x %d conversions, %d differ\n",
+    nthreads, ncases, f);
+  free (cases);
+  failures += f;
+
+  return failures ? 1 : 0;
+  }